@@ -105,6 +105,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
 
   opts.set_xla_cpu_enable_mlir_tiling_and_fusion(true);
   opts.set_xla_cpu_enable_experimental_deallocation(true);
+  opts.set_xla_cpu_enable_buffer_table_arena(false);
 
   opts.set_xla_partitioning_algorithm(
       DebugOptions::PARTITIONING_ALGORITHM_NOOP);
@@ -850,6 +851,33 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
           &DebugOptions::set_xla_cpu_enable_experimental_deallocation),
       debug_options->xla_cpu_enable_experimental_deallocation(),
       "Enable experimental deallocation."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_enable_buffer_table_arena",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_buffer_table_arena),
+      debug_options->xla_cpu_enable_buffer_table_arena(),
+      "Serve the temporary buffers of XLA:CPU executables from pooled "
+      "per-executable slabs instead of allocating them on every run."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_cost_model_profile",
+      string_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_cost_model_profile),
+      debug_options->xla_cpu_parallel_cost_model_profile(),
+      "If set, XLA:CPU chooses parallel task counts with a cost model "
+      "calibrated for the host. Either a path to a text CostModelProfile "
+      "proto, or \"calibrate\" to measure the host on first use."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_object_code_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_cpu_object_code_cache_dir),
+      debug_options->xla_cpu_object_code_cache_dir(),
+      "Directory in which XLA:CPU caches JIT-compiled object code, so that "
+      "identical modules skip LLVM optimization and code generation."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      debug_options->xla_cpu_parallel_codegen_split_count(),
+      "If greater than one, split the LLVM module of an XLA:CPU program into "
+      "up to this many shards that are optimized and compiled in parallel."));
   flag_list->push_back(
       tsl::Flag("xla_gpu_enable_latency_hiding_scheduler",
                 bool_setter_for(
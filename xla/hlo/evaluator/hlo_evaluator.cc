@@ -15,6 +15,7 @@ limitations under the License.
 #include "xla/hlo/evaluator/hlo_evaluator.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <complex>
 #include <cstdint>
@@ -22,6 +23,7 @@ limitations under the License.
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -61,11 +63,15 @@ limitations under the License.
 #include "xla/util.h"
 #include "xla/window_util.h"
 #include "tsl/lib/core/bitmap.h"
+#include "tsl/platform/blocking_counter.h"
+#include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/protobuf.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 
 namespace xla {
@@ -3927,6 +3933,10 @@ static StatusOr<bool> PerformReductionStep(
   return true;
 }
 
+// Minimum number of elements for which a reduction to a single element is
+// split across threads.
+static constexpr int64_t kParallelReduceMinElements = 1 << 16;
+
 static StatusOr<bool> GenerateReduceOutputElement(
     bool is_tuple, absl::Span<const int64_t> output_index,
 
@@ -3960,6 +3970,36 @@ static StatusOr<bool> GenerateReduceOutputElement(
     absl::Span<const int64_t> minor_to_major = LayoutUtil::MinorToMajor(shape);
 
     static constexpr int kChunkSize = 512;
+
+    // A reduction of every element visits the input in linear order, so its
+    // chunks are contiguous and can be summed in parallel. Adding up the
+    // chunk sums in order gives the same result as the loop below.
+    const int64_t num_elements = ShapeUtil::ElementsIn(shape);
+    if (output_index.empty() && shape.is_static() &&
+        num_elements >= kParallelReduceMinElements) {
+      std::vector<double> chunk_sums(CeilOfRatio<int64_t>(num_elements,
+                                                          kChunkSize));
+      HloEvaluator::ParallelFor(
+          chunk_sums.size(), kParallelReduceMinElements / kChunkSize,
+          [&](int64_t begin, int64_t end) {
+            int64_t indices[kChunkSize];
+            for (int64_t chunk = begin; chunk < end; ++chunk) {
+              const int64_t start = chunk * kChunkSize;
+              const int64_t size =
+                  std::min<int64_t>(kChunkSize, num_elements - start);
+              std::iota(indices, indices + size, start);
+              chunk_sums[chunk] = *input_arg0->GetSumAsDouble(
+                  absl::MakeConstSpan(indices, size));
+            }
+          });
+      for (double chunk_sum : chunk_sums) {
+        computed_result += chunk_sum;
+      }
+      TF_RETURN_IF_ERROR(
+          results[0].SetFromDouble(output_index, computed_result));
+      return true;
+    }
+
     int64_t linear_indices[kChunkSize];
     int n_linear_indices = 0;
 
@@ -4173,6 +4213,48 @@ Status HloEvaluator::Postprocess(HloInstruction* hlo) {
 }
 
 namespace {
+
+// State shared by the threads running a ParallelFor. Helpers that start after
+// every range has been claimed only touch this state, which they keep alive.
+class ParallelForState {
+ public:
+  ParallelForState(int64_t n, int64_t chunk_size,
+                   absl::FunctionRef<void(int64_t, int64_t)> fn)
+      : n_(n),
+        chunk_size_(chunk_size),
+        num_chunks_(CeilOfRatio(n, chunk_size)),
+        fn_(fn),
+        pending_(num_chunks_) {}
+
+  int64_t num_chunks() const { return num_chunks_; }
+
+  // Runs unclaimed ranges until there are none left.
+  void RunChunks() {
+    for (int64_t chunk = next_chunk_.fetch_add(1); chunk < num_chunks_;
+         chunk = next_chunk_.fetch_add(1)) {
+      const int64_t begin = chunk * chunk_size_;
+      fn_(begin, std::min(begin + chunk_size_, n_));
+      pending_.DecrementCount();
+    }
+  }
+
+  void Wait() { pending_.Wait(); }
+
+ private:
+  const int64_t n_;
+  const int64_t chunk_size_;
+  const int64_t num_chunks_;
+  absl::FunctionRef<void(int64_t, int64_t)> fn_;
+  std::atomic<int64_t> next_chunk_{0};
+  tsl::BlockingCounter pending_;
+};
+
+tsl::thread::ThreadPool* GetParallelForThreadPool() {
+  static auto* pool = new tsl::thread::ThreadPool(
+      tsl::Env::Default(), "hlo_evaluator", tsl::port::MaxParallelism());
+  return pool;
+}
+
 template <typename T>
 std::unique_ptr<Array2D<T>> MatmulArray2DImpl(
     const Array2D<T>& lhs, const Array2D<T>& rhs,
@@ -4185,18 +4267,64 @@ std::unique_ptr<Array2D<T>> MatmulArray2DImpl(
   int n = rhs.width();
   int k = lhs.width();
   auto result = std::make_unique<Array2D<T>>(m, n);
-  // Because Eigen is a header-oriented library, make sure that the Eigen code
-  // is the same as the code used by the CPU backend (otherwise the linker will
-  // randomly pick *some* definition).
-  impl_fn(
-      /*run_options_ptr=*/nullptr, result->data(), rhs.data(), lhs.data(), n, m,
-      k,
-      /*transpose_lhs=*/0,
-      /*transpose_rhs=*/0);
+  // Rows of the result only depend on the same rows of lhs, so blocks of rows
+  // are multiplied independently. Blocks hold at least kMinBlockFlops.
+  constexpr int64_t kMinBlockFlops = int64_t{1} << 20;
+  const int64_t min_rows =
+      std::max<int64_t>(1, kMinBlockFlops / std::max<int64_t>(1, n * k));
+  HloEvaluator::ParallelFor(m, min_rows, [&](int64_t begin, int64_t end) {
+    // Because Eigen is a header-oriented library, make sure that the Eigen
+    // code is the same as the code used by the CPU backend (otherwise the
+    // linker will randomly pick *some* definition).
+    impl_fn(
+        /*run_options_ptr=*/nullptr, result->data() + begin * n, rhs.data(),
+        lhs.data() + begin * k, n, end - begin, k,
+        /*transpose_lhs=*/0,
+        /*transpose_rhs=*/0);
+  });
   return result;
 }
 }  // namespace
 
+/* static */ void HloEvaluator::ParallelFor(
+    int64_t n, int64_t min_chunk_size,
+    absl::FunctionRef<void(int64_t, int64_t)> fn) {
+  CHECK_GT(min_chunk_size, 0);
+  if (n <= min_chunk_size) {
+    if (n > 0) {
+      fn(0, n);
+    }
+    return;
+  }
+  auto state = std::make_shared<ParallelForState>(n, min_chunk_size, fn);
+  tsl::thread::ThreadPool* pool = GetParallelForThreadPool();
+  const int64_t num_helpers =
+      std::min<int64_t>(state->num_chunks() - 1, pool->NumThreads());
+  for (int64_t i = 0; i < num_helpers; ++i) {
+    pool->Schedule([state]() { state->RunChunks(); });
+  }
+  state->RunChunks();
+  state->Wait();
+}
+
+/* static */ bool HloEvaluator::HaveSameLinearLayout(
+    const Literal& result, std::initializer_list<const Literal*> operands) {
+  const Shape& shape = result.shape();
+  if (!shape.IsArray() || !shape.is_static() ||
+      !LayoutUtil::IsDenseArray(shape)) {
+    return false;
+  }
+  for (const Literal* operand : operands) {
+    const Shape& operand_shape = operand->shape();
+    if (!operand_shape.IsArray() || !operand_shape.is_static() ||
+        !ShapeUtil::SameDimensions(shape, operand_shape) ||
+        !LayoutUtil::Equal(shape.layout(), operand_shape.layout())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 std::unique_ptr<Array2D<Eigen::half>> HloEvaluator::MatmulArray2D(
     const Array2D<Eigen::half>& lhs, const Array2D<Eigen::half>& rhs) {
   return MatmulArray2DImpl<Eigen::half>(
@@ -18,12 +18,15 @@ limitations under the License.
 
 #define _USE_MATH_DEFINES
 
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
 #include <memory>
 #include <optional>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/types/span.h"
 #include "xla/array2d.h"
 #include "xla/hlo/ir/dfs_hlo_visitor_with_default.h"
@@ -236,6 +239,13 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   static std::unique_ptr<Array2D<int32_t>> MatmulArray2D(
       const Array2D<int32_t>& lhs, const Array2D<int32_t>& rhs);
 
+  // Calls `fn` on disjoint [begin, end) ranges that together cover [0, n).
+  // Every range but the last holds `min_chunk_size` elements. Ranges are run
+  // by a thread pool shared by all evaluators and by the calling thread, which
+  // keeps nested calls from deadlocking; `fn` must be thread-safe.
+  static void ParallelFor(int64_t n, int64_t min_chunk_size,
+                          absl::FunctionRef<void(int64_t, int64_t)> fn);
+
  protected:
   // Evaluates the given instruction, and stores the evaluation result in the
   // evaluated_ map.
@@ -466,6 +476,17 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    if (HaveSameLinearLayout(result, {&operand_literal})) {
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      ParallelFor(result_data.size(), kElementwiseChunkSize,
+                  [&](int64_t begin, int64_t end) {
+                    for (int64_t i = begin; i < end; ++i) {
+                      result_data[i] = unary_op(operand_data[i]);
+                    }
+                  });
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
         [&](absl::Span<const int64_t> multi_index, int) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
@@ -473,6 +494,15 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     return std::move(result);
   }
 
+  // Number of elements an elementwise op evaluates per ParallelFor range.
+  static constexpr int64_t kElementwiseChunkSize = 1 << 14;
+
+  // Returns whether `result` and all `operands` are static dense arrays with
+  // the same dimensions and layout. Elementwise ops can then walk the linear
+  // data of all of them in lockstep instead of going through multi-indices.
+  static bool HaveSameLinearLayout(
+      const Literal& result, std::initializer_list<const Literal*> operands);
+
   // Map from a primitive type to its associated (templated) DfsHloVisitor.
   std::unique_ptr<DfsHloVisitor> typed_visitors_[PrimitiveType_ARRAYSIZE];
 
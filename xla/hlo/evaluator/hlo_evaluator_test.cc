@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "xla/hlo/evaluator/hlo_evaluator.h"
 
+#include <atomic>
 #include <initializer_list>
 #include <memory>
 #include <optional>
@@ -2628,6 +2629,146 @@ void BM_ReducePrecisely(::testing::benchmark::State& state) {
 
 BENCHMARK(BM_ReducePrecisely);
 
+// Evaluates add(p0, p1) on f32[n, n]. If range(1) is 0, p1 has a transposed
+// layout, so the evaluator has to take the multi-index path instead of walking
+// the operands' data linearly.
+void BM_ElementwiseAdd(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  const bool same_layout = state.range(1);
+  HloComputation::Builder b("BM_ElementwiseAdd");
+  HloModuleConfig config;
+  config.set_debug_options(GetDebugOptionsFromFlags());
+  HloModule module("BM_ElementwiseAdd", config);
+
+  Array2D<float> values(n, n);
+  values.FillUnique(1.0f);
+  Literal lhs = LiteralUtil::CreateR2FromArray2D(values);
+  Literal rhs = same_layout
+                    ? lhs.Clone()
+                    : lhs.Relayout(LayoutUtil::MakeLayout({0, 1}));
+  HloInstruction* lhs_instruction =
+      b.AddInstruction(HloInstruction::CreateConstant(std::move(lhs)));
+  HloInstruction* rhs_instruction =
+      b.AddInstruction(HloInstruction::CreateConstant(std::move(rhs)));
+  HloInstruction* add_instruction = b.AddInstruction(
+      HloInstruction::CreateBinary(lhs_instruction->shape(), HloOpcode::kAdd,
+                                   lhs_instruction, rhs_instruction));
+  module.AddEntryComputation(b.Build());
+
+  for (auto s : state) {
+    HloEvaluator hlo_eval;
+    hlo_eval.Evaluate(add_instruction).value();
+  }
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+
+BENCHMARK(BM_ElementwiseAdd)->ArgsProduct({{256, 2048}, {0, 1}});
+
+void BM_MatmulArray2D(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  Array2D<float> lhs(n, n);
+  Array2D<float> rhs(n, n);
+  lhs.FillRandom(1.0f);
+  rhs.FillRandom(1.0f);
+  for (auto s : state) {
+    HloEvaluator::MatmulArray2D(lhs, rhs);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * n * n * n);
+}
+
+BENCHMARK(BM_MatmulArray2D)->Arg(128)->Arg(1024);
+
+TEST(HloEvaluatorParallelForTest, CoversRangeOnce) {
+  constexpr int64_t kNumElements = 100003;
+  std::vector<std::atomic<int>> counts(kNumElements);
+  HloEvaluator::ParallelFor(
+      kNumElements, /*min_chunk_size=*/1000, [&](int64_t begin, int64_t end) {
+        // Nested calls run on the same pool and must not deadlock.
+        HloEvaluator::ParallelFor(end - begin, /*min_chunk_size=*/100,
+                                  [&](int64_t inner_begin, int64_t inner_end) {
+                                    for (int64_t i = begin + inner_begin;
+                                         i < begin + inner_end; ++i) {
+                                      counts[i].fetch_add(1);
+                                    }
+                                  });
+      });
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    ASSERT_EQ(counts[i].load(), 1) << "element " << i;
+  }
+}
+
+TEST_F(HloEvaluatorTest, LargeElementwiseOpsIgnoreOperandLayouts) {
+  constexpr absl::string_view kHloModule = R"(
+    HloModule elementwise
+
+    ENTRY main {
+      p0 = f32[300,300]{1,0} parameter(0)
+      p1 = f32[300,300]{0,1} parameter(1)
+      same_layout = f32[300,300]{1,0} add(p0, p0)
+      mixed_layout = f32[300,300]{1,0} add(p0, p1)
+      ROOT result = (f32[300,300]{1,0}, f32[300,300]{1,0}) tuple(same_layout,
+                                                                 mixed_layout)
+    }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(kHloModule));
+  Array2D<float> values(300, 300);
+  values.FillUnique(1.0f);
+  Literal p0 = LiteralUtil::CreateR2FromArray2D(values);
+  Literal p1 = p0.Relayout(LayoutUtil::MakeLayout({0, 1}));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({&p0, &p1}));
+
+  Array2D<float> doubled(300, 300);
+  doubled.Each([&](int64_t i, int64_t j, float* value) {
+    *value = 2 * values(i, j);
+  });
+  Literal expected = LiteralUtil::CreateR2FromArray2D(doubled);
+  std::vector<Literal> results = result.DecomposeTuple();
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, results[0]));
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, results[1]));
+}
+
+TEST_F(HloEvaluatorTest, LargeReduceToScalar) {
+  constexpr absl::string_view kHloModule = R"(
+    HloModule reduce
+
+    add {
+      lhs = f32[] parameter(0)
+      rhs = f32[] parameter(1)
+      ROOT add = f32[] add(lhs, rhs)
+    }
+
+    ENTRY main {
+      p0 = f32[512,1000] parameter(0)
+      init = f32[] constant(1)
+      ROOT reduce = f32[] reduce(p0, init), dimensions={0,1}, to_apply=add
+    }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(kHloModule));
+  Array2D<float> values(512, 1000, 0.25f);
+  Literal p0 = LiteralUtil::CreateR2FromArray2D(values);
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({&p0}));
+  EXPECT_TRUE(
+      LiteralTestUtil::Equal(LiteralUtil::CreateR0<float>(128001), result));
+}
+
+TEST(HloEvaluatorMatmulTest, MatchesNaiveMatmul) {
+  Array2D<float> lhs(301, 257);
+  Array2D<float> rhs(257, 65);
+  lhs.FillRandom(1.0f);
+  rhs.FillRandom(1.0f);
+  std::unique_ptr<Array2D<float>> result =
+      HloEvaluator::MatmulArray2D(lhs, rhs);
+  for (int64_t i = 0; i < lhs.height(); ++i) {
+    for (int64_t j = 0; j < rhs.width(); ++j) {
+      double expected = 0;
+      for (int64_t k = 0; k < lhs.width(); ++k) {
+        expected += static_cast<double>(lhs(i, k)) * rhs(k, j);
+      }
+      ASSERT_NEAR((*result)(i, j), expected, 1e-3) << i << ", " << j;
+    }
+  }
+}
+
 TEST_P(HloEvaluatorBf16Test, ReduceAdd) {
   HloComputation::Builder b(TestName());
 
@@ -2124,12 +2124,28 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     const Literal& rhs_literal = parent_->GetEvaluatedLiteralFor(rhs);
 
     Literal result(shape);
+    const std::function<ReturnT(ReturnT, ReturnT)> converted_op =
+        ConvertBinaryFunction(binary_op);
+
+    if (HloEvaluator::HaveSameLinearLayout(result,
+                                           {&lhs_literal, &rhs_literal})) {
+      absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+      absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      HloEvaluator::ParallelFor(
+          result_data.size(), HloEvaluator::kElementwiseChunkSize,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              result_data[i] = converted_op(lhs_data[i], rhs_data[i]);
+            }
+          });
+      return std::move(result);
+    }
 
     TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
         [&](absl::Span<const int64_t> multi_index, int) {
-          return ConvertBinaryFunction(binary_op)(
-              lhs_literal.Get<ReturnT>(multi_index),
-              rhs_literal.Get<ReturnT>(multi_index));
+          return converted_op(lhs_literal.Get<ReturnT>(multi_index),
+                              rhs_literal.Get<ReturnT>(multi_index));
         }));
     return std::move(result);
   }
@@ -2152,6 +2168,23 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
+    if (HloEvaluator::HaveSameLinearLayout(
+            result, {&lhs_literal, &rhs_literal, &ehs_literal})) {
+      absl::Span<const LhsType> lhs_data = lhs_literal.data<LhsType>();
+      absl::Span<const RhsType> rhs_data = rhs_literal.data<RhsType>();
+      absl::Span<const EhsType> ehs_data = ehs_literal.data<EhsType>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      HloEvaluator::ParallelFor(
+          result_data.size(), HloEvaluator::kElementwiseChunkSize,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              result_data[i] =
+                  ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+            }
+          });
+      return std::move(result);
+    }
+
     TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
         [&](absl::Span<const int64_t> multi_index, int) {
           return ternary_op(lhs_literal.Get<LhsType>(multi_index),
@@ -32,10 +32,12 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "xla/hlo/ir/dfs_hlo_visitor_with_default.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
 #include "xla/hlo/ir/hlo_clone_context.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_instructions.h"
@@ -50,6 +52,7 @@ limitations under the License.
 #include "xla/types.h"
 #include "xla/util.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/status.h"
 
@@ -141,7 +144,7 @@ HloInstruction* HloComputation::AddInstruction(
 HloInstruction* HloComputation::AddInstructionInternal(
     std::unique_ptr<HloInstruction> instruction) {
   if (parent() != nullptr) {
-    instruction->UniquifyName(&parent()->instruction_name_uniquer());
+    parent()->UniquifyInstructionName(instruction.get());
     instruction->SetUniqueId(parent()->NewUniqueInstructionId());
   }
   instruction->set_parent(this);
@@ -694,6 +697,60 @@ absl::Cord HloComputation::ToCord(
   return std::move(printer).ToCord();
 }
 
+namespace {
+
+// A printer that folds everything printed into a fingerprint instead of
+// accumulating it.
+class FingerprintPrinter : public Printer {
+ public:
+  void Append(const absl::AlphaNum& a) override {
+    fingerprint_ =
+        tsl::FingerprintCat64(fingerprint_, tsl::Fingerprint64(a.Piece()));
+  }
+
+  uint64_t fingerprint() const { return fingerprint_; }
+
+ private:
+  uint64_t fingerprint_ = 0;
+};
+
+}  // namespace
+
+uint64_t HloComputation::ContentFingerprint() const {
+  static const auto* const kOptions = new HloPrintOptions(
+      HloPrintOptions::Canonical()
+          .set_print_subcomputation_mode(
+              HloPrintOptions::PrintSubcomputationMode::kNameOnly)
+          .set_print_backend_config(true));
+  std::vector<HloInstruction*> post_order = MakeInstructionPostOrder();
+  FingerprintPrinter printer;
+  Print(&printer, *kOptions, post_order);
+
+  // The text leaves out large constants, the bodies of fusion computations
+  // and control dependencies, which are referred to by name only.
+  absl::flat_hash_map<const HloInstruction*, int64_t> positions;
+  positions.reserve(post_order.size());
+  for (int64_t i = 0; i < post_order.size(); ++i) {
+    const HloInstruction* instruction = post_order[i];
+    positions[instruction] = i;
+    if (instruction->opcode() == HloOpcode::kConstant) {
+      const auto* constant = Cast<HloConstantInstruction>(instruction);
+      if (constant->HasLiteral()) {
+        printer.Append(absl::HashOf(constant->literal()));
+      }
+    } else if (instruction->opcode() == HloOpcode::kFusion) {
+      for (const HloComputation* fused : instruction->called_computations()) {
+        printer.Append(fused->ContentFingerprint());
+      }
+    }
+    for (const HloInstruction* predecessor :
+         instruction->control_predecessors()) {
+      printer.Append(positions.at(predecessor));
+    }
+  }
+  return printer.fingerprint();
+}
+
 HloComputationProto HloComputation::ToProto() const {
   HloComputationProto proto;
   CHECK(unique_id_ != -1)
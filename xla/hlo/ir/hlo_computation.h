@@ -275,6 +275,16 @@ class HloComputation {
       const HloPrintOptions& options,
       absl::Span<const HloInstruction* const> instruction_order) const;
 
+  // Returns a fingerprint of the instructions of this computation, of their
+  // operands, control dependencies, attributes and constants, and of the
+  // fusion computations nested in it. Other called computations contribute
+  // only their names, so that a computation keeps its fingerprint when one of
+  // its callees changes. Instruction names and metadata are ignored, so
+  // rewrites that only replace instructions by identical ones do not change
+  // the fingerprint. The fingerprint is computed without materializing the
+  // HLO text, but it is only stable within a process.
+  uint64_t ContentFingerprint() const;
+
   // Returns a serialized representation of this computation.
   HloComputationProto ToProto() const;
 
@@ -387,10 +387,19 @@ class HloModule {
   uint64_t RandomNew64() const;
 
   // Returns the NameUniquer for uniquing instruction names in this module.
+  // Using it directly is not thread-safe; prefer UniquifyInstructionName.
   NameUniquer& instruction_name_uniquer() { return instruction_name_uniquer_; }
 
-  // Assign a new unique dense id for an instruction
+  // Gives 'instruction' a name that is unique in this module. Thread-safe, so
+  // that several computations of the module can add instructions at once.
+  void UniquifyInstructionName(HloInstruction* instruction) {
+    absl::MutexLock lock(&uniquer_mutex_);
+    instruction->UniquifyName(&instruction_name_uniquer_);
+  }
+
+  // Assign a new unique dense id for an instruction. Thread-safe.
   int NewUniqueInstructionId() {
+    absl::MutexLock lock(&uniquer_mutex_);
     int result = next_unique_id_;
     next_unique_id_++;
     return result;
@@ -445,7 +454,7 @@ class HloModule {
 
   void SetAndUniquifyInstrName(HloInstruction* instr, absl::string_view name) {
     instr->SetAndSanitizeName(name);
-    instr->UniquifyName(&instruction_name_uniquer_);
+    UniquifyInstructionName(instr);
   }
 
   Status CheckUniqueNamesAndIdsForComputationsAndInstructions() const;
@@ -594,6 +603,10 @@ class HloModule {
   NameUniquer computation_name_uniquer_{/*separator=*/"."};
   NameUniquer instruction_name_uniquer_{/*separator=*/"."};
   int next_unique_id_ = 0;
+  // Guards instruction_name_uniquer_ and next_unique_id_ against instructions
+  // being added to different computations concurrently. Adding or removing
+  // computations is not thread-safe.
+  absl::Mutex uniquer_mutex_;
 
   // Used to keep track of the next unique module id that should be assigned.
   static std::atomic<int> next_unique_module_id_;
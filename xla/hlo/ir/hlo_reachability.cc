@@ -15,27 +15,149 @@ limitations under the License.
 
 #include "xla/hlo/ir/hlo_reachability.h"
 
+#include <algorithm>
+#include <iterator>
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
 #include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
 
 namespace xla {
 
+bool HloReachabilityMap::BitSet::IntervalsContain(Index index) const {
+  // The first interval starting after `index`; only the one before it can
+  // contain `index`.
+  auto it = absl::c_upper_bound(
+      intervals_, index,
+      [](Index index, const Interval& interval) {
+        return index < interval.start;
+      });
+  return it != intervals_.begin() && index < std::prev(it)->end;
+}
+
+void HloReachabilityMap::BitSet::AddIntervals(
+    absl::Span<const Interval> intervals) {
+  DCHECK(!dense_);
+  std::vector<Interval> merged;
+  merged.reserve(intervals_.size() + intervals.size());
+  auto append = [&](const Interval& interval) {
+    if (!merged.empty() && interval.start <= merged.back().end) {
+      merged.back().end = std::max(merged.back().end, interval.end);
+    } else {
+      merged.push_back(interval);
+    }
+  };
+  auto a = intervals_.begin();
+  auto b = intervals.begin();
+  while (a != intervals_.end() || b != intervals.end()) {
+    if (b == intervals.end() ||
+        (a != intervals_.end() && a->start <= b->start)) {
+      append(*a++);
+    } else {
+      append(*b++);
+    }
+  }
+  intervals_ = std::move(merged);
+  if (intervals_.size() * sizeof(Interval) > NumWords(size_) * sizeof(Word)) {
+    Densify();
+  }
+}
+
+void HloReachabilityMap::BitSet::SetRange(Index start, Index end) {
+  DCHECK(dense_);
+  for (Index index = start; index < end;) {
+    if (index % kBits == 0 && end - index >= kBits) {
+      vector_[index / kBits] = ~Word{0};
+      index += kBits;
+    } else {
+      vector_[index / kBits] |= 1ull << (index % kBits);
+      ++index;
+    }
+  }
+}
+
+void HloReachabilityMap::BitSet::Densify() {
+  DCHECK(!dense_);
+  dense_ = true;
+  vector_.assign(NumWords(size_), 0);
+  for (const Interval& interval : intervals_) {
+    SetRange(interval.start, interval.end);
+  }
+  std::vector<Interval>().swap(intervals_);
+}
+
+void HloReachabilityMap::BitSet::UnionSlow(const BitSet& other) {
+  if (!dense_ && !other.dense_) {
+    AddIntervals(other.intervals_);
+  } else if (dense_) {
+    for (const Interval& interval : other.intervals_) {
+      SetRange(interval.start, interval.end);
+    }
+  } else {
+    Densify();
+    *this |= other;
+  }
+}
+
+bool HloReachabilityMap::BitSet::operator==(const BitSet& other) const {
+  if (dense_ == other.dense_) {
+    return dense_ ? vector_ == other.vector_ : intervals_ == other.intervals_;
+  }
+  const BitSet& dense = dense_ ? *this : other;
+  BitSet densified = dense_ ? other : *this;
+  densified.Densify();
+  return dense.vector_ == densified.vector_;
+}
+
 HloReachabilityMap::HloReachabilityMap(
     absl::Span<const HloInstruction* const> instructions)
-    : bit_sets_(instructions.size(), BitSet(instructions.size())) {
+    : HloReachabilityMap(instructions,
+                         DefaultRepresentation(instructions.size())) {}
+
+HloReachabilityMap::HloReachabilityMap(
+    absl::Span<const HloInstruction* const> instructions,
+    Representation representation)
+    : bit_sets_(instructions.size(),
+                BitSet(instructions.size(),
+                       /*compressible=*/representation ==
+                           Representation::kIntervals)),
+      representation_(representation) {
   for (size_t i = 0; i < instructions.size(); ++i) {
     bit_sets_[i].Set(i);  // Instructions are reachable from themselves.
     indices_[GetKey(instructions[i])] = i;
   }
 }
 
+HloReachabilityMap::Index HloReachabilityMap::AddInstruction(
+    const HloInstruction* instruction) {
+  Index index = bit_sets_.size();
+  auto [it, inserted] = indices_.insert({GetKey(instruction), index});
+  CHECK(inserted) << instruction->name() << " is already in the map";
+  bit_sets_.push_back(BitSet(
+      index + 1,
+      /*compressible=*/representation_ == Representation::kIntervals));
+  bit_sets_.back().Set(index);
+  return index;
+}
+
+size_t HloReachabilityMap::ReachabilitySetBytes() const {
+  size_t bytes = 0;
+  for (const BitSet& bit_set : bit_sets_) {
+    bytes += sizeof(BitSet) + bit_set.HeapBytes();
+  }
+  return bytes;
+}
+
 bool HloReachabilityMap::SetReachabilityToUnion(
     absl::Span<const HloInstruction* const> inputs,
     const HloInstruction* instruction) {
   Index index = GetIndex(instruction);
   BitSet& bit_set = bit_sets_[index];
+  bit_set.Grow(bit_sets_.size());
   tmp_bit_set_ = bit_set;
   SetReachabilityToUnionHelper(inputs, index);
   return bit_set != tmp_bit_set_;
@@ -65,6 +187,7 @@ void HloReachabilityMap::SetReachabilityToUnionHelper(
 void HloReachabilityMap::SetReachabilityToUnionHelper(
     absl::Span<const Index> input_indices, Index index) {
   BitSet& bit_set = bit_sets_[index];
+  bit_set.Grow(bit_sets_.size());
   // If instruction is part of inputs, don't reset the bit-set.
   if (!absl::c_linear_search(input_indices, index)) {
     bit_set.SetToZero();
@@ -104,11 +227,18 @@ std::unique_ptr<HloReachabilityMap> HloReachabilityMap::BuildWithRestrictions(
 
 std::unique_ptr<HloReachabilityMap> HloReachabilityMap::Build(
     const HloComputation* computation) {
+  return Build(computation,
+               DefaultRepresentation(computation->instruction_count()));
+}
+
+std::unique_ptr<HloReachabilityMap> HloReachabilityMap::Build(
+    const HloComputation* computation, Representation representation) {
   HloComputation::ChannelDependencies channel_dependencies =
       computation->ComputeChannelDependencies();
   std::vector<HloInstruction*> instructions =
       computation->MakeInstructionPostOrder(channel_dependencies);
-  auto result = std::make_unique<HloReachabilityMap>(instructions);
+  auto result =
+      std::make_unique<HloReachabilityMap>(instructions, representation);
 
   auto get_bit_set = [&](const HloInstruction* instruction) -> BitSet& {
     return result->bit_sets_[result->GetIndex(instruction)];
@@ -140,26 +270,100 @@ std::unique_ptr<HloReachabilityMap> HloReachabilityMap::Build(
 
 void HloReachabilityMap::UpdateReachabilityThroughInstruction(
     const HloInstruction* instruction) {
+  UpdateReachability(instruction, /*after_mutation=*/false);
+}
+
+void HloReachabilityMap::UpdateReachabilityAfterMutation(
+    const HloInstruction* instruction) {
+  UpdateReachability(instruction, /*after_mutation=*/true);
+}
+
+void HloReachabilityMap::UpdateReachability(const HloInstruction* instruction,
+                                            bool after_mutation) {
   std::queue<const HloInstruction*> worklist;
   worklist.push(instruction);
 
   std::vector<HloInstruction*> inputs;
+  auto get_inputs = [&](const HloInstruction* item) {
+    inputs.assign(item->operands().begin(), item->operands().end());
+    inputs.insert(inputs.end(), item->control_predecessors().begin(),
+                  item->control_predecessors().end());
+  };
+  auto push_successors = [&](const HloInstruction* item) {
+    for (const HloInstruction* user : item->users()) {
+      worklist.push(user);
+    }
+    for (const HloInstruction* succ : item->control_successors()) {
+      worklist.push(succ);
+    }
+  };
+
+  // Adds 'missing' and those of its transitive predecessors that are not in
+  // the map yet, each after its own predecessors. The successors of the added
+  // instructions are queued, as their predecessor sets changed.
+  auto add_missing = [&](const HloInstruction* missing) {
+    std::vector<std::pair<const HloInstruction*, bool>> stack;
+    stack.push_back({missing, false});
+    while (!stack.empty()) {
+      auto [item, inputs_added] = stack.back();
+      if (IsPresent(item)) {
+        stack.pop_back();
+        continue;
+      }
+      get_inputs(item);
+      if (!inputs_added) {
+        stack.back().second = true;
+        for (const HloInstruction* input : inputs) {
+          if (!IsPresent(input)) {
+            stack.push_back({input, false});
+          }
+        }
+        continue;
+      }
+      stack.pop_back();
+      AddInstruction(item);
+      FastSetReachabilityToUnion(inputs, item);
+      push_successors(item);
+    }
+  };
 
   while (!worklist.empty()) {
     const HloInstruction* item = worklist.front();
     worklist.pop();
 
-    inputs.assign(item->operands().begin(), item->operands().end());
-    inputs.insert(inputs.end(), item->control_predecessors().begin(),
-                  item->control_predecessors().end());
+    if (after_mutation && !IsPresent(item)) {
+      add_missing(item);
+      continue;
+    }
+
+    get_inputs(item);
+    if (after_mutation) {
+      for (const HloInstruction* input : inputs) {
+        if (!IsPresent(input)) {
+          add_missing(input);
+        }
+      }
+      // add_missing() clobbers 'inputs'.
+      get_inputs(item);
+      // Keep the reachability through channel dependencies, which only Build()
+      // computes; SetReachabilityToUnion does not reset an instruction that is
+      // one of its own inputs.
+      const auto* channel_instruction = DynCast<HloChannelInstruction>(item);
+      if (channel_instruction && channel_instruction->channel_id()) {
+        inputs.push_back(const_cast<HloInstruction*>(item));
+      }
+    }
 
     if (SetReachabilityToUnion(inputs, item)) {
       // Add immediate successors to worklist.
+      push_successors(item);
+    } else if (after_mutation) {
+      // Users that were created by the mutation, e.g. the get-tuple-elements
+      // of a new multi-output fusion, still need to be added.
       for (const HloInstruction* user : item->users()) {
-        worklist.push(user);
-      }
-      for (const HloInstruction* succ : item->control_successors()) {
-        worklist.push(succ);
+        if (!IsPresent(user)) {
+          worklist.push(user);
+        }
       }
     }
   }
@@ -41,10 +41,32 @@ class HloReachabilityMap {
  public:
   using Index = size_t;
 
+  // How the reachability set of each instruction is stored.
+  enum class Representation {
+    // One bit per instruction in every set, i.e. O(n^2) bits in total. Unions
+    // are plain word-wise ORs.
+    kDense,
+    // Every set is a sorted list of disjoint index intervals, and switches to
+    // dense bits only once that is smaller. Build() indexes instructions in
+    // post order, where the ancestors of an instruction mostly form a few
+    // long intervals, so this stays far below O(n^2) on large computations.
+    kIntervals,
+  };
+
+  // Maps over at least this many instructions use kIntervals unless a
+  // representation is requested explicitly; the dense sets would take 8MB.
+  static constexpr size_t kIntervalsThreshold = 8192;
+  static Representation DefaultRepresentation(size_t num_instructions) {
+    return num_instructions >= kIntervalsThreshold ? Representation::kIntervals
+                                                   : Representation::kDense;
+  }
+
   // Sets up a graph with no edges and where the nodes correspond to the given
   // instructions.
   explicit HloReachabilityMap(
       absl::Span<const HloInstruction* const> instructions);
+  HloReachabilityMap(absl::Span<const HloInstruction* const> instructions,
+                     Representation representation);
 
   // Computes and returns the reachability between HLO instructions in the
   // computation. The returned HloReachabilityMap is constructed such that
@@ -54,6 +76,8 @@ class HloReachabilityMap {
   // reachability. Trivially an instruction is reachable from itself.
   static std::unique_ptr<HloReachabilityMap> Build(
       const HloComputation* computation);
+  static std::unique_ptr<HloReachabilityMap> Build(
+      const HloComputation* computation, Representation representation);
 
   // Similar to the above Build operation except that it tries to identify
   // paths between instructions that do not contain control instructions
@@ -102,12 +126,28 @@ class HloReachabilityMap {
   void SetReachable(const HloInstruction* a, const HloInstruction* b) {
     SetReachable(GetIndex(a), GetIndex(b));
   }
-  void SetReachable(Index a, Index b) { bit_sets_[b].Set(a); }
+  void SetReachable(Index a, Index b) {
+    bit_sets_[b].Grow(bit_sets_.size());
+    bit_sets_[b].Set(a);
+  }
 
   // Updates the given reachability map after the immediate predecessor set
   // (operands and control predecessors) of 'instruction' has changed.
   void UpdateReachabilityThroughInstruction(const HloInstruction* instruction);
 
+  // Like UpdateReachabilityThroughInstruction, but also accepts a graph that
+  // was mutated in ways the map has not seen yet, so that a pass can keep one
+  // map alive across its rewrites instead of rebuilding it after each of them:
+  // 'instruction', its predecessors and its users that are not in the map are
+  // added to it first. Instructions with a channel dependency keep what they
+  // were reachable from before, since only Build() computes channel
+  // dependencies; reachability may thus be over-approximated for those, but
+  // is never missed.
+  void UpdateReachabilityAfterMutation(const HloInstruction* instruction);
+
+  // Adds 'instruction' to the map, reachable only from itself.
+  Index AddInstruction(const HloInstruction* instruction);
+
   // Returns true if "b" is reachable from "a"
   //
   // Note that this function only correctly answers queries about reachability
@@ -138,48 +178,118 @@ class HloReachabilityMap {
   void Replace(const HloInstruction* original,
                const HloInstruction* replacement);
 
+  Representation representation() const { return representation_; }
+
+  // Returns the number of bytes held by the reachability sets.
+  size_t ReachabilitySetBytes() const;
+
  private:
   // A dynamically sized bit-set implementation specialized for this use case
-  // providing fast bitwise OR (not available in tsl::gtl::BitMap).
+  // providing fast bitwise OR (not available in tsl::gtl::BitMap). A
+  // compressible bit-set holds its bits as sorted, disjoint, non-adjacent
+  // intervals for as long as they take less memory than the dense words.
   class BitSet {
    public:
     BitSet() = default;
-    explicit BitSet(size_t size)
-        : size_(size), vector_((size + kBits - 1) / kBits, 0) {}
-
-    // Returns the bit at the given index.
+    explicit BitSet(size_t size, bool compressible = false)
+        : size_(size),
+          compressible_(compressible),
+          dense_(!compressible),
+          vector_(compressible ? 0 : NumWords(size), 0) {}
+
+    // Returns the bit at the given index. Indices past the size of the set
+    // belong to instructions added to the map later, and are never set.
     bool Get(Index index) const {
-      DCHECK(index >= 0 && index < size_);
+      if (index >= size_) {
+        return false;
+      }
+      if (!dense_) {
+        return IntervalsContain(index);
+      }
       return vector_[index / kBits] & (1ull << (index % kBits));
     }
 
     // Sets the bit at the given index.
     void Set(Index index) {
       DCHECK(index >= 0 && index < size_);
+      if (!dense_) {
+        AddIntervals({Interval{index, index + 1}});
+        return;
+      }
       vector_[index / kBits] |= 1ull << (index % kBits);
     }
 
-    // Sets this bit-set to union of this bit-set and `other`.
+    // Sets this bit-set to union of this bit-set and `other`, which must not
+    // be larger.
     void operator|=(const BitSet& other) {
-      for (size_t i = 0; i < vector_.size(); ++i) {
-        vector_[i] |= other.vector_[i];
+      DCHECK_GE(size_, other.size_);
+      if (dense_ && other.dense_) {
+        for (size_t i = 0; i < other.vector_.size(); ++i) {
+          vector_[i] |= other.vector_[i];
+        }
+        return;
       }
+      UnionSlow(other);
     }
 
     // Sets the bitvector to all zeros.
-    void SetToZero() { absl::c_fill(vector_, 0); }
+    void SetToZero() {
+      if (compressible_) {
+        dense_ = false;
+        std::vector<Word>().swap(vector_);
+        intervals_.clear();
+        return;
+      }
+      absl::c_fill(vector_, 0);
+    }
 
-    bool operator==(const BitSet& other) const {
-      return vector_ == other.vector_;
+    // Makes room for indices up to `size`; the new bits are zero.
+    void Grow(size_t size) {
+      if (size <= size_) {
+        return;
+      }
+      size_ = size;
+      if (dense_) {
+        vector_.resize(NumWords(size), 0);
+      }
     }
+
+    bool operator==(const BitSet& other) const;
     bool operator!=(const BitSet& other) const { return !(*this == other); }
 
+    size_t HeapBytes() const {
+      return vector_.capacity() * sizeof(Word) +
+             intervals_.capacity() * sizeof(Interval);
+    }
+
    private:
     using Word = uint64_t;
     static constexpr size_t kBits = 64;
 
-    size_t size_;  // Number of bits in the set.
+    // The half-open range of indices [start, end).
+    struct Interval {
+      Index start;
+      Index end;
+      bool operator==(const Interval& other) const {
+        return start == other.start && end == other.end;
+      }
+    };
+
+    static size_t NumWords(size_t size) { return (size + kBits - 1) / kBits; }
+
+    bool IntervalsContain(Index index) const;
+    // Adds the sorted, disjoint `intervals` to a bit-set that is not dense,
+    // and makes it dense if the intervals outgrow the dense words.
+    void AddIntervals(absl::Span<const Interval> intervals);
+    void SetRange(Index start, Index end);
+    void Densify();
+    void UnionSlow(const BitSet& other);
+
+    size_t size_ = 0;  // Number of bits in the set.
+    bool compressible_ = false;
+    bool dense_ = true;
     std::vector<Word> vector_;
+    std::vector<Interval> intervals_;
   };
 
   using Key = std::pair<int, int>;  // module ID, instruction ID.
@@ -193,6 +303,11 @@ class HloReachabilityMap {
   void SetReachabilityToUnionHelper(absl::Span<const Index> input_indices,
                                     Index index);
 
+  // Helper for UpdateReachabilityThroughInstruction and
+  // UpdateReachabilityAfterMutation.
+  void UpdateReachability(const HloInstruction* instruction,
+                          bool after_mutation);
+
   // Map from instruction to index. The index is used for bit_set_ and the bits
   // within a BitSet.
   absl::flat_hash_map<Key, Index> indices_;
@@ -204,6 +319,8 @@ class HloReachabilityMap {
   // A temporary used by SetReachabilityToUnion to avoid an allocation with each
   // call to the method.
   BitSet tmp_bit_set_;
+
+  Representation representation_;
 };
 
 }  // namespace xla
@@ -0,0 +1,85 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_CPU_CROSS_HOST_TRANSPORT_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_CPU_CROSS_HOST_TRANSPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "xla/pjrt/tracked_tfrt_cpu_device_buffer.h"
+#include "xla/status.h"
+#include "xla/statusor.h"
+
+namespace xla {
+
+// Moves bytes between the memory of TfrtCpuClients that live in different
+// processes. It backs MakeCrossHostReceiveBuffers on the receiving client and
+// CopyToRemoteDevice on the sending one.
+//
+// A receive is identified by an opaque serialized descriptor, which the
+// receiver hands to the sender out of band, e.g. through the key-value store
+// of the distributed runtime (see cross_host_descriptor_exchange.h).
+//
+// Implementations must be thread-safe.
+class CpuCrossHostTransport {
+ public:
+  // A byte range [offset, offset + size) of a receive buffer.
+  struct ByteRange {
+    int64_t offset;
+    int64_t size;
+  };
+
+  // Memory that remote senders write into, and one serialized descriptor for
+  // each of the byte ranges it was prepared with.
+  struct Receive {
+    std::shared_ptr<MaybeOwningCpuMemory> memory;
+    absl::InlinedVector<std::string, 1> serialized_descriptors;
+  };
+
+  virtual ~CpuCrossHostTransport() = default;
+
+  // Allocates `size` bytes that remote senders can write into and prepares
+  // one receive for each of `ranges`. `on_done` is called exactly once for
+  // each range, with the range's index and the outcome of its send, once the
+  // bytes of that range have landed in `memory` or the receive was canceled.
+  // `on_done` may be called on any thread.
+  virtual StatusOr<Receive> PrepareReceive(
+      size_t size, absl::Span<const ByteRange> ranges,
+      absl::AnyInvocable<void(int range_index, Status status)> on_done) = 0;
+
+  // Cancels the pending receive `serialized_descriptor`, which must have been
+  // returned by PrepareReceive on this transport. Its `on_done` is called with
+  // `reason`. Returns an error if there is no such pending receive.
+  virtual Status CancelReceive(absl::string_view serialized_descriptor,
+                               Status reason) = 0;
+
+  // Writes the `size` bytes at `data` to the receive `serialized_descriptor`,
+  // which may belong to a transport in another process, and blocks until the
+  // receiver has been notified. `size` must match the size of the range the
+  // descriptor was prepared for.
+  virtual Status Send(absl::string_view serialized_descriptor,
+                      const void* data, size_t size) = 0;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_CPU_CROSS_HOST_TRANSPORT_H_
@@ -0,0 +1,72 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/cross_host_descriptor_exchange.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tsl/platform/env.h"
+
+namespace xla {
+
+Status PutCrossHostRecvDescriptor(DistributedRuntimeClient* client,
+                                  std::string key,
+                                  std::string serialized_descriptor) {
+  return client->KeyValueSet(std::move(key), std::move(serialized_descriptor));
+}
+
+PjRtFuture<StatusOr<std::string>> GetCrossHostRecvDescriptor(
+    DistributedRuntimeClient* client, std::string key, absl::Duration timeout) {
+  auto promise = PjRtFuture<StatusOr<std::string>>::CreatePromise();
+  // BlockingKeyValueGet blocks until the key is published, so it must not run
+  // on the caller's thread.
+  tsl::Env::Default()->SchedClosure([client, key = std::move(key), timeout,
+                                     promise]() mutable {
+    promise.Set(client->BlockingKeyValueGet(std::move(key), timeout));
+  });
+  return PjRtFuture<StatusOr<std::string>>(std::move(promise));
+}
+
+PjRtFuture<StatusOr<std::vector<std::string>>> GetCrossHostRecvDescriptors(
+    DistributedRuntimeClient* client, std::vector<std::string> keys,
+    absl::Duration timeout) {
+  auto promise =
+      PjRtFuture<StatusOr<std::vector<std::string>>>::CreatePromise();
+  tsl::Env::Default()->SchedClosure([client, keys = std::move(keys), timeout,
+                                     promise]() mutable {
+    // All keys share one deadline rather than waiting `timeout` for each.
+    absl::Time deadline = absl::Now() + timeout;
+    std::vector<std::string> descriptors;
+    descriptors.reserve(keys.size());
+    for (std::string& key : keys) {
+      absl::Duration remaining =
+          std::max(deadline - absl::Now(), absl::ZeroDuration());
+      StatusOr<std::string> descriptor =
+          client->BlockingKeyValueGet(std::move(key), remaining);
+      if (!descriptor.ok()) {
+        promise.Set(descriptor.status());
+        return;
+      }
+      descriptors.push_back(*std::move(descriptor));
+    }
+    promise.Set(std::move(descriptors));
+  });
+  return PjRtFuture<StatusOr<std::vector<std::string>>>(std::move(promise));
+}
+
+}  // namespace xla
@@ -0,0 +1,57 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_CROSS_HOST_DESCRIPTOR_EXCHANGE_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_CROSS_HOST_DESCRIPTOR_EXCHANGE_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "xla/pjrt/distributed/client.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/status.h"
+#include "xla/statusor.h"
+
+namespace xla {
+
+// Helpers that hand the serialized descriptors returned by
+// PjRtClient::MakeCrossHostReceiveBuffers from the receiving process to the
+// sending one through the key-value store of the distributed runtime.
+//
+// The receiver publishes each descriptor under a key both processes agree on,
+// and the sender passes the future returned by GetCrossHostRecvDescriptor(s)
+// straight to PjRtBuffer::CopyToRemoteDevice(Scattered).
+
+// Publishes `serialized_descriptor` under `key`.
+Status PutCrossHostRecvDescriptor(DistributedRuntimeClient* client,
+                                  std::string key,
+                                  std::string serialized_descriptor);
+
+// Returns a future for the descriptor published under `key`. The future holds
+// an error if nothing is published within `timeout`. `client` must outlive the
+// future.
+PjRtFuture<StatusOr<std::string>> GetCrossHostRecvDescriptor(
+    DistributedRuntimeClient* client, std::string key, absl::Duration timeout);
+
+// Like GetCrossHostRecvDescriptor, but for the descriptors published under
+// each of `keys`, in order.
+PjRtFuture<StatusOr<std::vector<std::string>>> GetCrossHostRecvDescriptors(
+    DistributedRuntimeClient* client, std::vector<std::string> keys,
+    absl::Duration timeout);
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_CROSS_HOST_DESCRIPTOR_EXCHANGE_H_
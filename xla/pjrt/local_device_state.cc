@@ -61,10 +61,10 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
     stream->Init();
     device_to_device_streams_.push_back(std::move(stream));
   }
-  execute_thread_ =
-      std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_execute");
-  callback_thread_ =
-      std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_callback");
+  execute_thread_ = std::make_unique<WorkerThreadPool>(
+      tsl::Env::Default(), "py_xla_execute", /*num_threads=*/1);
+  callback_thread_ = std::make_unique<WorkerThreadPool>(
+      tsl::Env::Default(), "py_xla_callback", kNumCallbackThreads);
 }
 
 LocalDeviceState::~LocalDeviceState() {
@@ -107,8 +107,9 @@ Status LocalDeviceState::ThenMemcpyDeviceToDevice(
   return OkStatus();
 }
 
-void LocalDeviceState::ThenExecuteCallback(se::Stream* stream,
-                                           std::function<void()> callback) {
+void LocalDeviceState::ThenExecuteCallback(
+    se::Stream* stream, std::function<void()> callback,
+    WorkerThreadPool::Priority priority) {
   tsl::profiler::TraceMe traceme("ThenExecuteCallback");
   if (callback_stream_map_.has_value()) {
     // Prevent concurrent updates to the callback stream map.
@@ -123,9 +124,10 @@ void LocalDeviceState::ThenExecuteCallback(se::Stream* stream,
     callback_stream->second->ThenWaitFor(stream);
     stream = callback_stream->second.get();
   }
-  stream->ThenDoHostCallback([this, callback{std::move(callback)}]() mutable {
-    callback_thread_->Schedule(std::move(callback));
-  });
+  stream->ThenDoHostCallback(
+      [this, callback{std::move(callback)}, priority]() mutable {
+        callback_thread_->Schedule(std::move(callback), priority);
+      });
 }
 
 se::Stream* LocalDeviceState::GetDeviceToHostStream() {
@@ -130,7 +130,8 @@ class LocalDeviceState {
                                           se::DeviceMemoryBase src_buffer,
                                           se::DeviceMemoryBase dst_buffer);
 
-  WorkerThread* execute_thread() const { return execute_thread_.get(); }
+  WorkerThreadPool* execute_thread() const { return execute_thread_.get(); }
+  WorkerThreadPool* callback_thread() const { return callback_thread_.get(); }
 
   // Enqueues a host callback on 'stream'. `stream` may, but need not, wait for
   // `callback` to complete. It is safe to call runtime methods from the
@@ -141,7 +142,12 @@ class LocalDeviceState {
   //    runtime and cannot perform GPU operations itself. On GPU, callbacks
   //    execute in a separate thread.
   // b) ThenDoHostCallback waits for the callback to complete.
-  void ThenExecuteCallback(se::Stream* stream, std::function<void()> callback);
+  // Callbacks run concurrently on the callback workers, so callers must not
+  // rely on callbacks enqueued on the same stream running one after another.
+  // Low-priority callbacks run only when no high-priority callback is queued.
+  void ThenExecuteCallback(se::Stream* stream, std::function<void()> callback,
+                           WorkerThreadPool::Priority priority =
+                               WorkerThreadPool::Priority::kHigh);
 
   // Helpers for releasing values on a worker thread at the tail of a stream on
   // a worker thread. Copies `object`, and destroys the copy when the tail of
@@ -149,10 +155,12 @@ class LocalDeviceState {
   // thread or on the worker thread (depending on thread schedules), not a
   // device callback, so it is safe if the destructor frees device resource
   // (e.g., GPU objects).
+  // Releases run at low priority, behind callbacks that complete executions.
   template <typename T>
   void ThenRelease(se::Stream* stream, T&& object) {
     ThenExecuteCallback(
-        stream, [object = std::forward<T>(object)]() { /* releases object */ });
+        stream, [object = std::forward<T>(object)]() { /* releases object */ },
+        WorkerThreadPool::Priority::kLow);
   }
 
   Semaphore& compute_semaphore() { return compute_semaphore_; }
@@ -198,14 +206,19 @@ class LocalDeviceState {
   std::optional<absl::flat_hash_map<se::Stream*, std::unique_ptr<se::Stream>>>
       callback_stream_map_;
 
-  // A worker thread, used for replicated computation launches.
-  std::unique_ptr<WorkerThread> execute_thread_;
+  // Number of workers that run callbacks, so that one slow callback does not
+  // hold up the callbacks that release the compute semaphore.
+  static constexpr int kNumCallbackThreads = 4;
 
-  // A worker thread, used for callbacks. It is necessary that this be a
-  // different thread to the execute thread because we acquire the compute
+  // A single worker thread, used for replicated computation launches. It has
+  // one worker so that every device launches programs in the same order.
+  std::unique_ptr<WorkerThreadPool> execute_thread_;
+
+  // Worker threads, used for callbacks. It is necessary that these be
+  // different threads to the execute thread because we acquire the compute
   // semaphore during calls to Execute but release it from a callback and if
   // they are the same thread we might deadlock.
-  std::unique_ptr<WorkerThread> callback_thread_;
+  std::unique_ptr<WorkerThreadPool> callback_thread_;
 };
 
 }  // namespace xla
@@ -16,9 +16,18 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_PJRT_LRU_CACHE_H_
 #define TENSORFLOW_COMPILER_XLA_PJRT_LRU_CACHE_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "tsl/platform/logging.h"
 
 namespace xla {
@@ -86,6 +95,10 @@ class LRUCache {
   Value GetOrCreateIfAbsent(const Key& key,
                             const std::function<Value(const Key&)>& factory);
 
+  // Returns the `value` associated with `key` and marks it as most recently
+  // used, or std::nullopt if `key` is absent.
+  std::optional<Value> Get(const Key& key);
+
   // Removes all entries from the cache.
   void Clear();
 
@@ -105,6 +118,10 @@ class LRUCache {
     std::optional<Value> value;
   };
 
+  // Adds `entry`, which must not be in the LRU list, to the back of the list
+  // since it is now the most recently used element.
+  void PushBack(Entry* entry);
+
   // We use `node_hash_map` because we want to guarantee pointer stability for
   // keys and values.
   absl::node_hash_map<Key, Entry, Hash, Eq> entries_;
@@ -151,18 +168,13 @@ Value LRUCache<Key, Value, Hash, Eq>::GetOrCreateIfAbsent(
     entry.prev->next = entry.next;
     entry.next->prev = entry.prev;
   }
-  // (Re-)adds entry to the back of the LRU list. Since it is now the
-  // most recently used element, it goes at the back.
-  LRUListEntry& lru_head = lru_list_->head_;
-  entry.container = this;
-  entry.prev = lru_head.prev;
-  entry.next = &lru_head;
-  lru_head.prev->next = &entry;
-  lru_head.prev = &entry;
+  // (Re-)adds entry to the back of the LRU list.
+  PushBack(&entry);
 
   Value v = *entry.value;
 
   // Evict an LRU entry if we are over capacity.
+  LRUListEntry& lru_head = lru_list_->head_;
   if (lru_list_->size_ > lru_list_->capacity_) {
     Entry* to_remove = static_cast<Entry*>(lru_head.next);
     to_remove->next->prev = &lru_head;
@@ -176,6 +188,199 @@ Value LRUCache<Key, Value, Hash, Eq>::GetOrCreateIfAbsent(
   return v;
 }
 
+template <typename Key, typename Value, typename Hash, typename Eq>
+std::optional<Value> LRUCache<Key, Value, Hash, Eq>::Get(const Key& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return std::nullopt;
+  Entry& entry = it->second;
+  entry.prev->next = entry.next;
+  entry.next->prev = entry.prev;
+  PushBack(&entry);
+  return *entry.value;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+void LRUCache<Key, Value, Hash, Eq>::PushBack(Entry* entry) {
+  LRUListEntry& lru_head = lru_list_->head_;
+  entry->container = this;
+  entry->prev = lru_head.prev;
+  entry->next = &lru_head;
+  lru_head.prev->next = entry;
+  lru_head.prev = entry;
+}
+
+// A thread-safe LRU cache that is split into independently locked shards, so
+// that lookups of different keys rarely contend on the same mutex.
+//
+// Each shard is an LRUCache with its own slice of the capacity, so eviction is
+// least-recently-used within a shard rather than across the whole cache.
+// Concurrent misses on the same key are de-duplicated: the first caller builds
+// the value, outside of any lock, and the others wait for it.
+//
+// Value must be copyable. As for LRUCache, it is typically a smart-pointer
+// type.
+template <typename Key, typename Value,
+          typename Hash = typename absl::node_hash_map<Key, Value>::hasher,
+          typename Eq = typename absl::node_hash_map<Key, Value>::key_equal>
+class ShardedLRUCache {
+ public:
+  struct Stats {
+    // Lookups that found the key in the cache.
+    int64_t hits = 0;
+    // Lookups that had to build the value.
+    int64_t misses = 0;
+    // Lookups that waited for a concurrent miss on the same key to build the
+    // value.
+    int64_t deduplicated_misses = 0;
+    // Entries that were evicted to make room for new ones.
+    int64_t evictions = 0;
+  };
+
+  // The cache holds `capacity` entries, split evenly over at most
+  // `num_shards` shards. Caches too small to give every shard
+  // kMinShardCapacity entries use fewer shards, so that a small cache keeps
+  // exact LRU order.
+  static constexpr int kMinShardCapacity = 16;
+  explicit ShardedLRUCache(int capacity, int num_shards = 16);
+
+  ShardedLRUCache(const ShardedLRUCache&) = delete;
+  ShardedLRUCache(ShardedLRUCache&&) = delete;
+  ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+  ShardedLRUCache& operator=(ShardedLRUCache&&) = delete;
+
+  // Returns the `value` associated with `key`. Creates a value with `factory`
+  // and inserts it if absent. `factory` is called without holding any lock,
+  // and at most once at a time for any given key.
+  Value GetOrCreateIfAbsent(const Key& key,
+                            const std::function<Value(const Key&)>& factory);
+
+  // Removes all entries from the cache.
+  void Clear();
+
+  int Size() const;
+  int Capacity() const { return capacity_; }
+
+  Stats GetStats() const;
+
+ private:
+  // A value that is being built by the first caller that missed on its key.
+  struct InFlight {
+    absl::Notification done;
+    std::optional<Value> value;
+  };
+
+  struct Shard {
+    explicit Shard(int capacity) : lru_list(capacity), cache(&lru_list) {}
+
+    mutable absl::Mutex mu;
+    typename LRUCache<Key, Value, Hash, Eq>::LRUList lru_list
+        ABSL_GUARDED_BY(mu);
+    LRUCache<Key, Value, Hash, Eq> cache ABSL_GUARDED_BY(mu);
+    absl::flat_hash_map<Key, std::shared_ptr<InFlight>, Hash, Eq> in_flight
+        ABSL_GUARDED_BY(mu);
+    Stats stats ABSL_GUARDED_BY(mu);
+  };
+
+  Shard& ShardFor(const Key& key) const {
+    // Remix the hash so that the shard index does not correlate with the slot
+    // of the key in the shard's own hash table.
+    uint64_t hash = static_cast<uint64_t>(Hash()(key));
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return *shards_[hash % shards_.size()];
+  }
+
+  const int capacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+ShardedLRUCache<Key, Value, Hash, Eq>::ShardedLRUCache(int capacity,
+                                                       int num_shards)
+    : capacity_(capacity) {
+  CHECK_GT(num_shards, 0);
+  num_shards = std::max(1, std::min(num_shards, capacity / kMinShardCapacity));
+  shards_.reserve(num_shards);
+  for (int i = 0; i < num_shards; ++i) {
+    // Spreads the capacity so that the shard capacities add up to `capacity`.
+    int shard_capacity = capacity / num_shards + (i < capacity % num_shards);
+    shards_.push_back(std::make_unique<Shard>(shard_capacity));
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+Value ShardedLRUCache<Key, Value, Hash, Eq>::GetOrCreateIfAbsent(
+    const Key& key, const std::function<Value(const Key&)>& factory) {
+  Shard& shard = ShardFor(key);
+  std::shared_ptr<InFlight> in_flight;
+  bool is_builder;
+  {
+    absl::MutexLock lock(&shard.mu);
+    if (std::optional<Value> value = shard.cache.Get(key)) {
+      ++shard.stats.hits;
+      return *std::move(value);
+    }
+    auto [it, inserted] = shard.in_flight.try_emplace(key);
+    if (inserted) {
+      ++shard.stats.misses;
+      it->second = std::make_shared<InFlight>();
+    } else {
+      ++shard.stats.deduplicated_misses;
+    }
+    in_flight = it->second;
+    is_builder = inserted;
+  }
+  if (!is_builder) {
+    in_flight->done.WaitForNotification();
+    return *in_flight->value;
+  }
+
+  Value value = factory(key);
+  {
+    absl::MutexLock lock(&shard.mu);
+    int size_before = shard.lru_list.Size();
+    shard.cache.GetOrCreateIfAbsent(key, [&](const Key&) { return value; });
+    if (shard.lru_list.Size() == size_before) ++shard.stats.evictions;
+    in_flight->value = value;
+    shard.in_flight.erase(key);
+  }
+  in_flight->done.Notify();
+  return value;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+void ShardedLRUCache<Key, Value, Hash, Eq>::Clear() {
+  for (auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mu);
+    shard->cache.Clear();
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+int ShardedLRUCache<Key, Value, Hash, Eq>::Size() const {
+  int size = 0;
+  for (const auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mu);
+    size += shard->cache.Size();
+  }
+  return size;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+typename ShardedLRUCache<Key, Value, Hash, Eq>::Stats
+ShardedLRUCache<Key, Value, Hash, Eq>::GetStats() const {
+  Stats stats;
+  for (const auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mu);
+    stats.hits += shard->stats.hits;
+    stats.misses += shard->stats.misses;
+    stats.deduplicated_misses += shard->stats.deduplicated_misses;
+    stats.evictions += shard->stats.evictions;
+  }
+  return stats;
+}
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_PJRT_LRU_CACHE_H_
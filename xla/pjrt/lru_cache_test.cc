@@ -15,9 +15,16 @@ limitations under the License.
 
 #include "xla/pjrt/lru_cache.h"
 
+#include <atomic>
 #include <random>
+#include <vector>
 
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "xla/test.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -115,5 +122,116 @@ TEST(LRUCache, RandomInsertions) {
   }
 }
 
+TEST(ShardedLRUCache, Basics) {
+  ShardedLRUCache<int, int> cache(/*capacity=*/3, /*num_shards=*/1);
+  EXPECT_EQ(3, cache.Capacity());
+  EXPECT_EQ(0, cache.Size());
+  EXPECT_EQ(0, cache.GetOrCreateIfAbsent(0, [](int) { return 0; }));
+  EXPECT_EQ(1, cache.GetOrCreateIfAbsent(1, [](int) { return 1; }));
+  EXPECT_EQ(2, cache.GetOrCreateIfAbsent(2, [](int) { return 2; }));
+  EXPECT_EQ(0, cache.GetOrCreateIfAbsent(0, [](int) { return 3; }));
+  EXPECT_EQ(4, cache.GetOrCreateIfAbsent(3, [](int) { return 4; }));
+  EXPECT_EQ(3, cache.Size());
+  EXPECT_EQ(5, cache.GetOrCreateIfAbsent(1, [](int) { return 5; }));
+
+  ShardedLRUCache<int, int>::Stats stats = cache.GetStats();
+  EXPECT_EQ(1, stats.hits);
+  EXPECT_EQ(5, stats.misses);
+  EXPECT_EQ(0, stats.deduplicated_misses);
+  EXPECT_EQ(2, stats.evictions);
+
+  cache.Clear();
+  EXPECT_EQ(0, cache.Size());
+  EXPECT_EQ(6, cache.GetOrCreateIfAbsent(0, [](int) { return 6; }));
+}
+
+TEST(ShardedLRUCache, RandomInsertions) {
+  ShardedLRUCache<int, int> cache(/*capacity=*/64, /*num_shards=*/4);
+  std::random_device rng;
+  std::uniform_int_distribution<int> dist(0, 1000);
+
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_LE(cache.Size(), cache.Capacity());
+    int key = dist(rng);
+    EXPECT_EQ(key * 37,
+              cache.GetOrCreateIfAbsent(key, [](int k) { return k * 37; }));
+  }
+  ShardedLRUCache<int, int>::Stats stats = cache.GetStats();
+  EXPECT_EQ(1000, stats.hits + stats.misses);
+  EXPECT_EQ(stats.misses - cache.Size(), stats.evictions);
+}
+
+TEST(ShardedLRUCache, ConcurrentMissesAreDeduplicated) {
+  constexpr int kNumThreads = 8;
+  ShardedLRUCache<int, int> cache(/*capacity=*/16);
+  std::atomic<int> num_factory_calls = 0;
+  absl::Notification release_factory;
+  std::vector<int> values(kNumThreads, -1);
+  {
+    tsl::thread::ThreadPool pool(tsl::Env::Default(), "lru_cache_test",
+                                 kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([&, i]() {
+        values[i] = cache.GetOrCreateIfAbsent(42, [&](int key) {
+          ++num_factory_calls;
+          release_factory.WaitForNotification();
+          return key + 1;
+        });
+      });
+    }
+    // Lets the factory return only once every other lookup is waiting on it.
+    while (cache.GetStats().deduplicated_misses < kNumThreads - 1) {
+      absl::SleepFor(absl::Milliseconds(1));
+    }
+    release_factory.Notify();
+  }
+  EXPECT_EQ(1, num_factory_calls);
+  for (int value : values) EXPECT_EQ(43, value);
+  ShardedLRUCache<int, int>::Stats stats = cache.GetStats();
+  EXPECT_EQ(1, stats.misses);
+  EXPECT_EQ(kNumThreads - 1, stats.deduplicated_misses);
+  EXPECT_EQ(43, cache.GetOrCreateIfAbsent(42, [](int) { return 0; }));
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below.
+//===----------------------------------------------------------------------===//
+
+constexpr int kBenchmarkNumKeys = 256;
+constexpr int kBenchmarkCapacity = 1024;
+
+// The single-mutex LRUCache that callers such as the PjRt clients used to
+// wrap around TransposePlanCache; the baseline for BM_ShardedLRUCacheLookup.
+struct MutexLRUCache {
+  MutexLRUCache() : cache(&list) {}
+
+  absl::Mutex mu;
+  LRUCache<int, int>::LRUList list{kBenchmarkCapacity};
+  LRUCache<int, int> cache ABSL_GUARDED_BY(mu);
+};
+
+void BM_MutexLRUCacheLookup(::testing::benchmark::State& state) {
+  static auto* cache = new MutexLRUCache();
+  int key = state.thread_index();
+  for (auto s : state) {
+    key = (key + 1) % kBenchmarkNumKeys;
+    absl::MutexLock lock(&cache->mu);
+    ::testing::benchmark::DoNotOptimize(
+        cache->cache.GetOrCreateIfAbsent(key, [](int k) { return k; }));
+  }
+}
+BENCHMARK(BM_MutexLRUCacheLookup)->ThreadRange(1, 64)->UseRealTime();
+
+void BM_ShardedLRUCacheLookup(::testing::benchmark::State& state) {
+  static auto* cache = new ShardedLRUCache<int, int>(kBenchmarkCapacity);
+  int key = state.thread_index();
+  for (auto s : state) {
+    key = (key + 1) % kBenchmarkNumKeys;
+    ::testing::benchmark::DoNotOptimize(
+        cache->GetOrCreateIfAbsent(key, [](int k) { return k; }));
+  }
+}
+BENCHMARK(BM_ShardedLRUCacheLookup)->ThreadRange(1, 64)->UseRealTime();
+
 }  // namespace
 }  // namespace xla
@@ -17,9 +17,13 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/casts.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/substitute.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/util.h"
@@ -42,6 +46,31 @@ StatusOr<std::uintptr_t> PjRtClient::UnsafeBufferPointer(PjRtBuffer* buffer) {
   return absl::bit_cast<std::uintptr_t>(ptr);
 }
 
+StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+PjRtClient::ExecuteGraph(absl::Span<const PjRtExecuteGraphNode> nodes,
+                         const ExecuteOptions& options) {
+  return DispatchExecuteGraph(
+      this, nodes, options,
+      /*prepare=*/
+      [](int node_index, const PjRtExecuteGraphNode& node,
+         const PjRtExecuteGraphPlacement& placement)
+          -> StatusOr<absl::Span<const bool>> {
+        return absl::Span<const bool>();
+      },
+      /*execute=*/
+      [&](int node_index, const PjRtExecuteGraphNode& node,
+          const PjRtExecuteGraphPlacement& placement,
+          absl::Span<PjRtBuffer* const> arguments)
+          -> StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> {
+        if (placement.portable) {
+          return node.executable->ExecutePortable(arguments, node.device,
+                                                  options);
+        }
+        return node.executable->ExecuteSharded(arguments, node.device,
+                                               options);
+      });
+}
+
 PjRtFuture<Status> PjRtBuffer::CopyRawToHostFuture(
     PjRtFuture<StatusOr<void*>> dst, int64_t offset, int64_t transfer_size) {
   StatusOr<void*> awaited_dst = dst.Await();
@@ -103,4 +132,182 @@ PjRtLoadedExecutable::GetCostAnalysis() const {
   return ret;
 }
 
+namespace {
+
+// Returns how many buffers an execution of `executable` with `options`
+// returns, or -1 if the executable does not expose its HLO.
+int NumExecuteOutputs(const PjRtLoadedExecutable& executable,
+                      const ExecuteOptions& options) {
+  StatusOr<std::vector<std::shared_ptr<HloModule>>> modules =
+      executable.GetHloModules();
+  if (!modules.ok() || modules->empty()) {
+    return -1;
+  }
+  const Shape& result_shape = (*modules)[0]->result_shape();
+  if (options.untuple_result && result_shape.IsTuple()) {
+    return result_shape.tuple_shapes_size();
+  }
+  return 1;
+}
+
+}  // namespace
+
+StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+DispatchExecuteGraph(
+    const PjRtClient* client, absl::Span<const PjRtExecuteGraphNode> nodes,
+    const ExecuteOptions& options,
+    absl::FunctionRef<StatusOr<absl::Span<const bool>>(
+        int node_index, const PjRtExecuteGraphNode& node,
+        const PjRtExecuteGraphPlacement& placement)>
+        prepare,
+    absl::FunctionRef<StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>(
+        int node_index, const PjRtExecuteGraphNode& node,
+        const PjRtExecuteGraphPlacement& placement,
+        absl::Span<PjRtBuffer* const> arguments)>
+        execute) {
+  // Validate the whole graph before anything is enqueued.
+  std::vector<PjRtExecuteGraphPlacement> placements(nodes.size());
+  std::vector<int> num_outputs(nodes.size());
+  absl::flat_hash_map<const PjRtLoadedExecutable*, int> num_executable_outputs;
+  // A value of the graph is either a buffer passed in by the caller or an
+  // output of a node. A donated value may have no other use in the graph.
+  using Value = std::tuple<PjRtBuffer*, int, int>;
+  absl::flat_hash_map<Value, int> value_uses;
+  // The donated values, with the node and argument index that donate them.
+  std::vector<std::tuple<Value, int, int>> donated_values;
+  for (int i = 0; i < nodes.size(); ++i) {
+    const PjRtExecuteGraphNode& node = nodes[i];
+    if (node.executable == nullptr || node.device == nullptr) {
+      return InvalidArgument("ExecuteGraph node %d has no executable or device",
+                             i);
+    }
+    if (node.executable->client() != client) {
+      return InvalidArgument(
+          "ExecuteGraph node %d runs executable %s of another client", i,
+          node.executable->name());
+    }
+    if (node.device->client() != client || !node.device->IsAddressable()) {
+      return InvalidArgument(
+          "ExecuteGraph node %d runs on device %s, which is not addressable "
+          "by this client",
+          i, node.device->DebugString());
+    }
+    absl::Span<PjRtDevice* const> devices =
+        node.executable->addressable_devices();
+    if (devices.empty()) {
+      placements[i].portable = true;
+    } else {
+      auto it = absl::c_find(devices, node.device);
+      if (it == devices.end()) {
+        return InvalidArgument(
+            "ExecuteGraph node %d runs on device %s, which is not assigned to "
+            "executable %s",
+            i, node.device->DebugString(), node.executable->name());
+      }
+      const PjRtLoadedExecutable::LogicalDeviceIds& logical_ids =
+          node.executable
+              ->addressable_device_logical_ids()[it - devices.begin()];
+      placements[i].replica = logical_ids.replica;
+      placements[i].partition = logical_ids.partition;
+    }
+    auto [it, inserted] =
+        num_executable_outputs.insert({node.executable, 0});
+    if (inserted) {
+      it->second = NumExecuteOutputs(*node.executable, options);
+    }
+    num_outputs[i] = it->second;
+
+    for (int j = 0; j < node.arguments.size(); ++j) {
+      const PjRtExecuteGraphNode::Argument& argument = node.arguments[j];
+      if ((argument.buffer == nullptr) == (argument.node_index < 0)) {
+        return InvalidArgument(
+            "Argument %d of ExecuteGraph node %d must be either a buffer or "
+            "an output of an earlier node",
+            j, i);
+      }
+      PjRtDevice* argument_device;
+      if (argument.buffer != nullptr) {
+        argument_device = argument.buffer->device();
+      } else {
+        if (argument.node_index >= i || argument.output_index < 0) {
+          return InvalidArgument(
+              "Argument %d of ExecuteGraph node %d refers to output %d of node "
+              "%d, which is not an output of an earlier node",
+              j, i, argument.output_index, argument.node_index);
+        }
+        const int producer_outputs = num_outputs[argument.node_index];
+        if (producer_outputs >= 0 &&
+            argument.output_index >= producer_outputs) {
+          return InvalidArgument(
+              "ExecuteGraph node %d consumes output %d of node %d, which has "
+              "only %d outputs",
+              i, argument.output_index, argument.node_index,
+              producer_outputs);
+        }
+        argument_device = nodes[argument.node_index].device;
+      }
+      if (argument_device != node.device) {
+        return InvalidArgument(
+            "Argument %d of ExecuteGraph node %d is on device %s, but the node "
+            "runs on device %s",
+            j, i, argument_device->DebugString(), node.device->DebugString());
+      }
+    }
+    TF_ASSIGN_OR_RETURN(absl::Span<const bool> donated,
+                        prepare(i, node, placements[i]));
+    for (int j = 0; j < node.arguments.size(); ++j) {
+      const PjRtExecuteGraphNode::Argument& argument = node.arguments[j];
+      Value value = argument.buffer != nullptr
+                        ? Value{argument.buffer, -1, -1}
+                        : Value{nullptr, argument.node_index,
+                                argument.output_index};
+      ++value_uses[value];
+      if (j < donated.size() && donated[j]) {
+        donated_values.push_back({value, i, j});
+      }
+    }
+  }
+  for (const auto& [value, node_index, argument_index] : donated_values) {
+    if (value_uses[value] > 1) {
+      return InvalidArgument(
+          "Argument %d of ExecuteGraph node %d is donated, but its value is "
+          "used more than once in the graph",
+          argument_index, node_index);
+    }
+  }
+
+  std::vector<std::vector<std::unique_ptr<PjRtBuffer>>> outputs(nodes.size());
+  std::vector<PjRtBuffer*> arguments;
+  for (int i = 0; i < nodes.size(); ++i) {
+    const PjRtExecuteGraphNode& node = nodes[i];
+    arguments.clear();
+    for (const PjRtExecuteGraphNode::Argument& argument : node.arguments) {
+      if (argument.buffer != nullptr) {
+        arguments.push_back(argument.buffer);
+        continue;
+      }
+      const auto& producer_outputs = outputs[argument.node_index];
+      // Only reached for executables whose output count is not known up
+      // front.
+      if (argument.output_index >= producer_outputs.size()) {
+        return InvalidArgument(
+            "ExecuteGraph node %d consumes output %d of node %d, which has "
+            "only %d outputs",
+            i, argument.output_index, argument.node_index,
+            producer_outputs.size());
+      }
+      arguments.push_back(producer_outputs[argument.output_index].get());
+    }
+    TF_ASSIGN_OR_RETURN(outputs[i],
+                        execute(i, node, placements[i], arguments));
+  }
+
+  for (int i = 0; i < nodes.size(); ++i) {
+    if (!nodes[i].return_outputs) {
+      outputs[i].clear();
+    }
+  }
+  return outputs;
+}
+
 }  // namespace xla
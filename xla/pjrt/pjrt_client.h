@@ -28,6 +28,7 @@ limitations under the License.
 #include "absl/base/attributes.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/notification.h"
 #include "absl/types/span.h"
@@ -343,6 +344,29 @@ struct LoadOptions {
 };
 
 class PjRtLoadedExecutable;
+struct ExecuteOptions;
+
+// One execution of a PjRtClient::ExecuteGraph() call.
+struct PjRtExecuteGraphNode {
+  // An argument of the execution. It is either `buffer`, supplied by the
+  // caller, or the output `output_index` of the earlier node `node_index`.
+  struct Argument {
+    PjRtBuffer* buffer = nullptr;
+    int node_index = -1;
+    int output_index = -1;
+  };
+
+  PjRtLoadedExecutable* executable = nullptr;
+  // The device to run `executable` on. For an executable with a device
+  // assignment, this selects the replica and partition as in
+  // ExecuteSharded(); a portable executable runs on it as in
+  // ExecutePortable().
+  PjRtDevice* device = nullptr;
+  std::vector<Argument> arguments;
+  // If false, the outputs of this node are only consumed by later nodes and
+  // are released once the whole graph is dispatched.
+  bool return_outputs = true;
+};
 
 // Encapsulates the state of Python session with XLA.
 //
@@ -736,6 +760,24 @@ class PjRtClient {
       absl::Span<const Shape> shapes, std::vector<GatherDetails> gather_details,
       PjRtDevice* device, PjRtCrossHostRecvNotifier notifier) = 0;
 
+  // Dispatches a chain, or more generally a DAG, of executions as one unit.
+  // Every node may only consume outputs of the nodes before it, so `nodes`
+  // is in topological order. The graph is validated once up front, and the
+  // nodes are then enqueued back to back: a node consumes the outputs of
+  // earlier nodes as soon as they are defined, without the host waiting for
+  // them. All nodes run with `options`; a node whose outputs are consumed by
+  // index must produce them untupled, e.g. by setting
+  // `options.untuple_result`. Donated parameters are donated as in
+  // Execute*(), so an intermediate output that is donated should be consumed
+  // only once.
+  //
+  // Returns the outputs of each node, or an empty vector for nodes whose
+  // `return_outputs` is false. If a node fails to launch, the nodes before
+  // it have already been enqueued and their outputs are released.
+  virtual StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+  ExecuteGraph(absl::Span<const PjRtExecuteGraphNode> nodes,
+               const ExecuteOptions& options);
+
   // Create ChannelHandles for XLA send/recv.
   virtual StatusOr<ChannelHandle> CreateChannelHandle() = 0;
   virtual StatusOr<ChannelHandle> CreateDeviceToHostChannelHandle() = 0;
@@ -1319,6 +1361,37 @@ class PjRtLoadedExecutable : public PjRtExecutable {
   };
 };
 
+// Where a node of an ExecuteGraph() call runs on its device. `portable` is
+// true for executables without a device assignment, which run as replica 0
+// and partition 0.
+struct PjRtExecuteGraphPlacement {
+  int replica = 0;
+  int partition = 0;
+  bool portable = false;
+};
+
+// Helper for implementations of PjRtClient::ExecuteGraph(). Validates `nodes`
+// against `client` and calls `prepare` for each node with its placement, so
+// that implementations can do their per-execution validation for the whole
+// graph before anything is enqueued. `prepare` returns which arguments of the
+// node are donated (an empty span if none are); a donated value may not be
+// used anywhere else in the graph. Then calls `execute` for each node in
+// order with its resolved arguments, which are known to be on the node's
+// device and to be outputs its producers return, and collects the outputs.
+StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+DispatchExecuteGraph(
+    const PjRtClient* client, absl::Span<const PjRtExecuteGraphNode> nodes,
+    const ExecuteOptions& options,
+    absl::FunctionRef<StatusOr<absl::Span<const bool>>(
+        int node_index, const PjRtExecuteGraphNode& node,
+        const PjRtExecuteGraphPlacement& placement)>
+        prepare,
+    absl::FunctionRef<StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>(
+        int node_index, const PjRtExecuteGraphNode& node,
+        const PjRtExecuteGraphPlacement& placement,
+        absl::Span<PjRtBuffer* const> arguments)>
+        execute);
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_PJRT_PJRT_CLIENT_H_
@@ -362,6 +362,155 @@ TEST_P(PjRtClientTest, ExecuteWithConcurrentUsageAndDonation) {
                                      *literal));
 }
 
+TEST_P(PjRtClientTest, ExecuteGraphChain) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  auto executable =
+      MakeIncrementProgram(client.get(), /*alias=*/false, /*device=*/0);
+
+  std::vector<int32_t> data(4, 0);
+  Shape shape = ShapeUtil::MakeShape(S32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), shape.element_type(), shape.dimensions(),
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+          client->addressable_devices()[0]));
+
+  // Three increments, each consuming the output of the previous one. Only the
+  // last one returns its output.
+  std::vector<PjRtExecuteGraphNode> nodes(3);
+  for (int i = 0; i < nodes.size(); ++i) {
+    nodes[i].executable = executable.get();
+    nodes[i].device = client->addressable_devices()[0];
+    PjRtExecuteGraphNode::Argument argument;
+    if (i == 0) {
+      argument.buffer = buffer.get();
+    } else {
+      argument.node_index = i - 1;
+      argument.output_index = 0;
+    }
+    nodes[i].arguments.push_back(argument);
+    nodes[i].return_outputs = i == nodes.size() - 1;
+  }
+
+  ExecuteOptions options;
+  options.execution_mode = GetParam();
+
+  TF_ASSERT_OK_AND_ASSIGN(auto results, client->ExecuteGraph(nodes, options));
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_TRUE(results[0].empty());
+  EXPECT_TRUE(results[1].empty());
+  ASSERT_EQ(results[2].size(), 1);
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, results[2][0]->ToLiteralSync());
+
+  std::vector<int32_t> expected(4, 3);
+  EXPECT_TRUE(LiteralTestUtil::Equal(LiteralUtil::CreateR1<int32_t>(expected),
+                                     *literal));
+}
+
+TEST_P(PjRtClientTest, ExecuteGraphRejectsForwardReference) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  auto executable =
+      MakeIncrementProgram(client.get(), /*alias=*/false, /*device=*/0);
+
+  std::vector<PjRtExecuteGraphNode> nodes(2);
+  for (int i = 0; i < nodes.size(); ++i) {
+    nodes[i].executable = executable.get();
+    nodes[i].device = client->addressable_devices()[0];
+    PjRtExecuteGraphNode::Argument argument;
+    argument.node_index = 1;
+    argument.output_index = 0;
+    nodes[i].arguments.push_back(argument);
+  }
+
+  ExecuteOptions options;
+  options.execution_mode = GetParam();
+
+  auto resultsor = client->ExecuteGraph(nodes, options);
+  ASSERT_FALSE(resultsor.ok());
+  EXPECT_THAT(resultsor.status().error_message(),
+              ::testing::HasSubstr("not an output of an earlier node"));
+}
+
+TEST_P(PjRtClientTest, ExecuteGraphRejectsMissingOutput) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  auto executable =
+      MakeIncrementProgram(client.get(), /*alias=*/true, /*device=*/0);
+
+  std::vector<int32_t> data(4, 0);
+  Shape shape = ShapeUtil::MakeShape(S32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), shape.element_type(), shape.dimensions(),
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+          client->addressable_devices()[0]));
+
+  // The second node consumes an output the first one does not have.
+  std::vector<PjRtExecuteGraphNode> nodes(2);
+  for (int i = 0; i < nodes.size(); ++i) {
+    nodes[i].executable = executable.get();
+    nodes[i].device = client->addressable_devices()[0];
+  }
+  nodes[0].arguments.push_back({buffer.get()});
+  nodes[1].arguments.push_back(
+      {/*buffer=*/nullptr, /*node_index=*/0, /*output_index=*/1});
+
+  ExecuteOptions options;
+  options.execution_mode = GetParam();
+
+  auto resultsor = client->ExecuteGraph(nodes, options);
+  ASSERT_FALSE(resultsor.ok());
+  EXPECT_THAT(resultsor.status().error_message(),
+              ::testing::HasSubstr("which has only 1 outputs"));
+  // Nothing ran, so the argument of the first node was not donated.
+  EXPECT_FALSE(buffer->IsDeleted());
+}
+
+TEST_P(PjRtClientTest, ExecuteGraphRejectsDonatedValueWithOtherUses) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  auto executable =
+      MakeIncrementProgram(client.get(), /*alias=*/false, /*device=*/0);
+  auto executable_with_donation =
+      MakeIncrementProgram(client.get(), /*alias=*/true, /*device=*/0);
+
+  std::vector<int32_t> data(4, 0);
+  Shape shape = ShapeUtil::MakeShape(S32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), shape.element_type(), shape.dimensions(),
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+          client->addressable_devices()[0]));
+
+  // Two nodes consume the output of the first one, and one of them donates
+  // it.
+  std::vector<PjRtExecuteGraphNode> nodes(3);
+  nodes[0].executable = executable.get();
+  nodes[0].arguments.push_back({buffer.get()});
+  nodes[1].executable = executable_with_donation.get();
+  nodes[2].executable = executable.get();
+  for (int i = 1; i < nodes.size(); ++i) {
+    nodes[i].arguments.push_back(
+        {/*buffer=*/nullptr, /*node_index=*/0, /*output_index=*/0});
+  }
+  for (PjRtExecuteGraphNode& node : nodes) {
+    node.device = client->addressable_devices()[0];
+  }
+
+  ExecuteOptions options;
+  options.execution_mode = GetParam();
+
+  auto resultsor = client->ExecuteGraph(nodes, options);
+  ASSERT_FALSE(resultsor.ok());
+  EXPECT_THAT(resultsor.status().error_message(),
+              ::testing::HasSubstr("Argument 0 of ExecuteGraph node 1 is "
+                                   "donated"));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     PjRtClientTestSuite, PjRtClientTest,
     ::testing::Values(ExecuteOptions::ExecutionMode::kSynchronous,
@@ -801,7 +801,6 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
     absl::InlinedVector<int64_t, 4> permutation(dims.size());
     absl::c_reverse_copy(compact_shape.layout().minor_to_major(),
                          permutation.begin());
-    absl::MutexLock lock(&transpose_mu_);
     TF_ASSIGN_OR_RETURN(transpose,
                         transpose_cache_.GetOrCreate(
                             primitive_util::ByteWidth(type), dims, permutation,
@@ -2139,12 +2138,14 @@ static RecvDeviceMemoryFunction ConvertRecvCallbacksToRecvFunction(
 // device_buffers has a usage hold added that must be dropped on error or
 // converted on success.
 StatusOr<ScopedShapedBuffer> PjRtStreamExecutorExecutable::EnqueueExecution(
-    absl::Span<PjRtBuffer* const> argument_handles, int replica, int partition,
-    int executable_idx, const RunId& run_id, const ExecuteOptions& options,
-    PjRtDevice* device,
+    const ExecutePlan& plan, absl::Span<PjRtBuffer* const> argument_handles,
+    const RunId& run_id, const ExecuteOptions& options,
     std::vector<PjRtStreamExecutorBuffer::ScopedHold>* device_buffers,
-    std::shared_ptr<DeviceAssignment> device_assignment,
     std::vector<std::function<void()>>& compute_callbacks) const {
+  const int replica = plan.replica;
+  const int partition = plan.partition;
+  const int executable_idx = plan.executable_idx;
+  PjRtDevice* device = plan.device;
   int device_ordinal = tensorflow::down_cast<PjRtStreamExecutorDevice*>(device)
                            ->local_device_state()
                            ->device_ordinal();
@@ -2157,46 +2158,43 @@ StatusOr<ScopedShapedBuffer> PjRtStreamExecutorExecutable::EnqueueExecution(
 
   absl::flat_hash_set<BufferSequencingEvent*> events;
   device_buffers->reserve(argument_handles.size());
-  absl::Span<int const> donated_params =
-      ParametersThatMustBeDonated(executable_idx);
-  auto donate_it = donated_params.begin();
   absl::flat_hash_set<PjRtStreamExecutorBuffer*> used_buffers;
   absl::flat_hash_set<PjRtStreamExecutorBuffer*> donated_buffers;
   for (int i = 0; i < argument_handles.size(); ++i) {
     auto* handle =
         tensorflow::down_cast<PjRtStreamExecutorBuffer*>(argument_handles[i]);
-    if (handle->device() != device) {
-      return InvalidArgument(
-          "Buffer passed to Execute() as argument %d to replica %d is on "
-          "device %s, but replica is assigned to device %s.",
-          i, replica, handle->device()->DebugString(), device->DebugString());
-    }
-    bool must_donate = donate_it != donated_params.end() && *donate_it == i;
-    if (must_donate) {
-      ++donate_it;
-    }
-    bool already_used = !used_buffers.emplace(handle).second;
-    bool already_donated =
-        must_donate ? !donated_buffers.emplace(handle).second
-                    : donated_buffers.find(handle) != donated_buffers.end();
-    if (must_donate && already_donated) {
-      return InvalidArgument(
-          "Attempt to donate the same buffer twice in Execute() (second use: "
-          "flattened argument %d, replica %d). "
-          "Toy example for this bug: `f(donate(a), donate(a))`.",
-          i, replica);
-    } else if (must_donate && already_used) {
-      return InvalidArgument(
-          "Attempt to donate a buffer which is also used by the same call to "
-          "Execute() (second use: flattened argument %d, replica %d). "
-          "Toy example for this bug: `f(a, donate(a))`.",
-          i, replica);
-    } else if (already_donated) {
-      return InvalidArgument(
-          "Attempt to use a buffer that was previously donated in the same "
-          "call to Execute() (second use: flattened argument %d, replica %d). "
-          "Toy example for this bug: `f(donate(a), a)`.",
-          i, replica);
+    bool must_donate = plan.must_donate[i];
+    if (!plan.arguments_validated) {
+      if (handle->device() != device) {
+        return InvalidArgument(
+            "Buffer passed to Execute() as argument %d to replica %d is on "
+            "device %s, but replica is assigned to device %s.",
+            i, replica, handle->device()->DebugString(),
+            device->DebugString());
+      }
+      bool already_used = !used_buffers.emplace(handle).second;
+      bool already_donated =
+          must_donate ? !donated_buffers.emplace(handle).second
+                      : donated_buffers.find(handle) != donated_buffers.end();
+      if (must_donate && already_donated) {
+        return InvalidArgument(
+            "Attempt to donate the same buffer twice in Execute() (second "
+            "use: flattened argument %d, replica %d). "
+            "Toy example for this bug: `f(donate(a), donate(a))`.",
+            i, replica);
+      } else if (must_donate && already_used) {
+        return InvalidArgument(
+            "Attempt to donate a buffer which is also used by the same call "
+            "to Execute() (second use: flattened argument %d, replica %d). "
+            "Toy example for this bug: `f(a, donate(a))`.",
+            i, replica);
+      } else if (already_donated) {
+        return InvalidArgument(
+            "Attempt to use a buffer that was previously donated in the same "
+            "call to Execute() (second use: flattened argument %d, replica "
+            "%d). Toy example for this bug: `f(donate(a), a)`.",
+            i, replica);
+      }
     }
     device_buffers->emplace_back(handle->GetBufferWithHold(
         must_donate ? PjRtStreamExecutorBuffer::ScopedHold::kDonation
@@ -2218,20 +2216,6 @@ StatusOr<ScopedShapedBuffer> PjRtStreamExecutorExecutable::EnqueueExecution(
                           &events);
   }
 
-  if (options.arguments_are_tupled) {
-    if (!parameter_is_tupled_arguments_) {
-      return InvalidArgument(
-          "Arguments may only be supplied as a tuple when the executable was "
-          "compiled with a single tupled parameter");
-    }
-    if (argument_handles.size() != 1) {
-      return InvalidArgument(
-          "Option arguments_are_tupled was true but %d buffers were passed to "
-          "execution",
-          argument_handles.size());
-    }
-  }
-
   TF_ASSIGN_OR_RETURN(
       std::vector<ExecutionInput> execution_inputs,
       MakeExecutionInputsAndWaitForEvents(
@@ -2256,6 +2240,7 @@ StatusOr<ScopedShapedBuffer> PjRtStreamExecutorExecutable::EnqueueExecution(
   run_options.set_allocator(client_->allocator());
   run_options.set_intra_op_thread_pool(
       client_->client()->backend().eigen_intra_op_thread_pool_device());
+  std::shared_ptr<DeviceAssignment> device_assignment = plan.device_assignment;
   run_options.set_device_assignment(device_assignment.get());
   run_options.set_run_id(run_id);
   run_options.set_rng_seed(device_state->GetNewPrngSeed());
@@ -2367,44 +2352,88 @@ PjRtStreamExecutorExecutable::MakeOutputBuffers(
   return outputs;
 }
 
-StatusOr<PjRtLoadedExecutable::Result>
-PjRtStreamExecutorExecutable::ExecuteHelper(
-    absl::Span<PjRtBuffer* const> argument_handles, int replica, int partition,
-    const RunId& run_id, const ExecuteOptions& options, bool fill_future,
-    PjRtDevice* device) const {
-  const uint64_t start_time_usecs = tsl::Env::Default()->NowMicros();
-  std::shared_ptr<DeviceAssignment> device_assignment;
+StatusOr<PjRtStreamExecutorExecutable::ExecutePlan>
+PjRtStreamExecutorExecutable::PrepareExecute(int num_arguments, int replica,
+                                             int partition,
+                                             const ExecuteOptions& options,
+                                             PjRtDevice* device) const {
+  ExecutePlan plan;
+  plan.replica = replica;
+  plan.partition = partition;
   if (device == nullptr) {
     CHECK(device_assignment_ != nullptr);
     const int device_id = (*device_assignment_)(replica, partition);
-    TF_ASSIGN_OR_RETURN(device, client_->LookupDevice(device_id));
-    device_assignment = device_assignment_;
+    TF_ASSIGN_OR_RETURN(plan.device, client_->LookupDevice(device_id));
+    plan.device_assignment = device_assignment_;
   } else {
     CHECK(device_assignment_ == nullptr);
     CHECK_EQ(replica, 0);
     CHECK_EQ(partition, 0);
     CHECK(addressable_devices_.empty());
-    device_assignment = std::make_shared<DeviceAssignment>(1, 1);
-    (*device_assignment)(0, 0) = device->id();
+    plan.device = device;
+    plan.device_assignment = std::make_shared<DeviceAssignment>(1, 1);
+    (*plan.device_assignment)(0, 0) = device->id();
   }
+  CHECK_EQ(plan.device->process_index(), client_->process_index());
 
-  CHECK_EQ(device->process_index(), client_->process_index());
+  if (options.arguments_are_tupled) {
+    if (!parameter_is_tupled_arguments_) {
+      return InvalidArgument(
+          "Arguments may only be supplied as a tuple when the executable was "
+          "compiled with a single tupled parameter");
+    }
+    if (num_arguments != 1) {
+      return InvalidArgument(
+          "Option arguments_are_tupled was true but %d buffers were passed to "
+          "execution",
+          num_arguments);
+    }
+  }
+
+  // SPMD sharding produces a single executable for multiple partitions.
+  plan.executable_idx = executables_.size() > 1 ? partition : 0;
+  plan.must_donate.assign(num_arguments, false);
+  for (int parameter : ParametersThatMustBeDonated(plan.executable_idx)) {
+    if (parameter < num_arguments) {
+      plan.must_donate[parameter] = true;
+    }
+  }
+  return plan;
+}
+
+StatusOr<PjRtLoadedExecutable::Result>
+PjRtStreamExecutorExecutable::ExecuteHelper(
+    absl::Span<PjRtBuffer* const> argument_handles, int replica, int partition,
+    const RunId& run_id, const ExecuteOptions& options, bool fill_future,
+    PjRtDevice* device) const {
+  TF_ASSIGN_OR_RETURN(ExecutePlan plan,
+                      PrepareExecute(argument_handles.size(), replica,
+                                     partition, options, device));
+  return DispatchExecute(plan, argument_handles, run_id, options, fill_future);
+}
+
+StatusOr<PjRtLoadedExecutable::Result>
+PjRtStreamExecutorExecutable::DispatchExecute(
+    const ExecutePlan& plan, absl::Span<PjRtBuffer* const> argument_handles,
+    const RunId& run_id, const ExecuteOptions& options,
+    bool fill_future) const {
+  DCHECK_EQ(plan.must_donate.size(), argument_handles.size());
+  const uint64_t start_time_usecs = tsl::Env::Default()->NowMicros();
+  const int replica = plan.replica;
+  PjRtDevice* device = plan.device;
   int device_ordinal = tensorflow::down_cast<PjRtStreamExecutorDevice*>(device)
                            ->local_device_state()
                            ->device_ordinal();
   tsl::profiler::TraceMe traceme("PjRtStreamExecutorExecutable::ExecuteHelper");
-  VLOG(1) << "Replica " << replica << ", partition " << partition
+  VLOG(1) << "Replica " << replica << ", partition " << plan.partition
           << " mapped to device ordinal for execution: " << device_ordinal;
 
-  // SPMD sharding produces a single executable for multiple partitions.
-  int executable_idx = executables_.size() > 1 ? partition : 0;
-
   std::vector<std::function<void()>> compute_callbacks;
   std::vector<PjRtStreamExecutorBuffer::ScopedHold> device_buffers;
   device_buffers.reserve(argument_handles.size());
-  StatusOr<ScopedShapedBuffer> result_buffer_or_status = EnqueueExecution(
-      argument_handles, replica, partition, executable_idx, run_id, options,
-      device, &device_buffers, std::move(device_assignment), compute_callbacks);
+  StatusOr<ScopedShapedBuffer> result_buffer_or_status =
+      EnqueueExecution(plan, argument_handles, run_id, options,
+                       &device_buffers, compute_callbacks);
 
   if (!result_buffer_or_status.ok()) {
     LOG(ERROR) << "Execution of replica " << replica
@@ -2651,6 +2680,61 @@ PjRtStreamExecutorExecutable::ExecutePortable(
   return std::move(result.buffers);
 }
 
+StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+PjRtStreamExecutorClient::ExecuteGraph(
+    absl::Span<const PjRtExecuteGraphNode> nodes,
+    const ExecuteOptions& options) {
+  tsl::profiler::TraceMe traceme("PjRtStreamExecutorClient::ExecuteGraph");
+  // Every node is validated and planned by PrepareExecute before the first
+  // one is enqueued, so that dispatching a node only acquires its arguments
+  // and enqueues it. Each node is enqueued on its device's compute stream,
+  // which orders it after the nodes it consumes.
+  std::vector<PjRtStreamExecutorExecutable::ExecutePlan> plans(nodes.size());
+  return DispatchExecuteGraph(
+      this, nodes, options,
+      /*prepare=*/
+      [&](int node_index, const PjRtExecuteGraphNode& node,
+          const PjRtExecuteGraphPlacement& placement)
+          -> StatusOr<absl::Span<const bool>> {
+        auto* executable = tensorflow::down_cast<PjRtStreamExecutorExecutable*>(
+            node.executable);
+        PjRtDevice* device = nullptr;
+        if (placement.portable) {
+          if (executable->device_assignment_ != nullptr ||
+              executable->num_replicas() != 1 ||
+              executable->num_partitions() != 1) {
+            return InvalidArgument(
+                "Executable %s is not assigned to device %s",
+                executable->name(), node.device->DebugString());
+          }
+          device = node.device;
+        }
+        TF_ASSIGN_OR_RETURN(
+            PjRtStreamExecutorExecutable::ExecutePlan plan,
+            executable->PrepareExecute(node.arguments.size(),
+                                       placement.replica, placement.partition,
+                                       options, device));
+        // DispatchExecuteGraph checked the devices of the arguments and that
+        // no donated value is used twice.
+        plan.arguments_validated = true;
+        plans[node_index] = std::move(plan);
+        return absl::Span<const bool>(plans[node_index].must_donate);
+      },
+      /*execute=*/
+      [&](int node_index, const PjRtExecuteGraphNode& node,
+          const PjRtExecuteGraphPlacement& placement,
+          absl::Span<PjRtBuffer* const> arguments)
+          -> StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> {
+        auto* executable = tensorflow::down_cast<PjRtStreamExecutorExecutable*>(
+            node.executable);
+        TF_ASSIGN_OR_RETURN(
+            auto result,
+            executable->DispatchExecute(plans[node_index], arguments, RunId(),
+                                        options, /*fill_future=*/false));
+        return std::move(result.buffers);
+      });
+}
+
 StatusOr<std::vector<std::shared_ptr<HloModule>>>
 PjRtStreamExecutorExecutable::GetHloModules() const {
   std::vector<std::shared_ptr<HloModule>> modules;
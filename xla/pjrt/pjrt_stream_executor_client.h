@@ -256,6 +256,10 @@ class PjRtStreamExecutorClient : public PjRtClient {
       void* device_ptr, const Shape& shape, PjRtDevice* device,
       std::function<void()> on_delete_callback) override;
 
+  StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>> ExecuteGraph(
+      absl::Span<const PjRtExecuteGraphNode> nodes,
+      const ExecuteOptions& options) override;
+
   StatusOr<ChannelHandle> CreateChannelHandle() override {
     return client()->CreateChannelHandle();
   }
@@ -368,8 +372,7 @@ class PjRtStreamExecutorClient : public PjRtClient {
 
   tsl::thread::ThreadPool thread_pool_;
 
-  absl::Mutex transpose_mu_;
-  TransposePlanCache transpose_cache_ ABSL_GUARDED_BY(transpose_mu_);
+  TransposePlanCache transpose_cache_;
 };
 
 // Converts a 2D set of Device objects indexed by [replica][partition] into an
@@ -833,12 +836,34 @@ class PjRtStreamExecutorExecutable : public PjRtLoadedExecutable {
       absl::Span<const PjRtStreamExecutorBuffer::ScopedHold> device_buffers,
       absl::flat_hash_set<BufferSequencingEvent*>& events) const;
 
+  // What PrepareExecute() works out about an execution before any argument
+  // is looked at, so that executions with the same placement and options can
+  // share it.
+  struct ExecutePlan {
+    int replica = 0;
+    int partition = 0;
+    int executable_idx = 0;
+    PjRtDevice* device = nullptr;
+    // Kept alive until the execution completes.
+    std::shared_ptr<DeviceAssignment> device_assignment;
+    // Whether each argument must be donated to the execution.
+    absl::InlinedVector<bool, 4> must_donate;
+    // Set by callers that already checked that the arguments are on `device`
+    // and that no donated argument is passed more than once.
+    bool arguments_validated = false;
+  };
+
+  // Resolves the device and executable of the execution and validates
+  // `options` against the executable.
+  StatusOr<ExecutePlan> PrepareExecute(int num_arguments, int replica,
+                                       int partition,
+                                       const ExecuteOptions& options,
+                                       PjRtDevice* device) const;
+
   StatusOr<ScopedShapedBuffer> EnqueueExecution(
-      absl::Span<PjRtBuffer* const> argument_handles, int replica,
-      int partition, int executable_idx, const RunId& run_id,
-      const ExecuteOptions& options, PjRtDevice* device,
+      const ExecutePlan& plan, absl::Span<PjRtBuffer* const> argument_handles,
+      const RunId& run_id, const ExecuteOptions& options,
       std::vector<PjRtStreamExecutorBuffer::ScopedHold>* device_buffers,
-      std::shared_ptr<DeviceAssignment> device_assignment,
       std::vector<std::function<void()>>& compute_callbacks) const;
 
   virtual std::vector<std::unique_ptr<PjRtBuffer>> MakeOutputBuffers(
@@ -849,6 +874,13 @@ class PjRtStreamExecutorExecutable : public PjRtLoadedExecutable {
       std::vector<std::shared_ptr<TrackedDeviceBuffer>>& buffers_to_release)
       const;
 
+  // Acquires the arguments and enqueues the execution planned by
+  // PrepareExecute().
+  StatusOr<Result> DispatchExecute(
+      const ExecutePlan& plan, absl::Span<PjRtBuffer* const> argument_handles,
+      const RunId& run_id, const ExecuteOptions& options,
+      bool fill_future) const;
+
   StatusOr<Result> ExecuteHelper(absl::Span<PjRtBuffer* const> argument_handles,
                                  int replica, int partition,
                                  const RunId& run_id,
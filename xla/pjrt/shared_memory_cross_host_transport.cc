@@ -0,0 +1,395 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/shared_memory_cross_host_transport.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "xla/util.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+
+namespace xla {
+namespace {
+
+// Identifies one byte range of a shared memory segment that a sender should
+// write into, and the socket on which to notify the receiver afterwards.
+struct ShmDescriptor {
+  std::string segment_name;
+  int64_t offset;
+  int64_t size;
+  uint64_t receive_id;
+  std::string socket_path;
+};
+
+// Descriptors are serialized as
+//   shm:<segment name>:<offset>:<size>:<receive id>:<socket path>
+// The socket path comes last because it is the only field that may contain a
+// colon.
+constexpr absl::string_view kDescriptorTag = "shm";
+constexpr int kNumDescriptorFields = 6;
+
+std::string SerializeDescriptor(const ShmDescriptor& descriptor) {
+  return absl::StrCat(kDescriptorTag, ":", descriptor.segment_name, ":",
+                      descriptor.offset, ":", descriptor.size, ":",
+                      descriptor.receive_id, ":", descriptor.socket_path);
+}
+
+StatusOr<ShmDescriptor> ParseDescriptor(absl::string_view serialized) {
+  std::vector<std::string> fields = absl::StrSplit(
+      serialized, absl::MaxSplits(':', kNumDescriptorFields - 1));
+  ShmDescriptor descriptor;
+  if (fields.size() != kNumDescriptorFields || fields[0] != kDescriptorTag ||
+      !absl::SimpleAtoi(fields[2], &descriptor.offset) ||
+      !absl::SimpleAtoi(fields[3], &descriptor.size) ||
+      !absl::SimpleAtoi(fields[4], &descriptor.receive_id)) {
+    return InvalidArgument("Malformed cross-host receive descriptor: %s",
+                           serialized);
+  }
+  descriptor.segment_name = std::move(fields[1]);
+  descriptor.socket_path = std::move(fields[5]);
+  return descriptor;
+}
+
+Status ErrnoError(absl::string_view what) {
+  return Internal("%s failed: %s", what, strerror(errno));
+}
+
+bool WriteFully(int fd, const void* data, size_t size) {
+  const char* p = static_cast<const char*>(data);
+  while (size > 0) {
+#ifdef MSG_NOSIGNAL
+    ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+#else
+    ssize_t n = send(fd, p, size, 0);
+#endif
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool ReadFully(int fd, void* data, size_t size) {
+  char* p = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t n = read(fd, p, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+StatusOr<sockaddr_un> MakeSocketAddress(const std::string& path) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    return InvalidArgument("Socket path %s is longer than %d characters", path,
+                           sizeof(address.sun_path) - 1);
+  }
+  std::memcpy(address.sun_path, path.data(), path.size());
+  return address;
+}
+
+}  // namespace
+
+// A shared memory segment created by the receiving transport. The segment's
+// name is unlinked as soon as no sender needs to open it anymore; the memory
+// stays mapped until the last reference to the segment is dropped.
+class SharedMemoryCrossHostTransport::Segment {
+ public:
+  static StatusOr<std::shared_ptr<Segment>> Create(std::string name,
+                                                   size_t size,
+                                                   int num_receives) {
+    // mmap does not accept empty mappings.
+    size_t mapped_size = std::max<size_t>(size, 1);
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return ErrnoError(absl::StrCat("shm_open(", name, ")"));
+    Status status;
+    void* data = MAP_FAILED;
+    if (ftruncate(fd, mapped_size) != 0) {
+      status = ErrnoError("ftruncate");
+    } else {
+      data = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                  0);
+      if (data == MAP_FAILED) status = ErrnoError("mmap");
+    }
+    close(fd);
+    if (!status.ok()) {
+      shm_unlink(name.c_str());
+      return status;
+    }
+    auto segment = std::shared_ptr<Segment>(
+        new Segment(std::move(name), data, mapped_size, num_receives));
+    if (num_receives == 0) segment->Unlink();
+    return segment;
+  }
+
+  ~Segment() {
+    Unlink();
+    munmap(data_, mapped_size_);
+  }
+
+  void* data() const { return data_; }
+
+  // Called once for each receive the segment was created for, when that
+  // receive completes.
+  void ReceiveDone() {
+    if (pending_receives_.fetch_sub(1) == 1) Unlink();
+  }
+
+ private:
+  Segment(std::string name, void* data, size_t mapped_size, int num_receives)
+      : name_(std::move(name)),
+        data_(data),
+        mapped_size_(mapped_size),
+        pending_receives_(num_receives) {}
+
+  void Unlink() {
+    if (!unlinked_.exchange(true)) shm_unlink(name_.c_str());
+  }
+
+  const std::string name_;
+  void* const data_;
+  const size_t mapped_size_;
+  std::atomic<int> pending_receives_;
+  std::atomic<bool> unlinked_{false};
+};
+
+struct SharedMemoryCrossHostTransport::PendingReceive {
+  // Keeps the segment mapped until the receive completes, even if the buffer
+  // backed by it is deleted in the meantime.
+  std::shared_ptr<Segment> segment;
+  int range_index;
+  // Shared by all receives prepared by the same PrepareReceive call.
+  std::shared_ptr<absl::AnyInvocable<void(int, Status)>> on_done;
+};
+
+StatusOr<std::unique_ptr<SharedMemoryCrossHostTransport>>
+SharedMemoryCrossHostTransport::Create(std::string socket_directory) {
+  static std::atomic<int> next_transport_id{0};
+  const int transport_id = next_transport_id.fetch_add(1);
+  const int pid = getpid();
+  std::string socket_path = absl::StrFormat(
+      "%s/xla_cpu_transport_%d_%d.sock", socket_directory, pid, transport_id);
+  TF_ASSIGN_OR_RETURN(sockaddr_un address, MakeSocketAddress(socket_path));
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return ErrnoError("socket");
+  unlink(socket_path.c_str());
+  if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) !=
+          0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    Status status = ErrnoError(absl::StrCat("Listening on ", socket_path));
+    close(fd);
+    return status;
+  }
+  // POSIX shared memory names are limited to a few dozen characters on some
+  // platforms, so keep the prefix short.
+  std::string segment_prefix =
+      absl::StrFormat("/xla_%d_%d_", pid, transport_id);
+  return absl::WrapUnique(new SharedMemoryCrossHostTransport(
+      std::move(socket_path), fd, std::move(segment_prefix)));
+}
+
+SharedMemoryCrossHostTransport::SharedMemoryCrossHostTransport(
+    std::string socket_path, int listen_fd, std::string segment_prefix)
+    : socket_path_(std::move(socket_path)),
+      listen_fd_(listen_fd),
+      segment_prefix_(std::move(segment_prefix)) {
+  listen_thread_.reset(tsl::Env::Default()->StartThread(
+      tsl::ThreadOptions(), "XLACpuCrossHostTransport",
+      [this]() { ListenLoop(); }));
+}
+
+SharedMemoryCrossHostTransport::~SharedMemoryCrossHostTransport() {
+  // Shutting down the listening socket makes the pending accept() fail, which
+  // ends the listen loop.
+  shutdown(listen_fd_, SHUT_RDWR);
+  listen_thread_.reset();
+  close(listen_fd_);
+  unlink(socket_path_.c_str());
+
+  absl::flat_hash_map<uint64_t, std::unique_ptr<PendingReceive>> pending;
+  {
+    absl::MutexLock lock(&mu_);
+    std::swap(pending, pending_receives_);
+  }
+  for (auto& [receive_id, receive] : pending) {
+    receive->segment->ReceiveDone();
+    (*receive->on_done)(receive->range_index,
+                        Cancelled("Cross-host transport was destroyed before "
+                                  "the receive completed"));
+  }
+}
+
+void SharedMemoryCrossHostTransport::ListenLoop() {
+  while (true) {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      return;
+    }
+    // Every notification is the 8-byte id of a completed receive.
+    uint64_t receive_id;
+    while (ReadFully(fd, &receive_id, sizeof(receive_id))) {
+      if (!CompleteReceive(receive_id, OkStatus())) {
+        LOG(WARNING) << "Notified of unknown cross-host receive "
+                     << receive_id;
+      }
+    }
+    close(fd);
+  }
+}
+
+bool SharedMemoryCrossHostTransport::CompleteReceive(uint64_t receive_id,
+                                                     Status status) {
+  std::unique_ptr<PendingReceive> receive;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = pending_receives_.find(receive_id);
+    if (it == pending_receives_.end()) return false;
+    receive = std::move(it->second);
+    pending_receives_.erase(it);
+  }
+  receive->segment->ReceiveDone();
+  (*receive->on_done)(receive->range_index, std::move(status));
+  return true;
+}
+
+StatusOr<CpuCrossHostTransport::Receive>
+SharedMemoryCrossHostTransport::PrepareReceive(
+    size_t size, absl::Span<const ByteRange> ranges,
+    absl::AnyInvocable<void(int range_index, Status status)> on_done) {
+  for (const ByteRange& range : ranges) {
+    if (range.offset < 0 || range.size < 0 ||
+        range.offset + range.size > static_cast<int64_t>(size)) {
+      return InvalidArgument(
+          "Receive range of %d bytes at offset %d is out of bounds of a "
+          "buffer of %d bytes",
+          range.size, range.offset, size);
+    }
+  }
+
+  std::string segment_name;
+  {
+    absl::MutexLock lock(&mu_);
+    segment_name = absl::StrCat(segment_prefix_, next_segment_id_++);
+  }
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<Segment> segment,
+                      Segment::Create(segment_name, size, ranges.size()));
+
+  Receive receive;
+  auto shared_on_done =
+      std::make_shared<absl::AnyInvocable<void(int, Status)>>(
+          std::move(on_done));
+  {
+    absl::MutexLock lock(&mu_);
+    for (int i = 0; i < static_cast<int>(ranges.size()); ++i) {
+      uint64_t receive_id = next_receive_id_++;
+      pending_receives_[receive_id] = absl::WrapUnique(
+          new PendingReceive{segment, /*range_index=*/i, shared_on_done});
+      receive.serialized_descriptors.push_back(SerializeDescriptor(
+          {segment_name, ranges[i].offset, ranges[i].size, receive_id,
+           socket_path_}));
+    }
+  }
+  // The buffer does not own the segment's memory, but keeps the segment alive
+  // for as long as it is in use.
+  void* data = segment->data();
+  receive.memory = std::shared_ptr<MaybeOwningCpuMemory>(
+      new MaybeOwningCpuMemory(data, size),
+      [segment = std::move(segment)](MaybeOwningCpuMemory* memory) {
+        delete memory;
+      });
+  return receive;
+}
+
+Status SharedMemoryCrossHostTransport::CancelReceive(
+    absl::string_view serialized_descriptor, Status reason) {
+  TF_ASSIGN_OR_RETURN(ShmDescriptor descriptor,
+                      ParseDescriptor(serialized_descriptor));
+  if (descriptor.socket_path != socket_path_ ||
+      !CompleteReceive(descriptor.receive_id, std::move(reason))) {
+    return NotFound("No pending cross-host receive for descriptor %s",
+                    serialized_descriptor);
+  }
+  return OkStatus();
+}
+
+Status SharedMemoryCrossHostTransport::Send(
+    absl::string_view serialized_descriptor, const void* data, size_t size) {
+  TF_ASSIGN_OR_RETURN(ShmDescriptor descriptor,
+                      ParseDescriptor(serialized_descriptor));
+  if (static_cast<int64_t>(size) != descriptor.size) {
+    return InvalidArgument(
+        "Sending %d bytes to a cross-host receive of %d bytes", size,
+        descriptor.size);
+  }
+
+  if (size > 0) {
+    int fd = shm_open(descriptor.segment_name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+      return ErrnoError(
+          absl::StrCat("shm_open(", descriptor.segment_name, ")"));
+    }
+    size_t mapped_size = descriptor.offset + descriptor.size;
+    void* base = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return ErrnoError("mmap");
+    std::memcpy(static_cast<char*>(base) + descriptor.offset, data, size);
+    munmap(base, mapped_size);
+  }
+
+  TF_ASSIGN_OR_RETURN(sockaddr_un address,
+                      MakeSocketAddress(descriptor.socket_path));
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return ErrnoError("socket");
+  Status status;
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&address),
+              sizeof(address)) != 0) {
+    status = ErrnoError(absl::StrCat("Connecting to ", descriptor.socket_path));
+  } else if (!WriteFully(fd, &descriptor.receive_id,
+                         sizeof(descriptor.receive_id))) {
+    status = ErrnoError("Notifying the cross-host receiver");
+  }
+  close(fd);
+  return status;
+}
+
+}  // namespace xla
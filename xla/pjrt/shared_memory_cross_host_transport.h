@@ -0,0 +1,99 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_SHARED_MEMORY_CROSS_HOST_TRANSPORT_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_SHARED_MEMORY_CROSS_HOST_TRANSPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xla/pjrt/cpu_cross_host_transport.h"
+#include "xla/status.h"
+#include "xla/statusor.h"
+#include "tsl/platform/env.h"
+
+namespace xla {
+
+// A transport between processes on the same host.
+//
+// Every receive buffer is a POSIX shared memory segment, so a buffer returned
+// by MakeCrossHostReceiveBuffers is used in place by the receiving client and
+// a send is a single memcpy from the source buffer straight into the receiver's
+// memory. Completion is signaled over a Unix domain socket that the receiving
+// transport listens on.
+class SharedMemoryCrossHostTransport : public CpuCrossHostTransport {
+ public:
+  // Creates a transport that listens on a Unix domain socket in
+  // `socket_directory`.
+  static StatusOr<std::unique_ptr<SharedMemoryCrossHostTransport>> Create(
+      std::string socket_directory = "/tmp");
+
+  // Fails all pending receives with a Cancelled error.
+  ~SharedMemoryCrossHostTransport() override;
+
+  StatusOr<Receive> PrepareReceive(
+      size_t size, absl::Span<const ByteRange> ranges,
+      absl::AnyInvocable<void(int range_index, Status status)> on_done)
+      override;
+
+  Status CancelReceive(absl::string_view serialized_descriptor,
+                       Status reason) override;
+
+  Status Send(absl::string_view serialized_descriptor, const void* data,
+              size_t size) override;
+
+  // Path of the socket this transport listens on.
+  const std::string& socket_path() const { return socket_path_; }
+
+ private:
+  class Segment;
+  struct PendingReceive;
+
+  SharedMemoryCrossHostTransport(std::string socket_path, int listen_fd,
+                                 std::string segment_prefix);
+
+  // Accepts notifications from senders until the transport is destroyed.
+  void ListenLoop();
+
+  // Completes the pending receive `receive_id` with `status`, if it has not
+  // completed yet. Returns whether it was pending.
+  bool CompleteReceive(uint64_t receive_id, Status status);
+
+  const std::string socket_path_;
+  const int listen_fd_;
+  // Names of the shared memory segments created by this transport start with
+  // this prefix, which is unique to the transport.
+  const std::string segment_prefix_;
+
+  absl::Mutex mu_;
+  uint64_t next_segment_id_ ABSL_GUARDED_BY(mu_) = 0;
+  uint64_t next_receive_id_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<uint64_t, std::unique_ptr<PendingReceive>>
+      pending_receives_ ABSL_GUARDED_BY(mu_);
+
+  std::unique_ptr<tsl::Thread> listen_thread_;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_SHARED_MEMORY_CROSS_HOST_TRANSPORT_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/pjrt/tfrt_cpu_pjrt_client.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <functional>
 #include <memory>
@@ -31,14 +32,21 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include "absl/algorithm/container.h"
 #include "absl/base/thread_annotations.h"
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "xla/client/executable_build_options.h"
 #include "xla/client/xla_computation.h"
+#include "xla/layout_util.h"
 #include "xla/literal.h"
 #include "xla/pjrt/mlir_to_hlo.h"
 #include "xla/pjrt/pjrt_client.h"
@@ -49,12 +57,14 @@ limitations under the License.
 #include "xla/primitive_util.h"
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/computation_placer.h"
+#include "xla/service/cpu/buffer_table_arena.h"
 #include "xla/service/cpu/cpu_executable.h"
 #include "xla/service/cpu/cpu_xfeed.h"
 #include "xla/service/dump.h"
 #include "xla/service/executable.h"
 #include "xla/service/hlo_cost_analysis.h"
 #include "xla/shape.h"
+#include "xla/shape_util.h"
 #include "xla/statusor.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/denormal.h"
@@ -124,9 +134,11 @@ static void EnqueueWorkWhenReady(
   });
 }
 
-TfrtCpuDevice::TfrtCpuDevice(int id, bool asynchronous)
+TfrtCpuDevice::TfrtCpuDevice(int id, bool asynchronous,
+                             TrackingCpuAllocator::Options allocator_options)
     : id_(id),
-      max_inflight_computations_semaphore_(/*capacity=*/asynchronous ? 32 : 1) {
+      max_inflight_computations_semaphore_(/*capacity=*/asynchronous ? 32 : 1),
+      allocator_(allocator_options) {
   debug_string_ = absl::StrCat("TFRT_CPU_", id);
   to_string_ = absl::StrCat("CpuDevice(id=", id, ")");
 }
@@ -155,26 +167,37 @@ static int CpuDeviceCount() {
 }
 
 static StatusOr<std::vector<std::unique_ptr<TfrtCpuDevice>>> GetTfrtCpuDevices(
-    bool asynchronous, int cpu_device_count) {
+    bool asynchronous, int cpu_device_count,
+    const TrackingCpuAllocator::Options& allocator_options) {
   std::vector<std::unique_ptr<TfrtCpuDevice>> devices;
   for (int i = 0; i < cpu_device_count; ++i) {
     auto device = std::make_unique<TfrtCpuDevice>(
-        /*id=*/i, asynchronous);
+        /*id=*/i, asynchronous, allocator_options);
     devices.push_back(std::move(device));
   }
   return std::move(devices);
 }
 
-StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous,
-                                                       int cpu_device_count) {
+StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
+    bool asynchronous, int cpu_device_count,
+    std::unique_ptr<CpuCrossHostTransport> cross_host_transport,
+    TrackingCpuAllocator::Options allocator_options) {
   // Need at least CpuDeviceCount threads to launch one collective.
   size_t num_threads = std::max(DefaultThreadPoolSize(), cpu_device_count);
 
-  TF_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
-                      GetTfrtCpuDevices(asynchronous, cpu_device_count));
+  TF_ASSIGN_OR_RETURN(
+      std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
+      GetTfrtCpuDevices(asynchronous, cpu_device_count, allocator_options));
 
   return std::unique_ptr<PjRtClient>(std::make_unique<TfrtCpuClient>(
-      /*process_index=*/0, std::move(devices), num_threads));
+      /*process_index=*/0, std::move(devices), num_threads,
+      std::move(cross_host_transport)));
+}
+
+StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous,
+                                                       int cpu_device_count) {
+  return GetTfrtCpuClient(asynchronous, cpu_device_count,
+                          /*cross_host_transport=*/nullptr);
 }
 
 StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous) {
@@ -183,7 +206,8 @@ StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous) {
 
 TfrtCpuClient::TfrtCpuClient(
     int process_index, std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
-    size_t num_threads)
+    size_t num_threads,
+    std::unique_ptr<CpuCrossHostTransport> cross_host_transport)
     : process_index_(process_index),
       owned_devices_(std::move(devices)),
       computation_placer_(std::make_unique<ComputationPlacer>()),
@@ -196,7 +220,8 @@ TfrtCpuClient::TfrtCpuClient(
                                       eigen_intraop_pool_->NumThreads())),
       last_collective_launch_event_(
           tfrt::MakeAvailableAsyncValueRef<CpuEvent>()),
-      transpose_cache_(1024) {
+      transpose_cache_(1024),
+      cross_host_transport_(std::move(cross_host_transport)) {
   for (const std::unique_ptr<TfrtCpuDevice>& device : owned_devices_) {
     devices_.push_back(device.get());
     CHECK(id_to_device_.insert({device->id(), device.get()}).second)
@@ -557,7 +582,7 @@ StatusOr<std::unique_ptr<TfrtCpuBuffer>> AllocateDestinationBuffer(
   if (!on_device_shape.IsTuple()) {
     size_t byte_size = ShapeUtil::ByteSizeOf(on_device_shape);
     TF_ASSIGN_OR_RETURN(auto device_buffer,
-                        MaybeOwningCpuMemory::AllocateShared(byte_size));
+                        device->allocator().Allocate(byte_size));
     buffers.push_back(std::move(device_buffer));
     return std::make_unique<TfrtCpuBuffer>(
         on_device_shape,
@@ -571,7 +596,7 @@ StatusOr<std::unique_ptr<TfrtCpuBuffer>> AllocateDestinationBuffer(
   for (const auto& leaf_shape : on_device_shape.tuple_shapes()) {
     size_t byte_size = ShapeUtil::ByteSizeOf(leaf_shape);
     TF_ASSIGN_OR_RETURN(auto device_buffer,
-                        MaybeOwningCpuMemory::AllocateShared(byte_size));
+                        device->allocator().Allocate(byte_size));
     buffers.push_back(std::move(device_buffer));
   }
   return std::make_unique<TfrtCpuBuffer>(
@@ -581,6 +606,295 @@ StatusOr<std::unique_ptr<TfrtCpuBuffer>> AllocateDestinationBuffer(
       client, device);
 }
 
+namespace {
+
+// Streams host data into buffers that are allocated up front. Chunks are
+// copied straight into the buffers' memory, and each buffer's definition
+// event only fires once its last transfer has landed, so the buffers can be
+// handed to Execute before their contents have arrived.
+class TfrtCpuAsyncHostToDeviceTransferManager
+    : public PjRtClient::AsyncHostToDeviceTransferManager {
+ public:
+  static StatusOr<std::unique_ptr<TfrtCpuAsyncHostToDeviceTransferManager>>
+  Create(absl::Span<const Shape> shapes, TfrtCpuDevice* device,
+         TfrtCpuClient* client) {
+    absl::InlinedVector<std::unique_ptr<PjRtBuffer>, 4> buffers;
+    absl::InlinedVector<void*, 4> buffer_ptrs;
+    absl::InlinedVector<tfrt::AsyncValueRef<CpuEvent>, 4> definition_events;
+    for (const Shape& shape : shapes) {
+      if (!shape.IsArray() || shape.is_dynamic()) {
+        return Unimplemented(
+            "Async transfers are only supported into static arrays, got %s",
+            shape.ToString());
+      }
+      Shape device_shape = shape;
+      if (!device_shape.has_layout()) {
+        LayoutUtil::SetToDefaultLayout(&device_shape);
+      }
+      TF_ASSIGN_OR_RETURN(auto device_buffer,
+                          device->allocator().Allocate(
+                              ShapeUtil::ByteSizeOf(device_shape)));
+      // Deleting the buffer waits for its definition event, so the memory
+      // stays alive until the last transfer has landed.
+      buffer_ptrs.push_back(device_buffer->data());
+      tfrt::AsyncValueRef<CpuEvent> definition_event =
+          tfrt::MakeConstructedAsyncValueRef<CpuEvent>();
+      definition_events.push_back(definition_event.CopyRef());
+      absl::InlinedVector<std::shared_ptr<MaybeOwningCpuMemory>, 4>
+          device_buffers;
+      device_buffers.push_back(std::move(device_buffer));
+      auto tracked_device_buffer = std::make_unique<TrackedTfrtCpuDeviceBuffer>(
+          /*is_tuple=*/false, std::move(device_buffers),
+          std::move(definition_event));
+      buffers.push_back(std::make_unique<TfrtCpuBuffer>(
+          device_shape, std::move(tracked_device_buffer), client, device));
+    }
+    return absl::WrapUnique(new TfrtCpuAsyncHostToDeviceTransferManager(
+        std::move(buffers), std::move(buffer_ptrs),
+        std::move(definition_events), device, client));
+  }
+
+  ~TfrtCpuAsyncHostToDeviceTransferManager() override {
+    absl::InlinedVector<tfrt::AsyncValueRef<CpuEvent>, 4> abandoned_events;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(
+          +[](int64_t* transfers_in_flight) {
+            return *transfers_in_flight == 0;
+          },
+          &total_transfers_in_flight_));
+      for (int i = 0; i < buffer_states_.size(); ++i) {
+        if (!buffer_states_[i].last_transfer_started) {
+          abandoned_events.push_back(
+              std::move(buffer_states_[i].definition_event));
+        }
+      }
+    }
+    // Consumers of buffers that never received their last transfer would
+    // otherwise wait forever.
+    for (auto& event : abandoned_events) {
+      event.SetError(
+          "AsyncHostToDeviceTransferManager was destroyed before the buffer's "
+          "last transfer");
+    }
+  }
+
+  size_t buffer_count() const override { return buffer_states_.size(); }
+
+  PjRtDevice* device() const override { return device_; }
+
+  std::unique_ptr<PjRtBuffer> RetrieveBuffer(int buffer_index) override {
+    absl::MutexLock lock(&mu_);
+    CHECK_GE(buffer_index, 0);
+    CHECK_LT(buffer_index, buffers_.size());
+    CHECK(buffers_[buffer_index] != nullptr)
+        << "RetrieveBuffer called more than once for buffer " << buffer_index;
+    return std::move(buffers_[buffer_index]);
+  }
+
+  size_t buffer_size(int buffer_index) const override {
+    CHECK_GE(buffer_index, 0);
+    CHECK_LT(buffer_index, buffer_states_.size());
+    return buffer_states_[buffer_index].size;
+  }
+
+  Status TransferLiteralToBuffer(
+      int buffer_index, const LiteralSlice& literal,
+      absl::AnyInvocable<void() &&> on_done) override {
+    TF_RETURN_IF_ERROR(CheckBufferIndex(buffer_index));
+    const Shape& device_shape = buffer_states_[buffer_index].shape;
+    if (!ShapeUtil::Compatible(literal.shape(), device_shape)) {
+      return InvalidArgument(
+          "Literal of shape %s cannot be transferred into a buffer of shape %s",
+          literal.shape().ToString(), device_shape.ToString());
+    }
+    if (LayoutUtil::Equal(literal.shape().layout(), device_shape.layout())) {
+      return TransferRawDataToSubBuffer(
+          buffer_index, literal.untyped_data(), /*offset=*/0,
+          literal.size_bytes(), /*is_last_transfer=*/true, std::move(on_done));
+    }
+    // The literal is relaid out on the host first; the copy has to live until
+    // the transfer is done.
+    auto relaid_out =
+        std::make_shared<Literal>(literal.Relayout(device_shape.layout()));
+    return TransferRawDataToSubBuffer(
+        buffer_index, relaid_out->untyped_data(), /*offset=*/0,
+        relaid_out->size_bytes(), /*is_last_transfer=*/true,
+        [relaid_out, on_done = std::move(on_done)]() mutable {
+          if (on_done) std::move(on_done)();
+        });
+  }
+
+  Status TransferRawDataToBuffer(
+      int buffer_index, absl::string_view data,
+      absl::AnyInvocable<void() &&> on_done) override {
+    TF_RETURN_IF_ERROR(CheckBufferIndex(buffer_index));
+    if (data.size() != buffer_states_[buffer_index].size) {
+      return InvalidArgument(
+          "Transfer of %d bytes into buffer %d of %d bytes", data.size(),
+          buffer_index, buffer_states_[buffer_index].size);
+    }
+    return TransferRawDataToSubBuffer(buffer_index, data.data(), /*offset=*/0,
+                                      data.size(), /*is_last_transfer=*/true,
+                                      std::move(on_done));
+  }
+
+  Status TransferRawDataToSubBuffer(
+      int buffer_index, const void* data, int64_t offset,
+      int64_t transfer_size, bool is_last_transfer,
+      absl::AnyInvocable<void() &&> on_done) override {
+    TF_RETURN_IF_ERROR(CheckBufferIndex(buffer_index));
+    {
+      absl::MutexLock lock(&mu_);
+      BufferState& state = buffer_states_[buffer_index];
+      if (offset < 0 || transfer_size < 0 ||
+          offset + transfer_size > state.size) {
+        return InvalidArgument(
+            "Transfer of %d bytes at offset %d is out of bounds of buffer %d "
+            "of %d bytes",
+            transfer_size, offset, buffer_index, state.size);
+      }
+      if (state.last_transfer_started) {
+        return FailedPrecondition(
+            "Transfer into buffer %d after its last transfer or error",
+            buffer_index);
+      }
+      state.last_transfer_started = is_last_transfer;
+      ++state.transfers_in_flight;
+      ++total_transfers_in_flight_;
+    }
+
+    char* dst = static_cast<char*>(buffer_ptrs_[buffer_index]) + offset;
+    if (transfer_size < kSmallDataTransferByteSize) {
+      std::memcpy(dst, data, transfer_size);
+      FinishTransfer(buffer_index, std::move(on_done));
+    } else {
+      // The destructor waits for transfers in flight, so `this` outlives the
+      // copy.
+      EnqueueWork(client_->pjrt_client_thread_pool(),
+                  [this, buffer_index, dst, data, transfer_size,
+                   on_done = std::move(on_done)]() mutable {
+                    tsl::profiler::TraceMe traceme("H2D Dispatch");
+                    std::memcpy(dst, data, transfer_size);
+                    FinishTransfer(buffer_index, std::move(on_done));
+                  });
+    }
+    return OkStatus();
+  }
+
+  void SetBufferError(int buffer_index, Status error) override {
+    CHECK_OK(CheckBufferIndex(buffer_index));
+    CHECK(!error.ok());
+    tfrt::AsyncValueRef<CpuEvent> event;
+    {
+      absl::MutexLock lock(&mu_);
+      BufferState& state = buffer_states_[buffer_index];
+      CHECK(!state.last_transfer_started)
+          << "SetBufferError called for buffer " << buffer_index
+          << " after its last transfer or error";
+      state.last_transfer_started = true;
+      if (state.transfers_in_flight > 0) {
+        // The last transfer in flight reports the error.
+        state.error = std::move(error);
+        return;
+      }
+      event = std::move(state.definition_event);
+    }
+    event.SetError(error);
+  }
+
+  void AddTransferMetadata(const TransferMetadata& metadata) override {}
+
+ private:
+  struct BufferState {
+    Shape shape;
+    int64_t size;
+    // Fired, with `error` if it is set, once the last transfer has finished.
+    tfrt::AsyncValueRef<CpuEvent> definition_event;
+    int64_t transfers_in_flight = 0;
+    // Set by the last transfer and by SetBufferError.
+    bool last_transfer_started = false;
+    Status error;
+  };
+
+  TfrtCpuAsyncHostToDeviceTransferManager(
+      absl::InlinedVector<std::unique_ptr<PjRtBuffer>, 4> buffers,
+      absl::InlinedVector<void*, 4> buffer_ptrs,
+      absl::InlinedVector<tfrt::AsyncValueRef<CpuEvent>, 4> definition_events,
+      TfrtCpuDevice* device, TfrtCpuClient* client)
+      : buffers_(std::move(buffers)),
+        buffer_ptrs_(std::move(buffer_ptrs)),
+        device_(device),
+        client_(client) {
+    buffer_states_.reserve(buffers_.size());
+    for (int i = 0; i < buffers_.size(); ++i) {
+      BufferState state;
+      state.shape = buffers_[i]->on_device_shape();
+      state.size = ShapeUtil::ByteSizeOf(state.shape);
+      state.definition_event = std::move(definition_events[i]);
+      buffer_states_.push_back(std::move(state));
+    }
+  }
+
+  Status CheckBufferIndex(int buffer_index) const {
+    if (buffer_index < 0 || buffer_index >= buffer_states_.size()) {
+      return InvalidArgument("Invalid buffer index %d for %d buffers",
+                             buffer_index, buffer_states_.size());
+    }
+    return OkStatus();
+  }
+
+  // Runs `on_done` and makes the buffer available to its consumers if the
+  // transfer was the last one in flight after the last transfer started.
+  void FinishTransfer(int buffer_index, absl::AnyInvocable<void() &&> on_done) {
+    if (on_done) std::move(on_done)();
+    tfrt::AsyncValueRef<CpuEvent> event;
+    Status error;
+    {
+      absl::MutexLock lock(&mu_);
+      BufferState& state = buffer_states_[buffer_index];
+      --total_transfers_in_flight_;
+      if (--state.transfers_in_flight == 0 && state.last_transfer_started) {
+        event = std::move(state.definition_event);
+        error = state.error;
+      }
+    }
+    if (!event) return;
+    if (error.ok()) {
+      event.SetStateConcrete();
+    } else {
+      event.SetError(error);
+    }
+  }
+
+  absl::Mutex mu_;
+  // Set to null by RetrieveBuffer.
+  absl::InlinedVector<std::unique_ptr<PjRtBuffer>, 4> buffers_
+      ABSL_GUARDED_BY(mu_);
+  // Memory backing each buffer; stays valid until its definition event fires.
+  const absl::InlinedVector<void*, 4> buffer_ptrs_;
+  // Only the `shape` and `size` fields may be read without holding mu_.
+  absl::InlinedVector<BufferState, 4> buffer_states_;
+  int64_t total_transfers_in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  TfrtCpuDevice* const device_;
+  TfrtCpuClient* const client_;
+};
+
+}  // namespace
+
+StatusOr<std::unique_ptr<PjRtClient::AsyncHostToDeviceTransferManager>>
+TfrtCpuClient::CreateBuffersForAsyncHostToDevice(
+    absl::Span<const Shape> shapes, PjRtDevice* device) {
+  tsl::profiler::TraceMe traceme(
+      "TfrtCpuClient::CreateBuffersForAsyncHostToDevice");
+  TF_ASSIGN_OR_RETURN(
+      auto manager,
+      TfrtCpuAsyncHostToDeviceTransferManager::Create(
+          shapes, tensorflow::down_cast<TfrtCpuDevice*>(device), this));
+  return std::unique_ptr<PjRtClient::AsyncHostToDeviceTransferManager>(
+      std::move(manager));
+}
+
 StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuClient::CreateViewOfDeviceBuffer(
     void* device_ptr, const Shape& shape, PjRtDevice* device,
     std::function<void()> on_delete_callback) {
@@ -638,30 +952,84 @@ StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuClient::BufferFromHostBuffer(
     buffers.push_back(std::move(device_buffer));
     on_delete_callback = std::move(on_done_with_host_buffer);
   } else {
-    TF_ASSIGN_OR_RETURN(auto device_buffer,
-                        MaybeOwningCpuMemory::AllocateShared(byte_size));
+    TF_ASSIGN_OR_RETURN(
+        auto device_buffer,
+        tensorflow::down_cast<TfrtCpuDevice*>(device)->allocator().Allocate(
+            byte_size));
     auto dst_data_ptr = device_buffer->data();
     buffers.push_back(device_buffer);
     if (!has_default_layout) {
       // If the input array does not have a major-to-minor layout, transpose it
-      // into major-to-minor layout. Currently we choose to always do this
-      // synchronously.
-      // TODO(phawkins): consider performing the transpose asynchronously.
-      // TODO(phawkins): parallelize the transpose.
+      // into major-to-minor layout. Large arrays are transposed in parallel on
+      // the client thread pool; unless the caller only guarantees the host
+      // buffer for the duration of the call, the transpose also runs
+      // asynchronously and the buffer's definition event is set once it is
+      // done.
+      bool is_small = byte_size < kSmallDataTransferByteSize;
       std::shared_ptr<TransposePlan> transpose;
       {
         absl::InlinedVector<int64_t, 4> permutation(dims.size());
         absl::c_iota(permutation, 0);
-        absl::MutexLock lock(&transpose_mu_);
         TF_ASSIGN_OR_RETURN(
-            transpose, transpose_cache_.GetOrCreate(
-                           primitive_util::ByteWidth(type), dims, permutation,
-                           TransposePlan::Striding{*byte_strides}));
+            transpose,
+            transpose_cache_.GetOrCreate(
+                primitive_util::ByteWidth(type), dims, permutation,
+                TransposePlan::Striding{*byte_strides},
+                /*output_tiling=*/TransposePlan::Tiling{},
+                TransposePlan::Transformation::kNone,
+                /*num_threads=*/
+                is_small ? 1 : pjrt_client_thread_pool()->NumThreads()));
       }
-      transpose->Execute(data, dst_data_ptr);
-      if (on_done_with_host_buffer) {
-        on_done_with_host_buffer();
-        on_done_with_host_buffer = nullptr;
+      bool should_sync_transpose =
+          host_buffer_semantics ==
+              HostBufferSemantics::kImmutableOnlyDuringCall ||
+          is_small;
+      if (should_sync_transpose) {
+        transpose->Execute(data, dst_data_ptr,
+                           [pool = pjrt_client_thread_pool()](
+                               std::function<void()> fn) {
+                             pool->Schedule(std::move(fn));
+                           });
+        if (on_done_with_host_buffer) {
+          on_done_with_host_buffer();
+          on_done_with_host_buffer = nullptr;
+        }
+      } else {
+        tfrt::AsyncValueRef<CpuEvent> transpose_event =
+            tfrt::MakeConstructedAsyncValueRef<CpuEvent>();
+        definition_events.push_back(transpose_event.CopyRef());
+        // Every partition runs as its own task, and whichever finishes last
+        // releases the host buffer and signals the definition event, so no
+        // pool thread blocks waiting for the others.
+        struct TransposeState {
+          std::shared_ptr<TransposePlan> transpose;
+          std::shared_ptr<MaybeOwningCpuMemory> device_buffer;
+          tfrt::AsyncValueRef<CpuEvent> transpose_event;
+          std::function<void()> on_done_with_host_buffer;
+          std::atomic<int> partitions_remaining;
+        };
+        auto state = std::make_shared<TransposeState>();
+        state->transpose = std::move(transpose);
+        state->device_buffer = std::move(device_buffer);
+        state->transpose_event = std::move(transpose_event);
+        state->on_done_with_host_buffer = std::move(on_done_with_host_buffer);
+        const int parallelism = state->transpose->Parallelism();
+        state->partitions_remaining.store(parallelism);
+        for (int partition = 0; partition < parallelism; ++partition) {
+          EnqueueWork(pjrt_client_thread_pool(), [state, partition, data,
+                                                  dst_data_ptr]() {
+            tsl::profiler::TraceMe traceme("H2D Transpose");
+            state->transpose->ExecutePartition(data, dst_data_ptr, partition);
+            if (state->partitions_remaining.fetch_sub(1) == 1) {
+              if (state->on_done_with_host_buffer) {
+                state->on_done_with_host_buffer();
+                state->on_done_with_host_buffer = nullptr;
+              }
+              // Signal transpose is complete.
+              state->transpose_event.SetStateConcrete();
+            }
+          });
+        }
       }
     } else {
       bool should_sync_copy =
@@ -764,6 +1132,228 @@ StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuClient::BufferFromHostLiteral(
   return std::unique_ptr<PjRtBuffer>(std::move(output_buffer));
 }
 
+// Returns the number of bytes spanned by one index of the dimension obtained
+// by combining `dimensions` of `shape`, and the size of that combined
+// dimension. `dimensions` must be the major dimensions of the shape's layout,
+// in major-to-minor order.
+static StatusOr<std::pair<int64_t, int64_t>> CombinedMajorDimension(
+    const Shape& shape, absl::Span<const int> dimensions) {
+  const Shape shape_with_layout = LayoutUtil::HasLayout(shape)
+                                      ? shape
+                                      : LayoutUtil::GetWithDefaultLayout(shape);
+  auto minor_to_major = shape_with_layout.layout().minor_to_major();
+  if (dimensions.empty() || dimensions.size() > minor_to_major.size()) {
+    return InvalidArgument("Invalid dimensions {%s} for shape %s",
+                           absl::StrJoin(dimensions, ","),
+                           ShapeUtil::HumanStringWithLayout(shape_with_layout));
+  }
+  int64_t combined_size = 1;
+  for (int i = 0; i < dimensions.size(); ++i) {
+    if (dimensions[i] != minor_to_major[minor_to_major.size() - 1 - i]) {
+      return InvalidArgument(
+          "Dimensions {%s} are not the major dimensions of shape %s",
+          absl::StrJoin(dimensions, ","),
+          ShapeUtil::HumanStringWithLayout(shape_with_layout));
+    }
+    combined_size *= shape.dimensions(dimensions[i]);
+  }
+  int64_t index_byte_size =
+      combined_size == 0 ? 0 : ShapeUtil::ByteSizeOf(shape) / combined_size;
+  return std::make_pair(index_byte_size, combined_size);
+}
+
+namespace {
+
+// Tracks the receives of one MakeCrossHostReceiveBuffers call. None of the
+// buffers becomes ready before every receive has completed, and each buffer
+// then fails with the first error of its own receives.
+class CrossHostReceiveGroup {
+ public:
+  CrossHostReceiveGroup(int num_buffers, int num_receives)
+      : remaining_(num_receives), statuses_(num_buffers) {
+    definition_events_.reserve(num_buffers);
+    for (int i = 0; i < num_buffers; ++i) {
+      definition_events_.push_back(
+          tfrt::MakeConstructedAsyncValueRef<CpuEvent>());
+    }
+    if (num_receives == 0) {
+      done_ = true;
+      SetDefinitionEvents(std::move(statuses_));
+    }
+  }
+
+  tfrt::AsyncValueRef<CpuEvent> definition_event(int buffer_index) const {
+    return definition_events_[buffer_index].CopyRef();
+  }
+
+  void ReceiveDone(int buffer_index, Status status) {
+    std::vector<Status> statuses;
+    {
+      absl::MutexLock lock(&mu_);
+      if (done_) return;
+      if (statuses_[buffer_index].ok()) {
+        statuses_[buffer_index] = std::move(status);
+      }
+      if (--remaining_ > 0) return;
+      done_ = true;
+      statuses = std::move(statuses_);
+    }
+    SetDefinitionEvents(std::move(statuses));
+  }
+
+  // Fails every buffer with `status` without waiting for the outstanding
+  // receives, whose completions are ignored from then on. Does nothing if the
+  // buffers are already defined, e.g. because there were no receives.
+  void Fail(const Status& status) {
+    {
+      absl::MutexLock lock(&mu_);
+      if (done_) return;
+      done_ = true;
+    }
+    for (auto& event : definition_events_) event.SetError(status);
+  }
+
+ private:
+  void SetDefinitionEvents(std::vector<Status> statuses) {
+    for (int i = 0; i < definition_events_.size(); ++i) {
+      if (statuses[i].ok()) {
+        definition_events_[i].SetStateConcrete();
+      } else {
+        definition_events_[i].SetError(statuses[i]);
+      }
+    }
+  }
+
+  std::vector<tfrt::AsyncValueRef<CpuEvent>> definition_events_;
+
+  absl::Mutex mu_;
+  int remaining_ ABSL_GUARDED_BY(mu_);
+  std::vector<Status> statuses_ ABSL_GUARDED_BY(mu_);
+  // Whether the definition events are set, or about to be.
+  bool done_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace
+
+StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+TfrtCpuClient::MakeCrossHostReceiveBuffers(absl::Span<const Shape> shapes,
+                                           PjRtDevice* device,
+                                           PjRtCrossHostRecvNotifier notifier) {
+  return MakeCrossHostReceiveBuffersImpl(
+      shapes, /*gather_details=*/nullptr, device, std::move(notifier));
+}
+
+StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+TfrtCpuClient::MakeCrossHostReceiveBuffersForGather(
+    absl::Span<const Shape> shapes, std::vector<GatherDetails> gather_details,
+    PjRtDevice* device, PjRtCrossHostRecvNotifier notifier) {
+  return MakeCrossHostReceiveBuffersImpl(shapes, &gather_details, device,
+                                         std::move(notifier));
+}
+
+StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+TfrtCpuClient::MakeCrossHostReceiveBuffersImpl(
+    absl::Span<const Shape> shapes,
+    const std::vector<GatherDetails>* gather_details, PjRtDevice* device,
+    PjRtCrossHostRecvNotifier notifier) {
+  tsl::profiler::TraceMe traceme("TfrtCpuClient::MakeCrossHostReceiveBuffers");
+  if (cross_host_transport_ == nullptr) {
+    return Unimplemented(
+        "MakeCrossHostReceiveBuffers requires a TfrtCpuClient created with a "
+        "CpuCrossHostTransport.");
+  }
+  if (gather_details != nullptr && gather_details->size() != shapes.size()) {
+    return InvalidArgument("Got %d gather details for %d shapes",
+                           gather_details->size(), shapes.size());
+  }
+
+  // The byte ranges in which each buffer is received.
+  std::vector<absl::InlinedVector<CpuCrossHostTransport::ByteRange, 1>> ranges(
+      shapes.size());
+  int num_receives = 0;
+  for (int i = 0; i < shapes.size(); ++i) {
+    if (shapes[i].IsTuple()) {
+      return Unimplemented(
+          "MakeCrossHostReceiveBuffers not implemented for tuples");
+    }
+    int64_t byte_size = ShapeUtil::ByteSizeOf(shapes[i]);
+    if (gather_details == nullptr) {
+      ranges[i].push_back({/*offset=*/0, /*size=*/byte_size});
+    } else {
+      const GatherDetails& details = (*gather_details)[i];
+      TF_ASSIGN_OR_RETURN(
+          auto combined_dimension,
+          CombinedMajorDimension(shapes[i], details.dimensions));
+      const auto [index_byte_size, combined_size] = combined_dimension;
+      int64_t start = 0;
+      for (int64_t boundary : details.slice_boundaries) {
+        if (boundary < start || boundary > combined_size) {
+          return InvalidArgument(
+              "Invalid gather slice boundaries {%s} for a combined dimension "
+              "of size %d",
+              absl::StrJoin(details.slice_boundaries, ","), combined_size);
+        }
+        ranges[i].push_back({/*offset=*/start * index_byte_size,
+                             /*size=*/(boundary - start) * index_byte_size});
+        start = boundary;
+      }
+    }
+    num_receives += ranges[i].size();
+  }
+
+  auto group =
+      std::make_shared<CrossHostReceiveGroup>(shapes.size(), num_receives);
+  auto* cpu_device = tensorflow::down_cast<TfrtCpuDevice*>(device);
+  std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+  buffers.reserve(shapes.size());
+  PjRtCrossHostRecvState state;
+  state.descriptors.reserve(shapes.size());
+  for (int i = 0; i < shapes.size(); ++i) {
+    // Senders write straight into the memory of the returned buffers.
+    StatusOr<CpuCrossHostTransport::Receive> receive =
+        cross_host_transport_->PrepareReceive(
+            ShapeUtil::ByteSizeOf(shapes[i]), ranges[i],
+            [group, i](int /*range_index*/, Status status) {
+              group->ReceiveDone(i, std::move(status));
+            });
+    if (!receive.ok()) {
+      group->Fail(receive.status());
+      for (const PjRtCrossHostRecvDescriptors& prepared : state.descriptors) {
+        for (const std::string& descriptor : prepared.serialized_descriptors) {
+          cross_host_transport_->CancelReceive(descriptor, receive.status())
+              .IgnoreError();
+        }
+      }
+      return receive.status();
+    }
+    absl::InlinedVector<std::shared_ptr<MaybeOwningCpuMemory>, 4> memory = {
+        std::move(receive->memory)};
+    buffers.push_back(std::make_unique<TfrtCpuBuffer>(
+        shapes[i],
+        std::make_unique<TrackedTfrtCpuDeviceBuffer>(
+            /*is_tuple=*/false, std::move(memory), group->definition_event(i)),
+        this, cpu_device));
+    PjRtCrossHostRecvDescriptors descriptors;
+    descriptors.serialized_descriptors =
+        std::move(receive->serialized_descriptors);
+    state.descriptors.push_back(std::move(descriptors));
+  }
+
+  CpuCrossHostTransport* transport = cross_host_transport_.get();
+  state.cancel_notifier = [transport](absl::string_view serialized_descriptor,
+                                      Status reason,
+                                      std::function<void(Status)> on_canceled) {
+    on_canceled(transport->CancelReceive(serialized_descriptor,
+                                         std::move(reason)));
+  };
+  EnqueueWork(pjrt_client_thread_pool(),
+              [notifier = std::move(notifier),
+               state = std::move(state)]() mutable {
+                notifier(std::move(state));
+              });
+  return std::move(buffers);
+}
+
 TfrtCpuBuffer::TfrtCpuBuffer(
     Shape on_device_shape,
     std::unique_ptr<TrackedTfrtCpuDeviceBuffer> tracked_device_buffer,
@@ -895,7 +1485,7 @@ std::unique_ptr<TrackedTfrtCpuDeviceBuffer>
 TfrtCpuBuffer::ReleaseBufferLocked() {
   absl::MutexLock lock(&mu_);
   auto condition = [this]() ABSL_SHARED_LOCKS_REQUIRED(mu_) {
-    return !pending_donation_;
+    return !pending_donation_ && inline_usage_count_ == 0;
   };
   mu_.Await(absl::Condition(&condition));
   return std::move(tracked_device_buffer_);
@@ -941,8 +1531,29 @@ TrackedTfrtCpuDeviceBuffer* TfrtCpuBuffer::AcquireUsage(
   return tracked_device_buffer_.get();
 }
 
+TrackedTfrtCpuDeviceBuffer* TfrtCpuBuffer::AcquireInlineUsage() {
+  absl::MutexLock lock(&mu_);
+  if (!tracked_device_buffer_) {
+    return nullptr;
+  }
+
+  ++inline_usage_count_;
+  return tracked_device_buffer_.get();
+}
+
+void TfrtCpuBuffer::DropInlineUsage() {
+  absl::MutexLock lock(&mu_);
+  CHECK_GT(inline_usage_count_, 0);
+  --inline_usage_count_;
+}
+
 StatusOr<TfrtCpuBuffer::DonationTransaction> TfrtCpuBuffer::AcquireDonation() {
   absl::MutexLock lock(&mu_);
+  // Inline usages have no usage event the donation could be serialized after.
+  auto no_inline_usage = [this]() ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+    return inline_usage_count_ == 0;
+  };
+  mu_.Await(absl::Condition(&no_inline_usage));
 
   if (tracked_device_buffer_ == nullptr) {
     return InvalidArgument("Donation requested for invalid buffer");
@@ -1163,8 +1774,10 @@ StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuBuffer::CopyToDevice(
 
   for (int i = 0; i < num_leaf_buffers; ++i) {
     auto src_buffer = src_device_buffer->Buffers()[i];
-    TF_ASSIGN_OR_RETURN(auto dst_buffer, MaybeOwningCpuMemory::AllocateShared(
-                                             src_buffer->size()));
+    TF_ASSIGN_OR_RETURN(auto dst_buffer,
+                        tensorflow::down_cast<TfrtCpuDevice*>(dst_device)
+                            ->allocator()
+                            .Allocate(src_buffer->size()));
     src_buffers.push_back(std::move(src_buffer));
     dst_buffers.push_back(std::move(dst_buffer));
     dst_definition_events.push_back(
@@ -1210,6 +1823,237 @@ StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuBuffer::CopyToDevice(
       client(), tensorflow::down_cast<TfrtCpuDevice*>(dst_device)));
 }
 
+PjRtFuture<Status> TfrtCpuBuffer::CopyRawToHost(void* dst, int64_t offset,
+                                                int64_t transfer_size) {
+  tsl::profiler::TraceMe traceme("TfrtCpuBuffer::CopyRawToHost");
+  if (on_device_shape().IsTuple()) {
+    return PjRtFuture<Status>(
+        Unimplemented("CopyRawToHost not implemented for tuples"));
+  }
+  int64_t buffer_size = ShapeUtil::ByteSizeOf(on_device_shape());
+  if (offset < 0 || transfer_size < 0 ||
+      offset + transfer_size > buffer_size) {
+    return PjRtFuture<Status>(InvalidArgument(
+        "CopyRawToHost of %d bytes at offset %d is out of bounds of a buffer "
+        "of %d bytes",
+        transfer_size, offset, buffer_size));
+  }
+  auto usage_event = tfrt::MakeConstructedAsyncValueRef<CpuEvent>();
+  auto* device_buffer = AcquireUsage(usage_event);
+  if (device_buffer == nullptr) {
+    return PjRtFuture<Status>(InvalidArgument(
+        "CopyRawToHost() called on deleted or donated buffer"));
+  }
+  MarkEventReadyOnExit ready_on_exit(std::move(usage_event));
+
+  // Copies straight out of the device buffer; holding the usage event keeps
+  // the memory alive until the copy is done.
+  const char* src =
+      static_cast<const char*>(device_buffer->Buffers()[0]->data()) + offset;
+  tfrt::AsyncValueRef<CpuEvent> definition_event =
+      device_buffer->definition_event().CopyRef();
+  if (definition_event.IsAvailable() &&
+      transfer_size < kSmallDataTransferByteSize) {
+    if (definition_event.IsError()) {
+      return PjRtFuture<Status>(
+          Internal("Error copying buffer to host: %s",
+                   definition_event.GetError().message()));
+    }
+    std::memcpy(dst, src, transfer_size);
+    return PjRtFuture<Status>(OkStatus());
+  }
+
+  auto ready_event = tfrt::MakeUnconstructedAsyncValueRef<Status>();
+  std::vector<tfrt::RCReference<tfrt::AsyncValue>> definition_avs = {
+      definition_event.CopyRCRef()};
+  EnqueueWorkWhenReady(
+      client()->pjrt_client_thread_pool(), definition_avs,
+      [definition_event = std::move(definition_event), dst, src,
+       transfer_size, ready_event = ready_event.CopyRef(),
+       ready_on_exit = std::move(ready_on_exit)]() mutable {
+        tsl::profiler::TraceMe traceme("D2H Dispatch");
+        if (definition_event.IsError()) {
+          ready_event.emplace(Internal("Error copying buffer to host: %s",
+                                       definition_event.GetError().message()));
+          return;
+        }
+        std::memcpy(dst, src, transfer_size);
+        ready_event.emplace(OkStatus());
+      });
+  return PjRtFuture<Status>(
+      std::move(ready_event),
+      /*on_block_start=*/
+      []() {
+        tsl::profiler::TraceMeProducer traceme("TfrtCpuBuffer::CopyRawToHost");
+        VLOG(1) << "TfrtCpuBuffer::CopyRawToHost";
+        return PjRtFutureHelpers::ProfilingKeys(
+            {/*traceme_context_id =*/traceme.GetContextId()});
+      },
+      /*on_block_end=*/
+      [](PjRtFutureHelpers::ProfilingKeys keys) {
+        tsl::profiler::TraceMeConsumer traceme("TfrtCpuBuffer::CopyRawToHost",
+                                               keys.traceme_context_id);
+      });
+}
+
+// Sends `byte_ranges[i]` of `data` to the i-th of `descriptors` through
+// `transport` once `definition_event` is available, and calls `callbacks[i]`
+// with the outcome. `usage_hold` keeps `data` alive until every send is done.
+static void SendToRemoteWhenReady(
+    CpuCrossHostTransport* transport, tsl::thread::ThreadPool* pool,
+    const char* data, tfrt::AsyncValueRef<CpuEvent> definition_event,
+    std::vector<CpuCrossHostTransport::ByteRange> byte_ranges,
+    StatusOr<std::vector<std::string>> descriptors,
+    std::vector<PjRtBuffer::RemoteSendCallback> callbacks,
+    MarkEventReadyOnExit usage_hold) {
+  if (descriptors.ok() && descriptors->size() != byte_ranges.size()) {
+    descriptors = InvalidArgument("Got %d descriptors for %d cross-host sends",
+                                  descriptors->size(), byte_ranges.size());
+  }
+  if (!descriptors.ok()) {
+    for (const auto& on_done : callbacks) {
+      on_done(descriptors.status(), /*sends_were_enqueued=*/false);
+    }
+    return;
+  }
+
+  std::vector<tfrt::RCReference<tfrt::AsyncValue>> definition_avs = {
+      definition_event.CopyRCRef()};
+  EnqueueWorkWhenReady(
+      pool, definition_avs,
+      [transport, data, definition_event = std::move(definition_event),
+       byte_ranges = std::move(byte_ranges),
+       descriptors = *std::move(descriptors),
+       callbacks = std::move(callbacks),
+       usage_hold = std::move(usage_hold)]() {
+        tsl::profiler::TraceMe traceme("CopyToRemoteDevice");
+        if (definition_event.IsError()) {
+          Status status =
+              Internal("Error sending buffer to remote device: %s",
+                       definition_event.GetError().message());
+          for (const auto& on_done : callbacks) {
+            on_done(status, /*sends_were_enqueued=*/false);
+          }
+          return;
+        }
+        for (int i = 0; i < byte_ranges.size(); ++i) {
+          Status status =
+              transport->Send(descriptors[i], data + byte_ranges[i].offset,
+                              byte_ranges[i].size);
+          callbacks[i](status, /*sends_were_enqueued=*/status.ok());
+        }
+      });
+}
+
+void TfrtCpuBuffer::CopyRangesToRemoteDevice(
+    PjRtFuture<StatusOr<std::vector<std::string>>> serialized_descriptors,
+    std::vector<CpuCrossHostTransport::ByteRange> byte_ranges,
+    std::vector<RemoteSendCallback> callbacks) {
+  auto fail = [&callbacks](const Status& status) {
+    for (const auto& on_done : callbacks) {
+      on_done(status, /*sends_were_enqueued=*/false);
+    }
+  };
+  if (client_->cross_host_transport() == nullptr) {
+    fail(Unimplemented(
+        "CopyToRemoteDevice requires a TfrtCpuClient created with a "
+        "CpuCrossHostTransport."));
+    return;
+  }
+  auto usage_event = tfrt::MakeConstructedAsyncValueRef<CpuEvent>();
+  auto* device_buffer = AcquireUsage(usage_event);
+  if (device_buffer == nullptr) {
+    fail(InvalidArgument(
+        "CopyToRemoteDevice() called on deleted or donated buffer"));
+    return;
+  }
+  MarkEventReadyOnExit usage_hold(std::move(usage_event));
+
+  // Sends straight out of the device buffer, which the usage hold keeps alive
+  // until the sends are done.
+  const char* data =
+      static_cast<const char*>(device_buffer->Buffers()[0]->data());
+  serialized_descriptors.OnReady(
+      [transport = client_->cross_host_transport(),
+       pool = client_->pjrt_client_thread_pool(), data,
+       definition_event = device_buffer->definition_event().CopyRef(),
+       byte_ranges = std::move(byte_ranges), callbacks = std::move(callbacks),
+       usage_hold = std::move(usage_hold)](
+          StatusOr<std::vector<std::string>> descriptors) mutable {
+        SendToRemoteWhenReady(transport, pool, data,
+                              std::move(definition_event),
+                              std::move(byte_ranges), std::move(descriptors),
+                              std::move(callbacks), std::move(usage_hold));
+      });
+}
+
+void TfrtCpuBuffer::CopyToRemoteDevice(
+    PjRtFuture<StatusOr<std::string>> serialized_descriptor,
+    RemoteSendCallback on_done) {
+  tsl::profiler::TraceMe traceme("TfrtCpuBuffer::CopyToRemoteDevice");
+  if (on_device_shape_.IsTuple()) {
+    on_done(Unimplemented("CopyToRemoteDevice not implemented for tuples"),
+            /*sends_were_enqueued=*/false);
+    return;
+  }
+  auto promise =
+      PjRtFuture<StatusOr<std::vector<std::string>>>::CreatePromise();
+  serialized_descriptor.OnReady(
+      [promise](StatusOr<std::string> descriptor) mutable {
+        if (!descriptor.ok()) {
+          promise.Set(descriptor.status());
+        } else {
+          promise.Set(std::vector<std::string>{*std::move(descriptor)});
+        }
+      });
+  std::vector<RemoteSendCallback> callbacks = {std::move(on_done)};
+  CopyRangesToRemoteDevice(
+      PjRtFuture<StatusOr<std::vector<std::string>>>(std::move(promise)),
+      {{/*offset=*/0, /*size=*/ShapeUtil::ByteSizeOf(on_device_shape_)}},
+      std::move(callbacks));
+}
+
+void TfrtCpuBuffer::CopyToRemoteDeviceScattered(
+    PjRtFuture<StatusOr<std::vector<std::string>>> serialized_descriptors,
+    std::vector<RemoteSendCallback> callbacks,
+    const xla::PjRtBuffer::ScatterDetails& scatter_details) {
+  tsl::profiler::TraceMe traceme("TfrtCpuBuffer::CopyToRemoteDeviceScattered");
+  std::vector<CpuCrossHostTransport::ByteRange> byte_ranges;
+  Status status;
+  if (on_device_shape_.IsTuple()) {
+    status = Unimplemented(
+        "CopyToRemoteDeviceScattered not implemented for tuples");
+  } else if (callbacks.size() != scatter_details.slices.size()) {
+    status = InvalidArgument("Got %d callbacks for %d scattered slices",
+                             callbacks.size(), scatter_details.slices.size());
+  } else {
+    StatusOr<std::pair<int64_t, int64_t>> combined_dimension =
+        CombinedMajorDimension(on_device_shape_, scatter_details.dimensions);
+    status = combined_dimension.status();
+    for (int i = 0; status.ok() && i < scatter_details.slices.size(); ++i) {
+      const auto [index_byte_size, combined_size] = *combined_dimension;
+      const auto [start, end] = scatter_details.slices[i];
+      if (start < 0 || end < start || end > combined_size) {
+        status = InvalidArgument(
+            "Scatter slice [%d, %d) is out of bounds of a combined dimension "
+            "of size %d",
+            start, end, combined_size);
+      } else {
+        byte_ranges.push_back({/*offset=*/start * index_byte_size,
+                               /*size=*/(end - start) * index_byte_size});
+      }
+    }
+  }
+  if (!status.ok()) {
+    for (const auto& on_done : callbacks) {
+      on_done(status, /*sends_were_enqueued=*/false);
+    }
+    return;
+  }
+  CopyRangesToRemoteDevice(std::move(serialized_descriptors),
+                           std::move(byte_ranges), std::move(callbacks));
+}
+
 PjRtFuture<Status> TfrtCpuBuffer::GetReadyFuture() {
   tfrt::AsyncValueRef<CpuEvent> definition_event;
   {
@@ -1261,6 +2105,28 @@ PjRtFuture<Status> TfrtCpuBuffer::GetReadyFuture() {
   }
 }
 
+// Returns whether running `module` may call back into host code other than
+// the compiled computation itself.
+static bool RunsHostCode(const HloModule& module) {
+  for (const HloComputation* computation : module.computations()) {
+    for (const HloInstruction* instruction : computation->instructions()) {
+      switch (instruction->opcode()) {
+        case HloOpcode::kCustomCall:
+        case HloOpcode::kInfeed:
+        case HloOpcode::kOutfeed:
+        case HloOpcode::kRecv:
+        case HloOpcode::kRecvDone:
+        case HloOpcode::kSend:
+        case HloOpcode::kSendDone:
+          return true;
+        default:
+          break;
+      }
+    }
+  }
+  return false;
+}
+
 TfrtCpuExecutable::TfrtCpuExecutable(
     int num_replicas, int num_partitions,
     std::shared_ptr<DeviceAssignment> device_assignment,
@@ -1287,7 +2153,10 @@ TfrtCpuExecutable::TfrtCpuExecutable(
   // The magic constant 1000 is determined by correlating computation with flop
   // estimate. It is a crude heuristic to find computation less than the thread
   // context switch time (~5us).
+  CHECK_OK(cpu_executable_->module().entry_computation()->Accept(
+      hlo_cost_analysis.get()));
   cheap_computation_ = hlo_cost_analysis->flop_count() < 1000;
+  execute_without_events_ = !RunsHostCode(cpu_executable_->module());
 
   const auto& computation_layout =
       cpu_executable_->module().entry_computation_layout();
@@ -1333,7 +2202,8 @@ Status TfrtCpuExecutable::SetUpDonation(bool tuple_inputs) {
 // and assemble the buffer pointers in order to call into CpuExecutable.
 static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
     const BufferAllocation& allocation,
-    absl::Span<std::pair<bool, TrackedTfrtCpuDeviceBuffer*> const> arguments) {
+    absl::Span<std::pair<bool, TrackedTfrtCpuDeviceBuffer*> const> arguments,
+    const cpu::BufferTableArena::Slab* slab, TrackingCpuAllocator& allocator) {
   if (allocation.is_entry_computation_parameter()) {
     auto [can_donate, arg] = arguments[allocation.parameter_number()];
     std::shared_ptr<MaybeOwningCpuMemory> out =
@@ -1346,21 +2216,27 @@ static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
     // example we might be pointing to a buffer owned by the client whose
     // lifetime will not extend past the lifetime of the donated input buffer.
     if ((!can_donate || !out->owns_data()) && !allocation.is_readonly()) {
-      TF_ASSIGN_OR_RETURN(
-          auto copy, MaybeOwningCpuMemory::AllocateShared(allocation.size()));
+      TF_ASSIGN_OR_RETURN(auto copy, allocator.Allocate(allocation.size()));
       std::memcpy(copy->data(), out->data(), allocation.size());
       return copy;
     }
     return out;
-  } else if (allocation.is_constant()) {
-    return std::make_shared<MaybeOwningCpuMemory>();
-  } else if (allocation.is_thread_local()) {
-    return std::make_shared<MaybeOwningCpuMemory>();
+  } else if (allocation.is_constant() || allocation.is_thread_local()) {
+    // Constants and thread-local buffers live outside the buffer table, so
+    // every run shares one empty entry for them.
+    static const auto* const empty_memory =
+        new std::shared_ptr<MaybeOwningCpuMemory>(
+            std::make_shared<MaybeOwningCpuMemory>());
+    return *empty_memory;
+  }
+
+  if (slab != nullptr && allocation.IsPreallocatedTempBuffer()) {
+    return std::make_shared<MaybeOwningCpuMemory>(
+        slab->Get(allocation.index()), allocation.size());
   }
 
   // Output and temporary buffer.
-  TF_ASSIGN_OR_RETURN(auto out,
-                      MaybeOwningCpuMemory::AllocateShared(allocation.size()));
+  TF_ASSIGN_OR_RETURN(auto out, allocator.Allocate(allocation.size()));
 
   // Since the output buffer and all the temporary buffers were written into
   // by the JITed code, msan has no way of knowing their memory was
@@ -1370,18 +2246,22 @@ static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
   return out;
 }
 
-static StatusOr<std::vector<std::shared_ptr<MaybeOwningCpuMemory>>>
-CreateBufferTable(
+// Fills `buffers` with the memory of each allocation of `assignment`. If
+// `slab` is not null, temporary buffers are carved out of it instead of being
+// allocated one by one from `allocator`.
+static Status CreateBufferTable(
     const BufferAssignment& assignment,
-    absl::Span<std::pair<bool, TrackedTfrtCpuDeviceBuffer*> const> arguments) {
-  std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffers(
-      assignment.Allocations().size());
+    absl::Span<std::pair<bool, TrackedTfrtCpuDeviceBuffer*> const> arguments,
+    const cpu::BufferTableArena::Slab* slab, TrackingCpuAllocator& allocator,
+    std::vector<std::shared_ptr<MaybeOwningCpuMemory>>& buffers) {
+  buffers.resize(assignment.Allocations().size());
   for (BufferAllocation::Index i = 0; i < assignment.Allocations().size();
        ++i) {
     const BufferAllocation& allocation = assignment.GetAllocation(i);
-    TF_ASSIGN_OR_RETURN(buffers[i], MemoryForAllocation(allocation, arguments));
+    TF_ASSIGN_OR_RETURN(buffers[i], MemoryForAllocation(allocation, arguments,
+                                                        slab, allocator));
   }
-  return std::move(buffers);
+  return OkStatus();
 }
 
 static absl::InlinedVector<std::shared_ptr<MaybeOwningCpuMemory>, 4>
@@ -1429,43 +2309,288 @@ static std::vector<xla::cpu::BufferDesc> MakeXLARuntimeDescriptorTable(
   return descriptor_table;
 }
 
-StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
-    absl::Span<PjRtBuffer* const> argument_handles, int replica, int partition,
-    const RunId& run_id, const ExecuteOptions& options,
-    tfrt::AsyncValueRef<CpuEvent> last_collective_launch_event,
-    bool fill_future, TfrtCpuDevice* device) {
-  tsl::profiler::TraceMe traceme("TfrtCpuExecutable::ExecuteHelper");
+// Returns an event that is always ready. Inline executions use it as the
+// definition event of their results, which are complete by the time the
+// results are handed out.
+static const tfrt::AsyncValueRef<CpuEvent>& ReadyCpuEvent() {
+  static const auto* const ready_event = new tfrt::AsyncValueRef<CpuEvent>(
+      tfrt::MakeAvailableAsyncValueRef<CpuEvent>());
+  return *ready_event;
+}
 
-  std::shared_ptr<DeviceAssignment> device_assignment;
+std::unique_ptr<TfrtCpuExecutable::InlineBufferTable>
+TfrtCpuExecutable::AcquireInlineBufferTable(TfrtCpuDevice* device) {
+  {
+    absl::MutexLock lock(&inline_buffer_tables_mu_);
+    // Temporary buffers are accounted to the allocator of the device they
+    // were allocated for, so tables are only reused on the same device.
+    auto it = absl::c_find_if(
+        inline_buffer_tables_,
+        [&](const std::unique_ptr<InlineBufferTable>& table) {
+          return table->device == device;
+        });
+    if (it != inline_buffer_tables_.end()) {
+      std::unique_ptr<InlineBufferTable> table = std::move(*it);
+      *it = std::move(inline_buffer_tables_.back());
+      inline_buffer_tables_.pop_back();
+      return table;
+    }
+  }
+  auto table = std::make_unique<InlineBufferTable>();
+  table->device = device;
+  auto* cpu_executable =
+      tensorflow::down_cast<cpu::CpuExecutable*>(cpu_executable_.get());
+  const int num_allocations =
+      cpu_executable->buffer_assignment().Allocations().size();
+  table->buffers.resize(num_allocations);
+  table->buffer_pointers.resize(num_allocations);
+  return table;
+}
+
+void TfrtCpuExecutable::ReleaseInlineBufferTable(
+    std::unique_ptr<InlineBufferTable> table) {
+  const BufferAssignment& assignment =
+      tensorflow::down_cast<cpu::CpuExecutable*>(cpu_executable_.get())
+          ->buffer_assignment();
+  // Drop the references to arguments and results so that the table does not
+  // keep them alive.
+  for (BufferAllocation::Index i = 0; i < table->buffers.size(); ++i) {
+    if (!assignment.GetAllocation(i).IsPreallocatedTempBuffer()) {
+      table->buffers[i].reset();
+    }
+  }
+  absl::MutexLock lock(&inline_buffer_tables_mu_);
+  inline_buffer_tables_.push_back(std::move(table));
+}
+
+StatusOr<std::optional<PjRtLoadedExecutable::Result>>
+TfrtCpuExecutable::ExecuteInline(
+    const ExecutePlan& plan, absl::Span<PjRtBuffer* const> argument_handles,
+    const RunId& run_id, const ExecuteOptions& options, bool fill_future) {
+  tsl::profiler::TraceMe traceme("TfrtCpuExecutable::ExecuteInline");
+  TfrtCpuDevice* device = plan.device;
+
+  absl::InlinedVector<TfrtCpuBuffer*, 4> held_buffers;
+  held_buffers.reserve(argument_handles.size());
+  auto drop_inline_usages = absl::MakeCleanup([&held_buffers]() {
+    for (TfrtCpuBuffer* buffer : held_buffers) {
+      buffer->DropInlineUsage();
+    }
+  });
+
+  absl::InlinedVector<std::pair<bool, TrackedTfrtCpuDeviceBuffer*>, 4>
+      tracked_buffers;
+  tracked_buffers.reserve(argument_handles.size());
+  for (int i = 0; i < argument_handles.size(); ++i) {
+    auto* tfrt_buffer =
+        tensorflow::down_cast<TfrtCpuBuffer*>(argument_handles[i]);
+    if (!plan.arguments_on_device && tfrt_buffer->device() != device) {
+      return InvalidArgument(
+          "Buffer passed to Execute() as argument %d to replica %d is on "
+          "device %s, but replica is assigned to device %s.",
+          i, plan.replica, tfrt_buffer->device()->DebugString(),
+          device->DebugString());
+    }
+    TrackedTfrtCpuDeviceBuffer* tracked_buffer =
+        tfrt_buffer->AcquireInlineUsage();
+    if (!tracked_buffer) {
+      return InvalidArgument(
+          "Invalid buffer passed: buffer has been deleted or donated.");
+    }
+    held_buffers.push_back(tfrt_buffer);
+    // Arguments that are still being written, or whose producer failed, are
+    // left to the regular path to wait on or to report.
+    if (!tracked_buffer->definition_event().IsConcrete()) {
+      return std::optional<Result>();
+    }
+    tracked_buffers.emplace_back(/*can_donate=*/false, tracked_buffer);
+  }
+
+  TF_RETURN_IF_ERROR(CheckBufferCompatibilities(tracked_buffers));
+
+  std::unique_ptr<TrackedTfrtCpuDeviceBuffer> tuplized_arg;
+  if (parameter_is_tupled_arguments_ && !options.arguments_are_tupled) {
+    absl::InlinedVector<std::shared_ptr<MaybeOwningCpuMemory>, 4> leaf_buffers;
+    leaf_buffers.reserve(tracked_buffers.size());
+    for (const auto& tracked_buffer : tracked_buffers) {
+      auto span = tracked_buffer.second->Buffers();
+      leaf_buffers.insert(leaf_buffers.end(), span.begin(), span.end());
+    }
+    tracked_buffers.clear();
+    tuplized_arg = std::make_unique<TrackedTfrtCpuDeviceBuffer>(
+        /*is_tuple=*/true, std::move(leaf_buffers),
+        /*definition_event=*/ReadyCpuEvent());
+    tracked_buffers.emplace_back(false, tuplized_arg.get());
+  }
+
+  auto* cpu_executable =
+      tensorflow::down_cast<cpu::CpuExecutable*>(cpu_executable_.get());
+  const BufferAssignment& assignment = cpu_executable->buffer_assignment();
+  std::unique_ptr<InlineBufferTable> table = AcquireInlineBufferTable(device);
+  auto release_table = absl::MakeCleanup([this, &table]() {
+    ReleaseInlineBufferTable(std::move(table));
+  });
+  for (BufferAllocation::Index i = 0; i < table->buffers.size(); ++i) {
+    if (table->buffers[i] != nullptr) {
+      // Temporary buffer left over from an earlier run.
+      continue;
+    }
+    TF_ASSIGN_OR_RETURN(
+        table->buffers[i],
+        MemoryForAllocation(assignment.GetAllocation(i), tracked_buffers,
+                            /*slab=*/nullptr, device->allocator()));
+    table->buffer_pointers[i] = table->buffers[i]->data();
+  }
+
+  ExecutableRunOptions run_options;
+  run_options.set_run_id(run_id);
+  run_options.set_device_ordinal(device->local_hardware_id());
+  run_options.set_device_assignment(plan.device_assignment.get());
+  run_options.set_intra_op_thread_pool(client_->eigen_intraop_device());
+
+  {
+    // Set denormal and rounding behavior to match the default TF
+    // ThreadPool behavior.
+    tsl::port::ScopedFlushDenormal flush;
+    tsl::port::ScopedSetRound round(FE_TONEAREST);
+
+    if (cpu_executable->IsXlaRuntime()) {
+      TF_RETURN_IF_ERROR(cpu_executable->ExecuteXlaRuntime(
+          MakeXLARuntimeDescriptorTable(table->buffers), &run_options));
+    } else {
+      XlaCustomCallStatus status;
+      cpu_executable->compute_function()(
+          table->buffer_pointers[result_buffer_index_], &run_options, nullptr,
+          table->buffer_pointers.data(), &status, nullptr);
+      std::optional<absl::string_view> error_message =
+          xla::CustomCallStatusGetMessage(&status);
+      if (error_message) {
+        return InternalError("Generated function failed: %s", *error_message);
+      }
+    }
+  }
+
+  auto result_buffers =
+      CreateResultShapedBuffer(result_buffer_indices_, table->buffers);
+  const Shape& result_shape = cpu_executable_->result_shape();
+  std::vector<std::unique_ptr<PjRtBuffer>> res;
+  if (options.untuple_result && result_shape.IsTuple()) {
+    res.reserve(result_buffers.size());
+    for (int i = 0; i < result_buffers.size(); ++i) {
+      absl::InlinedVector<std::shared_ptr<MaybeOwningCpuMemory>, 4> sub_buffer;
+      sub_buffer.push_back(std::move(result_buffers[i]));
+      auto leaf_tracked_device_buffer =
+          std::make_unique<TrackedTfrtCpuDeviceBuffer>(
+              /*is_tuple=*/false, std::move(sub_buffer),
+              /*definition_event=*/ReadyCpuEvent());
+      res.push_back(std::make_unique<TfrtCpuBuffer>(
+          result_shape.tuple_shapes(i), std::move(leaf_tracked_device_buffer),
+          client_, device));
+    }
+  } else {
+    auto tracked_device_buffer = std::make_unique<TrackedTfrtCpuDeviceBuffer>(
+        /*is_tuple=*/result_shape.IsTuple(), std::move(result_buffers),
+        /*definition_event=*/ReadyCpuEvent());
+    res.push_back(std::make_unique<TfrtCpuBuffer>(
+        result_shape, std::move(tracked_device_buffer), client_, device));
+  }
+  std::optional<PjRtFuture<Status>> future;
+  if (fill_future) {
+    future = PjRtFuture<Status>(OkStatus());
+  }
+  return std::optional<Result>(
+      Result({/*future=*/std::move(future), /*buffers=*/std::move(res)}));
+}
+
+StatusOr<TfrtCpuExecutable::ExecutePlan> TfrtCpuExecutable::PrepareExecute(
+    int num_arguments, int replica, int partition,
+    const ExecuteOptions& options, TfrtCpuDevice* device) const {
+  ExecutePlan plan;
+  plan.replica = replica;
   if (device == nullptr) {
     CHECK(device_assignment_ != nullptr);
     const int device_id = (*device_assignment_)(replica, partition);
     TF_ASSIGN_OR_RETURN(PjRtDevice * pjrt_device,
                         client_->LookupDevice(device_id));
-    device = tensorflow::down_cast<TfrtCpuDevice*>(pjrt_device);
-    device_assignment = device_assignment_;
+    plan.device = tensorflow::down_cast<TfrtCpuDevice*>(pjrt_device);
+    plan.device_assignment = device_assignment_;
   } else {
     CHECK(device_assignment_ == nullptr);
     CHECK_EQ(replica, 0);
     CHECK_EQ(partition, 0);
     CHECK(addressable_devices_.empty());
-    device_assignment = std::make_shared<DeviceAssignment>(1, 1);
-    (*device_assignment)(0, 0) = device->id();
+    plan.device = device;
+    plan.device_assignment = std::make_shared<DeviceAssignment>(1, 1);
+    (*plan.device_assignment)(0, 0) = device->id();
   }
-  CHECK_EQ(device->process_index(), client_->process_index());
+  CHECK_EQ(plan.device->process_index(), client_->process_index());
 
-  // Handle inputs.
   if (options.arguments_are_tupled) {
     if (!parameter_is_tupled_arguments_) {
       return InvalidArgument(
           "Arguments may only be supplied as a tuple when the executable was "
           "compiled with a single tupled parameter");
     }
-    if (argument_handles.size() != 1) {
+    if (num_arguments != 1) {
       return InvalidArgument(
           "Option arguments_are_tupled was true but %d buffers were passed to "
           "execution",
-          argument_handles.size());
+          num_arguments);
+    }
+  }
+
+  plan.execute_inline = cheap_computation_;
+  // Overwrite `execute_inline` if it is specified in the ExecuteOptions.
+  if (options.execution_mode == ExecuteOptions::ExecutionMode::kAsynchronous) {
+    plan.execute_inline = false;
+  } else if (options.execution_mode ==
+             ExecuteOptions::ExecutionMode::kSynchronous) {
+    plan.execute_inline = true;
+  }
+
+  plan.must_donate.assign(num_arguments, false);
+  for (int parameter : parameters_that_must_be_donated_) {
+    if (parameter < num_arguments) {
+      plan.must_donate[parameter] = true;
+    }
+  }
+  return plan;
+}
+
+StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
+    absl::Span<PjRtBuffer* const> argument_handles, int replica, int partition,
+    const RunId& run_id, const ExecuteOptions& options,
+    tfrt::AsyncValueRef<CpuEvent> last_collective_launch_event,
+    bool fill_future, TfrtCpuDevice* device) {
+  tsl::profiler::TraceMe traceme("TfrtCpuExecutable::ExecuteHelper");
+  TF_ASSIGN_OR_RETURN(ExecutePlan plan,
+                      PrepareExecute(argument_handles.size(), replica,
+                                     partition, options, device));
+  return DispatchExecute(plan, argument_handles, run_id, options,
+                         std::move(last_collective_launch_event), fill_future);
+}
+
+StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::DispatchExecute(
+    const ExecutePlan& plan, absl::Span<PjRtBuffer* const> argument_handles,
+    const RunId& run_id, const ExecuteOptions& options,
+    tfrt::AsyncValueRef<CpuEvent> last_collective_launch_event,
+    bool fill_future) {
+  DCHECK_EQ(plan.must_donate.size(), argument_handles.size());
+  TfrtCpuDevice* device = plan.device;
+  const int replica = plan.replica;
+  bool execute_inline = plan.execute_inline;
+
+  // Collectives are serialized through `last_collective_launch_event` and
+  // donations through usage events, so only the remaining computations can
+  // skip the event plumbing below.
+  if (execute_inline && execute_without_events_ &&
+      !last_collective_launch_event &&
+      parameters_that_must_be_donated_.empty()) {
+    TF_ASSIGN_OR_RETURN(
+        std::optional<Result> result,
+        ExecuteInline(plan, argument_handles, run_id, options, fill_future));
+    if (result.has_value()) {
+      return std::move(*result);
     }
   }
 
@@ -1488,12 +2613,10 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
   std::vector<tfrt::RCReference<tfrt::AsyncValue>> input_deps;
   input_deps.reserve(argument_handles.size());
 
-  auto donate_it = parameters_that_must_be_donated_.begin();
-
   for (int i = 0; i < argument_handles.size(); ++i) {
     PjRtBuffer* handle = argument_handles[i];
     auto* tfrt_buffer = tensorflow::down_cast<TfrtCpuBuffer*>(handle);
-    if (tfrt_buffer->device() != device) {
+    if (!plan.arguments_on_device && tfrt_buffer->device() != device) {
       return InvalidArgument(
           "Buffer passed to Execute() as argument %d to replica %d is on "
           "device %s, but replica is assigned to device %s.",
@@ -1503,10 +2626,7 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
 
     TrackedTfrtCpuDeviceBuffer* tracked_buffer;
     auto get_buffer = [&](int i) -> Status {
-      bool must_donate = donate_it != parameters_that_must_be_donated_.end() &&
-                         *donate_it == i;
-      if (must_donate) {
-        ++donate_it;
+      if (plan.must_donate[i]) {
         StatusOr<TfrtCpuBuffer::DonationTransaction> donation_transaction =
             tfrt_buffer->AcquireDonation();
         // On CPU, we allow donation to succeed by introducing a copy. This was
@@ -1569,9 +2689,16 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
 
   auto* cpu_executable =
       tensorflow::down_cast<cpu::CpuExecutable*>(cpu_executable_.get());
-  TF_ASSIGN_OR_RETURN(
-      std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffer_table,
-      CreateBufferTable(cpu_executable->buffer_assignment(), tracked_buffers));
+  // Temporary buffers are served from the executable's arena, if it has one.
+  // The slab goes back to the arena once this run drops `slab`.
+  std::shared_ptr<cpu::BufferTableArena::Slab> slab;
+  if (cpu_executable->buffer_table_arena() != nullptr) {
+    TF_ASSIGN_OR_RETURN(slab, cpu_executable->buffer_table_arena()->Acquire());
+  }
+  std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffer_table;
+  TF_RETURN_IF_ERROR(CreateBufferTable(cpu_executable->buffer_assignment(),
+                                       tracked_buffers, slab.get(),
+                                       device->allocator(), buffer_table));
   auto result_buffers =
       CreateResultShapedBuffer(result_buffer_indices_, buffer_table);
 
@@ -1595,6 +2722,7 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
   run_options.set_run_id(run_id);
   run_options.set_device_ordinal(device->local_hardware_id());
   // Need to keep device_assignment alive until execution completes.
+  std::shared_ptr<DeviceAssignment> device_assignment = plan.device_assignment;
   run_options.set_device_assignment(device_assignment.get());
   run_options.set_intra_op_thread_pool(client_->eigen_intraop_device());
 
@@ -1604,16 +2732,6 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
     input_deps.push_back(std::move(last_collective_launch_event));
   }
 
-  bool execute_inline = cheap_computation_;
-
-  // Overwrite `execute_inline` if it is specified in the ExecuteOptions.
-  if (options.execution_mode == ExecuteOptions::ExecutionMode::kAsynchronous) {
-    execute_inline = false;
-  } else if (options.execution_mode ==
-             ExecuteOptions::ExecutionMode::kSynchronous) {
-    execute_inline = true;
-  }
-
   if (input_deps.empty() && execute_inline) {
     // Synchronously call generated function.
 
@@ -1662,7 +2780,7 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
         client()->pjrt_client_thread_pool(), input_deps,
         [cpu_executable, result_buffer,
          buffer_pointers = std::move(buffer_pointers),
-         buffer_table = std::move(buffer_table),
+         buffer_table = std::move(buffer_table), slab = std::move(slab),
          run_options = std::move(run_options),
          cpu_executable_copy = cpu_executable_,
          device_assignment = std::move(device_assignment),
@@ -1981,4 +3099,59 @@ TfrtCpuExecutable::ExecutePortable(
   returned_future = std::move(result.future);
   return std::move(result.buffers);
 }
+
+StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+TfrtCpuClient::ExecuteGraph(absl::Span<const PjRtExecuteGraphNode> nodes,
+                            const ExecuteOptions& options) {
+  tsl::profiler::TraceMe traceme("TfrtCpuClient::ExecuteGraph");
+  // Every node is validated and planned by PrepareExecute before the first
+  // one is enqueued, so that dispatching a node only acquires its arguments
+  // and launches it. Nodes whose inputs are produced by earlier nodes wait for
+  // them on the client thread pool, not on this thread.
+  std::vector<TfrtCpuExecutable::ExecutePlan> plans(nodes.size());
+  return DispatchExecuteGraph(
+      this, nodes, options,
+      /*prepare=*/
+      [&](int node_index, const PjRtExecuteGraphNode& node,
+          const PjRtExecuteGraphPlacement& placement)
+          -> StatusOr<absl::Span<const bool>> {
+        auto* executable =
+            tensorflow::down_cast<TfrtCpuExecutable*>(node.executable);
+        TfrtCpuDevice* device = nullptr;
+        if (placement.portable) {
+          if (executable->device_assignment_ != nullptr ||
+              executable->num_replicas() != 1 ||
+              executable->num_partitions() != 1) {
+            return InvalidArgument(
+                "Executable %s is not assigned to device %s",
+                executable->name(), node.device->DebugString());
+          }
+          device = tensorflow::down_cast<TfrtCpuDevice*>(node.device);
+        }
+        TF_ASSIGN_OR_RETURN(
+            plans[node_index],
+            executable->PrepareExecute(node.arguments.size(),
+                                       placement.replica, placement.partition,
+                                       options, device));
+        // DispatchExecuteGraph checked the devices of the arguments.
+        plans[node_index].arguments_on_device = true;
+        return absl::Span<const bool>(plans[node_index].must_donate);
+      },
+      /*execute=*/
+      [&](int node_index, const PjRtExecuteGraphNode& node,
+          const PjRtExecuteGraphPlacement& placement,
+          absl::Span<PjRtBuffer* const> arguments)
+          -> StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> {
+        auto* executable =
+            tensorflow::down_cast<TfrtCpuExecutable*>(node.executable);
+        TF_ASSIGN_OR_RETURN(
+            auto result,
+            executable->DispatchExecute(
+                plans[node_index], arguments, RunId(), options,
+                /*last_collective_launch_event=*/
+                tfrt::AsyncValueRef<CpuEvent>(),
+                /*fill_future=*/false));
+        return std::move(result.buffers);
+      });
+}
 }  // namespace xla
@@ -24,16 +24,20 @@ limitations under the License.
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/synchronization/mutex.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "xla/client/executable_build_options.h"
 #include "xla/client/xla_computation.h"
 #include "xla/layout.h"
 #include "xla/literal.h"
+#include "xla/pjrt/cpu_cross_host_transport.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_executable.h"
 #include "xla/pjrt/pjrt_future.h"
 #include "xla/pjrt/semaphore.h"
 #include "xla/pjrt/tracked_tfrt_cpu_device_buffer.h"
+#include "xla/pjrt/tracking_cpu_allocator.h"
 #include "xla/pjrt/transpose.h"
 #include "xla/pjrt/worker_thread.h"
 #include "xla/runtime/cpu_event.h"
@@ -54,7 +58,8 @@ namespace xla {
 
 class TfrtCpuDevice final : public PjRtDevice {
  public:
-  TfrtCpuDevice(int id, bool asynchronous);
+  TfrtCpuDevice(int id, bool asynchronous,
+                TrackingCpuAllocator::Options allocator_options = {});
 
   void SetClient(PjRtClient* client) {
     CHECK(client_ == nullptr);
@@ -99,6 +104,13 @@ class TfrtCpuDevice final : public PjRtDevice {
     return attributes_;
   }
 
+  StatusOr<tsl::AllocatorStats> GetAllocatorStats() const override {
+    return allocator_.GetStats();
+  }
+
+  // Allocates the host memory of the buffers on this device.
+  TrackingCpuAllocator& allocator() { return allocator_; }
+
  private:
   int id_;
   PjRtClient* client_ = nullptr;
@@ -110,15 +122,19 @@ class TfrtCpuDevice final : public PjRtDevice {
   // ahead of the device.
   Semaphore max_inflight_computations_semaphore_;
   absl::flat_hash_map<std::string, PjRtDeviceAttribute> attributes_ = {};
+  TrackingCpuAllocator allocator_;
 };
 
 class TfrtCpuExecutable;
 
 class TfrtCpuClient final : public PjRtClient {
  public:
-  TfrtCpuClient(int process_index,
-                std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
-                size_t num_threads);
+  // `cross_host_transport` backs cross-host transfers; without one,
+  // MakeCrossHostReceiveBuffers and CopyToRemoteDevice are unimplemented.
+  TfrtCpuClient(
+      int process_index, std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
+      size_t num_threads,
+      std::unique_ptr<CpuCrossHostTransport> cross_host_transport = nullptr);
   ~TfrtCpuClient() override;
 
   int process_index() const override { return process_index_; }
@@ -176,9 +192,7 @@ class TfrtCpuClient final : public PjRtClient {
 
   StatusOr<std::unique_ptr<PjRtClient::AsyncHostToDeviceTransferManager>>
   CreateBuffersForAsyncHostToDevice(absl::Span<const Shape> shapes,
-                                    PjRtDevice* device) override {
-    return Unimplemented("Async transfer to buffers not implemented");
-  };
+                                    PjRtDevice* device) override;
 
   StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostBuffer(
       const void* data, PrimitiveType type, absl::Span<int64_t const> dims,
@@ -193,22 +207,21 @@ class TfrtCpuClient final : public PjRtClient {
   StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
   MakeCrossHostReceiveBuffers(absl::Span<const Shape> shapes,
                               PjRtDevice* device,
-                              PjRtCrossHostRecvNotifier notifier) override {
-    return Unimplemented("MakeCrossHostReceiveBuffers not implemented.");
-  }
+                              PjRtCrossHostRecvNotifier notifier) override;
 
   StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
   MakeCrossHostReceiveBuffersForGather(
       absl::Span<const Shape> shapes, std::vector<GatherDetails> gather_details,
-      PjRtDevice* device, PjRtCrossHostRecvNotifier notifier) override {
-    return Unimplemented(
-        "MakeCrossHostReceiveBuffersForGather not implemented.");
-  }
+      PjRtDevice* device, PjRtCrossHostRecvNotifier notifier) override;
 
   StatusOr<std::unique_ptr<PjRtBuffer>> CreateViewOfDeviceBuffer(
       void* device_ptr, const Shape& shape, PjRtDevice* device,
       std::function<void()> on_delete_callback) override;
 
+  StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>> ExecuteGraph(
+      absl::Span<const PjRtExecuteGraphNode> nodes,
+      const ExecuteOptions& options) override;
+
   StatusOr<ChannelHandle> CreateChannelHandle() override {
     return Unimplemented("CreateChannelHandle not implemented.");
   }
@@ -242,7 +255,19 @@ class TfrtCpuClient final : public PjRtClient {
     last_collective_launch_event_ = std::move(event);
   }
 
+  CpuCrossHostTransport* cross_host_transport() const {
+    return cross_host_transport_.get();
+  }
+
  private:
+  // Implements MakeCrossHostReceiveBuffers(ForGather). `gather_details` is
+  // nullptr if every buffer is received in one piece.
+  StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+  MakeCrossHostReceiveBuffersImpl(
+      absl::Span<const Shape> shapes,
+      const std::vector<GatherDetails>* gather_details, PjRtDevice* device,
+      PjRtCrossHostRecvNotifier notifier);
+
   int process_index_;
   // Includes all devices, including non-addressable devices.
   std::vector<std::unique_ptr<TfrtCpuDevice>> owned_devices_;
@@ -278,8 +303,9 @@ class TfrtCpuClient final : public PjRtClient {
   // A cache for transpose plans. We use transposes to convert
   // (possibly strided) buffers provided to BufferFromHostBuffer into dense
   // major-to-minor layout.
-  absl::Mutex transpose_mu_;
-  TransposePlanCache transpose_cache_ ABSL_GUARDED_BY(transpose_mu_);
+  TransposePlanCache transpose_cache_;
+
+  std::unique_ptr<CpuCrossHostTransport> cross_host_transport_;
 };
 
 class TfrtCpuBuffer final : public PjRtBuffer {
@@ -312,10 +338,10 @@ class TfrtCpuBuffer final : public PjRtBuffer {
 
   StatusOr<size_t> GetOnDeviceSizeInBytes() const override;
 
+  // Copies `transfer_size` bytes starting at `offset` of the buffer into
+  // `dst` once the buffer is defined. Not supported for tuples.
   PjRtFuture<Status> CopyRawToHost(void* dst, int64_t offset,
-                                   int64_t transfer_size) override {
-    return PjRtFuture<Status>(Unimplemented("CopyRawToHost not implemented"));
-  }
+                                   int64_t transfer_size) override;
 
   void Delete() override;
 
@@ -324,22 +350,16 @@ class TfrtCpuBuffer final : public PjRtBuffer {
   StatusOr<std::unique_ptr<PjRtBuffer>> CopyToDevice(
       PjRtDevice* dst_device) override;
 
+  // Sends the buffer through the client's CpuCrossHostTransport once both the
+  // descriptor and the buffer are ready. Not supported for tuples.
   void CopyToRemoteDevice(
       PjRtFuture<StatusOr<std::string>> serialized_descriptor,
-      RemoteSendCallback on_done) override {
-    on_done(Unimplemented("CopyToRemoteDevice not implemented."),
-            /*sends_were_enqueued=*/false);
-  }
+      RemoteSendCallback on_done) override;
 
   void CopyToRemoteDeviceScattered(
       PjRtFuture<StatusOr<std::vector<std::string>>> serialized_descriptors,
       std::vector<RemoteSendCallback> callbacks,
-      const xla::PjRtBuffer::ScatterDetails& scatter_details) override {
-    for (const auto& on_done : callbacks) {
-      on_done(Unimplemented("Implement CopyToRemoteDeviceScattered."),
-              /*sends_were_enqueued=*/false);
-    }
-  }
+      const xla::PjRtBuffer::ScatterDetails& scatter_details) override;
 
   PjRtFuture<Status> GetReadyFuture() override;
 
@@ -354,6 +374,14 @@ class TfrtCpuBuffer final : public PjRtBuffer {
   StatusOr<tfrt::AsyncValueRef<Literal>> CopyToHostAsyncInternal(
       bool discard_cached_copy, std::optional<xla::Layout> layout);
 
+  // Sends `byte_ranges[i]` of the buffer to the i-th descriptor that
+  // `serialized_descriptors` is fulfilled with, and calls `callbacks[i]` once
+  // that send is done or has failed.
+  void CopyRangesToRemoteDevice(
+      PjRtFuture<StatusOr<std::vector<std::string>>> serialized_descriptors,
+      std::vector<CpuCrossHostTransport::ByteRange> byte_ranges,
+      std::vector<RemoteSendCallback> callbacks);
+
   // Acquires the device buffer for shared read-only usages, and it also adds
   // the `usage_event` to it. Any donation event in the future is expected to be
   // serialized after all the usage events added through this method. Returns
@@ -362,6 +390,13 @@ class TfrtCpuBuffer final : public PjRtBuffer {
   TrackedTfrtCpuDeviceBuffer* AcquireUsage(
       tfrt::AsyncValueRef<runtime::CpuEvent> usage_event);
 
+  // Acquires the device buffer for a read-only usage that completes on the
+  // calling thread, without recording a usage event. Deletion and donation of
+  // the buffer block until the matching DropInlineUsage() call. Returns
+  // nullptr if the buffer is already donated or deleted.
+  TrackedTfrtCpuDeviceBuffer* AcquireInlineUsage();
+  void DropInlineUsage();
+
   // A helper class for managing a pending donation. It should be committed upon
   // success. Otherwise, the donated buffer is returned to the TfrtCpuBuffer.
   class DonationTransaction {
@@ -465,6 +500,9 @@ class TfrtCpuBuffer final : public PjRtBuffer {
   // might fail. Note that concurrent calls to AcquireUsage() and
   // AcquireDonation() might fail even if the pending donation is aborted later.
   bool pending_donation_ ABSL_GUARDED_BY(mu_) = false;
+  // Count of usages acquired through AcquireInlineUsage() that have not been
+  // dropped yet.
+  int inline_usage_count_ ABSL_GUARDED_BY(mu_) = 0;
 
   friend class TfrtCpuClient;
   friend class TfrtCpuExecutable;
@@ -562,6 +600,13 @@ class TfrtCpuExecutable final : public PjRtLoadedExecutable {
 
   std::shared_ptr<Executable> cpu_executable() const { return cpu_executable_; }
 
+  // Whether cheap computations may run without usage events (see
+  // ExecuteInline()). Only useful to disable in order to compare against the
+  // event-based path, e.g. in benchmarks.
+  void set_execute_without_events(bool execute_without_events) {
+    execute_without_events_ = execute_without_events;
+  }
+
  private:
   friend class TfrtCpuClient;
 
@@ -573,6 +618,57 @@ class TfrtCpuExecutable final : public PjRtLoadedExecutable {
       absl::Span<std::pair<bool, TrackedTfrtCpuDeviceBuffer*> const>
           input_buffers) const;
 
+  // Buffer table of a computation run by ExecuteInline(). Temporary buffers
+  // stay allocated across runs; the entries of parameters and outputs are
+  // refilled by every run and cleared when the table is released.
+  struct InlineBufferTable {
+    TfrtCpuDevice* device;
+    std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffers;
+    std::vector<void*> buffer_pointers;
+  };
+
+  std::unique_ptr<InlineBufferTable> AcquireInlineBufferTable(
+      TfrtCpuDevice* device);
+  void ReleaseInlineBufferTable(std::unique_ptr<InlineBufferTable> table);
+
+  // What PrepareExecute() works out about an execution before any argument
+  // is looked at, so that executions with the same placement and options can
+  // share it.
+  struct ExecutePlan {
+    int replica = 0;
+    TfrtCpuDevice* device = nullptr;
+    // Kept alive until the execution completes.
+    std::shared_ptr<DeviceAssignment> device_assignment;
+    bool execute_inline = false;
+    // Whether each argument must be donated to the execution.
+    absl::InlinedVector<bool, 4> must_donate;
+    // Set by callers that already checked that the arguments are on `device`.
+    bool arguments_on_device = false;
+  };
+
+  // Resolves the device of the execution and validates `options` against the
+  // executable.
+  StatusOr<ExecutePlan> PrepareExecute(int num_arguments, int replica,
+                                       int partition,
+                                       const ExecuteOptions& options,
+                                       TfrtCpuDevice* device) const;
+
+  // Runs the computation synchronously on the calling thread, without
+  // allocating events for the execution or its results. Returns std::nullopt
+  // if some argument is not defined yet, in which case the caller falls back
+  // to DispatchExecute's regular path.
+  StatusOr<std::optional<Result>> ExecuteInline(
+      const ExecutePlan& plan, absl::Span<PjRtBuffer* const> argument_handles,
+      const RunId& run_id, const ExecuteOptions& options, bool fill_future);
+
+  // Acquires the arguments and launches the execution planned by
+  // PrepareExecute().
+  StatusOr<Result> DispatchExecute(
+      const ExecutePlan& plan, absl::Span<PjRtBuffer* const> argument_handles,
+      const RunId& run_id, const ExecuteOptions& options,
+      tfrt::AsyncValueRef<runtime::CpuEvent> last_collective_launch_event,
+      bool fill_future);
+
   StatusOr<Result> ExecuteHelper(
       absl::Span<PjRtBuffer* const> argument_handles, int replica,
       int partition, const RunId& run_id, const ExecuteOptions& options,
@@ -620,6 +716,17 @@ class TfrtCpuExecutable final : public PjRtLoadedExecutable {
   // Cached result of comparing HloCostAnalysis FLOP estimate for execute
   // critical path.
   bool cheap_computation_;
+
+  // Whether cheap computations may take the ExecuteInline() path. False for
+  // computations that run host code, such as send/recv, infeed/outfeed or
+  // custom calls: that code may delete or donate an argument, which would
+  // wait on the inline usage held by its own thread.
+  bool execute_without_events_;
+
+  absl::Mutex inline_buffer_tables_mu_;
+  // Buffer tables of finished inline runs, kept for reuse by later runs.
+  std::vector<std::unique_ptr<InlineBufferTable>> inline_buffer_tables_
+      ABSL_GUARDED_BY(inline_buffer_tables_mu_);
 };
 
 // Creates a CPU client with one Device. For testing purposes, you can set the
@@ -632,6 +739,14 @@ StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous);
 StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous,
                                                        int cpu_device_count);
 
+// Similar to the function above, but buffers can also be transferred to and
+// from clients in other processes through `cross_host_transport`, and
+// `allocator_options` configure the memory limit and pooling of each device.
+StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
+    bool asynchronous, int cpu_device_count,
+    std::unique_ptr<CpuCrossHostTransport> cross_host_transport,
+    TrackingCpuAllocator::Options allocator_options = {});
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_PJRT_TFRT_CPU_PJRT_CLIENT_H_
@@ -15,18 +15,38 @@ limitations under the License.
 
 #include "xla/pjrt/tfrt_cpu_pjrt_client.h"
 
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "xla/array2d.h"
+#include "xla/layout_util.h"
 #include "xla/literal_util.h"
+#include "xla/pjrt/cross_host_descriptor_exchange.h"
+#include "xla/pjrt/distributed/client.h"
+#include "xla/pjrt/shared_memory_cross_host_transport.h"
 #include "xla/service/custom_call_status.h"
 #include "xla/service/custom_call_target_registry.h"
 #include "xla/service/hlo_parser.h"
+#include "xla/shape_util.h"
+#include "xla/util.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
 
 namespace xla {
 namespace {
@@ -143,5 +163,629 @@ TEST(TfrtCpuClientTest, HloSnapshot) {
       LiteralUtil::CreateR2<float>({{11.0, 22.0}, {33.0, 44.0}, {55.0, 66.0}}));
 }
 
+TEST(TfrtCpuClientTest, AsyncTransferChunksArriveAfterExecute) {
+  constexpr char kProgram[] = R"(
+    HloModule add
+    ENTRY add {
+      x = f32[3,2] parameter(0)
+      y = f32[3,2] parameter(1)
+      ROOT add = f32[3,2] add(x, y)
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                          ParseAndReturnUnverifiedModule(kProgram, {}));
+  XlaComputation xla_computation(hlo_module->ToProto());
+  TF_ASSERT_OK_AND_ASSIGN(auto pjrt_executable,
+                          client->Compile(xla_computation, {}));
+
+  Shape shape = ShapeUtil::MakeShape(F32, {3, 2});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto transfer_manager,
+      client->CreateBuffersForAsyncHostToDevice(
+          {shape, shape}, client->addressable_devices()[0]));
+  ASSERT_EQ(transfer_manager->buffer_count(), 2);
+  ASSERT_EQ(transfer_manager->buffer_size(0), 6 * sizeof(float));
+  std::unique_ptr<PjRtBuffer> x = transfer_manager->RetrieveBuffer(0);
+  std::unique_ptr<PjRtBuffer> y = transfer_manager->RetrieveBuffer(1);
+
+  // Execution is enqueued before any data has arrived.
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto result, pjrt_executable->Execute(
+                       /*argument_handles=*/{{x.get(), y.get()}}, {}));
+
+  std::vector<float> x_data{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  std::vector<float> y_data{10.0, 20.0, 30.0, 40.0, 50.0, 60.0};
+  int num_done = 0;
+  TF_ASSERT_OK(transfer_manager->TransferRawDataToSubBuffer(
+      0, x_data.data(), /*offset=*/0, 2 * sizeof(float),
+      /*is_last_transfer=*/false, [&num_done]() { ++num_done; }));
+  TF_ASSERT_OK(transfer_manager->TransferRawDataToSubBuffer(
+      0, x_data.data() + 2, /*offset=*/2 * sizeof(float), 4 * sizeof(float),
+      /*is_last_transfer=*/true, [&num_done]() { ++num_done; }));
+  TF_ASSERT_OK(transfer_manager->TransferRawDataToBuffer(
+      1,
+      absl::string_view(reinterpret_cast<const char*>(y_data.data()),
+                        y_data.size() * sizeof(float)),
+      [&num_done]() { ++num_done; }));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                          result[0][0]->ToLiteralSync());
+  EXPECT_EQ(*literal, LiteralUtil::CreateR2<float>(
+                          {{11.0, 22.0}, {33.0, 44.0}, {55.0, 66.0}}));
+  EXPECT_EQ(num_done, 3);
+}
+
+TEST(TfrtCpuClientTest, AsyncTransferLiteralAndErrors) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  Shape shape = ShapeUtil::MakeShape(F32, {2, 2});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto transfer_manager,
+      client->CreateBuffersForAsyncHostToDevice(
+          {shape, shape}, client->addressable_devices()[0]));
+  std::unique_ptr<PjRtBuffer> transferred = transfer_manager->RetrieveBuffer(0);
+  std::unique_ptr<PjRtBuffer> failed = transfer_manager->RetrieveBuffer(1);
+
+  float data[4] = {};
+  EXPECT_FALSE(transfer_manager
+                   ->TransferRawDataToSubBuffer(
+                       0, data, /*offset=*/8, /*transfer_size=*/16,
+                       /*is_last_transfer=*/false, nullptr)
+                   .ok());
+
+  // A literal in a different layout is relaid out on the way.
+  Literal literal = LiteralUtil::CreateR2WithLayout<float>(
+      {{1.0, 2.0}, {3.0, 4.0}}, LayoutUtil::MakeLayout({0, 1}));
+  TF_ASSERT_OK(
+      transfer_manager->TransferLiteralToBuffer(0, literal, nullptr));
+  EXPECT_FALSE(transfer_manager
+                   ->TransferRawDataToSubBuffer(
+                       0, data, /*offset=*/0, /*transfer_size=*/4,
+                       /*is_last_transfer=*/true, nullptr)
+                   .ok());
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> result,
+                          transferred->ToLiteralSync());
+  EXPECT_EQ(*result, LiteralUtil::CreateR2<float>({{1.0, 2.0}, {3.0, 4.0}}));
+
+  transfer_manager->SetBufferError(1, InternalError("transfer failed"));
+  EXPECT_THAT(failed->ToLiteralSync().status().error_message(),
+              ::testing::HasSubstr("transfer failed"));
+}
+
+TEST(TfrtCpuClientTest, BufferFromHostBufferTransposesAsynchronously) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  // Large enough to take the parallel, asynchronous transpose path.
+  constexpr int64_t kRows = 256;
+  constexpr int64_t kCols = 384;
+  std::vector<float> column_major(kRows * kCols);
+  Array2D<float> expected(kRows, kCols);
+  for (int64_t i = 0; i < kRows; ++i) {
+    for (int64_t j = 0; j < kCols; ++j) {
+      column_major[j * kRows + i] = i * kCols + j;
+      expected(i, j) = i * kCols + j;
+    }
+  }
+  std::vector<int64_t> byte_strides = {sizeof(float), kRows * sizeof(float)};
+
+  for (auto semantics :
+       {PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+        PjRtClient::HostBufferSemantics::kImmutableUntilTransferCompletes}) {
+    std::atomic<bool> done_with_host_buffer = false;
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto buffer,
+        client->BufferFromHostBuffer(
+            column_major.data(), F32, {kRows, kCols}, byte_strides, semantics,
+            [&]() { done_with_host_buffer = true; },
+            client->addressable_devices()[0]));
+    if (semantics ==
+        PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall) {
+      EXPECT_TRUE(done_with_host_buffer);
+    }
+    TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                            buffer->ToLiteralSync());
+    EXPECT_TRUE(done_with_host_buffer);
+    EXPECT_EQ(*literal, LiteralUtil::CreateR2FromArray2D(expected));
+  }
+}
+
+TEST(TfrtCpuClientTest, CopyRawToHostReadsSubRange) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  // Large enough that the copy is dispatched to the client thread pool.
+  constexpr int64_t kNumElements = 64 * 1024;
+  std::vector<int32_t> data(kNumElements);
+  absl::c_iota(data, 0);
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), S32, {kNumElements}, /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+          /*on_done_with_host_buffer=*/nullptr,
+          client->addressable_devices()[0]));
+
+  std::vector<int32_t> small(4);
+  TF_ASSERT_OK(buffer
+                   ->CopyRawToHost(small.data(), 10 * sizeof(int32_t),
+                                   small.size() * sizeof(int32_t))
+                   .Await());
+  EXPECT_THAT(small, ::testing::ElementsAre(10, 11, 12, 13));
+
+  std::vector<int32_t> large(kNumElements / 2);
+  TF_ASSERT_OK(buffer
+                   ->CopyRawToHost(large.data(),
+                                   kNumElements / 2 * sizeof(int32_t),
+                                   large.size() * sizeof(int32_t))
+                   .Await());
+  EXPECT_EQ(large.front(), kNumElements / 2);
+  EXPECT_EQ(large.back(), kNumElements - 1);
+
+  EXPECT_THAT(buffer
+                  ->CopyRawToHost(small.data(),
+                                  (kNumElements - 2) * sizeof(int32_t),
+                                  small.size() * sizeof(int32_t))
+                  .Await()
+                  .error_message(),
+              ::testing::HasSubstr("out of bounds"));
+}
+
+TEST(TfrtCpuClientTest, CopyRawToHostWaitsForDefinition) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto transfer_manager,
+      client->CreateBuffersForAsyncHostToDevice(
+          {shape, shape}, client->addressable_devices()[0]));
+  std::unique_ptr<PjRtBuffer> buffer = transfer_manager->RetrieveBuffer(0);
+  std::unique_ptr<PjRtBuffer> failed = transfer_manager->RetrieveBuffer(1);
+
+  std::vector<float> dst(2);
+  PjRtFuture<Status> copied =
+      buffer->CopyRawToHost(dst.data(), 2 * sizeof(float), 2 * sizeof(float));
+  PjRtFuture<Status> copy_failed =
+      failed->CopyRawToHost(dst.data(), 0, 2 * sizeof(float));
+
+  std::vector<float> src = {1.0, 2.0, 3.0, 4.0};
+  TF_ASSERT_OK(transfer_manager->TransferRawDataToBuffer(
+      0,
+      absl::string_view(reinterpret_cast<const char*>(src.data()),
+                        src.size() * sizeof(float)),
+      /*on_done=*/nullptr));
+  transfer_manager->SetBufferError(1, InternalError("transfer failed"));
+
+  TF_ASSERT_OK(copied.Await());
+  EXPECT_THAT(dst, ::testing::ElementsAre(3.0, 4.0));
+  EXPECT_THAT(copy_failed.Await().error_message(),
+              ::testing::HasSubstr("transfer failed"));
+}
+
+// An in-process key-value store standing in for the distributed runtime
+// service, for exchanging cross-host receive descriptors.
+class FakeDistributedRuntimeClient : public DistributedRuntimeClient {
+ public:
+  Status Connect() override { return OkStatus(); }
+  Status Shutdown() override { return OkStatus(); }
+  Status EnumerateDevices(const LocalTopologyProto& local_topology,
+                          GlobalTopologyProto* global_topology) override {
+    return Unimplemented("EnumerateDevices");
+  }
+  StatusOr<std::string> BlockingKeyValueGet(std::string key,
+                                            absl::Duration timeout) override {
+    absl::MutexLock lock(&mu_);
+    auto has_key = [&]() ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+      return values_.contains(key);
+    };
+    if (!mu_.AwaitWithTimeout(absl::Condition(&has_key), timeout)) {
+      return tsl::errors::DeadlineExceeded("Timed out waiting for ", key);
+    }
+    return values_[key];
+  }
+  StatusOr<std::vector<std::pair<std::string, std::string>>> KeyValueDirGet(
+      absl::string_view key) override {
+    return Unimplemented("KeyValueDirGet");
+  }
+  Status KeyValueSet(std::string key, std::string value) override {
+    absl::MutexLock lock(&mu_);
+    values_[key] = std::move(value);
+    return OkStatus();
+  }
+  Status KeyValueDelete(std::string key) override {
+    absl::MutexLock lock(&mu_);
+    values_.erase(key);
+    return OkStatus();
+  }
+  Status WaitAtBarrier(std::string barrier_id,
+                       absl::Duration timeout) override {
+    return OkStatus();
+  }
+  StatusOr<tsl::CoordinationServiceAgent*> GetCoordinationServiceAgent()
+      override {
+    return Unimplemented("GetCoordinationServiceAgent");
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, std::string> values_ ABSL_GUARDED_BY(mu_);
+};
+
+// Each client gets its own transport, so transfers between two clients of the
+// same process take the same shared memory and socket path as transfers
+// between processes.
+StatusOr<std::unique_ptr<PjRtClient>> GetClientWithSharedMemoryTransport() {
+  TF_ASSIGN_OR_RETURN(auto transport, SharedMemoryCrossHostTransport::Create());
+  return GetTfrtCpuClient(/*asynchronous=*/true, /*cpu_device_count=*/1,
+                          std::move(transport));
+}
+
+// Returns a notifier for MakeCrossHostReceiveBuffers that fulfills `state`.
+PjRtCrossHostRecvNotifier NotifyInto(
+    PjRtFuture<StatusOr<PjRtCrossHostRecvState>>::Promise state) {
+  return [state](StatusOr<PjRtCrossHostRecvState> result) mutable {
+    state.Set(std::move(result));
+  };
+}
+
+TEST(TfrtCpuClientTest, CrossHostTransferThroughSharedMemory) {
+  TF_ASSERT_OK_AND_ASSIGN(auto receiver, GetClientWithSharedMemoryTransport());
+  TF_ASSERT_OK_AND_ASSIGN(auto sender, GetClientWithSharedMemoryTransport());
+  FakeDistributedRuntimeClient distributed_client;
+
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  auto recv_state =
+      PjRtFuture<StatusOr<PjRtCrossHostRecvState>>::CreatePromise();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto received,
+      receiver->MakeCrossHostReceiveBuffers(
+          {shape}, receiver->addressable_devices()[0], NotifyInto(recv_state)));
+
+  // The send is issued before the receiver publishes its descriptor.
+  Literal literal = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto src,
+      sender->BufferFromHostLiteral(literal, sender->addressable_devices()[0]));
+  auto sent = PjRtFuture<Status>::CreatePromise();
+  src->CopyToRemoteDevice(
+      GetCrossHostRecvDescriptor(&distributed_client, "transfer/0",
+                                 absl::Seconds(60)),
+      [sent](Status status, bool sends_were_enqueued) mutable {
+        sent.Set(status);
+      });
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      PjRtCrossHostRecvState state,
+      PjRtFuture<StatusOr<PjRtCrossHostRecvState>>(recv_state).Await());
+  ASSERT_EQ(state.descriptors.size(), 1);
+  TF_ASSERT_OK(PutCrossHostRecvDescriptor(
+      &distributed_client, "transfer/0",
+      state.descriptors[0].serialized_descriptors[0]));
+
+  TF_ASSERT_OK(PjRtFuture<Status>(sent).Await());
+  TF_ASSERT_OK_AND_ASSIGN(auto result, received[0]->ToLiteralSync());
+  EXPECT_EQ(*result, literal);
+}
+
+TEST(TfrtCpuClientTest, CrossHostGatherScatterAndCancel) {
+  TF_ASSERT_OK_AND_ASSIGN(auto receiver, GetClientWithSharedMemoryTransport());
+  TF_ASSERT_OK_AND_ASSIGN(auto sender, GetClientWithSharedMemoryTransport());
+
+  Shape shape = ShapeUtil::MakeShape(S32, {4, 2});
+  PjRtClient::GatherDetails gather_details;
+  gather_details.dimensions = {0};
+  gather_details.slice_boundaries = {1, 4};
+  auto recv_state =
+      PjRtFuture<StatusOr<PjRtCrossHostRecvState>>::CreatePromise();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto received,
+      receiver->MakeCrossHostReceiveBuffersForGather(
+          {shape, shape}, {gather_details, gather_details},
+          receiver->addressable_devices()[0], NotifyInto(recv_state)));
+  TF_ASSERT_OK_AND_ASSIGN(
+      PjRtCrossHostRecvState state,
+      PjRtFuture<StatusOr<PjRtCrossHostRecvState>>(recv_state).Await());
+  ASSERT_EQ(state.descriptors.size(), 2);
+  ASSERT_EQ(state.descriptors[0].serialized_descriptors.size(), 2);
+
+  // The first buffer is scattered into both slices of the first receive.
+  Literal literal =
+      LiteralUtil::CreateR2<int32_t>({{0, 1}, {2, 3}, {4, 5}, {6, 7}});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto src,
+      sender->BufferFromHostLiteral(literal, sender->addressable_devices()[0]));
+  PjRtBuffer::ScatterDetails scatter_details;
+  scatter_details.dimensions = {0};
+  scatter_details.slices = {{0, 1}, {1, 4}};
+  std::vector<PjRtFuture<Status>::Promise> sent = {
+      PjRtFuture<Status>::CreatePromise(), PjRtFuture<Status>::CreatePromise()};
+  std::vector<PjRtBuffer::RemoteSendCallback> callbacks;
+  for (const auto& promise : sent) {
+    callbacks.push_back(
+        [promise](Status status, bool sends_were_enqueued) mutable {
+          promise.Set(status);
+        });
+  }
+  src->CopyToRemoteDeviceScattered(
+      PjRtFuture<StatusOr<std::vector<std::string>>>(std::vector<std::string>(
+          state.descriptors[0].serialized_descriptors.begin(),
+          state.descriptors[0].serialized_descriptors.end())),
+      std::move(callbacks), scatter_details);
+  for (const auto& promise : sent) {
+    TF_ASSERT_OK(PjRtFuture<Status>(promise).Await());
+  }
+
+  // Nothing sends to the second buffer, so the receiver cancels its slices.
+  // Neither buffer is ready before that.
+  for (const std::string& descriptor :
+       state.descriptors[1].serialized_descriptors) {
+    auto canceled = PjRtFuture<Status>::CreatePromise();
+    state.cancel_notifier(descriptor, Cancelled("sender has no data"),
+                          [canceled](Status status) mutable {
+                            canceled.Set(status);
+                          });
+    TF_ASSERT_OK(PjRtFuture<Status>(canceled).Await());
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(auto result, received[0]->ToLiteralSync());
+  EXPECT_EQ(*result, literal);
+  EXPECT_THAT(received[1]->ToLiteralSync().status().error_message(),
+              ::testing::HasSubstr("sender has no data"));
+}
+
+TEST(TfrtCpuClientTest, CrossHostTransfersRequireTransport) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  EXPECT_THAT(client
+                  ->MakeCrossHostReceiveBuffers(
+                      {shape}, client->addressable_devices()[0],
+                      [](StatusOr<PjRtCrossHostRecvState>) {})
+                  .status()
+                  .error_message(),
+              ::testing::HasSubstr("CpuCrossHostTransport"));
+}
+
+TEST(TfrtCpuClientTest, DeviceAllocatorStatsAndLimit) {
+  TrackingCpuAllocator::Options allocator_options;
+  allocator_options.memory_limit_bytes = 1024;
+  allocator_options.max_allocation_wait = absl::Milliseconds(10);
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto client,
+      GetTfrtCpuClient(/*asynchronous=*/true, /*cpu_device_count=*/1,
+                       /*cross_host_transport=*/nullptr, allocator_options));
+  PjRtDevice* device = client->addressable_devices()[0];
+  auto buffer_from_host = [&](int64_t num_elements) {
+    std::vector<int32_t> data(num_elements);
+    return client->BufferFromHostBuffer(
+        data.data(), S32, {num_elements}, /*byte_strides=*/std::nullopt,
+        PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+        /*on_done_with_host_buffer=*/nullptr, device);
+  };
+
+  TF_ASSERT_OK_AND_ASSIGN(auto buffer, buffer_from_host(128));
+  TF_ASSERT_OK_AND_ASSIGN(tsl::AllocatorStats stats,
+                          device->GetAllocatorStats());
+  EXPECT_EQ(stats.bytes_in_use, 512);
+  EXPECT_EQ(stats.bytes_limit, 1024);
+
+  // Over the limit while `buffer` is alive, and nothing frees it in time.
+  EXPECT_EQ(buffer_from_host(256).status().code(),
+            tsl::error::RESOURCE_EXHAUSTED);
+  buffer.reset();
+  TF_ASSERT_OK_AND_ASSIGN(buffer, buffer_from_host(256));
+  TF_ASSERT_OK_AND_ASSIGN(stats, device->GetAllocatorStats());
+  EXPECT_EQ(stats.bytes_in_use, 1024);
+  EXPECT_EQ(stats.peak_bytes_in_use, 1024);
+}
+
+TEST(TfrtCpuClientTest, CheapComputationRunsInline) {
+  constexpr char kProgram[] = R"(
+    HloModule add_mul
+    ENTRY add_mul {
+      x = f32[4] parameter(0)
+      y = f32[4] parameter(1)
+      add = f32[4] add(x, y)
+      mul = f32[4] multiply(x, y)
+      ROOT result = (f32[4], f32[4]) tuple(add, mul)
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                          ParseAndReturnUnverifiedModule(kProgram, {}));
+  XlaComputation xla_computation(hlo_module->ToProto());
+  TF_ASSERT_OK_AND_ASSIGN(auto pjrt_executable,
+                          client->Compile(xla_computation, {}));
+  auto buffer_from_host = [&](const std::vector<float>& data) {
+    return client->BufferFromHostBuffer(
+        data.data(), F32, {4}, /*byte_strides=*/std::nullopt,
+        PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+        /*on_done_with_host_buffer=*/nullptr, client->addressable_devices()[0]);
+  };
+
+  ExecuteOptions options;
+  options.untuple_result = true;
+  // Later runs reuse the buffer table of the earlier ones.
+  for (float scale : {1.0f, 2.0f, 3.0f}) {
+    TF_ASSERT_OK_AND_ASSIGN(auto x,
+                            buffer_from_host({scale, scale, scale, scale}));
+    TF_ASSERT_OK_AND_ASSIGN(auto y, buffer_from_host({1.0f, 2.0f, 3.0f, 4.0f}));
+    TF_ASSERT_OK(x->GetReadyFuture().Await());
+    TF_ASSERT_OK(y->GetReadyFuture().Await());
+
+    std::optional<std::vector<PjRtFuture<Status>>> futures;
+    futures.emplace();
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto results, pjrt_executable->Execute({{x.get(), y.get()}}, options,
+                                               futures));
+    ASSERT_EQ(results[0].size(), 2);
+    EXPECT_TRUE((*futures)[0].IsKnownReady());
+    EXPECT_TRUE(results[0][0]->GetReadyFuture().IsKnownReady());
+
+    TF_ASSERT_OK_AND_ASSIGN(auto sum, results[0][0]->ToLiteralSync());
+    TF_ASSERT_OK_AND_ASSIGN(auto product, results[0][1]->ToLiteralSync());
+    EXPECT_EQ(*sum, LiteralUtil::CreateR1<float>(
+                        {scale + 1, scale + 2, scale + 3, scale + 4}));
+    EXPECT_EQ(*product, LiteralUtil::CreateR1<float>(
+                            {scale, 2 * scale, 3 * scale, 4 * scale}));
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below.
+//===----------------------------------------------------------------------===//
+
+// Copies a host array whose dimensions are laid out in the order given by
+// `kPermutations[state.range(1)]` (major to minor) into a device buffer.
+void BM_BufferFromHostBufferTransposed(::testing::benchmark::State& state) {
+  static const auto* const kPermutations =
+      new std::vector<std::vector<int64_t>>{
+          {1, 0}, {2, 1, 0}, {0, 2, 1}, {1, 0, 2}};
+  const int64_t num_elements = state.range(0);
+  const std::vector<int64_t>& permutation = (*kPermutations)[state.range(1)];
+  const int64_t rank = permutation.size();
+
+  std::vector<int64_t> dims(rank);
+  int64_t remaining = num_elements;
+  for (int64_t i = 0; i < rank; ++i) {
+    dims[i] = std::llround(std::pow(remaining, 1.0 / (rank - i)));
+    remaining /= dims[i];
+  }
+  std::vector<int64_t> byte_strides(rank);
+  int64_t stride = sizeof(float);
+  for (int64_t i = rank - 1; i >= 0; --i) {
+    byte_strides[permutation[i]] = stride;
+    stride *= dims[permutation[i]];
+  }
+  std::vector<float> data(stride / sizeof(float), 1.0f);
+
+  std::unique_ptr<PjRtClient> client =
+      GetTfrtCpuClient(/*asynchronous=*/true).value();
+  for (auto s : state) {
+    auto buffer =
+        client
+            ->BufferFromHostBuffer(
+                data.data(), F32, dims, byte_strides,
+                PjRtClient::HostBufferSemantics::
+                    kImmutableUntilTransferCompletes,
+                /*on_done_with_host_buffer=*/nullptr,
+                client->addressable_devices()[0])
+            .value();
+    TF_CHECK_OK(buffer->GetReadyFuture().Await());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size() * sizeof(float));
+}
+
+BENCHMARK(BM_BufferFromHostBufferTransposed)
+    ->ArgsProduct({{1 << 14, 1 << 18, 1 << 22}, {0, 1, 2, 3}})
+    ->UseRealTime();
+
+// Measures the dispatch overhead of a computation too cheap to be worth a
+// thread hop. `state.range(0)` selects ExecuteOptions::execution_mode: the
+// default runs it on the calling thread, kAsynchronous on the client thread
+// pool. If `state.range(1)` is 0, runs on the calling thread still record
+// usage events as they did before ExecuteInline() existed, which is the
+// baseline for the event-free path.
+void BM_ExecuteCheapComputation(::testing::benchmark::State& state) {
+  constexpr char kProgram[] = R"(
+    HloModule add
+    ENTRY add {
+      x = f32[4] parameter(0)
+      y = f32[4] parameter(1)
+      ROOT add = f32[4] add(x, y)
+    })";
+
+  std::unique_ptr<PjRtClient> client =
+      GetTfrtCpuClient(/*asynchronous=*/true).value();
+  auto hlo_module = ParseAndReturnUnverifiedModule(kProgram, {}).value();
+  XlaComputation xla_computation(hlo_module->ToProto());
+  auto pjrt_executable = client->Compile(xla_computation, {}).value();
+  static_cast<TfrtCpuExecutable*>(pjrt_executable.get())
+      ->set_execute_without_events(state.range(1) != 0);
+  std::vector<float> data(4, 1.0f);
+  auto buffer =
+      client
+          ->BufferFromHostBuffer(
+              data.data(), F32, {4}, /*byte_strides=*/std::nullopt,
+              PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+              /*on_done_with_host_buffer=*/nullptr,
+              client->addressable_devices()[0])
+          .value();
+  TF_CHECK_OK(buffer->GetReadyFuture().Await());
+
+  ExecuteOptions options;
+  options.execution_mode =
+      static_cast<ExecuteOptions::ExecutionMode>(state.range(0));
+  for (auto s : state) {
+    auto results =
+        pjrt_executable->Execute({{buffer.get(), buffer.get()}}, options)
+            .value();
+    TF_CHECK_OK(results[0][0]->GetReadyFuture().Await());
+  }
+}
+
+BENCHMARK(BM_ExecuteCheapComputation)
+    ->Args({static_cast<int>(ExecuteOptions::ExecutionMode::kDefault), 1})
+    ->Args({static_cast<int>(ExecuteOptions::ExecutionMode::kDefault), 0})
+    ->Args({static_cast<int>(ExecuteOptions::ExecutionMode::kAsynchronous), 1});
+
+// Measures the dispatch overhead of a chain of `state.range(1)` cheap
+// computations, each consuming the output of the previous one. If
+// `state.range(0)` is 0, the chain is dispatched by calling Execute() for each
+// computation in turn; otherwise by a single ExecuteGraph() call.
+void BM_ExecuteChain(::testing::benchmark::State& state) {
+  constexpr char kProgram[] = R"(
+    HloModule add
+    ENTRY add {
+      x = f32[4] parameter(0)
+      ROOT add = f32[4] add(x, x)
+    })";
+  const bool execute_graph = state.range(0) != 0;
+  const int chain_length = state.range(1);
+
+  std::unique_ptr<PjRtClient> client =
+      GetTfrtCpuClient(/*asynchronous=*/true).value();
+  auto hlo_module = ParseAndReturnUnverifiedModule(kProgram, {}).value();
+  XlaComputation xla_computation(hlo_module->ToProto());
+  auto pjrt_executable = client->Compile(xla_computation, {}).value();
+  PjRtDevice* device = client->addressable_devices()[0];
+  std::vector<float> data(4, 1.0f);
+  auto buffer =
+      client
+          ->BufferFromHostBuffer(
+              data.data(), F32, {4}, /*byte_strides=*/std::nullopt,
+              PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+              /*on_done_with_host_buffer=*/nullptr, device)
+          .value();
+  TF_CHECK_OK(buffer->GetReadyFuture().Await());
+
+  std::vector<PjRtExecuteGraphNode> nodes(chain_length);
+  for (int i = 0; i < chain_length; ++i) {
+    nodes[i].executable = pjrt_executable.get();
+    nodes[i].device = device;
+    if (i == 0) {
+      nodes[i].arguments.push_back({buffer.get()});
+    } else {
+      nodes[i].arguments.push_back(
+          {/*buffer=*/nullptr, /*node_index=*/i - 1, /*output_index=*/0});
+    }
+    nodes[i].return_outputs = i == chain_length - 1;
+  }
+
+  ExecuteOptions options;
+  for (auto s : state) {
+    std::unique_ptr<PjRtBuffer> result;
+    if (execute_graph) {
+      auto outputs = client->ExecuteGraph(nodes, options).value();
+      result = std::move(outputs.back()[0]);
+    } else {
+      PjRtBuffer* argument = buffer.get();
+      for (int i = 0; i < chain_length; ++i) {
+        auto results = pjrt_executable->Execute({{argument}}, options).value();
+        result = std::move(results[0][0]);
+        argument = result.get();
+      }
+    }
+    TF_CHECK_OK(result->GetReadyFuture().Await());
+  }
+  state.SetItemsProcessed(state.iterations() * chain_length);
+}
+
+BENCHMARK(BM_ExecuteChain)->ArgsProduct({{0, 1}, {1, 16, 256}});
+
 }  // namespace
 }  // namespace xla
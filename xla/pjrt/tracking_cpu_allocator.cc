@@ -0,0 +1,171 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/tracking_cpu_allocator.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/cpu_function_runtime.h"
+#include "xla/util.h"
+#include "tsl/platform/mem.h"
+
+namespace xla {
+
+struct TrackingCpuAllocator::State {
+  explicit State(Options options) : options(options) {}
+
+  ~State() {
+    for (auto& [size, data] : pool) tsl::port::AlignedFree(data);
+  }
+
+  bool HasRoomFor(size_t size) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    return options.memory_limit_bytes == 0 ||
+           stats.bytes_in_use + static_cast<int64_t>(size) <=
+               options.memory_limit_bytes;
+  }
+
+  // Frees pooled blocks, largest first, until `size` more bytes fit under the
+  // memory limit next to the live and pooled ones.
+  void TrimPoolFor(size_t size) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    if (options.memory_limit_bytes == 0) return;
+    while (!pool.empty() &&
+           stats.bytes_in_use + pool_bytes + static_cast<int64_t>(size) >
+               options.memory_limit_bytes) {
+      auto it = std::prev(pool.end());
+      pool_bytes -= it->first;
+      tsl::port::AlignedFree(it->second);
+      pool.erase(it);
+    }
+  }
+
+  void Free(void* data, size_t size) {
+    absl::MutexLock lock(&mu);
+    stats.bytes_in_use -= size;
+    if (options.pool_capacity_bytes > 0 &&
+        static_cast<int64_t>(size) >= options.pool_min_block_bytes &&
+        pool_bytes + static_cast<int64_t>(size) <=
+            options.pool_capacity_bytes) {
+      pool.emplace(size, data);
+      pool_bytes += size;
+    } else {
+      tsl::port::AlignedFree(data);
+    }
+    stats.pool_bytes = stats.bytes_in_use + pool_bytes;
+  }
+
+  const Options options;
+
+  mutable absl::Mutex mu;
+  tsl::AllocatorStats stats ABSL_GUARDED_BY(mu);
+  // Free blocks kept for reuse, keyed by size.
+  std::multimap<size_t, void*> pool ABSL_GUARDED_BY(mu);
+  int64_t pool_bytes ABSL_GUARDED_BY(mu) = 0;
+};
+
+TrackingCpuAllocator::TrackingCpuAllocator(Options options)
+    : state_(std::make_shared<State>(options)) {
+  absl::MutexLock lock(&state_->mu);
+  if (options.memory_limit_bytes > 0) {
+    state_->stats.bytes_limit = options.memory_limit_bytes;
+  }
+  state_->stats.pool_bytes = 0;
+  state_->stats.peak_pool_bytes = 0;
+}
+
+TrackingCpuAllocator::~TrackingCpuAllocator() = default;
+
+StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> TrackingCpuAllocator::Allocate(
+    size_t size) {
+  const Options& options = state_->options;
+  if (options.memory_limit_bytes > 0 &&
+      static_cast<int64_t>(size) > options.memory_limit_bytes) {
+    return ResourceExhausted(
+        "Allocation of %d bytes exceeds the device memory limit of %d bytes.",
+        size, options.memory_limit_bytes);
+  }
+
+  void* data = nullptr;
+  {
+    absl::MutexLock lock(&state_->mu);
+    auto has_room = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(state_->mu) {
+      return state_->HasRoomFor(size);
+    };
+    if (!state_->mu.AwaitWithTimeout(absl::Condition(&has_room),
+                                     options.max_allocation_wait)) {
+      return ResourceExhausted(
+          "Out of device memory allocating %d bytes: %d of %d bytes are in "
+          "use.",
+          size, state_->stats.bytes_in_use, options.memory_limit_bytes);
+    }
+    auto it = state_->pool.find(size);
+    if (it != state_->pool.end()) {
+      data = it->second;
+      state_->pool.erase(it);
+      state_->pool_bytes -= size;
+    } else {
+      state_->TrimPoolFor(size);
+    }
+    // Reserves the bytes before calling into malloc, so that concurrent
+    // allocations cannot go over the limit together.
+    tsl::AllocatorStats& stats = state_->stats;
+    ++stats.num_allocs;
+    stats.bytes_in_use += size;
+    stats.peak_bytes_in_use =
+        std::max(stats.peak_bytes_in_use, stats.bytes_in_use);
+    stats.largest_alloc_size =
+        std::max(stats.largest_alloc_size, static_cast<int64_t>(size));
+  }
+
+  if (data == nullptr) {
+    data = tsl::port::AlignedMalloc(size, cpu_function_runtime::MinAlign());
+    if (data == nullptr) {
+      absl::MutexLock lock(&state_->mu);
+      --state_->stats.num_allocs;
+      state_->stats.bytes_in_use -= size;
+      return ResourceExhausted("Out of memory allocating %d bytes.", size);
+    }
+  }
+  {
+    absl::MutexLock lock(&state_->mu);
+    int64_t held_bytes = state_->stats.bytes_in_use + state_->pool_bytes;
+    state_->stats.pool_bytes = held_bytes;
+    state_->stats.peak_pool_bytes =
+        std::max(*state_->stats.peak_pool_bytes, held_bytes);
+  }
+
+  // The memory is marked as owned so that computations may donate it, but it
+  // is freed, or returned to the pool, by the deleter of the shared_ptr. The
+  // deleter keeps the state alive, so buffers may outlive the allocator.
+  return std::shared_ptr<MaybeOwningCpuMemory>(
+      new MaybeOwningCpuMemory(
+          MaybeOwningCpuMemory::OwnedDataPtr{static_cast<uint8_t*>(data),
+                                             [](void*) {}},
+          size),
+      [state = state_, size](MaybeOwningCpuMemory* memory) {
+        state->Free(memory->data(), size);
+        delete memory;
+      });
+}
+
+tsl::AllocatorStats TrackingCpuAllocator::GetStats() const {
+  absl::MutexLock lock(&state_->mu);
+  return state_->stats;
+}
+
+}  // namespace xla
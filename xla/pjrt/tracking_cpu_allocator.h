@@ -0,0 +1,79 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_TRACKING_CPU_ALLOCATOR_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_TRACKING_CPU_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/time/time.h"
+#include "xla/pjrt/tracked_tfrt_cpu_device_buffer.h"
+#include "xla/statusor.h"
+#include "tsl/framework/allocator.h"
+
+namespace xla {
+
+// Allocates the host memory that backs the buffers of a TfrtCpuDevice and
+// keeps count of it, so that the device can report allocator stats and cap
+// how much memory it holds. Thread-safe.
+//
+// Memory returned by Allocate is accounted for until the last reference to it
+// is dropped, which may happen after the allocator has been destroyed.
+class TrackingCpuAllocator {
+ public:
+  struct Options {
+    // Maximum number of bytes that may be allocated at once. 0 means
+    // unlimited.
+    int64_t memory_limit_bytes = 0;
+
+    // How long Allocate waits for memory to be freed when an allocation would
+    // go over `memory_limit_bytes`, before giving up with ResourceExhausted.
+    absl::Duration max_allocation_wait = absl::Seconds(10);
+
+    // Freed blocks of at least `pool_min_block_bytes` are kept for reuse by
+    // later allocations of the same size, up to `pool_capacity_bytes` in
+    // total. 0 disables pooling.
+    int64_t pool_capacity_bytes = 0;
+    int64_t pool_min_block_bytes = 1 << 20;
+  };
+
+  explicit TrackingCpuAllocator(Options options);
+  ~TrackingCpuAllocator();
+
+  TrackingCpuAllocator(const TrackingCpuAllocator&) = delete;
+  TrackingCpuAllocator& operator=(const TrackingCpuAllocator&) = delete;
+
+  // Allocates `size` bytes aligned to cpu_function_runtime::MinAlign(). If the
+  // allocation would go over the memory limit, blocks until enough memory has
+  // been freed, e.g. by computations that are in flight. Returns
+  // ResourceExhausted if `size` exceeds the limit, if no memory is freed
+  // within `max_allocation_wait`, or if the host is out of memory.
+  StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> Allocate(size_t size);
+
+  // Returns the number of allocations and the bytes in use by live buffers.
+  // `pool_bytes` counts the live bytes plus the free blocks held for reuse.
+  tsl::AllocatorStats GetStats() const;
+
+ private:
+  struct State;
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_TRACKING_CPU_ALLOCATOR_H_
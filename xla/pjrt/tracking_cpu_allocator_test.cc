@@ -0,0 +1,119 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/tracking_cpu_allocator.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "xla/test.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+
+namespace xla {
+namespace {
+
+TEST(TrackingCpuAllocatorTest, TracksBytesInUse) {
+  TrackingCpuAllocator allocator({});
+  TF_ASSERT_OK_AND_ASSIGN(auto a, allocator.Allocate(100));
+  TF_ASSERT_OK_AND_ASSIGN(auto b, allocator.Allocate(300));
+  EXPECT_TRUE(a->owns_data());
+  EXPECT_EQ(a->size(), 100);
+
+  tsl::AllocatorStats stats = allocator.GetStats();
+  EXPECT_EQ(stats.num_allocs, 2);
+  EXPECT_EQ(stats.bytes_in_use, 400);
+  EXPECT_EQ(stats.peak_bytes_in_use, 400);
+  EXPECT_EQ(stats.largest_alloc_size, 300);
+  EXPECT_FALSE(stats.bytes_limit.has_value());
+
+  b.reset();
+  stats = allocator.GetStats();
+  EXPECT_EQ(stats.bytes_in_use, 100);
+  EXPECT_EQ(stats.peak_bytes_in_use, 400);
+}
+
+TEST(TrackingCpuAllocatorTest, RejectsAllocationsOverTheLimit) {
+  TrackingCpuAllocator allocator(
+      {/*memory_limit_bytes=*/1024,
+       /*max_allocation_wait=*/absl::Milliseconds(10)});
+  EXPECT_EQ(allocator.GetStats().bytes_limit, 1024);
+  EXPECT_EQ(allocator.Allocate(2048).status().code(),
+            tsl::error::RESOURCE_EXHAUSTED);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto a, allocator.Allocate(1000));
+  // Nothing frees memory within the wait.
+  EXPECT_EQ(allocator.Allocate(100).status().code(),
+            tsl::error::RESOURCE_EXHAUSTED);
+  EXPECT_EQ(allocator.GetStats().bytes_in_use, 1000);
+}
+
+TEST(TrackingCpuAllocatorTest, WaitsForMemoryToBeFreed) {
+  TrackingCpuAllocator allocator(
+      {/*memory_limit_bytes=*/1024,
+       /*max_allocation_wait=*/absl::InfiniteDuration()});
+  TF_ASSERT_OK_AND_ASSIGN(auto a, allocator.Allocate(1000));
+
+  absl::Notification allocated;
+  std::unique_ptr<tsl::Thread> thread(tsl::Env::Default()->StartThread(
+      tsl::ThreadOptions(), "allocate", [&]() {
+        TF_ASSERT_OK_AND_ASSIGN(auto b, allocator.Allocate(1000));
+        allocated.Notify();
+      }));
+  EXPECT_FALSE(
+      allocated.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+  a.reset();
+  allocated.WaitForNotification();
+}
+
+TEST(TrackingCpuAllocatorTest, PoolsLargeBlocks) {
+  TrackingCpuAllocator::Options options;
+  options.pool_capacity_bytes = 4096;
+  options.pool_min_block_bytes = 1024;
+  TrackingCpuAllocator allocator(options);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto large, allocator.Allocate(2048));
+  TF_ASSERT_OK_AND_ASSIGN(auto small, allocator.Allocate(16));
+  void* large_data = large->data();
+  large.reset();
+  small.reset();
+
+  tsl::AllocatorStats stats = allocator.GetStats();
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.pool_bytes, 2048);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto reused, allocator.Allocate(2048));
+  EXPECT_EQ(reused->data(), large_data);
+  stats = allocator.GetStats();
+  EXPECT_EQ(stats.bytes_in_use, 2048);
+  EXPECT_EQ(stats.pool_bytes, 2048);
+}
+
+TEST(TrackingCpuAllocatorTest, MemoryMayOutliveTheAllocator) {
+  std::shared_ptr<MaybeOwningCpuMemory> memory;
+  {
+    TrackingCpuAllocator::Options options;
+    options.pool_capacity_bytes = 4096;
+    options.pool_min_block_bytes = 1;
+    TrackingCpuAllocator allocator(options);
+    TF_ASSERT_OK_AND_ASSIGN(memory, allocator.Allocate(64));
+  }
+  memory.reset();
+}
+
+}  // namespace
+}  // namespace xla
@@ -439,6 +439,17 @@ void TransposePlan::ExecuteTyped(const char* a, char* b,
               outer_block_elems_b_, scratch.get());
         }
         break;
+      case 32:
+        if (nodes.size() > 1) {
+          Transpose<T, 32, transformation>(a, outer_block_elems_a_, b,
+                                           outer_block_elems_b_, nodes.data(),
+                                           scratch.get());
+        } else {
+          MacroKernel<T, 32, transformation>(
+              a, nodes.back().lda, outer_block_elems_a_, b, nodes.back().ldb,
+              outer_block_elems_b_, scratch.get());
+        }
+        break;
       default:
         LOG(FATAL) << "Invalid inner_block_size " << inner_block_elems_;
     }
@@ -451,6 +462,36 @@ struct uint128 {
 };
 static_assert(sizeof(uint128) == 16, "uint128 should be 16 bytes in size");
 
+void TransposePlan::ExecuteNodes(const void* a, void* b,
+                                 absl::Span<Node const> nodes) const {
+  const char* ac = static_cast<const char*>(a);
+  char* bc = static_cast<char*>(b);
+  switch (elem_size_in_bytes_) {
+    case 1:
+      ExecuteTyped<uint8_t, Transformation::kNone>(ac, bc, nodes);
+      break;
+    case 2:
+      ExecuteTyped<uint16_t, Transformation::kNone>(ac, bc, nodes);
+      break;
+    case 4:
+      if (transformation_ == Transformation::kNone) {
+        ExecuteTyped<uint32_t, Transformation::kNone>(ac, bc, nodes);
+      } else {
+        DCHECK(transformation_ == Transformation::kF64ToEf57);
+        ExecuteTyped<uint32_t, Transformation::kF64ToEf57>(ac, bc, nodes);
+      }
+      break;
+    case 8:
+      ExecuteTyped<uint64_t, Transformation::kNone>(ac, bc, nodes);
+      break;
+    case 16:
+      ExecuteTyped<uint128, Transformation::kNone>(ac, bc, nodes);
+      break;
+    default:
+      LOG(FATAL) << "Unimplemented element size " << elem_size_in_bytes_;
+  }
+}
+
 void TransposePlan::Execute(
     const void* a, void* b,
     const std::function<void(std::function<void(void)>)>& schedule_work) const {
@@ -458,39 +499,9 @@ void TransposePlan::Execute(
     return;
   }
 
-  const char* ac = static_cast<const char*>(a);
-  char* bc = static_cast<char*>(b);
-
-  auto execute_by_type = [&](absl::Span<Node const> nodes) {
-    switch (elem_size_in_bytes_) {
-      case 1:
-        ExecuteTyped<uint8_t, Transformation::kNone>(ac, bc, nodes);
-        break;
-      case 2:
-        ExecuteTyped<uint16_t, Transformation::kNone>(ac, bc, nodes);
-        break;
-      case 4:
-        if (transformation_ == Transformation::kNone) {
-          ExecuteTyped<uint32_t, Transformation::kNone>(ac, bc, nodes);
-        } else {
-          DCHECK(transformation_ == Transformation::kF64ToEf57);
-          ExecuteTyped<uint32_t, Transformation::kF64ToEf57>(ac, bc, nodes);
-        }
-        break;
-      case 8:
-        ExecuteTyped<uint64_t, Transformation::kNone>(ac, bc, nodes);
-        break;
-      case 16:
-        ExecuteTyped<uint128, Transformation::kNone>(ac, bc, nodes);
-        break;
-      default:
-        LOG(FATAL) << "Unimplemented element size " << elem_size_in_bytes_;
-    }
-  };
-
   if (!schedule_work || nodes_.size() <= 1) {
     for (const auto& nodes : nodes_) {
-      execute_by_type(nodes);
+      ExecuteNodes(a, b, nodes);
     }
   } else {
     absl::BlockingCounter counter(nodes_.size());
@@ -498,7 +509,7 @@ void TransposePlan::Execute(
       schedule_work([&, nodes]() {
         tsl::profiler::TraceMe traceme("Transpose::Execute",
                                        /*level=*/2);
-        execute_by_type(nodes);
+        ExecuteNodes(a, b, nodes);
         counter.DecrementCount();
       });
     }
@@ -506,6 +517,16 @@ void TransposePlan::Execute(
   }
 }
 
+void TransposePlan::ExecutePartition(const void* a, void* b,
+                                     int partition) const {
+  DCHECK_GE(partition, 0);
+  DCHECK_LT(partition, nodes_.size());
+  if (num_elems_ == 0) {
+    return;
+  }
+  ExecuteNodes(a, b, nodes_[partition]);
+}
+
 // Everything above this point pertains to executing plans.
 // Everything below this point pertains to building plans.
 
@@ -1101,24 +1122,25 @@ void TransposePlan::Initialize() {
   } else {
     // What are the smallest and largest block sizes for which we have a
     // vectorized kernel for this element size?
+    const TransposeKernelIsa isa = HostTransposeKernelIsa();
     int min_inner_block_elems;
     int max_inner_block_elems;
     switch (elem_size_in_bytes_) {
       case 1:
         min_inner_block_elems = 4;
-        max_inner_block_elems = 16;
+        max_inner_block_elems = isa >= TransposeKernelIsa::kAvx2 ? 32 : 16;
         break;
       case 2:
-        min_inner_block_elems = 8;
-        max_inner_block_elems = 8;
+        min_inner_block_elems = 4;
+        max_inner_block_elems = isa >= TransposeKernelIsa::kAvx2 ? 16 : 8;
         break;
       case 4:
         min_inner_block_elems = 4;
-        max_inner_block_elems = 8;
+        max_inner_block_elems = isa >= TransposeKernelIsa::kAvx512 ? 16 : 8;
         break;
       case 8:
         min_inner_block_elems = 2;
-        max_inner_block_elems = 4;
+        max_inner_block_elems = isa >= TransposeKernelIsa::kAvx512 ? 8 : 4;
         break;
       case 16:
         min_inner_block_elems = 1;
@@ -1136,10 +1158,16 @@ void TransposePlan::Initialize() {
       // path.
       inner_block_elems_ = 1;
     }
+    // Macrokernels span at least 16 elements in each direction, or a single
+    // microkernel if those are wider.
+    const int64_t macro_block_elems =
+        std::max<int64_t>(16, inner_block_elems_);
     outer_block_elems_a_ = FloorOfRatio<int64_t>(
-        std::min<int64_t>(16, a_stride1_size), inner_block_elems_);
+        std::min<int64_t>(macro_block_elems, a_stride1_size),
+        inner_block_elems_);
     outer_block_elems_b_ = FloorOfRatio<int64_t>(
-        std::min<int64_t>(16, b_stride1_size), inner_block_elems_);
+        std::min<int64_t>(macro_block_elems, b_stride1_size),
+        inner_block_elems_);
   }
 
   // Loop order heuristic: try to make loops with small strides innermost.
@@ -1358,7 +1386,7 @@ H AbslHashValue(H h, const TransposePlanCacheKey& key) {
 }
 
 TransposePlanCache::TransposePlanCache(int capacity)
-    : lru_list_(capacity), cache_(&lru_list_) {}
+    : cache_(capacity) {}
 
 TransposePlanCache::~TransposePlanCache() = default;
 
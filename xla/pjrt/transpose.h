@@ -105,6 +105,13 @@ class TransposePlan {
                const std::function<void(std::function<void(void)>)>&
                    schedule_work = {}) const;
 
+  // Executes the part of the transposition assigned to `partition`, where
+  // 0 <= partition < Parallelism(). Running every partition exactly once, in
+  // any order and on any threads, is equivalent to calling Execute(). Unlike
+  // Execute(), this never blocks, so callers can fan the partitions out on a
+  // thread pool without tying up a thread waiting for the rest.
+  void ExecutePartition(const void* a, void* b, int partition) const;
+
   // Returns a human-readable description of the plan.
   std::string ToString() const;
 
@@ -162,6 +169,9 @@ class TransposePlan {
   template <typename T, Transformation transformation>
   void ExecuteTyped(const char* a, char* b, absl::Span<Node const> nodes) const;
 
+  // Dispatches to ExecuteTyped based on the element size and transformation.
+  void ExecuteNodes(const void* a, void* b, absl::Span<Node const> nodes) const;
+
   // Number of threads requested.
   int num_threads_requested_ = 1;
 
@@ -245,7 +255,7 @@ struct TransposePlanCacheKey;
 template <typename H>
 H AbslHashValue(H h, const TransposePlanCacheKey& key);
 
-// An LRU cache for transpose plans. Not thread-safe.
+// An LRU cache for transpose plans. Thread-safe.
 // Transpose plans aren't cheap to build, but once computed for a particular set
 // of inputs can be cached and reused for arrays. TransposePlanCache implements
 // such a cache.
@@ -271,9 +281,8 @@ class TransposePlanCache {
       int num_threads = 1);
 
  private:
-  LRUCache<TransposePlanCacheKey,
-           StatusOr<std::shared_ptr<TransposePlan>>>::LRUList lru_list_;
-  LRUCache<TransposePlanCacheKey, StatusOr<std::shared_ptr<TransposePlan>>>
+  ShardedLRUCache<TransposePlanCacheKey,
+                  StatusOr<std::shared_ptr<TransposePlan>>>
       cache_;
 };
 
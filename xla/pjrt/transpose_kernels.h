@@ -16,9 +16,18 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_PJRT_TRANSPOSE_KERNELS_H_
 #define TENSORFLOW_COMPILER_XLA_PJRT_TRANSPOSE_KERNELS_H_
 
+#include <array>
 #include <cstdint>
 
 #include "Eigen/Core"  // from @eigen_archive
+#include "tsl/platform/cpu_info.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+// Kernels for instruction sets beyond the ones the file is compiled for are
+// built with function-level target attributes and selected at runtime.
+#define XLA_TRANSPOSE_HAS_X86_TARGET_KERNELS 1
+#endif
 
 namespace xla {
 
@@ -69,7 +78,36 @@ struct TransposeMicroKernel<uint8_t, /*bs=*/4> {
   }
 };
 
-// TODO(phawkins): add an 8x8 byte transpose kernel.
+template <>
+struct TransposeMicroKernel<uint8_t, /*bs=*/8> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    std::array<__m128i, 8> packet;
+    for (int i = 0; i < 8; ++i) {
+      packet[i] =
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + lda * i));
+    }
+    // 00 10 01 11 02 12 03 13 04 14 05 15 06 16 07 17
+    __m128i t0 = _mm_unpacklo_epi8(packet[0], packet[1]);
+    __m128i t1 = _mm_unpacklo_epi8(packet[2], packet[3]);
+    __m128i t2 = _mm_unpacklo_epi8(packet[4], packet[5]);
+    __m128i t3 = _mm_unpacklo_epi8(packet[6], packet[7]);
+    // 00 10 20 30 01 11 21 31 02 12 22 32 03 13 23 33
+    __m128i s0 = _mm_unpacklo_epi16(t0, t1);
+    __m128i s1 = _mm_unpackhi_epi16(t0, t1);  // 04 14 24 34 ...
+    __m128i s2 = _mm_unpacklo_epi16(t2, t3);  // 40 50 60 70 ...
+    __m128i s3 = _mm_unpackhi_epi16(t2, t3);  // 44 54 64 74 ...
+    // 00 10 20 30 40 50 60 70 01 11 21 31 41 51 61 71
+    std::array<__m128i, 4> u = {
+        _mm_unpacklo_epi32(s0, s2), _mm_unpackhi_epi32(s0, s2),
+        _mm_unpacklo_epi32(s1, s3), _mm_unpackhi_epi32(s1, s3)};
+    for (int i = 0; i < 4; ++i) {
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * (2 * i)), u[i]);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * (2 * i + 1)),
+                       _mm_unpackhi_epi64(u[i], u[i]));
+    }
+  }
+};
 
 // TODO(phawkins): Eigen doesn't have a SSE/AVX byte Packet16c type. Add one
 // and call it here rather than using AVX intrinsics.
@@ -183,7 +221,31 @@ struct TransposeMicroKernel<uint8_t, /*bs=*/16> {
   }
 };
 
-// TODO(phawkins): add an 4x4 uint16_t transpose kernel.
+template <>
+struct TransposeMicroKernel<uint16_t, /*bs=*/4> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    std::array<__m128i, 4> packet;
+    for (int i = 0; i < 4; ++i) {
+      packet[i] =
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + lda * i));
+    }
+    // 00 10 01 11 02 12 03 13
+    __m128i t0 = _mm_unpacklo_epi16(packet[0], packet[1]);
+    // 20 30 21 31 22 32 23 33
+    __m128i t1 = _mm_unpacklo_epi16(packet[2], packet[3]);
+    // 00 10 20 30 01 11 21 31
+    __m128i u0 = _mm_unpacklo_epi32(t0, t1);
+    // 02 12 22 32 03 13 23 33
+    __m128i u1 = _mm_unpackhi_epi32(t0, t1);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 0), u0);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 1),
+                     _mm_unpackhi_epi64(u0, u0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 2), u1);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 3),
+                     _mm_unpackhi_epi64(u1, u1));
+  }
+};
 
 template <>
 struct TransposeMicroKernel<uint16_t, /*bs=*/8> {
@@ -287,6 +349,225 @@ struct TransposeMicroKernel<uint64_t, /*bs=*/4> {
 
 #endif  // EIGEN_VECTORIZE_AVX
 
+// The widest instruction set for which vectorized kernels are available on the
+// host CPU.
+enum class TransposeKernelIsa {
+  kDefault = 0,
+  kAvx2 = 1,
+  kAvx512 = 2,
+};
+
+inline TransposeKernelIsa HostTransposeKernelIsa() {
+#ifdef XLA_TRANSPOSE_HAS_X86_TARGET_KERNELS
+  static const TransposeKernelIsa isa = [] {
+    if (tsl::port::TestCPUFeature(tsl::port::CPUFeature::AVX512F)) {
+      return TransposeKernelIsa::kAvx512;
+    }
+    if (tsl::port::TestCPUFeature(tsl::port::CPUFeature::AVX2)) {
+      return TransposeKernelIsa::kAvx2;
+    }
+    return TransposeKernelIsa::kDefault;
+  }();
+  return isa;
+#else
+  return TransposeKernelIsa::kDefault;
+#endif
+}
+
+#ifdef XLA_TRANSPOSE_HAS_X86_TARGET_KERNELS
+
+// The kernels below are only selected by TransposePlan if
+// HostTransposeKernelIsa() reports that the host supports them. Since they
+// are compiled for a different target than their callers they are never
+// inlined, so they are only provided for block sizes large enough to amortize
+// the call.
+//
+// Each AVX2 kernel treats its block as 2x2 quadrants: the unpack instructions
+// transpose within each 128-bit lane, which transposes the four quadrants in
+// place, and a final cross-lane permute swaps the two off-diagonal quadrants.
+// The AVX-512 kernels do the same with a 4x4 grid of 128-bit lanes.
+
+// Transposes 16x16 bytes within each 128-bit lane of `packet`.
+__attribute__((target("avx2"))) inline void Transpose16x16BytesInLanes(
+    std::array<__m256i, 16>& packet) {
+  std::array<__m256i, 16> t;
+  for (int i = 0; i < 8; ++i) {
+    t[2 * i] = _mm256_unpacklo_epi8(packet[2 * i], packet[2 * i + 1]);
+    t[2 * i + 1] = _mm256_unpackhi_epi8(packet[2 * i], packet[2 * i + 1]);
+  }
+  std::array<__m256i, 16> s;
+  for (int i = 0; i < 4; ++i) {
+    s[4 * i + 0] = _mm256_unpacklo_epi16(t[4 * i + 0], t[4 * i + 2]);
+    s[4 * i + 1] = _mm256_unpackhi_epi16(t[4 * i + 0], t[4 * i + 2]);
+    s[4 * i + 2] = _mm256_unpacklo_epi16(t[4 * i + 1], t[4 * i + 3]);
+    s[4 * i + 3] = _mm256_unpackhi_epi16(t[4 * i + 1], t[4 * i + 3]);
+  }
+  std::array<__m256i, 16> u;
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      u[8 * i + 2 * j] =
+          _mm256_unpacklo_epi32(s[8 * i + j], s[8 * i + j + 4]);
+      u[8 * i + 2 * j + 1] =
+          _mm256_unpackhi_epi32(s[8 * i + j], s[8 * i + j + 4]);
+    }
+  }
+  for (int i = 0; i < 8; ++i) {
+    packet[2 * i] = _mm256_unpacklo_epi64(u[i], u[i + 8]);
+    packet[2 * i + 1] = _mm256_unpackhi_epi64(u[i], u[i + 8]);
+  }
+}
+
+__attribute__((target("avx2"))) inline void TransposeBytes32x32Avx2(
+    const char* __restrict a, int64_t lda, char* __restrict b, int64_t ldb) {
+  std::array<__m256i, 16> top;
+  std::array<__m256i, 16> bottom;
+  for (int i = 0; i < 16; ++i) {
+    top[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + lda * i));
+    bottom[i] = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(a + lda * (i + 16)));
+  }
+  Transpose16x16BytesInLanes(top);
+  Transpose16x16BytesInLanes(bottom);
+  for (int i = 0; i < 16; ++i) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(b + ldb * i),
+                        _mm256_permute2x128_si256(top[i], bottom[i], 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(b + ldb * (i + 16)),
+                        _mm256_permute2x128_si256(top[i], bottom[i], 0x31));
+  }
+}
+
+// Transposes 8x8 16-bit elements within each 128-bit lane of `packet`.
+__attribute__((target("avx2"))) inline void Transpose8x8HalvesInLanes(
+    std::array<__m256i, 8>& packet) {
+  std::array<__m256i, 8> t;
+  for (int i = 0; i < 4; ++i) {
+    t[2 * i] = _mm256_unpacklo_epi16(packet[2 * i], packet[2 * i + 1]);
+    t[2 * i + 1] = _mm256_unpackhi_epi16(packet[2 * i], packet[2 * i + 1]);
+  }
+  std::array<__m256i, 8> s;
+  for (int i = 0; i < 2; ++i) {
+    s[4 * i + 0] = _mm256_unpacklo_epi32(t[4 * i + 0], t[4 * i + 2]);
+    s[4 * i + 1] = _mm256_unpackhi_epi32(t[4 * i + 0], t[4 * i + 2]);
+    s[4 * i + 2] = _mm256_unpacklo_epi32(t[4 * i + 1], t[4 * i + 3]);
+    s[4 * i + 3] = _mm256_unpackhi_epi32(t[4 * i + 1], t[4 * i + 3]);
+  }
+  for (int i = 0; i < 4; ++i) {
+    packet[2 * i] = _mm256_unpacklo_epi64(s[i], s[i + 4]);
+    packet[2 * i + 1] = _mm256_unpackhi_epi64(s[i], s[i + 4]);
+  }
+}
+
+__attribute__((target("avx2"))) inline void TransposeHalves16x16Avx2(
+    const char* __restrict a, int64_t lda, char* __restrict b, int64_t ldb) {
+  std::array<__m256i, 8> top;
+  std::array<__m256i, 8> bottom;
+  for (int i = 0; i < 8; ++i) {
+    top[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + lda * i));
+    bottom[i] = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(a + lda * (i + 8)));
+  }
+  Transpose8x8HalvesInLanes(top);
+  Transpose8x8HalvesInLanes(bottom);
+  for (int i = 0; i < 8; ++i) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(b + ldb * i),
+                        _mm256_permute2x128_si256(top[i], bottom[i], 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(b + ldb * (i + 8)),
+                        _mm256_permute2x128_si256(top[i], bottom[i], 0x31));
+  }
+}
+
+// Given rows[g] holding lanes {g0, g1, g2, g3}, writes lanes {0g, 1g, 2g, 3g}
+// to rows[g], i.e., transposes the 4x4 grid of 128-bit lanes.
+__attribute__((target("avx512f"))) inline void TransposeLanes4x4(
+    std::array<__m512i, 4>& rows) {
+  __m512i t0 = _mm512_shuffle_i32x4(rows[0], rows[1], 0x44);
+  __m512i t1 = _mm512_shuffle_i32x4(rows[0], rows[1], 0xee);
+  __m512i t2 = _mm512_shuffle_i32x4(rows[2], rows[3], 0x44);
+  __m512i t3 = _mm512_shuffle_i32x4(rows[2], rows[3], 0xee);
+  rows[0] = _mm512_shuffle_i32x4(t0, t2, 0x88);
+  rows[1] = _mm512_shuffle_i32x4(t0, t2, 0xdd);
+  rows[2] = _mm512_shuffle_i32x4(t1, t3, 0x88);
+  rows[3] = _mm512_shuffle_i32x4(t1, t3, 0xdd);
+}
+
+__attribute__((target("avx512f"))) inline void TransposeWords16x16Avx512(
+    const char* __restrict a, int64_t lda, char* __restrict b, int64_t ldb) {
+  // by_column[k][g] holds, in lane l, rows 4g..4g+3 of column 4l+k.
+  std::array<std::array<__m512i, 4>, 4> by_column;
+  for (int g = 0; g < 4; ++g) {
+    std::array<__m512i, 4> r;
+    for (int i = 0; i < 4; ++i) {
+      r[i] = _mm512_loadu_si512(a + lda * (4 * g + i));
+    }
+    __m512i t0 = _mm512_unpacklo_epi32(r[0], r[1]);
+    __m512i t1 = _mm512_unpackhi_epi32(r[0], r[1]);
+    __m512i t2 = _mm512_unpacklo_epi32(r[2], r[3]);
+    __m512i t3 = _mm512_unpackhi_epi32(r[2], r[3]);
+    by_column[0][g] = _mm512_unpacklo_epi64(t0, t2);
+    by_column[1][g] = _mm512_unpackhi_epi64(t0, t2);
+    by_column[2][g] = _mm512_unpacklo_epi64(t1, t3);
+    by_column[3][g] = _mm512_unpackhi_epi64(t1, t3);
+  }
+  for (int k = 0; k < 4; ++k) {
+    TransposeLanes4x4(by_column[k]);
+    for (int l = 0; l < 4; ++l) {
+      _mm512_storeu_si512(b + ldb * (4 * l + k), by_column[k][l]);
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) inline void TransposeDoubleWords8x8Avx512(
+    const char* __restrict a, int64_t lda, char* __restrict b, int64_t ldb) {
+  // by_column[k][g] holds, in lane l, rows 2g..2g+1 of column 2l+k.
+  std::array<std::array<__m512i, 4>, 2> by_column;
+  for (int g = 0; g < 4; ++g) {
+    __m512i r0 = _mm512_loadu_si512(a + lda * (2 * g));
+    __m512i r1 = _mm512_loadu_si512(a + lda * (2 * g + 1));
+    by_column[0][g] = _mm512_unpacklo_epi64(r0, r1);
+    by_column[1][g] = _mm512_unpackhi_epi64(r0, r1);
+  }
+  for (int k = 0; k < 2; ++k) {
+    TransposeLanes4x4(by_column[k]);
+    for (int l = 0; l < 4; ++l) {
+      _mm512_storeu_si512(b + ldb * (2 * l + k), by_column[k][l]);
+    }
+  }
+}
+
+template <>
+struct TransposeMicroKernel<uint8_t, /*bs=*/32> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    TransposeBytes32x32Avx2(a, lda, b, ldb);
+  }
+};
+
+template <>
+struct TransposeMicroKernel<uint16_t, /*bs=*/16> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    TransposeHalves16x16Avx2(a, lda, b, ldb);
+  }
+};
+
+template <>
+struct TransposeMicroKernel<uint32_t, /*bs=*/16> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    TransposeWords16x16Avx512(a, lda, b, ldb);
+  }
+};
+
+template <>
+struct TransposeMicroKernel<uint64_t, /*bs=*/8> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    TransposeDoubleWords8x8Avx512(a, lda, b, ldb);
+  }
+};
+
+#endif  // XLA_TRANSPOSE_HAS_X86_TARGET_KERNELS
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_PJRT_TRANSPOSE_KERNELS_H_
@@ -26,6 +26,7 @@ limitations under the License.
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "xla/array.h"
 #include "xla/permutation_util.h"
+#include "xla/pjrt/transpose_kernels.h"
 #include "xla/shape_util.h"
 #include "xla/test.h"
 #include "xla/util.h"
@@ -298,6 +299,9 @@ std::vector<TransposeTestCase> GetTransposeTestCases() {
       TransposeTestCase(/*dims=*/{8, 8}, /*permutation=*/{1, 0}),
       TransposeTestCase(/*dims=*/{16, 16}, /*permutation=*/{0, 1}),
       TransposeTestCase(/*dims=*/{16, 16}, /*permutation=*/{1, 0}),
+      TransposeTestCase(/*dims=*/{32, 32}, /*permutation=*/{1, 0}),
+      TransposeTestCase(/*dims=*/{40, 72}, /*permutation=*/{1, 0}),
+      TransposeTestCase(/*dims=*/{97, 67}, /*permutation=*/{1, 0}),
       TransposeTestCase(/*dims=*/{11, 15}, /*permutation=*/{0, 1}),
       TransposeTestCase(/*dims=*/{11, 15}, /*permutation=*/{1, 0}),
       TransposeTestCase(/*dims=*/{11, 15, 13}, /*permutation=*/{0, 1, 2}),
@@ -391,11 +395,57 @@ TEST_P(TransposeTest, TransposeInt64) { TestTranspose<int64_t>(1); }
 TEST_P(TransposeTest, TransposeInt128) { TestTranspose<absl::int128>(1); }
 
 TEST_P(TransposeTest, ParallelTransposeInt8) { TestTranspose<int8_t>(16); }
+TEST_P(TransposeTest, ParallelTransposeInt16) { TestTranspose<int16_t>(16); }
 TEST_P(TransposeTest, ParallelTransposeInt32) { TestTranspose<int32_t>(16); }
 
 INSTANTIATE_TEST_SUITE_P(TransposeTestInstance, TransposeTest,
                          ::testing::ValuesIn(GetTransposeTestCases()));
 
+// Checks a single microkernel against a scalar transpose, using strides that
+// are wider than the block so that out-of-block writes would be caught.
+template <typename T, int bs>
+void TestMicroKernel() {
+  SCOPED_TRACE(absl::StrCat("sizeof(T)=", sizeof(T), " bs=", bs));
+  constexpr int64_t kLda = bs + 3;
+  constexpr int64_t kLdb = bs + 5;
+  std::vector<T> a(bs * kLda);
+  for (int64_t i = 0; i < a.size(); ++i) {
+    a[i] = static_cast<T>(i * 7 + 1);
+  }
+  std::vector<T> expected(bs * kLdb, 0);
+  for (int i = 0; i < bs; ++i) {
+    for (int j = 0; j < bs; ++j) {
+      expected[i * kLdb + j] = a[j * kLda + i];
+    }
+  }
+  std::vector<T> b(bs * kLdb, 0);
+  TransposeMicroKernel<T, bs>::Apply(
+      reinterpret_cast<const char*>(a.data()), kLda * sizeof(T),
+      reinterpret_cast<char*>(b.data()), kLdb * sizeof(T));
+  EXPECT_EQ(b, expected);
+}
+
+TEST(TransposeTest, MicroKernels) {
+  TestMicroKernel<uint8_t, 4>();
+  TestMicroKernel<uint8_t, 8>();
+  TestMicroKernel<uint8_t, 16>();
+  TestMicroKernel<uint16_t, 4>();
+  TestMicroKernel<uint16_t, 8>();
+  TestMicroKernel<uint32_t, 4>();
+  TestMicroKernel<uint32_t, 8>();
+  TestMicroKernel<uint64_t, 2>();
+  TestMicroKernel<uint64_t, 4>();
+  // The wider kernels may only run on hosts that support them.
+  if (HostTransposeKernelIsa() >= TransposeKernelIsa::kAvx2) {
+    TestMicroKernel<uint8_t, 32>();
+    TestMicroKernel<uint16_t, 16>();
+  }
+  if (HostTransposeKernelIsa() >= TransposeKernelIsa::kAvx512) {
+    TestMicroKernel<uint32_t, 16>();
+    TestMicroKernel<uint64_t, 8>();
+  }
+}
+
 TEST(TransposeTest, NegativeStrides1D) {
   int64_t n = 10;
   std::vector<int32_t> input(n);
@@ -481,6 +531,8 @@ void BM_Eigen(const TransposeTestCase& bm, int parallelism,
                         bm.permutation);
     tsl::testing::DoNotOptimize(output);
   }
+  state.SetBytesProcessed(state.iterations() * input.num_elements() *
+                          sizeof(T));
 }
 static void BM_Eigen_uint8(const TransposeTestCase& bm, int parallelism,
                            ::testing::benchmark::State& state) {
@@ -511,15 +563,25 @@ void BM_Transpose(const TransposeTestCase& bm, int parallelism,
     });
     tsl::testing::DoNotOptimize(output);
   }
+  state.SetBytesProcessed(state.iterations() * input.num_elements() *
+                          sizeof(T));
 }
 static void BM_Transpose_uint8(const TransposeTestCase& bm, int parallelism,
                                ::testing::benchmark::State& state) {
   BM_Transpose<uint8_t>(bm, parallelism, state);
 }
+static void BM_Transpose_uint16(const TransposeTestCase& bm, int parallelism,
+                                ::testing::benchmark::State& state) {
+  BM_Transpose<uint16_t>(bm, parallelism, state);
+}
 static void BM_Transpose_float(const TransposeTestCase& bm, int parallelism,
                                ::testing::benchmark::State& state) {
   BM_Transpose<float>(bm, parallelism, state);
 }
+static void BM_Transpose_uint64(const TransposeTestCase& bm, int parallelism,
+                                ::testing::benchmark::State& state) {
+  BM_Transpose<uint64_t>(bm, parallelism, state);
+}
 
 static void* benchmarks = []() {
   using BenchmarkFn =
@@ -528,8 +590,10 @@ static void* benchmarks = []() {
       {
           {"BM_Eigen_uint8", BM_Eigen_uint8, {1}},
           {"BM_Transpose_uint8", BM_Transpose_uint8, {1, 4, 8}},  //
+          {"BM_Transpose_uint16", BM_Transpose_uint16, {1, 4, 8}},  //
           {"BM_Eigen_float", BM_Eigen_float, {1}},
           {"BM_Transpose_float", BM_Transpose_float, {1, 4, 8}},  //
+          {"BM_Transpose_uint64", BM_Transpose_uint64, {1, 4, 8}},  //
   };
   auto benchmark_cases = BenchmarkCases();
   for (const auto& benchmark_case : benchmark_cases) {
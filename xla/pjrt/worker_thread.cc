@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "xla/pjrt/worker_thread.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace xla {
 
 WorkerThread::WorkerThread(tsl::Env* env, const std::string& name) {
@@ -51,4 +54,87 @@ void WorkerThread::WorkLoop() {
   }
 }
 
+WorkerThreadPool::WorkerThreadPool(tsl::Env* env, const std::string& name,
+                                   int num_threads, int max_batch_size)
+    : num_threads_(num_threads), max_batch_size_(max_batch_size) {
+  CHECK_GT(num_threads, 0);
+  CHECK_GT(max_batch_size, 0);
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(env->StartThread(tsl::ThreadOptions(), name,
+                                           [this]() { WorkLoop(); }));
+  }
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+  {
+    absl::MutexLock lock(&mu_);
+    shutting_down_ = true;
+  }
+  // Joins the workers, which exit once both lanes are empty.
+  threads_.clear();
+}
+
+void WorkerThreadPool::Schedule(std::function<void()> fn, Priority priority) {
+  CHECK(fn != nullptr);
+  Task task{std::move(fn), absl::Now()};
+  absl::MutexLock lock(&mu_);
+  CHECK(!shutting_down_);
+  if (priority == Priority::kHigh) {
+    high_priority_queue_.push_back(std::move(task));
+  } else {
+    low_priority_queue_.push_back(std::move(task));
+  }
+}
+
+WorkerThreadPool::Stats WorkerThreadPool::GetStats() const {
+  absl::MutexLock lock(&mu_);
+  Stats stats = stats_;
+  stats.high_priority_queue_depth = high_priority_queue_.size();
+  stats.low_priority_queue_depth = low_priority_queue_.size();
+  return stats;
+}
+
+bool WorkerThreadPool::WorkAvailableOrShuttingDown() const {
+  return !high_priority_queue_.empty() || !low_priority_queue_.empty() ||
+         shutting_down_;
+}
+
+void WorkerThreadPool::WorkLoop() {
+  std::vector<std::function<void()>> batch;
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(
+          this, &WorkerThreadPool::WorkAvailableOrShuttingDown));
+      int64_t num_queued =
+          high_priority_queue_.size() + low_priority_queue_.size();
+      if (num_queued == 0) {
+        // Shutting down and nothing left to run.
+        return;
+      }
+      int64_t batch_size = std::clamp<int64_t>(
+          num_queued / num_threads_, 1, max_batch_size_);
+      absl::Time now = absl::Now();
+      for (std::deque<Task>* queue :
+           {&high_priority_queue_, &low_priority_queue_}) {
+        while (!queue->empty() &&
+               static_cast<int64_t>(batch.size()) < batch_size) {
+          absl::Duration wait_time = now - queue->front().enqueue_time;
+          stats_.total_wait_time += wait_time;
+          stats_.max_wait_time = std::max(stats_.max_wait_time, wait_time);
+          batch.push_back(std::move(queue->front().fn));
+          queue->pop_front();
+        }
+      }
+      stats_.num_dequeued += batch.size();
+      ++stats_.num_batches;
+    }
+    for (std::function<void()>& fn : batch) {
+      fn();
+    }
+    batch.clear();
+  }
+}
+
 }  // namespace xla
@@ -16,12 +16,16 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_PJRT_WORKER_THREAD_H_
 #define TENSORFLOW_COMPILER_XLA_PJRT_WORKER_THREAD_H_
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <queue>
 #include <string>
+#include <vector>
 
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "tsl/platform/env.h"
 
 namespace xla {
@@ -49,6 +53,65 @@ class WorkerThread {
   std::unique_ptr<tsl::Thread> thread_;
 };
 
+// A pool of worker threads that run closures from two priority lanes. Workers
+// always drain the high-priority lane before the low-priority one, and closures
+// within a lane are started in the order they were scheduled. With a single
+// worker the pool is a drop-in replacement for WorkerThread.
+//
+// Workers dequeue closures in batches, which reduces contention on the queue
+// mutex when many small closures are scheduled.
+class WorkerThreadPool {
+ public:
+  enum class Priority { kHigh, kLow };
+
+  struct Stats {
+    // Closures currently waiting in each lane.
+    int64_t high_priority_queue_depth = 0;
+    int64_t low_priority_queue_depth = 0;
+    // Closures dequeued by a worker so far, and the number of batches they
+    // were dequeued in.
+    int64_t num_dequeued = 0;
+    int64_t num_batches = 0;
+    // Time the dequeued closures spent in the queue, summed and maximum.
+    absl::Duration total_wait_time;
+    absl::Duration max_wait_time;
+  };
+
+  // 'name' is a name for the threads for debugging purposes. A worker dequeues
+  // at most 'max_batch_size' closures at a time, and no more than its share of
+  // the queued closures so that the other workers are not left idle.
+  WorkerThreadPool(tsl::Env* env, const std::string& name, int num_threads,
+                   int max_batch_size = 16);
+
+  // Blocks until all enqueued closures have completed.
+  ~WorkerThreadPool();
+
+  // Adds 'fn' to the lane for 'priority'.
+  void Schedule(std::function<void()> fn, Priority priority = Priority::kHigh);
+
+  Stats GetStats() const;
+
+ private:
+  struct Task {
+    std::function<void()> fn;
+    absl::Time enqueue_time;
+  };
+
+  bool WorkAvailableOrShuttingDown() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void WorkLoop();
+
+  const int num_threads_;
+  const int max_batch_size_;
+
+  mutable absl::Mutex mu_;
+  std::deque<Task> high_priority_queue_ ABSL_GUARDED_BY(mu_);
+  std::deque<Task> low_priority_queue_ ABSL_GUARDED_BY(mu_);
+  bool shutting_down_ ABSL_GUARDED_BY(mu_) = false;
+  Stats stats_ ABSL_GUARDED_BY(mu_);
+
+  std::vector<std::unique_ptr<tsl::Thread>> threads_;
+};
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_PJRT_WORKER_THREAD_H_
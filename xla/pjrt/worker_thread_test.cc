@@ -0,0 +1,135 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/worker_thread.h"
+
+#include <atomic>
+#include <vector>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "xla/test.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test_benchmark.h"
+
+namespace xla {
+namespace {
+
+TEST(WorkerThreadPoolTest, RunsAllClosures) {
+  std::atomic<int> count = 0;
+  {
+    WorkerThreadPool pool(tsl::Env::Default(), "test", /*num_threads=*/4);
+    for (int i = 0; i < 1000; ++i) {
+      pool.Schedule([&]() { ++count; },
+                    i % 2 ? WorkerThreadPool::Priority::kHigh
+                          : WorkerThreadPool::Priority::kLow);
+    }
+  }
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(WorkerThreadPoolTest, HighPriorityClosuresRunFirst) {
+  WorkerThreadPool pool(tsl::Env::Default(), "test", /*num_threads=*/1);
+  absl::Notification started;
+  absl::Notification unblock;
+  pool.Schedule([&]() {
+    started.Notify();
+    unblock.WaitForNotification();
+  });
+  started.WaitForNotification();
+
+  absl::Mutex mu;
+  std::vector<int> order;
+  absl::BlockingCounter done(4);
+  auto record = [&](int i) {
+    return [&, i]() {
+      {
+        absl::MutexLock lock(&mu);
+        order.push_back(i);
+      }
+      done.DecrementCount();
+    };
+  };
+  pool.Schedule(record(0), WorkerThreadPool::Priority::kLow);
+  pool.Schedule(record(1), WorkerThreadPool::Priority::kHigh);
+  pool.Schedule(record(2), WorkerThreadPool::Priority::kLow);
+  pool.Schedule(record(3), WorkerThreadPool::Priority::kHigh);
+
+  WorkerThreadPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.high_priority_queue_depth, 2);
+  EXPECT_EQ(stats.low_priority_queue_depth, 2);
+
+  unblock.Notify();
+  done.Wait();
+  EXPECT_EQ(order, (std::vector<int>{1, 3, 0, 2}));
+
+  stats = pool.GetStats();
+  EXPECT_EQ(stats.high_priority_queue_depth, 0);
+  EXPECT_EQ(stats.low_priority_queue_depth, 0);
+  EXPECT_EQ(stats.num_dequeued, 5);
+  // The four closures queued behind the blocking one are dequeued together.
+  EXPECT_EQ(stats.num_batches, 2);
+  EXPECT_GE(stats.total_wait_time, stats.max_wait_time);
+}
+
+TEST(WorkerThreadPoolTest, SlowClosureDoesNotBlockOtherWorkers) {
+  WorkerThreadPool pool(tsl::Env::Default(), "test", /*num_threads=*/2);
+  absl::Notification unblock;
+  pool.Schedule([&]() { unblock.WaitForNotification(); });
+  absl::Notification ran;
+  pool.Schedule([&]() { ran.Notify(); });
+  ran.WaitForNotification();
+  unblock.Notify();
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below.
+//===----------------------------------------------------------------------===//
+
+constexpr int kBenchmarkNumClosures = 1000;
+
+void BM_WorkerThreadSchedule(::testing::benchmark::State& state) {
+  WorkerThread thread(tsl::Env::Default(), "benchmark");
+  for (auto s : state) {
+    absl::BlockingCounter done(kBenchmarkNumClosures);
+    for (int i = 0; i < kBenchmarkNumClosures; ++i) {
+      thread.Schedule([&]() { done.DecrementCount(); });
+    }
+    done.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * kBenchmarkNumClosures);
+}
+BENCHMARK(BM_WorkerThreadSchedule)->UseRealTime();
+
+void BM_WorkerThreadPoolSchedule(::testing::benchmark::State& state) {
+  WorkerThreadPool pool(tsl::Env::Default(), "benchmark",
+                        /*num_threads=*/state.range(0),
+                        /*max_batch_size=*/state.range(1));
+  for (auto s : state) {
+    absl::BlockingCounter done(kBenchmarkNumClosures);
+    for (int i = 0; i < kBenchmarkNumClosures; ++i) {
+      pool.Schedule([&]() { done.DecrementCount(); });
+    }
+    done.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * kBenchmarkNumClosures);
+}
+BENCHMARK(BM_WorkerThreadPoolSchedule)
+    ->ArgsProduct({{1, 2, 4}, {1, 16}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace xla
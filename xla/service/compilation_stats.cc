@@ -15,14 +15,26 @@ limitations under the License.
 
 #include "xla/service/compilation_stats.h"
 
+#include <algorithm>
+#include <ctime>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "xla/types.h"
 #include "tsl/platform/env.h"
+#include "tsl/profiler/lib/traceme_encode.h"
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
 
 namespace xla {
 
@@ -140,4 +152,155 @@ void Stats::CompilationReport() {
 
 int Stats::GetPassesSize() { return passes_.size(); }
 
+namespace {
+
+// CPU time used by all threads of the process.
+uint64_t ProcessCpuMicros() {
+  return static_cast<uint64_t>(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+}
+
+// Peak resident set size of the process, or 0 where it is not known.
+int64_t PeakRssBytes() {
+#if defined(__linux__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return static_cast<int64_t>(usage.ru_maxrss) * 1024;  // In KiB on Linux.
+  }
+#endif
+  return 0;
+}
+
+}  // namespace
+
+void PassProfilingStats::StartPass(absl::string_view pass_name) {
+  CHECK(!current_.has_value()) << "Can't start " << pass_name
+                               << " while running " << current_->pass_name();
+  current_.emplace();
+  current_->set_pass_name(std::string(pass_name));
+  current_->set_start_timestamp_usec(tsl::Env::Default()->NowMicros());
+  start_cpu_micros_ = ProcessCpuMicros();
+  start_peak_rss_bytes_ = PeakRssBytes();
+  trace_me_.emplace([name = std::string(pass_name)] {
+    return absl::StrCat("HloPass:", name);
+  });
+}
+
+void PassProfilingStats::RecordPassRunDetails(absl::string_view pass_name,
+                                              const PassRunDetails& details) {
+  CHECK(current_.has_value());
+  CHECK_EQ(current_->pass_name(), pass_name);
+  current_->set_instruction_count_before(details.instruction_count_before);
+  current_->set_instruction_count_after(details.instruction_count_after);
+  current_->set_module_changed(details.module_changed);
+  current_->set_fixed_point_iterations(details.fixed_point_iterations);
+}
+
+void PassProfilingStats::EndPass(absl::string_view pass_name) {
+  CHECK(current_.has_value());
+  CHECK_EQ(current_->pass_name(), pass_name);
+  FinishPass(pass_name);
+}
+
+void PassProfilingStats::RecordPassError(absl::string_view pass_name,
+                                         absl::string_view err) {
+  // Invariant checkers run before the pass they checked has ended, so their
+  // errors are recorded as errors of that pass. Errors of a nested pipeline,
+  // or of the checkers run after it, are reported under the pipeline's name,
+  // which has no profile; the passes inside it have ended by then.
+  if (!current_.has_value() || current_->pass_name() != pass_name) {
+    return;
+  }
+  current_->set_error(std::string(err));
+  FinishPass(pass_name);
+}
+
+void PassProfilingStats::FinishPass(absl::string_view pass_name) {
+  HloPassProfile& profile = *current_;
+  profile.set_wall_time_usec(tsl::Env::Default()->NowMicros() -
+                             profile.start_timestamp_usec());
+  profile.set_cpu_time_usec(ProcessCpuMicros() - start_cpu_micros_);
+  profile.set_peak_rss_delta_bytes(PeakRssBytes() - start_peak_rss_bytes_);
+  trace_me_->AppendMetadata([&] {
+    return tsl::profiler::TraceMeEncode(
+        {{"changed", static_cast<int>(profile.module_changed())},
+         {"instructions_before", profile.instruction_count_before()},
+         {"instructions_after", profile.instruction_count_after()},
+         {"fixed_point_iterations", profile.fixed_point_iterations()},
+         {"cpu_time_usec", profile.cpu_time_usec()},
+         {"peak_rss_delta_bytes", profile.peak_rss_delta_bytes()}});
+  });
+  trace_me_.reset();
+  *profiles_.add_passes() = std::move(profile);
+  current_.reset();
+}
+
+void PassProfilingStats::CompilationReport() {
+  CHECK(!current_.has_value())
+      << "EndPass never called for " << current_->pass_name();
+  struct Summary {
+    std::string name;
+    int64_t num_runs = 0;
+    int64_t num_changed = 0;
+    int64_t fixed_point_iterations = 0;
+    int64_t wall_time_usec = 0;
+    int64_t cpu_time_usec = 0;
+    int64_t peak_rss_delta_bytes = 0;
+  };
+  absl::flat_hash_map<std::string, Summary> summaries;
+  int64_t total_wall_time_usec = 0;
+  for (const HloPassProfile& profile : profiles_.passes()) {
+    Summary& summary = summaries[profile.pass_name()];
+    summary.name = profile.pass_name();
+    ++summary.num_runs;
+    summary.num_changed += profile.module_changed();
+    summary.fixed_point_iterations += profile.fixed_point_iterations();
+    summary.wall_time_usec += profile.wall_time_usec();
+    summary.cpu_time_usec += profile.cpu_time_usec();
+    summary.peak_rss_delta_bytes += profile.peak_rss_delta_bytes();
+    total_wall_time_usec += profile.wall_time_usec();
+  }
+
+  std::vector<Summary> sorted_summaries;
+  sorted_summaries.reserve(summaries.size());
+  for (auto& it : summaries) {
+    sorted_summaries.push_back(std::move(it.second));
+  }
+  absl::c_sort(sorted_summaries, [](const Summary& a, const Summary& b) {
+    // Sort passes that take the longest first, break ties using pass names.
+    return std::make_pair(b.wall_time_usec, a.name) <
+           std::make_pair(a.wall_time_usec, b.name);
+  });
+  LOG(INFO) << "Total runtime (ms) of HLO passes: "
+            << total_wall_time_usec / 1000.0;
+  LOG(INFO) << "Pass name, num runs, num changed, fixed point iterations, "
+               "time (ms), cpu time (ms), peak rss growth (MiB)";
+  for (const Summary& summary : sorted_summaries) {
+    LOG(INFO) << summary.name << ", " << summary.num_runs << ", "
+              << summary.num_changed << ", " << summary.fixed_point_iterations
+              << ", " << summary.wall_time_usec / 1000.0 << ", "
+              << summary.cpu_time_usec / 1000.0 << ", "
+              << summary.peak_rss_delta_bytes / (1024.0 * 1024.0);
+  }
+}
+
+std::string PassProfilingStats::ToCsv() const {
+  std::vector<std::string> lines;
+  lines.reserve(profiles_.passes_size() + 1);
+  lines.push_back(
+      "pass_name,start_timestamp_usec,wall_time_usec,cpu_time_usec,"
+      "peak_rss_delta_bytes,instruction_count_before,instruction_count_after,"
+      "module_changed,fixed_point_iterations,error");
+  for (const HloPassProfile& profile : profiles_.passes()) {
+    lines.push_back(absl::StrCat(
+        profile.pass_name(), ",", profile.start_timestamp_usec(), ",",
+        profile.wall_time_usec(), ",", profile.cpu_time_usec(), ",",
+        profile.peak_rss_delta_bytes(), ",",
+        profile.instruction_count_before(), ",",
+        profile.instruction_count_after(), ",",
+        profile.module_changed() ? "true" : "false", ",",
+        profile.fixed_point_iterations(), ",", profile.error()));
+  }
+  return absl::StrCat(absl::StrJoin(lines, "\n"), "\n");
+}
+
 }  // namespace xla
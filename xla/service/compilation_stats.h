@@ -16,11 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_COMPILATION_STATS_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_COMPILATION_STATS_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "xla/service/hlo.pb.h"
+#include "tsl/profiler/lib/traceme.h"
 
 namespace xla {
 
@@ -47,6 +51,63 @@ class CompilationStats {
 
   virtual void RecordPassError(absl::string_view pass_name,
                                absl::string_view err) = 0;
+
+  // What HloPassPipeline knows about a pass run besides its timing.
+  struct PassRunDetails {
+    int64_t instruction_count_before = 0;
+    int64_t instruction_count_after = 0;
+    bool module_changed = false;
+    // How often HloPassFix ran the pass to reach a fixed point; 0 if the pass
+    // does not iterate.
+    int64_t fixed_point_iterations = 0;
+  };
+
+  // Called by HloPassPipeline right before EndPass. Ignored by default.
+  virtual void RecordPassRunDetails(absl::string_view pass_name,
+                                    const PassRunDetails& details) {}
+};
+
+// Collects a compile-time and memory profile of every pass run: wall time,
+// CPU time of the process, growth of the peak resident set size, instruction
+// counts before and after, whether the module changed and how often HloPassFix
+// reran the pass. Each run is also emitted as a profiler trace event, and the
+// profiles can be exported as a proto or as CSV.
+class PassProfilingStats : public CompilationStats {
+ public:
+  PassProfilingStats() = default;
+
+  void StartPass(absl::string_view pass_name) override;
+
+  void EndPass(absl::string_view pass_name) override;
+
+  void RecordPassRunDetails(absl::string_view pass_name,
+                            const PassRunDetails& details) override;
+
+  // Logs the passes with their total times, sorted by wall time.
+  void CompilationReport() override;
+
+  int GetPassesSize() override { return profiles_.passes_size(); }
+
+  // Ends the running pass, which will not get an EndPass call.
+  void RecordPassError(absl::string_view pass_name,
+                       absl::string_view err) override;
+
+  // One entry per pass run, in the order the passes were started.
+  const HloPassProfiles& profiles() const { return profiles_; }
+
+  // Returns the profiles as CSV, with a header line.
+  std::string ToCsv() const;
+
+ private:
+  void FinishPass(absl::string_view pass_name);
+
+  HloPassProfiles profiles_;
+
+  // State of the running pass.
+  std::optional<HloPassProfile> current_;
+  std::optional<tsl::profiler::TraceMe> trace_me_;
+  uint64_t start_cpu_micros_ = 0;
+  int64_t start_peak_rss_bytes_ = 0;
 };
 
 }  // namespace xla
@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/buffer_table_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/dynamic_annotations.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/cpu_function_runtime.h"
+#include "xla/util.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/mem.h"
+
+namespace xla {
+namespace cpu {
+
+// Idle slabs of an arena. Shared between the arena and its checked-out slabs
+// so that a slab can always be returned, even while the arena is being torn
+// down.
+struct BufferTableArena::Slab::FreeList {
+  explicit FreeList(int64_t max_cached_slabs)
+      : max_cached_slabs(max_cached_slabs) {}
+
+  ~FreeList() {
+    for (uint8_t* slab : slabs) {
+      tsl::port::AlignedFree(slab);
+    }
+  }
+
+  const int64_t max_cached_slabs;
+  absl::Mutex mu;
+  std::vector<uint8_t*> slabs ABSL_GUARDED_BY(mu);
+};
+
+BufferTableArena::Slab::~Slab() {
+  {
+    absl::MutexLock lock(&free_list_->mu);
+    if (static_cast<int64_t>(free_list_->slabs.size()) <
+        free_list_->max_cached_slabs) {
+      free_list_->slabs.push_back(data_);
+      return;
+    }
+  }
+  tsl::port::AlignedFree(data_);
+}
+
+BufferTableArena::BufferTableArena(
+    absl::Span<const BufferAllocation> allocations, int64_t max_cached_slabs)
+    : offsets_(allocations.size(), -1),
+      free_list_(std::make_shared<Slab::FreeList>(max_cached_slabs)) {
+  for (const BufferAllocation& allocation : allocations) {
+    if (!allocation.IsPreallocatedTempBuffer()) {
+      continue;
+    }
+    offsets_[allocation.index()] = slab_size_;
+    slab_size_ += RoundUpTo<int64_t>(allocation.size(),
+                                     cpu_function_runtime::Align());
+  }
+  VLOG(3) << "Buffer table arena with slabs of " << slab_size_ << " bytes";
+}
+
+BufferTableArena::~BufferTableArena() = default;
+
+StatusOr<std::shared_ptr<BufferTableArena::Slab>> BufferTableArena::Acquire() {
+  uint8_t* data = nullptr;
+  {
+    absl::MutexLock lock(&free_list_->mu);
+    if (!free_list_->slabs.empty()) {
+      data = free_list_->slabs.back();
+      free_list_->slabs.pop_back();
+    }
+  }
+  if (data == nullptr) {
+    // AlignedMalloc may return nullptr for a zero-sized request, which would
+    // be indistinguishable from running out of memory.
+    int64_t size = std::max<int64_t>(slab_size_, cpu_function_runtime::Align());
+    data = static_cast<uint8_t*>(
+        tsl::port::AlignedMalloc(size, cpu_function_runtime::Align()));
+    if (data == nullptr) {
+      return ResourceExhausted("Out of memory allocating %d bytes.", size);
+    }
+    // The JITed code writes the temporary buffers before reading them, but
+    // msan has no way of knowing that.
+    ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(data, size);
+  }
+  return std::shared_ptr<Slab>(new Slab(free_list_, data, offsets_));
+}
+
+}  // namespace cpu
+}  // namespace xla
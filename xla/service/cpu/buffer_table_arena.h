@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_BUFFER_TABLE_ARENA_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_BUFFER_TABLE_ARENA_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/statusor.h"
+
+namespace xla {
+namespace cpu {
+
+// Pools contiguous slabs that hold all preallocated temporary buffers of a
+// buffer assignment, so that running a CPU executable does not have to allocate
+// and free every temporary buffer on every run.
+//
+// The offset of every temporary buffer within a slab is fixed when the arena is
+// created, so handing out a buffer is pointer arithmetic on a slab and needs no
+// synchronization. A slab is checked out for the duration of a single run and
+// goes back to the arena once the run drops its last reference to it, so
+// concurrent runs never share a slab.
+//
+// This class is thread-safe.
+class BufferTableArena {
+ public:
+  // A slab checked out of the arena.
+  class Slab {
+   public:
+    ~Slab();
+
+    Slab(const Slab&) = delete;
+    Slab& operator=(const Slab&) = delete;
+
+    // Returns the memory backing the temporary allocation `index`.
+    // REQUIRES: arena.Contains(index).
+    void* Get(BufferAllocation::Index index) const {
+      return data_ + offsets_[index];
+    }
+
+   private:
+    friend class BufferTableArena;
+    struct FreeList;
+
+    Slab(std::shared_ptr<FreeList> free_list, uint8_t* data,
+         absl::Span<const int64_t> offsets)
+        : free_list_(std::move(free_list)), data_(data), offsets_(offsets) {}
+
+    std::shared_ptr<FreeList> free_list_;
+    uint8_t* data_;
+    absl::Span<const int64_t> offsets_;
+  };
+
+  // Creates an arena for `allocations`. At most `max_cached_slabs` idle slabs
+  // are kept for reuse; slabs returned beyond that are freed.
+  explicit BufferTableArena(absl::Span<const BufferAllocation> allocations,
+                            int64_t max_cached_slabs = 4);
+  ~BufferTableArena();
+
+  BufferTableArena(const BufferTableArena&) = delete;
+  BufferTableArena& operator=(const BufferTableArena&) = delete;
+
+  // Returns whether allocation `index` is served from the arena.
+  bool Contains(BufferAllocation::Index index) const {
+    return offsets_[index] >= 0;
+  }
+
+  // Checks out a slab that no other run is using. The slab may be released
+  // after the arena is destroyed, but Slab::Get must not be called by then.
+  StatusOr<std::shared_ptr<Slab>> Acquire();
+
+  // Size in bytes of a single slab.
+  int64_t slab_size() const { return slab_size_; }
+
+ private:
+  // Offset of each allocation within a slab, or -1 if the allocation is not
+  // served from the arena.
+  std::vector<int64_t> offsets_;
+  int64_t slab_size_ = 0;
+
+  std::shared_ptr<Slab::FreeList> free_list_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_BUFFER_TABLE_ARENA_H_
@@ -0,0 +1,95 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/buffer_table_arena.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "xla/cpu_function_runtime.h"
+#include "xla/service/buffer_assignment.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Returns allocations 0 and 2 as temporary buffers and allocation 1 as an
+// output, which must not be served from the arena.
+std::vector<BufferAllocation> MakeAllocations() {
+  std::vector<BufferAllocation> allocations;
+  allocations.emplace_back(/*index=*/0, /*size=*/100, /*color=*/0);
+  allocations.emplace_back(/*index=*/1, /*size=*/200, /*color=*/0);
+  allocations.back().set_maybe_live_out(true);
+  allocations.emplace_back(/*index=*/2, /*size=*/300, /*color=*/0);
+  return allocations;
+}
+
+TEST(BufferTableArenaTest, ServesOnlyTemporaryBuffers) {
+  std::vector<BufferAllocation> allocations = MakeAllocations();
+  BufferTableArena arena(allocations);
+  EXPECT_TRUE(arena.Contains(0));
+  EXPECT_FALSE(arena.Contains(1));
+  EXPECT_TRUE(arena.Contains(2));
+  EXPECT_EQ(arena.slab_size(), 128 + 320);
+}
+
+TEST(BufferTableArenaTest, SlicesAreAlignedAndDisjoint) {
+  std::vector<BufferAllocation> allocations = MakeAllocations();
+  BufferTableArena arena(allocations);
+  auto slab = arena.Acquire().value();
+  auto* first = static_cast<char*>(slab->Get(0));
+  auto* second = static_cast<char*>(slab->Get(2));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % cpu_function_runtime::Align(),
+            0);
+  EXPECT_EQ(
+      reinterpret_cast<uintptr_t>(second) % cpu_function_runtime::Align(), 0);
+  EXPECT_GE(second - first, 100);
+}
+
+TEST(BufferTableArenaTest, ReusesReleasedSlabs) {
+  std::vector<BufferAllocation> allocations = MakeAllocations();
+  BufferTableArena arena(allocations);
+  void* data = nullptr;
+  {
+    auto slab = arena.Acquire().value();
+    data = slab->Get(0);
+  }
+  auto slab = arena.Acquire().value();
+  EXPECT_EQ(slab->Get(0), data);
+}
+
+TEST(BufferTableArenaTest, ConcurrentRunsGetDistinctSlabs) {
+  std::vector<BufferAllocation> allocations = MakeAllocations();
+  BufferTableArena arena(allocations);
+  auto first = arena.Acquire().value();
+  auto second = arena.Acquire().value();
+  EXPECT_NE(first->Get(0), second->Get(0));
+}
+
+TEST(BufferTableArenaTest, SlabMayOutliveArena) {
+  std::vector<BufferAllocation> allocations = MakeAllocations();
+  auto arena = std::make_unique<BufferTableArena>(allocations,
+                                                  /*max_cached_slabs=*/1);
+  auto slab = arena->Acquire().value();
+  arena.reset();
+  // Dropping the slab after the arena must not crash or leak.
+  slab.reset();
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -97,6 +97,18 @@ llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
     pre_optimization_hook_(module);
   }
 
+  std::string cache_key;
+  if (object_code_cache_) {
+    cache_key = object_code_cache_->Key(
+        module, *target_machine_, opt_level_, optimize_for_size_,
+        disable_expensive_passes_, fast_math_flags_, dfsan_enabled_);
+    if (std::unique_ptr<llvm::MemoryBuffer> cached =
+            object_code_cache_->Lookup(cache_key)) {
+      RunPostCodegenHook(*cached);
+      return std::move(cached);
+    }
+  }
+
   llvm::OptimizationLevel opt_level;
   if (optimize_for_size_) {
     opt_level = llvm::OptimizationLevel::Os;
@@ -188,17 +200,26 @@ llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer(
       new llvm::SmallVectorMemoryBuffer(std::move(stream_buffer)));
 
+  if (object_code_cache_) {
+    object_code_cache_->Store(cache_key, memory_buffer->getMemBufferRef());
+  }
+
+  RunPostCodegenHook(*memory_buffer);
+
+  return std::move(memory_buffer);
+}
+
+void CompilerFunctor::RunPostCodegenHook(
+    const llvm::MemoryBuffer& memory_buffer) const {
   if (post_codegen_hook_) {
     llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_file =
-        llvm::object::ObjectFile::createObjectFile(*memory_buffer);
+        llvm::object::ObjectFile::createObjectFile(memory_buffer);
     if (obj_file) {
       post_codegen_hook_(*obj_file.get());
     } else {
       LOG(WARNING) << "Could convert memory buffer to object file!";
     }
   }
-
-  return std::move(memory_buffer);
 }
 
 }  // namespace cpu
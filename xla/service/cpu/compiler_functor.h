@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_COMPILER_FUNCTOR_H_
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "llvm/IR/Operator.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Target/TargetMachine.h"
+#include "xla/service/cpu/object_code_cache.h"
 #include "xla/service/llvm_compiler.h"
 #include "tsl/platform/logging.h"
 
@@ -35,6 +37,10 @@ namespace cpu {
 
 // Functor class for compiling an LLVM module down to an object file. For use by
 // Orc JIT compile layer.
+//
+// If 'object_code_cache' is set, object files are looked up in and added to it.
+// On a cache hit the post-optimization hook is not run, since no optimized IR
+// is produced.
 class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
  public:
   explicit CompilerFunctor(
@@ -46,7 +52,8 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
       std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook =
           nullptr,
       bool dfsan_enabled = false,
-      const std::vector<std::string>& dfsan_abi_list_files = {})
+      const std::vector<std::string>& dfsan_abi_list_files = {},
+      std::shared_ptr<const ObjectCodeCache> object_code_cache = nullptr)
       : IRCompiler(llvm::orc::IRSymbolMapper::ManglingOptions()),
         target_machine_(target_machine),
         opt_level_(opt_level),
@@ -57,13 +64,16 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
         post_optimization_hook_(std::move(post_optimization_hook)),
         post_codegen_hook_(std::move(post_codegen_hook)),
         dfsan_enabled_(dfsan_enabled),
-        dfsan_abi_list_files_(dfsan_abi_list_files) {}
+        dfsan_abi_list_files_(dfsan_abi_list_files),
+        object_code_cache_(std::move(object_code_cache)) {}
 
   // Compile a Module to an ObjectFile.
   llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> operator()(
       llvm::Module& module) override;
 
  private:
+  void RunPostCodegenHook(const llvm::MemoryBuffer& memory_buffer) const;
+
   llvm::TargetMachine* target_machine_;
   const unsigned opt_level_;
   const bool optimize_for_size_;
@@ -74,6 +84,7 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
   std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook_;
   const bool dfsan_enabled_ = false;
   const std::vector<std::string> dfsan_abi_list_files_;
+  const std::shared_ptr<const ObjectCodeCache> object_code_cache_;
 };
 
 }  // namespace cpu
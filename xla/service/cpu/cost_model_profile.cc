@@ -0,0 +1,188 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/cost_model_profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xla/status.h"
+#include "xla/util.h"
+#include "tsl/platform/blocking_counter.h"
+#include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Every measurement is repeated this many times and the fastest run is kept.
+constexpr int kRepetitions = 3;
+
+// Large enough to not fit in the last-level cache of common hosts.
+constexpr int64_t kBandwidthBufferBytes = int64_t{64} << 20;
+
+template <typename F>
+double MinSeconds(F&& f) {
+  double best = std::numeric_limits<double>::infinity();
+  for (int i = 0; i < kRepetitions; ++i) {
+    absl::Time start = absl::Now();
+    f();
+    best = std::min(best, absl::ToDoubleSeconds(absl::Now() - start));
+  }
+  return std::max(best, 1e-9);
+}
+
+// Runs 'f(i)' for every i in [0, num_threads) on 'pool' and waits for all of
+// them to finish.
+template <typename F>
+void RunOnAllThreads(tsl::thread::ThreadPool* pool, int num_threads, F&& f) {
+  tsl::BlockingCounter counter(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    pool->Schedule([&, i] {
+      f(i);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+}
+
+// Returns the bytes per second read and written when copying 'src' into 'dst'
+// using 'num_threads' threads that each copy a contiguous slice.
+double MeasureCopyBandwidth(tsl::thread::ThreadPool* pool, int num_threads,
+                            const std::vector<char>& src,
+                            std::vector<char>& dst) {
+  const int64_t slice = CeilOfRatio<int64_t>(src.size(), num_threads);
+  double seconds = MinSeconds([&] {
+    RunOnAllThreads(pool, num_threads, [&](int i) {
+      int64_t begin = std::min<int64_t>(i * slice, src.size());
+      int64_t end = std::min<int64_t>(begin + slice, src.size());
+      std::memcpy(dst.data() + begin, src.data() + begin, end - begin);
+    });
+  });
+  return 2.0 * src.size() / seconds;
+}
+
+double MeasureFlopsPerSecond() {
+  constexpr int64_t kIterations = int64_t{1} << 22;
+  constexpr int kAccumulators = 16;
+  volatile float sink = 0.0f;
+  double seconds = MinSeconds([&] {
+    float acc[kAccumulators];
+    for (int j = 0; j < kAccumulators; ++j) acc[j] = j;
+    for (int64_t i = 0; i < kIterations; ++i) {
+      for (int j = 0; j < kAccumulators; ++j) {
+        acc[j] = acc[j] * 0.999f + 0.001f;
+      }
+    }
+    float sum = 0.0f;
+    for (int j = 0; j < kAccumulators; ++j) sum += acc[j];
+    sink = sum;
+  });
+  (void)sink;
+  return 2.0 * kIterations * kAccumulators / seconds;
+}
+
+double MeasureTranscendentalsPerSecond() {
+  constexpr int64_t kIterations = int64_t{1} << 20;
+  volatile float sink = 0.0f;
+  double seconds = MinSeconds([&] {
+    float x = 0.5f;
+    for (int64_t i = 0; i < kIterations; ++i) {
+      x = std::exp(-x);
+    }
+    sink = x;
+  });
+  (void)sink;
+  return kIterations / seconds;
+}
+
+double MeasureTaskOverheadSeconds(tsl::thread::ThreadPool* pool,
+                                  int num_threads) {
+  constexpr int kTasksPerThread = 64;
+  const int num_tasks = kTasksPerThread * num_threads;
+  double seconds = MinSeconds(
+      [&] { RunOnAllThreads(pool, num_tasks, [](int) {}); });
+  return seconds / num_tasks;
+}
+
+Status ValidateCostModelProfile(const CostModelProfile& profile) {
+  if (profile.flops_per_second_per_core() <= 0 ||
+      profile.transcendentals_per_second_per_core() <= 0 ||
+      profile.memory_bandwidth_per_core() <= 0 ||
+      profile.memory_bandwidth_total() <= 0 ||
+      profile.task_overhead_seconds() < 0) {
+    return InvalidArgument(
+        "CostModelProfile throughputs must be positive and the task overhead "
+        "must not be negative: %s",
+        profile.ShortDebugString());
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+StatusOr<CostModelProfile> LoadCostModelProfile(absl::string_view path) {
+  CostModelProfile profile;
+  TF_RETURN_IF_ERROR(
+      tsl::ReadTextProto(tsl::Env::Default(), std::string(path), &profile));
+  TF_RETURN_IF_ERROR(ValidateCostModelProfile(profile));
+  return profile;
+}
+
+CostModelProfile CalibrateCostModelProfile(int num_threads) {
+  num_threads = std::max(num_threads, 1);
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "xla_cpu_calibration",
+                               num_threads);
+  std::vector<char> src(kBandwidthBufferBytes, 1);
+  std::vector<char> dst(kBandwidthBufferBytes, 0);
+
+  CostModelProfile profile;
+  profile.set_flops_per_second_per_core(MeasureFlopsPerSecond());
+  profile.set_transcendentals_per_second_per_core(
+      MeasureTranscendentalsPerSecond());
+  profile.set_memory_bandwidth_per_core(
+      MeasureCopyBandwidth(&pool, 1, src, dst));
+  profile.set_memory_bandwidth_total(std::max(
+      profile.memory_bandwidth_per_core(),
+      MeasureCopyBandwidth(&pool, num_threads, src, dst)));
+  profile.set_task_overhead_seconds(
+      MeasureTaskOverheadSeconds(&pool, num_threads));
+  VLOG(1) << "Calibrated CPU cost model profile: "
+          << profile.ShortDebugString();
+  return profile;
+}
+
+StatusOr<CostModelProfile> GetCostModelProfile(absl::string_view spec) {
+  if (spec == kCalibrateCostModelProfile) {
+    static const CostModelProfile* calibrated = new CostModelProfile(
+        CalibrateCostModelProfile(tsl::port::MaxParallelism()));
+    return *calibrated;
+  }
+  return LoadCostModelProfile(spec);
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,46 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_COST_MODEL_PROFILE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_COST_MODEL_PROFILE_H_
+
+#include "absl/strings/string_view.h"
+#include "xla/service/cpu/cost_model_profile.pb.h"
+#include "xla/statusor.h"
+
+namespace xla {
+namespace cpu {
+
+// Value of the xla_cpu_parallel_cost_model_profile flag that requests
+// measuring the host instead of loading a profile from a file.
+inline constexpr absl::string_view kCalibrateCostModelProfile = "calibrate";
+
+// Reads a text CostModelProfile proto from 'path' and checks that every
+// throughput in it is positive.
+StatusOr<CostModelProfile> LoadCostModelProfile(absl::string_view path);
+
+// Measures the host by running short compute, memory and dispatch
+// microbenchmarks on 'num_threads' threads. Takes in the order of a second.
+CostModelProfile CalibrateCostModelProfile(int num_threads);
+
+// Returns the profile selected by the value of the
+// xla_cpu_parallel_cost_model_profile flag. Calibration results are cached, so
+// the host is measured at most once per process.
+StatusOr<CostModelProfile> GetCostModelProfile(absl::string_view spec);
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_COST_MODEL_PROFILE_H_
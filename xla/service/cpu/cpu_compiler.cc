@@ -18,6 +18,7 @@ limitations under the License.
 #include <stddef.h>
 #include <string.h>
 
+#include <algorithm>
 #include <functional>
 #include <map>
 #include <memory>
@@ -36,6 +37,7 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
@@ -104,6 +106,7 @@ limitations under the License.
 #include "xla/service/call_inliner.h"
 #include "xla/service/change_op_data_type.h"
 #include "xla/service/cholesky_expander.h"
+#include "xla/service/collective_ops_utils.h"
 #include "xla/service/comparison_expander.h"
 #include "xla/service/conditional_canonicalizer.h"
 #include "xla/service/conditional_simplifier.h"
@@ -121,6 +124,7 @@ limitations under the License.
 #include "xla/service/cpu/dot_op_emitter.h"
 #include "xla/service/cpu/hlo_xla_runtime_pipeline.h"
 #include "xla/service/cpu/ir_emitter.h"
+#include "xla/service/cpu/object_code_cache.h"
 #include "xla/service/cpu/parallel_task_assignment.h"
 #include "xla/service/cpu/runtime/collectives.h"
 #include "xla/service/cpu/runtime/custom_call.h"
@@ -538,6 +542,13 @@ void AddHloVerifier(HloPassPipeline* pipeline, bool allow_sparse_shapes,
   }
 }
 
+// Returns whether `instr` is an all-gather or reduce-scatter that the CPU
+// IrEmitter lowers to a call into the CPU runtime, without decomposing it into
+// an all-reduce first.
+bool IsNativeCpuCollective(const HloCollectiveInstruction& instr) {
+  return instr.operand_count() == 1 && instr.shape().IsArray();
+}
+
 }  // namespace
 
 Status CpuCompiler::RunHloPassesThroughLayoutAssn(
@@ -599,9 +610,28 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   pipeline.AddPass<QrExpander>();
   pipeline.AddPass<EighExpander>();
   pipeline.AddPass<TriangularSolveExpander>();
-  pipeline.AddPass<AllGatherDecomposer>();
+  if (is_mlir_compile) {
+    pipeline.AddPass<AllGatherDecomposer>();
+  } else {
+    // The IrEmitter implements single-operand all-gathers natively.
+    pipeline.AddPass<AllGatherDecomposer>(
+        [](const HloAllGatherInstruction& ag) {
+          return !IsNativeCpuCollective(ag);
+        });
+  }
   pipeline.AddPass<AllToAllDecomposer>();
-  pipeline.AddPass<ReduceScatterDecomposer>();
+  if (is_mlir_compile) {
+    pipeline.AddPass<ReduceScatterDecomposer>();
+  } else {
+    // The IrEmitter implements single-operand reduce-scatters with a
+    // recognized reduction computation natively.
+    pipeline.AddPass<ReduceScatterDecomposer>(
+        /*update_layout=*/nullptr,
+        /*should_decompose=*/[](const HloReduceScatterInstruction& rs) {
+          return !IsNativeCpuCollective(rs) ||
+                 !MatchReductionComputation(rs.to_apply()).has_value();
+        });
+  }
   pipeline.AddPass<StochasticConvertDecomposer>();
 
   // Inline computations with a single call site.
@@ -1028,6 +1058,27 @@ struct OrcJITPostCompilationHook {
   const HloModule* module;
 };
 
+// Returns the on-disk object code cache requested by 'config', or nullptr if
+// caching is disabled.
+std::shared_ptr<const ObjectCodeCache> GetObjectCodeCache(
+    const HloModuleConfig& config) {
+  const std::string& directory =
+      config.debug_options().xla_cpu_object_code_cache_dir();
+  if (directory.empty()) {
+    return nullptr;
+  }
+  // LLVM command line options affect code generation without being visible to
+  // the TargetMachine, so they are mixed into every cache key.
+  std::vector<std::string> extra_options;
+  for (const auto& [name, value] :
+       config.debug_options().xla_backend_extra_options()) {
+    extra_options.push_back(absl::StrCat(name, "=", value));
+  }
+  std::sort(extra_options.begin(), extra_options.end());
+  return std::make_shared<ObjectCodeCache>(directory,
+                                           absl::StrJoin(extra_options, ","));
+}
+
 void InitializeLLVMCommandLineOptions(const HloModuleConfig& config) {
   llvm_ir::InitializeLLVMCommandLineOptions(
       config.debug_options().xla_backend_extra_options());
@@ -1229,7 +1280,8 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
       module->config().debug_options().xla_llvm_disable_expensive_passes(),
       llvm_ir::GetCpuFastMathFlags(module->config()), pre_optimization_ir_hook,
       post_optimization_ir_hook,
-      OrcJITPostCompilationHook::Create(module.get()));
+      OrcJITPostCompilationHook::Create(module.get()),
+      GetObjectCodeCache(module->config()));
   if (!jit) {
     return InternalError("Creating JIT failed: %s",
                          llvm::toString(jit.takeError()));
@@ -1333,10 +1385,23 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
 
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
-  // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  // JIT compile the LLVM IR module to in-memory machine code. Sharded
+  // compilation is skipped when IR or objects are dumped or hooked, since
+  // those expect to see the whole module at once.
+  const int64_t num_codegen_shards =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
+  if (num_codegen_shards > 1 && !DumpingEnabledForHloModule(*module) &&
+      !user_pre_optimization_hook_ && !user_post_optimization_hook_) {
+    if (llvm::Error error = (*jit)->AddModuleInShards(std::move(llvm_module),
+                                                      num_codegen_shards)) {
+      return InternalError("Parallel LLVM codegen failed: %s",
+                           llvm::toString(std::move(error)));
+    }
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   auto cpu_executable = std::make_unique<CpuExecutable>(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
@@ -74,6 +74,11 @@ CpuExecutable::CpuExecutable(
     buffer_assignment_ =
         std::make_shared<BufferAssignmentProto>(assignment_->ToProto());
   }
+  if (assignment_ && has_module() &&
+      module().config().debug_options().xla_cpu_enable_buffer_table_arena()) {
+    buffer_table_arena_ =
+        std::make_unique<BufferTableArena>(assignment_->Allocations());
+  }
   if (has_module()) {
     XlaDebugInfoManager::Get()->RegisterModule(
         module().unique_id(), shared_module(), buffer_assignment_);
@@ -108,6 +113,11 @@ CpuExecutable::CpuExecutable(
     buffer_assignment_ =
         std::make_shared<BufferAssignmentProto>(assignment_->ToProto());
   }
+  if (assignment_ && has_module() &&
+      module().config().debug_options().xla_cpu_enable_buffer_table_arena()) {
+    buffer_table_arena_ =
+        std::make_unique<BufferTableArena>(assignment_->Allocations());
+  }
   if (has_module()) {
     XlaDebugInfoManager::Get()->RegisterModule(
         module().unique_id(), shared_module(), buffer_assignment_);
@@ -123,7 +133,8 @@ CpuExecutable::~CpuExecutable() {
 static StatusOr<MaybeOwningDeviceMemory> MemoryForAllocation(
     const BufferAllocation& allocation,
     absl::Span<ExecutionInput const> arguments,
-    se::DeviceMemoryAllocator* memory_allocator, int device_ordinal) {
+    se::DeviceMemoryAllocator* memory_allocator, int device_ordinal,
+    const BufferTableArena::Slab* slab) {
   VLOG(3) << allocation.ToString();
   if (allocation.is_entry_computation_parameter()) {
     se::DeviceMemoryBase out = arguments[allocation.parameter_number()]
@@ -143,6 +154,12 @@ static StatusOr<MaybeOwningDeviceMemory> MemoryForAllocation(
   }
 
   int64_t buffer_size = allocation.size();
+  if (slab != nullptr && allocation.IsPreallocatedTempBuffer()) {
+    VLOG(3) << "buffer served from the buffer table arena";
+    return MaybeOwningDeviceMemory{
+        se::DeviceMemoryBase(slab->Get(allocation.index()), buffer_size)};
+  }
+
   TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory out,
                       memory_allocator->Allocate(device_ordinal, buffer_size));
   VLOG(3) << "buffer allocated " << buffer_size << " bytes [" << out->opaque()
@@ -158,7 +175,8 @@ static StatusOr<MaybeOwningDeviceMemory> MemoryForAllocation(
 
 StatusOr<std::vector<MaybeOwningDeviceMemory>> CpuExecutable::CreateBufferTable(
     se::DeviceMemoryAllocator* memory_allocator, int device_ordinal,
-    absl::Span<ExecutionInput const> arguments) {
+    absl::Span<ExecutionInput const> arguments,
+    const BufferTableArena::Slab* slab) {
   std::vector<MaybeOwningDeviceMemory> buffers(
       assignment_->Allocations().size());
   VLOG(3) << "Allocating " << assignment_->Allocations().size()
@@ -168,7 +186,7 @@ StatusOr<std::vector<MaybeOwningDeviceMemory>> CpuExecutable::CreateBufferTable(
     const BufferAllocation& allocation = assignment_->GetAllocation(i);
     TF_ASSIGN_OR_RETURN(
         buffers[i], MemoryForAllocation(allocation, arguments, memory_allocator,
-                                        device_ordinal));
+                                        device_ordinal, slab));
   }
 
   if (VLOG_IS_ON(3)) {
@@ -608,10 +626,14 @@ StatusOr<ExecutionOutput> CpuExecutable::ExecuteAsyncOnStream(
       run_options->stream()->implementation());
   se::Stream* stream = run_options->stream();
   se::DeviceMemoryAllocator* memory_allocator = run_options->allocator();
+  std::shared_ptr<BufferTableArena::Slab> slab;
+  if (buffer_table_arena_) {
+    TF_ASSIGN_OR_RETURN(slab, buffer_table_arena_->Acquire());
+  }
   TF_ASSIGN_OR_RETURN(
       std::vector<MaybeOwningDeviceMemory> buffers,
       CreateBufferTable(memory_allocator, stream->parent()->device_ordinal(),
-                        arguments));
+                        arguments, slab.get()));
 
   TF_ASSIGN_OR_RETURN(
       ExecutionOutput result,
@@ -631,6 +653,9 @@ StatusOr<ExecutionOutput> CpuExecutable::ExecuteAsyncOnStream(
     CpuExecutable* executable;
     ServiceExecutableRunOptions run_options;
     std::shared_ptr<std::vector<MaybeOwningDeviceMemory>> task_buffers;
+    // Keeps the temporary buffers checked out of the arena until the task is
+    // done with them.
+    std::shared_ptr<BufferTableArena::Slab> slab;
     HloExecutionProfile* hlo_execution_profile;
 
     Status operator()() {
@@ -642,7 +667,7 @@ StatusOr<ExecutionOutput> CpuExecutable::ExecuteAsyncOnStream(
       AsyncRunTask{this, *run_options,
                    std::make_shared<std::vector<MaybeOwningDeviceMemory>>(
                        std::move(buffers)),
-                   hlo_execution_profile});
+                   std::move(slab), hlo_execution_profile});
 
   MarkToBeReleasedArguments(absl::MakeSpan(arguments), result);
   return std::move(result);
@@ -31,6 +31,7 @@ limitations under the License.
 #include "xla/runtime/ffi.h"
 #include "xla/runtime/jit_executable.h"
 #include "xla/service/buffer_assignment.h"
+#include "xla/service/cpu/buffer_table_arena.h"
 #include "xla/service/cpu/simple_orc_jit.h"
 #include "xla/service/cpu/xla_framework.h"
 #include "xla/service/custom_call_status_internal.h"
@@ -214,6 +215,12 @@ class CpuExecutable : public Executable {
 
   const BufferAssignment& buffer_assignment() const { return *assignment_; }
 
+  // Arena serving the temporary buffers of every run, or nullptr if
+  // xla_cpu_enable_buffer_table_arena is off.
+  BufferTableArena* buffer_table_arena() const {
+    return buffer_table_arena_.get();
+  }
+
   int64_t SizeOfGeneratedCodeInBytes() const override;
 
   StatusOr<std::string_view> GetObjFile() const {
@@ -249,9 +256,13 @@ class CpuExecutable : public Executable {
   //
   //  - buffers_to_free: buffers whose ownership was donated by the caller that
   //    are to be freed by the caller.
+  //
+  // If `slab` is not null, temporary buffers are carved out of it instead of
+  // being allocated with `memory_allocator`.
   StatusOr<std::vector<MaybeOwningDeviceMemory>> CreateBufferTable(
       se::DeviceMemoryAllocator* memory_allocator, int device_ordinal,
-      absl::Span<ExecutionInput const> arguments);
+      absl::Span<ExecutionInput const> arguments,
+      const BufferTableArena::Slab* slab = nullptr);
 
   // Creates an Execution output holding ScopedShapedBuffer for holding the
   // result of the computation, moving buffers out of allocated_buffers and into
@@ -274,6 +285,10 @@ class CpuExecutable : public Executable {
 
   std::shared_ptr<const BufferAssignmentProto> buffer_assignment_;
 
+  // Pooled storage for the preallocated temporary buffers; see
+  // buffer_table_arena().
+  std::unique_ptr<BufferTableArena> buffer_table_arena_;
+
   // The LLVM IR, in string format, of the unoptimized module generated for this
   // CpuExecutable. We save a string instead of an llvm::Module* because leaving
   // llvm::Module* in a singleton can cause the heap checker to emit false
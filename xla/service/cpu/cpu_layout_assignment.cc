@@ -103,6 +103,11 @@ static bool OperandsAndResultMustHaveRowMajorLayout(
   } else if (instr.opcode() == HloOpcode::kDot) {
     return DotOperandsAndResultMustHaveRowMajorLayout(instr,
                                                       target_machine_features);
+  } else if (instr.opcode() == HloOpcode::kAllGather ||
+             instr.opcode() == HloOpcode::kReduceScatter) {
+    // The CPU runtime implements these by copying contiguous chunks of the
+    // row-major operand and result.
+    return instr.shape().IsArray();
   }
   return false;
 }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/service/cpu/cpu_runtime.h"
 
+#include <algorithm>
 #include <complex>
 #include <cstdarg>
 #include <cstddef>
@@ -29,6 +30,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/dynamic_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_format.h"
@@ -44,6 +46,7 @@ limitations under the License.
 #include "xla/service/hlo_parser.h"
 #include "xla/shape_util.h"
 #include "xla/statusor.h"
+#include "xla/util.h"
 #include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "tsl/platform/logging.h"
@@ -148,7 +151,10 @@ extern const char* const kTracingStartSymbolName =
     "__xla_cpu_runtime_TracingStart";
 extern const char* const kTracingEndSymbolName = "__xla_cpu_runtime_TracingEnd";
 extern const char* const kXlaCpuRuntimeSymbolNamePrefix = "__xla_cpu_runtime_";
+extern const char* const kAllGatherSymbolName = "__xla_cpu_runtime_AllGather";
 extern const char* const kAllReduceSymbolName = "__xla_cpu_runtime_AllReduce";
+extern const char* const kReduceScatterSymbolName =
+    "__xla_cpu_runtime_ReduceScatter";
 extern const char* const kAllToAllSymbolName = "__xla_cpu_runtime_AllToAll";
 extern const char* const kCollectivePermuteSymbolName =
     "__xla_cpu_runtime_CollectivePermute";
@@ -226,6 +232,149 @@ struct AllToAllParticipantData : ParticipantData {
   }
 };
 
+struct AllGatherParticipantData : ParticipantData {
+  AllGatherParticipantData(const RendezvousKey& rendezvous_key_p,
+                           int64_t device_ordinal_p, se::Stream* stream_p)
+      : ParticipantData(rendezvous_key_p),
+        device_ordinal(device_ordinal_p),
+        stream(stream_p) {}
+
+  int64_t device_ordinal;
+  se::Stream* stream;
+  // Position of this participant in rendezvous_key.global_devices, which is
+  // also the position of its chunk in the gathered output.
+  int rank;
+  se::DeviceMemoryBase source_buffer;
+  se::DeviceMemoryBase destination_buffer;
+  // The source buffer is made up of `num_chunks` contiguous chunks of
+  // `chunk_bytes` each. Chunk `i` of rank `r` lands at chunk `i * N + r` of
+  // every destination buffer, where N is the number of participants.
+  int64_t num_chunks;
+  int64_t chunk_bytes;
+
+  std::string ToString() const override {
+    return absl::StrFormat(
+        "AllGatherParticipantData{rank=%d, source_buffer=%p, "
+        "destination_buffer=%p, num_chunks=%d, chunk_bytes=%d, "
+        "device_ordinal=%d, stream=%p}",
+        rank, source_buffer.opaque(), destination_buffer.opaque(), num_chunks,
+        chunk_bytes, device_ordinal, stream);
+  }
+};
+
+struct ReduceScatterParticipantData : ParticipantData {
+  ReduceScatterParticipantData(const RendezvousKey& rendezvous_key_p,
+                               int64_t device_ordinal_p, se::Stream* stream_p)
+      : ParticipantData(rendezvous_key_p),
+        device_ordinal(device_ordinal_p),
+        stream(stream_p) {}
+
+  int64_t device_ordinal;
+  se::Stream* stream;
+  // Position of this participant in rendezvous_key.global_devices, which is
+  // also the index of the reduced chunk it receives.
+  int rank;
+  se::DeviceMemoryBase source_buffer;
+  se::DeviceMemoryBase destination_buffer;
+  PrimitiveType primitive_type;
+  ReductionKind reduction_kind;
+  // The destination buffer is made up of `num_chunks` contiguous chunks of
+  // `chunk_elements` each. Chunk `i` of rank `r` is the reduction of chunk
+  // `i * N + r` of every source buffer, where N is the number of participants.
+  int64_t num_chunks;
+  int64_t chunk_elements;
+
+  std::string ToString() const override {
+    return absl::StrFormat(
+        "ReduceScatterParticipantData{rank=%d, source_buffer=%p, "
+        "destination_buffer=%p, num_chunks=%d, chunk_elements=%d, "
+        "device_ordinal=%d, stream=%p}",
+        rank, source_buffer.opaque(), destination_buffer.opaque(), num_chunks,
+        chunk_elements, device_ordinal, stream);
+  }
+};
+
+template <typename T, bool kIsSignedIntegralType>
+struct SumProductTypeForReductionStep {
+  using type = T;
+};
+
+template <typename T>
+struct SumProductTypeForReductionStep<T, /*kIsSignedIntegralType=*/true> {
+  using type = typename std::make_unsigned_t<T>;
+};
+
+template <typename T,
+          typename std::enable_if<!is_complex<T>::value>::type* = nullptr>
+T PerformReductionStep(ReductionKind reduction_kind, T a, T b) {
+  using SumProductType = typename SumProductTypeForReductionStep<
+      T, std::is_integral<T>::value && std::is_signed<T>::value>::type;
+  switch (reduction_kind) {
+    case ReductionKind::SUM:
+      return absl::bit_cast<T>(
+          static_cast<SumProductType>(absl::bit_cast<SumProductType>(a) +
+                                      absl::bit_cast<SumProductType>(b)));
+    case ReductionKind::PRODUCT:
+      return absl::bit_cast<T>(
+          static_cast<SumProductType>(absl::bit_cast<SumProductType>(a) *
+                                      absl::bit_cast<SumProductType>(b)));
+    case ReductionKind::MIN:
+      return std::min(a, b);
+    case ReductionKind::MAX:
+      return std::max(a, b);
+  }
+}
+
+template <typename T,
+          typename std::enable_if<is_complex<T>::value>::type* = nullptr>
+T PerformReductionStep(ReductionKind reduction_kind, T a, T b) {
+  using SumProductType = typename SumProductTypeForReductionStep<
+      T, std::is_integral<T>::value && std::is_signed<T>::value>::type;
+  switch (reduction_kind) {
+    case ReductionKind::SUM:
+      return absl::bit_cast<T>(
+          static_cast<SumProductType>(absl::bit_cast<SumProductType>(a) +
+                                      absl::bit_cast<SumProductType>(b)));
+    case ReductionKind::PRODUCT:
+      return absl::bit_cast<T>(
+          static_cast<SumProductType>(absl::bit_cast<SumProductType>(a) *
+                                      absl::bit_cast<SumProductType>(b)));
+    case ReductionKind::MIN:
+    case ReductionKind::MAX:
+      LOG(FATAL) << "min/max not valid for complex types";
+  }
+}
+
+// Folds `in` into `acc` element-wise. The reduction kind is dispatched once
+// per block so that the inner loops are simple enough to be vectorized.
+template <typename T>
+void ReduceBlock(ReductionKind reduction_kind, T* __restrict acc,
+                 const T* __restrict in, int64_t size) {
+  switch (reduction_kind) {
+    case ReductionKind::SUM:
+      for (int64_t i = 0; i < size; ++i) {
+        acc[i] = PerformReductionStep<T>(ReductionKind::SUM, acc[i], in[i]);
+      }
+      break;
+    case ReductionKind::PRODUCT:
+      for (int64_t i = 0; i < size; ++i) {
+        acc[i] =
+            PerformReductionStep<T>(ReductionKind::PRODUCT, acc[i], in[i]);
+      }
+      break;
+    case ReductionKind::MIN:
+      for (int64_t i = 0; i < size; ++i) {
+        acc[i] = PerformReductionStep<T>(ReductionKind::MIN, acc[i], in[i]);
+      }
+      break;
+    case ReductionKind::MAX:
+      for (int64_t i = 0; i < size; ++i) {
+        acc[i] = PerformReductionStep<T>(ReductionKind::MAX, acc[i], in[i]);
+      }
+      break;
+  }
+}
+
 // Inverses the encoding of a Shape protobuf into an LLVM global variable.
 StatusOr<Shape> DecodeSelfDescribingShapeConstant(const void* shape_ptr,
                                                   int32_t size_bytes) {
@@ -373,184 +522,305 @@ class CpuAllReduceRendezvous
   StatusOr<std::nullptr_t> RunCollectiveOp(
       const AllReduceParticipantData& participant) override {
     PrimitiveType datatype = participant.buffers.front().primitive_type;
-    bool primary = InitializationBarrier();
 
-    if (primary) {
-      switch (datatype) {
-        case S8:
-          DoAllReduce<S8>(participant);
-          break;
-        case PRED:
-        case U8:
-          DoAllReduce<U8>(participant);
-          break;
-        case S16:
-          DoAllReduce<S16>(participant);
-          break;
-        case U16:
-          DoAllReduce<U16>(participant);
-          break;
-        case S32:
-          DoAllReduce<S32>(participant);
-          break;
-        case U32:
-          DoAllReduce<U32>(participant);
-          break;
-        case S64:
-          DoAllReduce<S64>(participant);
-          break;
-        case U64:
-          DoAllReduce<U64>(participant);
-          break;
-        case F16:
-          DoAllReduce<F16>(participant);
-          break;
-        case F32:
-          DoAllReduce<F32>(participant);
-          break;
-        case F64:
-          DoAllReduce<F64>(participant);
-          break;
-        case C64:
-          DoAllReduce<C64>(participant);
-          break;
-        case C128:
-          DoAllReduce<C128>(participant);
-          break;
-        default:
-          LOG(FATAL) << "Unexpected datatype;";
-      }
+    // Every participant reduces its own 1/N slice of each buffer and then
+    // scatters the reduced slice into the outputs of all participants, so the
+    // reduction is spread across all participating threads rather than done by
+    // a single primary thread. Rendezvous::SubmitParticipant does not let any
+    // participant return before all of them have finished, so every output is
+    // complete once the collective op returns.
+    switch (datatype) {
+      case S8:
+        DoAllReduce<S8>(participant);
+        break;
+      case PRED:
+      case U8:
+        DoAllReduce<U8>(participant);
+        break;
+      case S16:
+        DoAllReduce<S16>(participant);
+        break;
+      case U16:
+        DoAllReduce<U16>(participant);
+        break;
+      case S32:
+        DoAllReduce<S32>(participant);
+        break;
+      case U32:
+        DoAllReduce<U32>(participant);
+        break;
+      case S64:
+        DoAllReduce<S64>(participant);
+        break;
+      case U64:
+        DoAllReduce<U64>(participant);
+        break;
+      case F16:
+        DoAllReduce<F16>(participant);
+        break;
+      case F32:
+        DoAllReduce<F32>(participant);
+        break;
+      case F64:
+        DoAllReduce<F64>(participant);
+        break;
+      case C64:
+        DoAllReduce<C64>(participant);
+        break;
+      case C128:
+        DoAllReduce<C128>(participant);
+        break;
+      default:
+        LOG(FATAL) << "Unexpected datatype;";
     }
     return nullptr;
   }
 
  private:
+  // Slices are aligned to this many bytes so that participants never write to
+  // the same cache line of an output buffer.
+  static constexpr int64_t kSliceAlignmentBytes = 64;
+
+  // Slices are reduced in blocks of this many bytes so that the partially
+  // reduced block stays in cache while the inputs of all participants are
+  // folded into it.
+  static constexpr int64_t kBlockBytes = 16 * 1024;
+
   template <PrimitiveType PT>
-  void DoAllReduce(AllReduceParticipantData participant) {
+  void DoAllReduce(const AllReduceParticipantData& participant) {
     using T = typename primitive_util::PrimitiveTypeToNative<PT>::type;
-    absl::MutexLock lock(&mu_);
-    CHECK(!participants_.empty());
     ReductionKind reduction_kind = participant.reduction_kind;
-    for (const auto& p : participants_) {
-      CHECK(p.reduction_kind == reduction_kind);
-    }
-    int num_participants = participants_.size();
 
     // participant_idx -> buffer_idx -> buffer.
-    std::vector<std::vector<absl::Span<T>>> input_buffers;
+    std::vector<std::vector<absl::Span<const T>>> input_buffers;
     std::vector<std::vector<absl::Span<T>>> output_buffers;
-    input_buffers.reserve(num_participants);
-    output_buffers.reserve(num_participants);
-    const AllReduceParticipantData& first_participant = participants_.front();
-
-    int buffers_per_participant = first_participant.buffers.size();
-    for (AllReduceParticipantData& p : participants_) {
-      CHECK_EQ(p.buffers.size(), buffers_per_participant);
-
-      input_buffers.emplace_back();
-      output_buffers.emplace_back();
-      std::vector<absl::Span<T>>& participant_input_buffers =
-          input_buffers.back();
-      std::vector<absl::Span<T>>& participant_output_buffers =
-          output_buffers.back();
-      participant_input_buffers.reserve(p.buffers.size());
-      participant_output_buffers.reserve(p.buffers.size());
-
-      for (int buffer_idx = 0; buffer_idx < buffers_per_participant;
-           buffer_idx++) {
-        auto& participant_buffer = p.buffers[buffer_idx];
-        participant_input_buffers.emplace_back(
-            static_cast<T*>(participant_buffer.source_data.opaque()),
-            participant_buffer.element_count);
-        participant_output_buffers.emplace_back(
-            static_cast<T*>(participant_buffer.destination_data.opaque()),
-            participant_buffer.element_count);
-        CHECK_EQ(participant_buffer.element_count,
-                 first_participant.buffers[buffer_idx].element_count);
+    int rank = -1;
+    {
+      absl::MutexLock lock(&mu_);
+      CHECK(!participants_.empty());
+      for (const auto& p : participants_) {
+        CHECK(p.reduction_kind == reduction_kind);
+      }
+      int num_participants = participants_.size();
+      input_buffers.reserve(num_participants);
+      output_buffers.reserve(num_participants);
+      const AllReduceParticipantData& first_participant = participants_.front();
+
+      int buffers_per_participant = first_participant.buffers.size();
+      for (int participant_idx = 0; participant_idx < num_participants;
+           participant_idx++) {
+        const AllReduceParticipantData& p = participants_[participant_idx];
+        CHECK_EQ(p.buffers.size(), buffers_per_participant);
+        if (p.device_ordinal == participant.device_ordinal) {
+          rank = participant_idx;
+        }
+
+        input_buffers.emplace_back();
+        output_buffers.emplace_back();
+        std::vector<absl::Span<const T>>& participant_input_buffers =
+            input_buffers.back();
+        std::vector<absl::Span<T>>& participant_output_buffers =
+            output_buffers.back();
+        participant_input_buffers.reserve(p.buffers.size());
+        participant_output_buffers.reserve(p.buffers.size());
+
+        for (int buffer_idx = 0; buffer_idx < buffers_per_participant;
+             buffer_idx++) {
+          auto& participant_buffer = p.buffers[buffer_idx];
+          participant_input_buffers.emplace_back(
+              static_cast<const T*>(participant_buffer.source_data.opaque()),
+              participant_buffer.element_count);
+          participant_output_buffers.emplace_back(
+              static_cast<T*>(participant_buffer.destination_data.opaque()),
+              participant_buffer.element_count);
+          CHECK_EQ(participant_buffer.element_count,
+                   first_participant.buffers[buffer_idx].element_count);
+        }
       }
     }
+    CHECK_GE(rank, 0) << "Participant " << participant.ToString()
+                      << " not found among all-reduce participants";
 
-    for (int buffer_idx = 0; buffer_idx < buffers_per_participant;
+    int64_t num_participants = input_buffers.size();
+    constexpr int64_t kSliceAlignment =
+        std::max<int64_t>(1, kSliceAlignmentBytes / sizeof(T));
+    constexpr int64_t kBlockSize =
+        std::max<int64_t>(1, kBlockBytes / sizeof(T));
+
+    for (int buffer_idx = 0; buffer_idx < output_buffers[rank].size();
          buffer_idx++) {
-      int element_count = first_participant.buffers[buffer_idx].element_count;
-      for (int idx = 0; idx < element_count; idx++) {
-        T out = GetInitialValue<T>(reduction_kind);
-        for (int participant_idx = 0; participant_idx < participants_.size();
+      int64_t element_count = output_buffers[rank][buffer_idx].size();
+      int64_t slice_size = RoundUpTo(
+          CeilOfRatio(element_count, num_participants), kSliceAlignment);
+      int64_t slice_begin = std::min(element_count, rank * slice_size);
+      int64_t slice_end = std::min(element_count, slice_begin + slice_size);
+
+      for (int64_t block_begin = slice_begin; block_begin < slice_end;
+           block_begin += kBlockSize) {
+        int64_t block_size = std::min(kBlockSize, slice_end - block_begin);
+
+        // Accumulate into this participant's own output. All inputs of a block
+        // are read before any output of the same block is written, so in-place
+        // all-reduces (source == destination) are handled correctly.
+        T* acc = output_buffers[rank][buffer_idx].data() + block_begin;
+        const T* own_input =
+            input_buffers[rank][buffer_idx].data() + block_begin;
+        if (acc != own_input) {
+          std::memcpy(acc, own_input, block_size * sizeof(T));
+        }
+        for (int64_t participant_idx = 0; participant_idx < num_participants;
              participant_idx++) {
-          out = PerformReductionStep<T>(
-              reduction_kind, out,
-              input_buffers[participant_idx][buffer_idx][idx]);
+          if (participant_idx == rank) continue;
+          ReduceBlock<T>(
+              reduction_kind, acc,
+              input_buffers[participant_idx][buffer_idx].data() + block_begin,
+              block_size);
         }
-        for (int participant_idx = 0; participant_idx < participants_.size();
+
+        // All-gather: publish the reduced block to every other participant.
+        for (int64_t participant_idx = 0; participant_idx < num_participants;
              participant_idx++) {
-          output_buffers[participant_idx][buffer_idx][idx] = out;
+          if (participant_idx == rank) continue;
+          std::memcpy(
+              output_buffers[participant_idx][buffer_idx].data() + block_begin,
+              acc, block_size * sizeof(T));
         }
       }
     }
   }
+};
 
-  template <typename T>
-  T GetInitialValue(ReductionKind reduction_kind) {
-    switch (reduction_kind) {
-      case ReductionKind::SUM:
-        return static_cast<T>(0);
-      case ReductionKind::PRODUCT:
-        return static_cast<T>(1);
-      case ReductionKind::MIN:
-        return std::numeric_limits<T>::max();
-      case ReductionKind::MAX:
-        return std::numeric_limits<T>::min();
+class CpuAllGatherRendezvous
+    : public Rendezvous<AllGatherParticipantData, std::nullptr_t> {
+ public:
+  explicit CpuAllGatherRendezvous(const RendezvousKey& k)
+      : Rendezvous<AllGatherParticipantData, std::nullptr_t>(k) {}
+
+ protected:
+  StatusOr<std::nullptr_t> RunCollectiveOp(
+      const AllGatherParticipantData& participant) override {
+    // Every participant pushes its own chunks into the destination buffers of
+    // all participants. The written regions are disjoint, so no participant
+    // has to wait for a primary thread to do all of the copies.
+    std::vector<char*> destination_buffers;
+    {
+      absl::MutexLock lock(&mu_);
+      destination_buffers.resize(participants_.size());
+      for (const AllGatherParticipantData& p : participants_) {
+        CHECK_EQ(p.num_chunks, participant.num_chunks);
+        CHECK_EQ(p.chunk_bytes, participant.chunk_bytes);
+        destination_buffers[p.rank] =
+            static_cast<char*>(p.destination_buffer.opaque());
+      }
     }
-  }
 
-  template <typename T, bool kIsSignedIntegralType>
-  struct SumProductTypeForReductionStep {
-    using type = T;
-  };
+    int64_t num_participants = destination_buffers.size();
+    const char* source =
+        static_cast<const char*>(participant.source_buffer.opaque());
+    for (int64_t chunk = 0; chunk < participant.num_chunks; ++chunk) {
+      int64_t destination_offset =
+          (chunk * num_participants + participant.rank) *
+          participant.chunk_bytes;
+      for (char* destination : destination_buffers) {
+        std::memcpy(destination + destination_offset,
+                    source + chunk * participant.chunk_bytes,
+                    participant.chunk_bytes);
+      }
+    }
+    return nullptr;
+  }
+};
 
-  template <typename T>
-  struct SumProductTypeForReductionStep<T, /*kIsSignedIntegralType=*/true> {
-    using type = typename std::make_unsigned_t<T>;
-  };
+class CpuReduceScatterRendezvous
+    : public Rendezvous<ReduceScatterParticipantData, std::nullptr_t> {
+ public:
+  explicit CpuReduceScatterRendezvous(const RendezvousKey& k)
+      : Rendezvous<ReduceScatterParticipantData, std::nullptr_t>(k) {}
 
-  template <typename T,
-            typename std::enable_if<!is_complex<T>::value>::type* = nullptr>
-  T PerformReductionStep(ReductionKind reduction_kind, T a, T b) {
-    using SumProductType = typename SumProductTypeForReductionStep<
-        T, std::is_integral<T>::value && std::is_signed<T>::value>::type;
-    switch (reduction_kind) {
-      case ReductionKind::SUM:
-        return absl::bit_cast<T>(
-            static_cast<SumProductType>(absl::bit_cast<SumProductType>(a) +
-                                        absl::bit_cast<SumProductType>(b)));
-      case ReductionKind::PRODUCT:
-        return absl::bit_cast<T>(
-            static_cast<SumProductType>(absl::bit_cast<SumProductType>(a) *
-                                        absl::bit_cast<SumProductType>(b)));
-      case ReductionKind::MIN:
-        return std::min(a, b);
-      case ReductionKind::MAX:
-        return std::max(a, b);
+ protected:
+  StatusOr<std::nullptr_t> RunCollectiveOp(
+      const ReduceScatterParticipantData& participant) override {
+    // Every participant reduces the chunks it owns directly into its own
+    // destination buffer, reading the corresponding chunks of all source
+    // buffers.
+    switch (participant.primitive_type) {
+      case S8:
+        DoReduceScatter<S8>(participant);
+        break;
+      case PRED:
+      case U8:
+        DoReduceScatter<U8>(participant);
+        break;
+      case S16:
+        DoReduceScatter<S16>(participant);
+        break;
+      case U16:
+        DoReduceScatter<U16>(participant);
+        break;
+      case S32:
+        DoReduceScatter<S32>(participant);
+        break;
+      case U32:
+        DoReduceScatter<U32>(participant);
+        break;
+      case S64:
+        DoReduceScatter<S64>(participant);
+        break;
+      case U64:
+        DoReduceScatter<U64>(participant);
+        break;
+      case F16:
+        DoReduceScatter<F16>(participant);
+        break;
+      case F32:
+        DoReduceScatter<F32>(participant);
+        break;
+      case F64:
+        DoReduceScatter<F64>(participant);
+        break;
+      case C64:
+        DoReduceScatter<C64>(participant);
+        break;
+      case C128:
+        DoReduceScatter<C128>(participant);
+        break;
+      default:
+        LOG(FATAL) << "Unexpected datatype;";
     }
+    return nullptr;
   }
 
-  template <typename T,
-            typename std::enable_if<is_complex<T>::value>::type* = nullptr>
-  T PerformReductionStep(ReductionKind reduction_kind, T a, T b) {
-    using SumProductType = typename SumProductTypeForReductionStep<
-        T, std::is_integral<T>::value && std::is_signed<T>::value>::type;
-    switch (reduction_kind) {
-      case ReductionKind::SUM:
-        return absl::bit_cast<T>(
-            static_cast<SumProductType>(absl::bit_cast<SumProductType>(a) +
-                                        absl::bit_cast<SumProductType>(b)));
-      case ReductionKind::PRODUCT:
-        return absl::bit_cast<T>(
-            static_cast<SumProductType>(absl::bit_cast<SumProductType>(a) *
-                                        absl::bit_cast<SumProductType>(b)));
-      case ReductionKind::MIN:
-      case ReductionKind::MAX:
-        LOG(FATAL) << "min/max not valid for complex types";
+ private:
+  template <PrimitiveType PT>
+  void DoReduceScatter(const ReduceScatterParticipantData& participant) {
+    using T = typename primitive_util::PrimitiveTypeToNative<PT>::type;
+    std::vector<const T*> source_buffers;
+    {
+      absl::MutexLock lock(&mu_);
+      source_buffers.resize(participants_.size());
+      for (const ReduceScatterParticipantData& p : participants_) {
+        CHECK(p.reduction_kind == participant.reduction_kind);
+        CHECK_EQ(p.primitive_type, participant.primitive_type);
+        CHECK_EQ(p.num_chunks, participant.num_chunks);
+        CHECK_EQ(p.chunk_elements, participant.chunk_elements);
+        source_buffers[p.rank] =
+            static_cast<const T*>(p.source_buffer.opaque());
+      }
+    }
+
+    int64_t num_participants = source_buffers.size();
+    int64_t chunk_elements = participant.chunk_elements;
+    T* destination = static_cast<T*>(participant.destination_buffer.opaque());
+    for (int64_t chunk = 0; chunk < participant.num_chunks; ++chunk) {
+      int64_t source_offset =
+          (chunk * num_participants + participant.rank) * chunk_elements;
+      T* acc = destination + chunk * chunk_elements;
+      std::memcpy(acc, source_buffers[0] + source_offset,
+                  chunk_elements * sizeof(T));
+      for (int64_t i = 1; i < num_participants; ++i) {
+        ReduceBlock<T>(participant.reduction_kind, acc,
+                       source_buffers[i] + source_offset, chunk_elements);
+      }
     }
   }
 };
@@ -576,6 +846,20 @@ GlobalAllToAllRendezvousMap() {
   return m;
 }
 
+RefcountingHashMap<RendezvousKey, CpuAllGatherRendezvous>&
+GlobalAllGatherRendezvousMap() {
+  static auto& m =
+      *new RefcountingHashMap<RendezvousKey, CpuAllGatherRendezvous>;
+  return m;
+}
+
+RefcountingHashMap<RendezvousKey, CpuReduceScatterRendezvous>&
+GlobalReduceScatterRendezvousMap() {
+  static auto& m =
+      *new RefcountingHashMap<RendezvousKey, CpuReduceScatterRendezvous>;
+  return m;
+}
+
 RendezvousKey GetRendezvousKey(const ExecutableRunOptions* run_options,
                                std::vector<ReplicaGroup> group,
                                int32_t channel_id_present,
@@ -771,6 +1055,103 @@ void AllReduceImpl(const ExecutableRunOptions* run_options,
                   .status());
 }
 
+// Returns the position of the calling device among the participants of the
+// collective identified by `rendezvous_key`.
+int GetRankInRendezvous(const RendezvousKey& rendezvous_key,
+                        int device_ordinal) {
+  auto it = absl::c_find(rendezvous_key.global_devices,
+                         GlobalDeviceId(device_ordinal));
+  CHECK(it != rendezvous_key.global_devices.end())
+      << "Device " << device_ordinal << " does not participate in "
+      << rendezvous_key.ToString();
+  return std::distance(rendezvous_key.global_devices.begin(), it);
+}
+
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY
+void AllGatherImpl(const ExecutableRunOptions* run_options,
+                   int32_t channel_id_present, int32_t use_global_device_ids,
+                   int64_t op_id, const void* replica_groups_str,
+                   int32_t replica_groups_str_size, int64_t num_chunks,
+                   int64_t chunk_bytes, void* source_buffer,
+                   void* destination_buffer) {
+  int device_ordinal = GetDeviceOrdinal(run_options);
+  absl::string_view replica_groups_serialized(
+      static_cast<const char*>(replica_groups_str), replica_groups_str_size);
+  std::vector<ReplicaGroup> group =
+      ParseReplicaGroupsOnly(replica_groups_serialized).value();
+  RendezvousKey rendezvous_key = GetRendezvousKey(
+      run_options, group, channel_id_present, use_global_device_ids, op_id);
+  int64_t num_participants = rendezvous_key.global_devices.size();
+
+  AllGatherParticipantData participant(rendezvous_key, device_ordinal,
+                                       run_options->stream());
+  participant.rank = GetRankInRendezvous(rendezvous_key, device_ordinal);
+  participant.num_chunks = num_chunks;
+  participant.chunk_bytes = chunk_bytes;
+  participant.source_buffer =
+      se::DeviceMemoryBase(source_buffer, num_chunks * chunk_bytes);
+  participant.destination_buffer = se::DeviceMemoryBase(
+      destination_buffer, num_chunks * chunk_bytes * num_participants);
+
+  auto make_cpu_rendezvous = [](const RendezvousKey& k) {
+    return std::make_unique<CpuAllGatherRendezvous>(k);
+  };
+  TF_CHECK_OK(CpuAllGatherRendezvous::SubmitParticipant(
+                  [&] {
+                    return GlobalAllGatherRendezvousMap().GetOrCreateIfAbsent(
+                        rendezvous_key, make_cpu_rendezvous);
+                  },
+                  participant)
+                  .status());
+}
+
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY
+void ReduceScatterImpl(const ExecutableRunOptions* run_options,
+                       const void* replica_groups_str,
+                       int32_t replica_groups_str_size,
+                       int32_t channel_id_present,
+                       int32_t use_global_device_ids, int64_t op_id,
+                       int32_t reduction_kind, int32_t element_type,
+                       int64_t num_chunks, int64_t chunk_elements,
+                       void* input_buffer, void* output_buffer) {
+  int device_ordinal = GetDeviceOrdinal(run_options);
+  absl::string_view replica_groups_serialized(
+      static_cast<const char*>(replica_groups_str), replica_groups_str_size);
+  std::vector<ReplicaGroup> group =
+      ParseReplicaGroupsOnly(replica_groups_serialized).value();
+  RendezvousKey rendezvous_key = GetRendezvousKey(
+      run_options, group, channel_id_present, use_global_device_ids, op_id);
+  int64_t num_participants = rendezvous_key.global_devices.size();
+
+  PrimitiveType primitive_type = static_cast<PrimitiveType>(element_type);
+  int64_t chunk_bytes =
+      chunk_elements * ShapeUtil::ByteSizeOfPrimitiveType(primitive_type);
+
+  ReduceScatterParticipantData participant(rendezvous_key, device_ordinal,
+                                           run_options->stream());
+  participant.rank = GetRankInRendezvous(rendezvous_key, device_ordinal);
+  participant.primitive_type = primitive_type;
+  participant.reduction_kind = static_cast<ReductionKind>(reduction_kind);
+  participant.num_chunks = num_chunks;
+  participant.chunk_elements = chunk_elements;
+  participant.source_buffer = se::DeviceMemoryBase(
+      input_buffer, num_chunks * chunk_bytes * num_participants);
+  participant.destination_buffer =
+      se::DeviceMemoryBase(output_buffer, num_chunks * chunk_bytes);
+
+  auto make_cpu_rendezvous = [](const RendezvousKey& k) {
+    return std::make_unique<CpuReduceScatterRendezvous>(k);
+  };
+  TF_CHECK_OK(
+      CpuReduceScatterRendezvous::SubmitParticipant(
+          [&] {
+            return GlobalReduceScatterRendezvousMap().GetOrCreateIfAbsent(
+                rendezvous_key, make_cpu_rendezvous);
+          },
+          participant)
+          .status());
+}
+
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY
 void ReplicaIdImpl(const ExecutableRunOptions* run_options,
                    void* output_buffer) {
@@ -927,6 +1308,32 @@ void __xla_cpu_runtime_AllReduce(const xla::ExecutableRunOptions* run_options,
       shape_ptr, shape_length, num_buffers, input_buffers, output_buffers);
 }
 
+void __xla_cpu_runtime_AllGather(const xla::ExecutableRunOptions* run_options,
+                                 int32_t channel_id_present,
+                                 int32_t use_global_device_ids, int64_t op_id,
+                                 const void* replica_groups_str,
+                                 int32_t replica_groups_str_size,
+                                 int64_t num_chunks, int64_t chunk_bytes,
+                                 void* source_buffer,
+                                 void* destination_buffer) {
+  return xla::cpu::runtime::AllGatherImpl(
+      run_options, channel_id_present, use_global_device_ids, op_id,
+      replica_groups_str, replica_groups_str_size, num_chunks, chunk_bytes,
+      source_buffer, destination_buffer);
+}
+
+void __xla_cpu_runtime_ReduceScatter(
+    const xla::ExecutableRunOptions* run_options,
+    const void* replica_groups_str, int32_t replica_groups_str_size,
+    int32_t channel_id_present, int32_t use_global_device_ids, int64_t op_id,
+    int32_t reduction_kind, int32_t element_type, int64_t num_chunks,
+    int64_t chunk_elements, void* input_buffer, void* output_buffer) {
+  return xla::cpu::runtime::ReduceScatterImpl(
+      run_options, replica_groups_str, replica_groups_str_size,
+      channel_id_present, use_global_device_ids, op_id, reduction_kind,
+      element_type, num_chunks, chunk_elements, input_buffer, output_buffer);
+}
+
 void __xla_cpu_runtime_ReplicaId(const xla::ExecutableRunOptions* run_options,
                                  void* output_buffer) {
   return xla::cpu::runtime::ReplicaIdImpl(run_options, output_buffer);
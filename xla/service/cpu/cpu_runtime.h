@@ -81,7 +81,9 @@ extern const char* const kPrintfToStderrSymbolName;
 extern const char* const kStatusIsSuccessSymbolName;
 extern const char* const kKeyValueSortSymbolName;
 extern const char* const kTopKF32SymbolName;
+extern const char* const kAllGatherSymbolName;
 extern const char* const kAllReduceSymbolName;
+extern const char* const kReduceScatterSymbolName;
 extern const char* const kCollectivePermuteSymbolName;
 extern const char* const kPartitionIdSymbolName;
 extern const char* const kReplicaIdSymbolName;
@@ -187,6 +189,34 @@ extern void __xla_cpu_runtime_AllReduce(
     int32_t reduction_kind, const void* shape_ptr, int32_t shape_length,
     int32_t num_buffers, void** input_buffers, void** output_buffers);
 
+// Perform all gather on a CPU.
+//
+// The source buffer consists of `num_chunks` contiguous chunks of
+// `chunk_bytes` bytes each. For N participants, chunk `i` of the participant
+// with rank `r` in its replica group is written to chunk `i * N + r` of the
+// destination buffer of every participant.
+extern void __xla_cpu_runtime_AllGather(
+    const xla::ExecutableRunOptions* run_options, int32_t channel_id_present,
+    int32_t use_global_device_ids, int64_t op_id,
+    const void* replica_groups_str, int32_t replica_groups_str_size,
+    int64_t num_chunks, int64_t chunk_bytes, void* source_buffer,
+    void* destination_buffer);
+
+// Perform reduce scatter on a CPU.
+//
+// The output buffer consists of `num_chunks` contiguous chunks of
+// `chunk_elements` elements of type `element_type` each. For N participants,
+// chunk `i` of the output of the participant with rank `r` in its replica
+// group is the reduction of chunk `i * N + r` of the input buffers of all
+// participants.
+// reduction_kind: operator used for a reduction, cf. ReductionKind.
+extern void __xla_cpu_runtime_ReduceScatter(
+    const xla::ExecutableRunOptions* run_options,
+    const void* replica_groups_str, int32_t replica_groups_str_size,
+    int32_t channel_id_present, int32_t use_global_device_ids, int64_t op_id,
+    int32_t reduction_kind, int32_t element_type, int64_t num_chunks,
+    int64_t chunk_elements, void* input_buffer, void* output_buffer);
+
 extern void __xla_cpu_runtime_CollectivePermute(
     const xla::ExecutableRunOptions* run_options, int32_t channel_id_present,
     int64_t op_id, int32_t byte_size, void* input_buffer, void* output_buffer,
@@ -15,24 +15,33 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 #include "xla/service/cpu/cpu_runtime.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "absl/strings/str_format.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "xla/array2d.h"
 #include "xla/client/local_client.h"
+#include "xla/executable_run_options.h"
+#include "xla/service/collective_ops_utils.h"
+#include "xla/service/computation_placer.h"
 #include "xla/service/cpu/runtime_custom_call_status.h"
 #include "xla/service/cpu/runtime_matmul.h"
 #include "xla/service/cpu/runtime_matmul_acl.h"
 #include "xla/service/cpu/runtime_matmul_mkl.h"
 #include "xla/service/cpu/runtime_single_threaded_matmul.h"
 #include "xla/service/custom_call_status_internal.h"
+#include "xla/shape_util.h"
 #include "xla/types.h"
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -251,5 +260,107 @@ TEST_F(CpuRuntimeTest, FailureStatus) {
   ASSERT_FALSE(__xla_cpu_runtime_StatusIsSuccess(&success_status));
 }
 
+// Runs a single f32 all-reduce over `inputs.size()` replicas, one thread per
+// replica, writing the reduced values into `outputs`.
+void RunAllReduceF32(tsl::thread::ThreadPool* pool, int64_t op_id,
+                     ReductionKind reduction_kind,
+                     std::vector<std::vector<float>>& inputs,
+                     std::vector<std::vector<float>>& outputs) {
+  int num_replicas = inputs.size();
+  int64_t num_elements = inputs[0].size();
+  DeviceAssignment device_assignment(num_replicas, /*computation_count=*/1);
+  for (int i = 0; i < num_replicas; ++i) {
+    device_assignment(i, 0) = i;
+  }
+  RunId run_id;
+  std::string shape =
+      ShapeUtil::MakeShapeWithDescendingLayout(F32, {num_elements})
+          .ToProto()
+          .SerializeAsString();
+  std::string replica_groups = "{}";
+
+  tsl::BlockingCounter done(num_replicas);
+  for (int i = 0; i < num_replicas; ++i) {
+    pool->Schedule([&, i] {
+      ExecutableRunOptions run_options;
+      run_options.set_device_ordinal(i);
+      run_options.set_device_assignment(&device_assignment);
+      run_options.set_run_id(run_id);
+      void* input_buffer = inputs[i].data();
+      void* output_buffer = outputs[i].data();
+      __xla_cpu_runtime_AllReduce(
+          &run_options, replica_groups.data(), replica_groups.size(),
+          /*channel_id_present=*/0, /*use_global_device_ids=*/0, op_id,
+          static_cast<int32_t>(reduction_kind), shape.data(), shape.size(),
+          /*num_buffers=*/1, &input_buffer, &output_buffer);
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+}
+
+TEST_F(CpuRuntimeTest, AllReduceSum) {
+  // Uses an element count that does not divide evenly into slices, so that
+  // the last participant gets a partial slice and some get none at all.
+  constexpr int kNumReplicas = 3;
+  constexpr int64_t kNumElements = 1001;
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "all_reduce_test",
+                               kNumReplicas);
+  std::vector<std::vector<float>> inputs(kNumReplicas);
+  std::vector<std::vector<float>> outputs(kNumReplicas);
+  for (int r = 0; r < kNumReplicas; ++r) {
+    for (int64_t i = 0; i < kNumElements; ++i) {
+      inputs[r].push_back(r * kNumElements + i);
+    }
+    outputs[r].resize(kNumElements);
+  }
+  RunAllReduceF32(&pool, /*op_id=*/0, ReductionKind::SUM, inputs, outputs);
+  for (int r = 0; r < kNumReplicas; ++r) {
+    for (int64_t i = 0; i < kNumElements; ++i) {
+      ASSERT_EQ(outputs[r][i], 3 * kNumElements + 3 * i) << r << " " << i;
+    }
+  }
+}
+
+TEST_F(CpuRuntimeTest, AllReduceMaxInPlace) {
+  constexpr int kNumReplicas = 4;
+  constexpr int64_t kNumElements = 4096;
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "all_reduce_test",
+                               kNumReplicas);
+  std::vector<std::vector<float>> buffers(kNumReplicas);
+  for (int r = 0; r < kNumReplicas; ++r) {
+    for (int64_t i = 0; i < kNumElements; ++i) {
+      buffers[r].push_back(-1.0f * ((r + i) % kNumReplicas) - 1.0f);
+    }
+  }
+  RunAllReduceF32(&pool, /*op_id=*/0, ReductionKind::MAX, buffers, buffers);
+  for (int r = 0; r < kNumReplicas; ++r) {
+    for (int64_t i = 0; i < kNumElements; ++i) {
+      ASSERT_EQ(buffers[r][i], -1.0f) << r << " " << i;
+    }
+  }
+}
+
+void BM_AllReduceF32(::testing::benchmark::State& state) {
+  const int num_replicas = state.range(0);
+  const int64_t num_elements = state.range(1);
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "all_reduce_bm",
+                               num_replicas);
+  std::vector<std::vector<float>> inputs(
+      num_replicas, std::vector<float>(num_elements, 1.0f));
+  std::vector<std::vector<float>> outputs(num_replicas,
+                                          std::vector<float>(num_elements));
+  int64_t op_id = 0;
+  for (auto s : state) {
+    RunAllReduceF32(&pool, op_id++, ReductionKind::SUM, inputs, outputs);
+  }
+  state.SetBytesProcessed(state.iterations() * num_replicas * num_elements *
+                          sizeof(float));
+}
+
+BENCHMARK(BM_AllReduceF32)
+    ->ArgsProduct({{2, 4, 8, 16}, {1 << 10, 1 << 16, 1 << 20, 1 << 24}})
+    ->UseRealTime();
+
 }  // namespace
 }  // namespace xla
@@ -1285,6 +1285,162 @@ Status IrEmitter::HandleAllReduce(HloInstruction* crs) {
   return HandleAllReduceMultipleReplica(crs);
 }
 
+// Returns the number of contiguous chunks that a row-major array of `shape`
+// splits into when it is cut along `dimension`, i.e. the product of all
+// dimensions more major than `dimension`.
+static int64_t NumContiguousChunks(const Shape& shape, int64_t dimension) {
+  int64_t num_chunks = 1;
+  for (int64_t i = 0; i < dimension; ++i) {
+    num_chunks *= shape.dimensions(i);
+  }
+  return num_chunks;
+}
+
+Status IrEmitter::HandleAllGather(HloInstruction* instruction) {
+  auto* instr = Cast<HloAllGatherInstruction>(instruction);
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(instruction));
+  if (instr->operand_count() != 1 || !instr->shape().IsArray()) {
+    return Unimplemented("Only single-operand AllGather is supported: %s",
+                         instr->ToString());
+  }
+
+  const Shape& operand_shape = instr->operand(0)->shape();
+  const Shape& shape = instr->shape();
+  if (!LayoutUtil::IsMonotonicWithDim0Major(operand_shape.layout()) ||
+      !LayoutUtil::IsMonotonicWithDim0Major(shape.layout())) {
+    return Unimplemented("AllGather requires row-major layouts: %s",
+                         instr->ToString());
+  }
+
+  std::string replica_groups =
+      ReplicaGroupsToString(instruction->replica_groups());
+  int32_t replica_groups_size = replica_groups.size();
+  llvm::Value* replica_groups_v = b_.CreateGlobalStringPtr(replica_groups);
+
+  // Each participant contributes `num_chunks` contiguous chunks, one per
+  // index of the dimensions that are more major than the gather dimension.
+  int64_t num_chunks =
+      NumContiguousChunks(operand_shape, instr->all_gather_dimension());
+  int64_t chunk_bytes = ShapeUtil::ByteSizeOf(operand_shape) / num_chunks;
+
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice input_slice,
+                      assignment_.GetUniqueSlice(instr->operand(0), {}));
+  llvm::Value* input_buffer = EmitBufferPointer(input_slice, operand_shape);
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice output_slice,
+                      assignment_.GetUniqueSlice(instr, {}));
+  llvm::Value* output_buffer = EmitBufferPointer(output_slice, shape);
+
+  llvm::Type* i8_ptr_type = llvm::Type::getInt8PtrTy(module_->getContext());
+  EmitCallToFunc(
+      runtime::kAllGatherSymbolName,
+      {/*run_options=*/GetExecutableRunOptionsArgument(),
+       /*channel_id_present=*/
+       b_.getInt32(static_cast<int32_t>(instr->channel_id().has_value())),
+       /*use_global_device_ids=*/
+       b_.getInt32(static_cast<int32_t>(instr->use_global_device_ids())),
+       /*op_id=*/
+       b_.getInt64(instr->channel_id().has_value()
+                       ? *instr->channel_id()
+                       : instr->GetModule()->unique_id()),
+       /*replica_groups=*/replica_groups_v,
+       /*replica_groups_size=*/b_.getInt32(replica_groups_size),
+       /*num_chunks=*/b_.getInt64(num_chunks),
+       /*chunk_bytes=*/b_.getInt64(chunk_bytes),
+       /*source_buffer=*/b_.CreateBitCast(input_buffer, i8_ptr_type),
+       /*destination_buffer=*/b_.CreateBitCast(output_buffer, i8_ptr_type)},
+      b_.getVoidTy());
+
+  return OkStatus();
+}
+
+Status IrEmitter::HandleReduceScatter(HloInstruction* instruction) {
+  auto* instr = Cast<HloReduceScatterInstruction>(instruction);
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(instruction));
+  if (instr->operand_count() != 1 || !instr->shape().IsArray()) {
+    return Unimplemented("Only single-operand ReduceScatter is supported: %s",
+                         instr->ToString());
+  }
+
+  const Shape& operand_shape = instr->operand(0)->shape();
+  const Shape& shape = instr->shape();
+  if (!LayoutUtil::IsMonotonicWithDim0Major(operand_shape.layout()) ||
+      !LayoutUtil::IsMonotonicWithDim0Major(shape.layout())) {
+    return Unimplemented("ReduceScatter requires row-major layouts: %s",
+                         instr->ToString());
+  }
+
+  PrimitiveType datatype = shape.element_type();
+  switch (datatype) {
+    case PRED:
+    case S8:
+    case U8:
+    case S16:
+    case U16:
+    case S32:
+    case U32:
+    case S64:
+    case U64:
+    case F16:
+    case F32:
+    case F64:
+    case C64:
+    case C128:
+      break;
+    default:
+      return Unimplemented(
+          "ReduceScatter for datatype '%s' is not supported",
+          primitive_util::LowercasePrimitiveTypeName(datatype));
+  }
+
+  std::optional<ReductionKind> reduction_kind =
+      MatchReductionComputation(instr->to_apply());
+  if (!reduction_kind.has_value()) {
+    return Unimplemented("ReduceScatter for computation '%s' is not supported",
+                         instr->to_apply()->ToString());
+  }
+
+  std::string replica_groups = ReplicaGroupsToString(instr->replica_groups());
+  int32_t replica_groups_size = replica_groups.size();
+  llvm::Value* replica_groups_v = b_.CreateGlobalStringPtr(replica_groups);
+
+  // Each participant receives `num_chunks` contiguous chunks, one per index of
+  // the dimensions that are more major than the scatter dimension.
+  int64_t num_chunks = NumContiguousChunks(shape, instr->scatter_dimension());
+  int64_t chunk_elements = ShapeUtil::ElementsIn(shape) / num_chunks;
+
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice input_slice,
+                      assignment_.GetUniqueSlice(instr->operand(0), {}));
+  llvm::Value* input_buffer = EmitBufferPointer(input_slice, operand_shape);
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice output_slice,
+                      assignment_.GetUniqueSlice(instr, {}));
+  llvm::Value* output_buffer = EmitBufferPointer(output_slice, shape);
+
+  llvm::Type* i8_ptr_type = llvm::Type::getInt8PtrTy(module_->getContext());
+  EmitCallToFunc(
+      runtime::kReduceScatterSymbolName,
+      {/*run_options=*/GetExecutableRunOptionsArgument(),
+       /*replica_groups=*/replica_groups_v,
+       /*replica_groups_size=*/b_.getInt32(replica_groups_size),
+       /*channel_id_present=*/
+       b_.getInt32(static_cast<int32_t>(instr->channel_id().has_value())),
+       /*use_global_device_ids=*/
+       b_.getInt32(static_cast<int32_t>(instr->use_global_device_ids())),
+       /*op_id=*/
+       b_.getInt64(instr->channel_id().has_value()
+                       ? *instr->channel_id()
+                       : instr->GetModule()->unique_id()),
+       /*reduction_kind=*/
+       b_.getInt32(static_cast<int32_t>(*reduction_kind)),
+       /*element_type=*/b_.getInt32(datatype),
+       /*num_chunks=*/b_.getInt64(num_chunks),
+       /*chunk_elements=*/b_.getInt64(chunk_elements),
+       /*input_buffer=*/b_.CreateBitCast(input_buffer, i8_ptr_type),
+       /*output_buffer=*/b_.CreateBitCast(output_buffer, i8_ptr_type)},
+      b_.getVoidTy());
+
+  return OkStatus();
+}
+
 Status IrEmitter::HandleAllToAll(HloInstruction* instruction) {
   auto* instr = Cast<HloAllToAllInstruction>(instruction);
   TF_RETURN_IF_ERROR(EmitTargetAddressForOp(instruction));
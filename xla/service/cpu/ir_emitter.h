@@ -134,6 +134,7 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   // special in some way are handled explicitly in HandleFoo methods.
   Status DefaultAction(HloInstruction* hlo) override;
 
+  Status HandleAllGather(HloInstruction* instruction) override;
   Status HandleAllToAll(HloInstruction* instruction) override;
   Status HandleBitcast(HloInstruction* bitcast) override;
   Status HandleConstant(HloInstruction* constant) override;
@@ -145,6 +146,7 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   Status HandleFft(HloInstruction* fft) override;
   Status HandleAllReduce(HloInstruction* crs) override;
   Status HandleCollectivePermute(HloInstruction* crs) override;
+  Status HandleReduceScatter(HloInstruction* instruction) override;
   Status HandleInfeed(HloInstruction* instruction) override;
   Status HandleOutfeed(HloInstruction* outfeed) override;
   Status HandleSort(HloInstruction* hlo) override;
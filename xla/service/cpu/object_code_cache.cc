@@ -0,0 +1,137 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/object_code_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tsl/lib/monitoring/counter.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/path.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+auto* object_code_cache_lookups = tsl::monitoring::Counter<1>::New(
+    "/xla/cpu/object_code_cache_lookups",
+    "The number of lookups in the XLA:CPU on-disk object code cache.",
+    "result");
+
+}  // namespace
+
+ObjectCodeCache::ObjectCodeCache(std::string directory, std::string key_salt)
+    : directory_(std::move(directory)), key_salt_(std::move(key_salt)) {}
+
+std::string ObjectCodeCache::Key(const llvm::Module& module,
+                                 const llvm::TargetMachine& target_machine,
+                                 int opt_level, bool optimize_for_size,
+                                 bool disable_expensive_passes,
+                                 llvm::FastMathFlags fast_math_flags,
+                                 bool dfsan_enabled) const {
+  llvm::SmallVector<char, 0> bitcode;
+  llvm::raw_svector_ostream ostream(bitcode);
+  llvm::WriteBitcodeToFile(module, ostream);
+
+  std::string options = absl::StrCat(
+      LLVM_VERSION_STRING, ";", target_machine.getTargetTriple().str(), ";",
+      target_machine.getTargetCPU().str(), ";",
+      target_machine.getTargetFeatureString().str(), ";", opt_level, ";",
+      optimize_for_size, disable_expensive_passes, dfsan_enabled, ";",
+      fast_math_flags.allowReassoc(), fast_math_flags.noNaNs(),
+      fast_math_flags.noInfs(), fast_math_flags.noSignedZeros(),
+      fast_math_flags.allowReciprocal(), fast_math_flags.allowContract(),
+      fast_math_flags.approxFunc(), ";", key_salt_);
+
+  tsl::Fprint128 fingerprint = tsl::FingerprintCat128(
+      tsl::Fingerprint128(options),
+      tsl::Fingerprint128(absl::string_view(bitcode.data(), bitcode.size())));
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+std::string ObjectCodeCache::PathForKey(const std::string& key) const {
+  return tsl::io::JoinPath(directory_, absl::StrCat(key, ".o"));
+}
+
+std::unique_ptr<llvm::MemoryBuffer> ObjectCodeCache::Lookup(
+    const std::string& key) const {
+  static auto* hits = object_code_cache_lookups->GetCell("hit");
+  static auto* misses = object_code_cache_lookups->GetCell("miss");
+
+  tsl::Env* env = tsl::Env::Default();
+  std::string path = PathForKey(key);
+  std::string contents;
+  if (!env->FileExists(path).ok() ||
+      !tsl::ReadFileToString(env, path, &contents).ok()) {
+    VLOG(2) << "Object code cache miss: " << path;
+    misses->IncrementBy(1);
+    return nullptr;
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> object =
+      llvm::MemoryBuffer::getMemBufferCopy(contents, path);
+  // Guard against truncated or otherwise corrupted entries.
+  llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> object_file =
+      llvm::object::ObjectFile::createObjectFile(object->getMemBufferRef());
+  if (!object_file) {
+    LOG(WARNING) << "Ignoring invalid object code cache entry " << path << ": "
+                 << llvm::toString(object_file.takeError());
+    misses->IncrementBy(1);
+    return nullptr;
+  }
+
+  VLOG(2) << "Object code cache hit: " << path;
+  hits->IncrementBy(1);
+  return object;
+}
+
+void ObjectCodeCache::Store(const std::string& key,
+                            llvm::MemoryBufferRef object) const {
+  tsl::Env* env = tsl::Env::Default();
+  std::string path = PathForKey(key);
+  std::string tmp_path = path;
+  tsl::Status status = env->RecursivelyCreateDir(directory_);
+  if (status.ok() && !env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    status = tsl::errors::Internal("Failed to create a unique file name");
+  }
+  if (status.ok()) {
+    status = tsl::WriteStringToFile(
+        env, tmp_path,
+        absl::string_view(object.getBufferStart(), object.getBufferSize()));
+  }
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write object code cache entry " << path << ": "
+                 << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
+}  // namespace cpu
+}  // namespace xla
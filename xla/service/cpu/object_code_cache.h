@@ -0,0 +1,79 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_OBJECT_CODE_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_OBJECT_CODE_CACHE_H_
+
+#include <memory>
+#include <string>
+
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Target/TargetMachine.h"
+
+namespace xla {
+namespace cpu {
+
+// A content-addressed cache of object files on disk, used by the CPU JIT to
+// skip LLVM optimization and code generation for modules it has compiled
+// before, including in earlier processes.
+//
+// Entries are keyed on the unoptimized LLVM module together with everything
+// else that influences the generated code: the target triple, CPU and
+// features, the optimization options and the LLVM version. The LLVM module is
+// itself a deterministic function of the optimized HLO module and the
+// compilation flags, so this is at least as precise as keying on the HLO.
+//
+// The cache is best effort: failures to read or write entries are logged and
+// treated as misses. Entries are written to a temporary file and renamed into
+// place, so concurrent processes may share a directory.
+//
+// Lookups are exported as the /xla/cpu/object_code_cache_lookups metric, with
+// a "result" label that is either "hit" or "miss".
+class ObjectCodeCache {
+ public:
+  // 'key_salt' is mixed into every key and should capture global state that
+  // affects code generation but is not visible to LLVM's TargetMachine, such
+  // as LLVM command line options.
+  ObjectCodeCache(std::string directory, std::string key_salt);
+
+  // Returns the key for compiling 'module' with 'target_machine' and the given
+  // options.
+  std::string Key(const llvm::Module& module,
+                  const llvm::TargetMachine& target_machine, int opt_level,
+                  bool optimize_for_size, bool disable_expensive_passes,
+                  llvm::FastMathFlags fast_math_flags,
+                  bool dfsan_enabled) const;
+
+  // Returns the cached object file for 'key', or nullptr on a miss.
+  std::unique_ptr<llvm::MemoryBuffer> Lookup(const std::string& key) const;
+
+  // Stores 'object' under 'key'.
+  void Store(const std::string& key, llvm::MemoryBufferRef object) const;
+
+  const std::string& directory() const { return directory_; }
+
+ private:
+  std::string PathForKey(const std::string& key) const;
+
+  const std::string directory_;
+  const std::string key_salt_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_OBJECT_CODE_CACHE_H_
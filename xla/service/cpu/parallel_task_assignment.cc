@@ -16,13 +16,17 @@ limitations under the License.
 #include "xla/service/cpu/parallel_task_assignment.h"
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
+#include <string>
+#include <utility>
 
 #include "absl/strings/str_cat.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/cost_model_profile.h"
 #include "xla/service/cpu/ir_emission_utils.h"
 #include "xla/service/cpu/shape_partition.h"
 #include "xla/service/llvm_ir/dynamic_update_slice_util.h"
@@ -109,6 +113,60 @@ class DefaultCostModel : public ParallelCostModel {
   const std::unique_ptr<HloCostAnalysis> cost_analysis_;
 };
 
+// Picks the task count that minimizes the run time estimated from a calibrated
+// host profile. An instruction split into 'n' tasks is modeled as taking
+//
+//   max(compute / n, bytes / min(n * per-core bandwidth, total bandwidth))
+//     + n * per-task overhead
+//
+// so memory-bound instructions stop splitting once the extra tasks no longer
+// buy bandwidth, and small instructions are not split at all.
+class CalibratedCostModel : public ParallelCostModel {
+ public:
+  CalibratedCostModel(const int64_t max_parallelism, CostModelProfile profile,
+                      std::unique_ptr<HloCostAnalysis> cost_analysis)
+      : max_parallelism_(max_parallelism),
+        profile_(std::move(profile)),
+        cost_analysis_(std::move(cost_analysis)) {}
+  ~CalibratedCostModel() override {}
+
+  int64_t GetParallelTaskCount(HloInstruction* instruction) override {
+    const double compute_seconds =
+        cost_analysis_->flop_count(*instruction) /
+            profile_.flops_per_second_per_core() +
+        cost_analysis_->transcendental_count(*instruction) /
+            profile_.transcendentals_per_second_per_core();
+    const double bytes = cost_analysis_->bytes_accessed(*instruction);
+
+    int64_t best_task_count = 1;
+    double best_seconds = EstimateSeconds(compute_seconds, bytes, 1);
+    for (int64_t n = 2; n <= max_parallelism_; ++n) {
+      const double seconds = EstimateSeconds(compute_seconds, bytes, n);
+      // Only add tasks for a clear win, so that estimation noise does not
+      // split instructions for nothing.
+      if (seconds < 0.95 * best_seconds) {
+        best_task_count = n;
+        best_seconds = seconds;
+      }
+    }
+    return best_task_count;
+  }
+
+ private:
+  double EstimateSeconds(double compute_seconds, double bytes,
+                         int64_t task_count) const {
+    const double bandwidth =
+        std::min(task_count * profile_.memory_bandwidth_per_core(),
+                 profile_.memory_bandwidth_total());
+    return std::max(compute_seconds / task_count, bytes / bandwidth) +
+           task_count * profile_.task_overhead_seconds();
+  }
+
+  const int64_t max_parallelism_;
+  const CostModelProfile profile_;
+  const std::unique_ptr<HloCostAnalysis> cost_analysis_;
+};
+
 ParallelTaskAssignment::ParallelTaskAssignment(
     const int64_t max_parallelism,
     const HloCostAnalysis::ShapeSizeFunction& shape_size, HloModule* module,
@@ -119,6 +177,18 @@ ParallelTaskAssignment::ParallelTaskAssignment(
   auto cost_analysis = std::make_unique<HloCostAnalysis>(shape_size);
   HloComputation* computation = module->entry_computation();
   Status status = computation->root_instruction()->Accept(cost_analysis.get());
+  const std::string& profile_spec =
+      module->config().debug_options().xla_cpu_parallel_cost_model_profile();
+  if (status.ok() && !profile_spec.empty()) {
+    StatusOr<CostModelProfile> profile = GetCostModelProfile(profile_spec);
+    if (profile.ok()) {
+      cost_model_.reset(new CalibratedCostModel(
+          max_parallelism, *std::move(profile), std::move(cost_analysis)));
+      return;
+    }
+    LOG(WARNING) << "Ignoring CPU cost model profile '" << profile_spec
+                 << "': " << profile.status();
+  }
   if (status.ok()) {
     // Set default cost model based on 'cost_analysis'.
     cost_model_.reset(new DefaultCostModel(max_parallelism, shape_size,
@@ -33,6 +33,9 @@ class ParallelCostModel {
 };
 
 // ParallelTaskAssignment computes parallel task counts for HLOs in 'module'.
+// If the module sets xla_cpu_parallel_cost_model_profile, task counts minimize
+// the run time estimated from that host profile; otherwise they come from
+// HloCostAnalysis based heuristics.
 class ParallelTaskAssignment {
  public:
   // 'max_parallelism': the maximum parallel task count per instruction.
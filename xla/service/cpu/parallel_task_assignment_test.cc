@@ -15,11 +15,15 @@ limitations under the License.
 
 #include "xla/service/cpu/parallel_task_assignment.h"
 
+#include "absl/strings/str_cat.h"
+#include "xla/service/cpu/cost_model_profile.pb.h"
 #include "xla/service/cpu/cpu_executable.h"
 #include "xla/service/cpu/target_machine_features_fake.h"
 #include "xla/test.h"
 #include "xla/tests/hlo_test_base.h"
 #include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
 
 namespace xla {
 namespace {
@@ -45,6 +49,18 @@ class ParallelTaskAssignmentTest : public HloTestBase {
                                      &target_machine_features_)
         .Run(module);
   }
+
+  // Makes the assigner use the calibrated cost model with 'profile' on
+  // 'module'.
+  void UseCostModelProfile(HloModule* module,
+                           const cpu::CostModelProfile& profile) {
+    std::string path = tsl::io::JoinPath(
+        tsl::testing::TmpDir(), absl::StrCat(module->name(), ".profile"));
+    TF_ASSERT_OK(tsl::WriteTextProto(tsl::Env::Default(), path, profile));
+    DebugOptions debug_options = module->config().debug_options();
+    debug_options.set_xla_cpu_parallel_cost_model_profile(path);
+    module->config().set_debug_options(debug_options);
+  }
 };
 
 TEST_F(ParallelTaskAssignmentTest, DotOperationNotParallelized) {
@@ -206,5 +222,44 @@ TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+constexpr char kMemoryBoundAdd[] = R"(
+  HloModule TestTaskParallel_memory_bound_add
+    ENTRY add {
+      lhs = f32[1234567] parameter(0)
+      rhs = f32[1234567] parameter(1)
+      ROOT add = f32[1234567] add(lhs, rhs)
+    }
+  )";
+
+TEST_F(ParallelTaskAssignmentTest,
+       MemoryBoundAddNotParallelizedWhenOneCoreSaturatesBandwidth) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(kMemoryBoundAdd));
+  cpu::CostModelProfile profile;
+  profile.set_flops_per_second_per_core(1e9);
+  profile.set_transcendentals_per_second_per_core(1e8);
+  profile.set_memory_bandwidth_per_core(1e10);
+  profile.set_memory_bandwidth_total(1e10);
+  profile.set_task_overhead_seconds(1e-6);
+  UseCostModelProfile(m.get(), profile);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(ParallelTaskAssignmentTest,
+       MemoryBoundAddParallelizedWhenCoresAddBandwidth) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(kMemoryBoundAdd));
+  cpu::CostModelProfile profile;
+  profile.set_flops_per_second_per_core(1e9);
+  profile.set_transcendentals_per_second_per_core(1e8);
+  profile.set_memory_bandwidth_per_core(1e10);
+  profile.set_memory_bandwidth_total(1e11);
+  profile.set_task_overhead_seconds(1e-6);
+  UseCostModelProfile(m.get(), profile);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+}
+
 }  // namespace
 }  // namespace xla
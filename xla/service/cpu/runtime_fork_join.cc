@@ -17,21 +17,157 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/base/dynamic_annotations.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "xla/executable_run_options.h"
 #include "xla/service/custom_call_status_internal.h"
-#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/mutex.h"
 
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      void*, int64_t*, uint64_t*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchronize threads after parallel calls complete.
+namespace {
+
+// State shared between the caller of ParallelForkJoin and the helper closures
+// it enqueues on the intra-op thread pool.
+//
+// Partitions are not bound to threads up front: the caller and every helper
+// repeatedly claim the next unclaimed partition until none are left. A slow
+// partition therefore only delays the thread running it, and the caller keeps
+// doing useful work instead of blocking while partitions are still unclaimed.
+//
+// The state is reference counted so that the caller only has to wait for
+// partitions that are in flight, not for helpers that have not been scheduled
+// yet. This matters for nested fork-joins: if every pool thread is busy, the
+// caller simply runs all partitions itself, and helpers that start late find
+// nothing left to do. As late helpers may outlive the call, the state cannot
+// live on the caller's stack; instead, states are recycled through a free
+// list once their last reference is dropped, so that calls do not allocate
+// once as many states exist as fork-joins run at the same time.
+class ForkJoinState {
+ public:
+  // Returns a state for a fork-join with the given arguments, to be released
+  // by `num_refs` calls to Unref().
+  static ForkJoinState* Acquire(ComputeFunctionType function, void* result_ptr,
+                                const void* run_options_ptr,
+                                void** buffer_table, uint64_t* prof_counters,
+                                int32_t num_partitions, int64_t* partitions,
+                                int64_t stride, int32_t num_refs) {
+    FreeList& free_list = GetFreeList();
+    ForkJoinState* state = nullptr;
+    {
+      tsl::mutex_lock lock(free_list.mu);
+      if (free_list.head != nullptr) {
+        state = free_list.head;
+        free_list.head = state->next_free_;
+      }
+    }
+    if (state == nullptr) {
+      state = new ForkJoinState();
+    }
+    state->function_ = function;
+    state->result_ptr_ = result_ptr;
+    state->run_options_ptr_ = run_options_ptr;
+    state->buffer_table_ = buffer_table;
+    state->prof_counters_ = prof_counters;
+    state->num_partitions_ = num_partitions;
+    state->partitions_ = partitions;
+    state->stride_ = stride;
+    state->next_partition_.store(0, std::memory_order_relaxed);
+    state->pending_ = num_partitions;
+    state->refs_.store(num_refs, std::memory_order_relaxed);
+    state->errors_.clear();
+    return state;
+  }
+
+  // Claims and runs partitions until every partition has been claimed.
+  void RunPartitions() {
+    while (true) {
+      const int32_t i = next_partition_.fetch_add(1, std::memory_order_relaxed);
+      if (i >= num_partitions_) return;
+      XlaCustomCallStatus status;
+      function_(result_ptr_, run_options_ptr_, nullptr, buffer_table_, &status,
+                &partitions_[i * stride_], prof_counters_);
+      VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+      tsl::mutex_lock lock(mu_);
+      if (status.message) {
+        errors_.emplace_back(i, *std::move(status.message));
+      }
+      if (--pending_ == 0) {
+        done_.notify_all();
+      }
+    }
+  }
+
+  // Blocks until every partition has finished running and returns the errors
+  // they reported, ordered by partition.
+  std::vector<std::pair<int32_t, std::string>> Wait() {
+    tsl::mutex_lock lock(mu_);
+    while (pending_ > 0) {
+      done_.wait(lock);
+    }
+    std::sort(errors_.begin(), errors_.end());
+    return std::move(errors_);
+  }
+
+  void Unref() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      FreeList& free_list = GetFreeList();
+      tsl::mutex_lock lock(free_list.mu);
+      next_free_ = free_list.head;
+      free_list.head = this;
+    }
+  }
+
+ private:
+  // States whose last reference was dropped, linked through `next_free_`.
+  struct FreeList {
+    tsl::mutex mu;
+    ForkJoinState* head TF_GUARDED_BY(mu) = nullptr;
+  };
+
+  static FreeList& GetFreeList() {
+    static auto* free_list = new FreeList();
+    return *free_list;
+  }
+
+  ForkJoinState() = default;
+
+  ComputeFunctionType function_;
+  void* result_ptr_;
+  const void* run_options_ptr_;
+  void** buffer_table_;
+  uint64_t* prof_counters_;
+  int32_t num_partitions_;
+  int64_t* partitions_;
+  int64_t stride_;
+
+  std::atomic<int32_t> next_partition_{0};
+  std::atomic<int32_t> refs_{0};
+
+  tsl::mutex mu_;
+  tsl::condition_variable done_;
+  int32_t pending_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<std::pair<int32_t, std::string>> errors_ TF_GUARDED_BY(mu_);
+
+  ForkJoinState* next_free_ = nullptr;
+};
+
+}  // namespace
+
+// Runs 'num_partitions' calls to 'function_ptr' in parallel on the intra-op
+// thread pool. The calling thread takes part in running partitions, and
+// partitions are handed out dynamically to whichever thread is free, so
+// partitions of uneven cost and nested fork-joins do not stall the pool.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -73,55 +209,42 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   const xla::ExecutableRunOptions* run_options =
       static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
   CHECK_NE(run_options, nullptr);
-  CHECK_NE(run_options->intra_op_thread_pool(), nullptr);
+  const Eigen::ThreadPoolDevice* thread_pool =
+      run_options->intra_op_thread_pool();
+  CHECK_NE(thread_pool, nullptr);
 
   ComputeFunctionType function =
       reinterpret_cast<ComputeFunctionType>(function_ptr);
   // Compute partition stride in 'partitions' array.
   const int64_t stride = 2 * num_partitioned_dims;
 
-  std::vector<XlaCustomCallStatus> statuses(num_partitions);
-
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tsl::BlockingCounter bc(num_partitions - 1);
-  for (int32_t i = 1; i < num_partitions; ++i) {
-    const int64_t offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc, &statuses]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &statuses[i], &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
-  }
+  // There is no point in enqueueing more helpers than the pool can run at
+  // once; the caller is the remaining participant.
+  const int32_t num_helpers =
+      std::min<int32_t>(num_partitions - 1, thread_pool->numThreads());
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &statuses[0],
-           &partitions[0], prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
-
-  // Collect all error messages (if any).
-  std::vector<std::pair<int32_t, absl::string_view>> error_messages;
-  for (int32_t i = 0; i < num_partitions; ++i) {
-    std::optional<absl::string_view> msg =
-        xla::CustomCallStatusGetMessage(&statuses[i]);
-    if (msg) {
-      error_messages.emplace_back(i, *msg);
-    }
+  ForkJoinState* state = ForkJoinState::Acquire(
+      function, result_ptr, run_options_ptr, buffer_table, prof_counters,
+      num_partitions, partitions, stride, num_helpers + 1);
+  for (int32_t i = 0; i < num_helpers; ++i) {
+    thread_pool->enqueueNoNotification([state]() {
+      state->RunPartitions();
+      state->Unref();
+    });
   }
 
-  if (!error_messages.empty()) {
+  state->RunPartitions();
+  std::vector<std::pair<int32_t, std::string>> errors = state->Wait();
+  state->Unref();
+
+  if (!errors.empty()) {
     // Join all error messages into a single string to serve as the message for
     // the returned status.
     std::string error_message = absl::StrJoin(
-        error_messages, "\n",
-        [](std::string* out, std::pair<int32_t, absl::string_view> p) {
-          int32_t idx = p.first;
-          absl::string_view msg = p.second;
-          absl::StrAppend(out,
-                          absl::StrFormat("Partition %d error: %s", idx, msg));
+        errors, "\n",
+        [](std::string* out, const std::pair<int32_t, std::string>& p) {
+          absl::StrAppend(out, absl::StrFormat("Partition %d error: %s",
+                                               p.first, p.second));
         });
     XlaCustomCallStatusSetFailure(
         reinterpret_cast<XlaCustomCallStatus*>(status), error_message.data(),
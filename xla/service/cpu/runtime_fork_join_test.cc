@@ -0,0 +1,241 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/runtime_fork_join.h"
+
+#define EIGEN_USE_THREADS
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "xla/executable_run_options.h"
+#include "xla/service/custom_call_status_internal.h"
+#include "tsl/platform/blocking_counter.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Builds a one-dimensional 'partitions' array where partition i covers
+// [bounds[i], bounds[i + 1]).
+std::vector<int64_t> MakePartitions(const std::vector<int64_t>& bounds) {
+  std::vector<int64_t> partitions;
+  for (int64_t i = 0; i + 1 < bounds.size(); ++i) {
+    partitions.push_back(bounds[i]);
+    partitions.push_back(bounds[i + 1]);
+  }
+  return partitions;
+}
+
+// Increments the counters at [start, limit) of the vector in buffer_table[0].
+void CountPartition(void* /*result*/, const void* /*run_options*/,
+                    const void** /*params*/, void** buffer_table,
+                    void* /*status*/, int64_t* partition,
+                    uint64_t* /*prof_counters*/) {
+  auto* counters =
+      static_cast<std::vector<std::atomic<int32_t>>*>(buffer_table[0]);
+  for (int64_t i = partition[0]; i < partition[1]; ++i) {
+    (*counters)[i].fetch_add(1);
+  }
+}
+
+// Fails every partition that starts at an odd index.
+void FailOddPartitions(void* /*result*/, const void* /*run_options*/,
+                       const void** /*params*/, void** /*buffer_table*/,
+                       void* status, int64_t* partition,
+                       uint64_t* /*prof_counters*/) {
+  if (partition[0] % 2 == 1) {
+    std::string message = absl::StrCat("odd ", partition[0]);
+    XlaCustomCallStatusSetFailure(static_cast<XlaCustomCallStatus*>(status),
+                                  message.data(), message.size());
+  }
+}
+
+// Runs a nested fork-join over [start, limit) that counts into the vector in
+// buffer_table[0].
+void NestedCountPartition(void* result, const void* run_options,
+                          const void** /*params*/, void** buffer_table,
+                          void* status, int64_t* partition,
+                          uint64_t* prof_counters) {
+  std::vector<int64_t> bounds;
+  for (int64_t i = partition[0]; i <= partition[1]; ++i) bounds.push_back(i);
+  std::vector<int64_t> partitions = MakePartitions(bounds);
+  __xla_cpu_runtime_ParallelForkJoin(
+      result, run_options, nullptr, buffer_table, status, prof_counters,
+      partitions.size() / 2, partitions.data(), 1,
+      reinterpret_cast<void*>(&CountPartition));
+}
+
+class ForkJoinTest : public ::testing::Test {
+ protected:
+  ForkJoinTest()
+      : pool_(tsl::Env::Default(), "fork_join_test", 2),
+        device_(pool_.AsEigenThreadPool(), pool_.NumThreads()) {
+    run_options_.set_intra_op_thread_pool(&device_);
+  }
+
+  tsl::thread::ThreadPool pool_;
+  Eigen::ThreadPoolDevice device_;
+  ExecutableRunOptions run_options_;
+};
+
+TEST_F(ForkJoinTest, RunsEveryPartitionOnce) {
+  std::vector<std::atomic<int32_t>> counters(100);
+  void* buffer_table[] = {&counters};
+  std::vector<int64_t> partitions =
+      MakePartitions({0, 1, 2, 10, 11, 50, 51, 52, 99, 100});
+  XlaCustomCallStatus status;
+  __xla_cpu_runtime_ParallelForkJoin(
+      nullptr, &run_options_, nullptr, buffer_table, &status, nullptr,
+      partitions.size() / 2, partitions.data(), 1,
+      reinterpret_cast<void*>(&CountPartition));
+  EXPECT_FALSE(status.message.has_value());
+  for (int64_t i = 0; i < counters.size(); ++i) {
+    EXPECT_EQ(counters[i].load(), 1) << "element " << i;
+  }
+}
+
+TEST_F(ForkJoinTest, JoinsErrorsInPartitionOrder) {
+  std::vector<int64_t> partitions = MakePartitions({0, 1, 2, 3, 4, 5});
+  XlaCustomCallStatus status;
+  __xla_cpu_runtime_ParallelForkJoin(
+      nullptr, &run_options_, nullptr, nullptr, &status, nullptr,
+      partitions.size() / 2, partitions.data(), 1,
+      reinterpret_cast<void*>(&FailOddPartitions));
+  ASSERT_TRUE(status.message.has_value());
+  EXPECT_EQ(*status.message,
+            "Partition 1 error: odd 1\nPartition 3 error: odd 3");
+}
+
+TEST_F(ForkJoinTest, NestedForkJoinsComplete) {
+  // Every outer partition blocks a pool thread while running an inner
+  // fork-join, so this only completes if callers run partitions themselves.
+  std::vector<std::atomic<int32_t>> counters(64);
+  void* buffer_table[] = {&counters};
+  std::vector<int64_t> partitions =
+      MakePartitions({0, 8, 16, 24, 32, 40, 48, 56, 64});
+  XlaCustomCallStatus status;
+  __xla_cpu_runtime_ParallelForkJoin(
+      nullptr, &run_options_, nullptr, buffer_table, &status, nullptr,
+      partitions.size() / 2, partitions.data(), 1,
+      reinterpret_cast<void*>(&NestedCountPartition));
+  EXPECT_FALSE(status.message.has_value());
+  for (int64_t i = 0; i < counters.size(); ++i) {
+    EXPECT_EQ(counters[i].load(), 1) << "element " << i;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below.
+//===----------------------------------------------------------------------===//
+
+using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
+                                     void*, int64_t*, uint64_t*);
+
+// The previous fork-join strategy, kept as a baseline: one closure per
+// partition is enqueued on the pool and the caller blocks until all of them
+// have finished.
+void StaticForkJoin(const void* run_options_ptr, void** buffer_table,
+                    int32_t num_partitions, int64_t* partitions,
+                    ComputeFunctionType function) {
+  const auto* run_options =
+      static_cast<const ExecutableRunOptions*>(run_options_ptr);
+  std::vector<XlaCustomCallStatus> statuses(num_partitions);
+  tsl::BlockingCounter bc(num_partitions - 1);
+  for (int32_t i = 1; i < num_partitions; ++i) {
+    run_options->intra_op_thread_pool()->enqueueNoNotification([&, i]() {
+      function(nullptr, run_options_ptr, nullptr, buffer_table, &statuses[i],
+               &partitions[2 * i], nullptr);
+      bc.DecrementCount();
+    });
+  }
+  function(nullptr, run_options_ptr, nullptr, buffer_table, &statuses[0],
+           &partitions[0], nullptr);
+  bc.Wait();
+}
+
+// Spins for a number of iterations proportional to the partition size.
+void SpinPartition(void* /*result*/, const void* /*run_options*/,
+                   const void** /*params*/, void** /*buffer_table*/,
+                   void* /*status*/, int64_t* partition,
+                   uint64_t* /*prof_counters*/) {
+  uint64_t x = partition[0];
+  for (int64_t i = partition[0]; i < partition[1]; ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  tsl::testing::DoNotOptimize(x);
+}
+
+// Partitions whose costs grow linearly, so that the last partition is
+// 'num_partitions' times as expensive as the first.
+std::vector<int64_t> MakeSkewedPartitions(int32_t num_partitions) {
+  constexpr int64_t kUnitCost = 1 << 12;
+  std::vector<int64_t> bounds = {0};
+  for (int32_t i = 1; i <= num_partitions; ++i) {
+    bounds.push_back(bounds.back() + i * kUnitCost);
+  }
+  return MakePartitions(bounds);
+}
+
+void RunSkewedForkJoinBenchmark(::testing::benchmark::State& state,
+                                bool dynamic) {
+  const int num_threads = state.range(0);
+  const int32_t num_partitions = state.range(1);
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "fork_join_bm",
+                               num_threads);
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), pool.NumThreads());
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+  std::vector<int64_t> partitions = MakeSkewedPartitions(num_partitions);
+  for (auto s : state) {
+    if (dynamic) {
+      XlaCustomCallStatus status;
+      __xla_cpu_runtime_ParallelForkJoin(
+          nullptr, &run_options, nullptr, nullptr, &status, nullptr,
+          num_partitions, partitions.data(), 1,
+          reinterpret_cast<void*>(&SpinPartition));
+    } else {
+      StaticForkJoin(&run_options, nullptr, num_partitions, partitions.data(),
+                     &SpinPartition);
+    }
+  }
+}
+
+void BM_StaticForkJoinSkewed(::testing::benchmark::State& state) {
+  RunSkewedForkJoinBenchmark(state, /*dynamic=*/false);
+}
+
+void BM_ParallelForkJoinSkewed(::testing::benchmark::State& state) {
+  RunSkewedForkJoinBenchmark(state, /*dynamic=*/true);
+}
+
+BENCHMARK(BM_StaticForkJoinSkewed)
+    ->ArgsProduct({{2, 4, 8}, {4, 16, 64}})
+    ->UseRealTime();
+BENCHMARK(BM_ParallelForkJoinSkewed)
+    ->ArgsProduct({{2, 4, 8}, {4, 16, 64}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
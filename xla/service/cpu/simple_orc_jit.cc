@@ -21,16 +21,24 @@ limitations under the License.
 #include <cstdio>
 #include <list>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/TargetParser/Host.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/ExecutionEngine/CRunnerUtils.h"  // from @llvm-project
 #include "xla/service/cpu/cpu_runtime.h"
 #include "xla/service/cpu/orc_jit_memory_mapper.h"
@@ -55,7 +63,11 @@ limitations under the License.
 #include "xla/service/cpu/windows_compatibility.h"
 #include "xla/service/custom_call_target_registry.h"
 #include "xla/types.h"
+#include "tsl/platform/blocking_counter.h"
+#include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/threadpool.h"
 
 // Provided by compiler-rt and MLIR.
 // Converts an F32 value to a BF16.
@@ -105,8 +117,18 @@ SimpleOrcJIT::SimpleOrcJIT(
     bool disable_expensive_passes, llvm::FastMathFlags fast_math_flags,
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
-    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
-    : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+    std::shared_ptr<const ObjectCodeCache> object_code_cache)
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      optimize_for_size_(optimize_for_size),
+      disable_expensive_passes_(disable_expensive_passes),
+      fast_math_flags_(fast_math_flags),
+      pre_optimization_hook_(std::move(pre_optimization_hook)),
+      post_optimization_hook_(std::move(post_optimization_hook)),
+      post_codegen_hook_(std::move(post_codegen_hook)),
+      object_code_cache_(std::move(object_code_cache)),
+      target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       target_triple_(target_machine_->getTargetTriple()),
       data_layout_(target_machine_->createDataLayout()),
       target_process_control_(std::move(target_process_control)),
@@ -116,13 +138,8 @@ SimpleOrcJIT::SimpleOrcJIT(
                       return std::make_unique<llvm::SectionMemoryManager>(
                           orc_jit_memory_mapper::GetInstance());
                     }),
-      compile_layer_(
-          *execution_session_, object_layer_,
-          std::make_unique<CompilerFunctor>(
-              target_machine_.get(), opt_level, optimize_for_size,
-              disable_expensive_passes, fast_math_flags,
-              std::move(pre_optimization_hook),
-              std::move(post_optimization_hook), std::move(post_codegen_hook))),
+      compile_layer_(*execution_session_, object_layer_,
+                     CreateCompiler(target_machine_.get())),
       main_jit_dylib_(&execution_session_->createBareJITDylib("<main>")),
       gdb_jit_event_listener_(
           llvm::JITEventListener::createGDBRegistrationListener()),
@@ -181,7 +198,8 @@ llvm::Expected<std::unique_ptr<SimpleOrcJIT>> SimpleOrcJIT::Create(
     bool disable_expensive_passes, llvm::FastMathFlags fast_math_flags,
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
-    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook) {
+    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+    std::shared_ptr<const ObjectCodeCache> object_code_cache) {
   auto SSP = std::make_shared<llvm::orc::SymbolStringPool>();
   auto target_process_control =
       llvm::orc::SelfExecutorProcessControl::Create(std::move(SSP));
@@ -195,7 +213,17 @@ llvm::Expected<std::unique_ptr<SimpleOrcJIT>> SimpleOrcJIT::Create(
       std::move(*target_process_control), std::move(execution_session),
       target_options, opt_level, optimize_for_size, disable_expensive_passes,
       fast_math_flags, std::move(pre_optimization_hook),
-      std::move(post_optimization_hook), std::move(post_codegen_hook));
+      std::move(post_optimization_hook), std::move(post_codegen_hook),
+      std::move(object_code_cache));
+}
+
+std::unique_ptr<CompilerFunctor> SimpleOrcJIT::CreateCompiler(
+    llvm::TargetMachine* target_machine) const {
+  return std::make_unique<CompilerFunctor>(
+      target_machine, opt_level_, optimize_for_size_, disable_expensive_passes_,
+      fast_math_flags_, pre_optimization_hook_, post_optimization_hook_,
+      post_codegen_hook_, /*dfsan_enabled=*/false,
+      /*dfsan_abi_list_files=*/std::vector<std::string>{}, object_code_cache_);
 }
 
 llvm::JITEvaluatedSymbol SimpleOrcJIT::ResolveRuntimeSymbol(
@@ -241,6 +269,82 @@ llvm::Error SimpleOrcJIT::AddModule(llvm::orc::ThreadSafeModule module) {
   return compile_layer_.add(*main_jit_dylib_, std::move(module));
 }
 
+llvm::Error SimpleOrcJIT::AddModuleInShards(
+    std::unique_ptr<llvm::Module> module, int num_shards) {
+  // Shards must not share an LLVMContext to be compiled concurrently, so they
+  // are moved to their own contexts through bitcode.
+  std::vector<std::string> shard_bitcode;
+  llvm::SplitModule(
+      *module, num_shards,
+      [&](std::unique_ptr<llvm::Module> shard) {
+        std::string bitcode;
+        llvm::raw_string_ostream ostream(bitcode);
+        llvm::WriteBitcodeToFile(*shard, ostream);
+        ostream.flush();
+        shard_bitcode.push_back(std::move(bitcode));
+      },
+      /*PreserveLocals=*/false);
+  module.reset();
+  VLOG(1) << "Compiling LLVM module in " << shard_bitcode.size() << " shards";
+
+  // TargetMachine is not thread-safe, so every shard gets its own.
+  const int64_t num_compiled_shards = shard_bitcode.size();
+  std::vector<std::unique_ptr<llvm::TargetMachine>> target_machines;
+  for (int64_t i = 0; i < num_compiled_shards; ++i) {
+    target_machines.push_back(
+        InferTargetMachineForJIT(target_options_, opt_level_));
+  }
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(
+      num_compiled_shards);
+  std::vector<std::string> errors(num_compiled_shards);
+  {
+    tsl::thread::ThreadPool pool(
+        tsl::Env::Default(), "xla_cpu_parallel_codegen",
+        std::min<int64_t>(num_compiled_shards,
+                          tsl::port::MaxParallelism()));
+    tsl::BlockingCounter counter(num_compiled_shards);
+    for (int64_t i = 0; i < num_compiled_shards; ++i) {
+      pool.Schedule([&, i] {
+        llvm::LLVMContext context;
+        llvm::Expected<std::unique_ptr<llvm::Module>> shard =
+            llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(shard_bitcode[i],
+                                      absl::StrCat("__compute_module_", i)),
+                context);
+        if (shard) {
+          llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> object =
+              (*CreateCompiler(target_machines[i].get()))(**shard);
+          if (object) {
+            objects[i] = std::move(*object);
+          } else {
+            errors[i] = llvm::toString(object.takeError());
+          }
+        } else {
+          errors[i] = llvm::toString(shard.takeError());
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+
+  for (int64_t i = 0; i < num_compiled_shards; ++i) {
+    if (!errors[i].empty()) {
+      return llvm::make_error<llvm::StringError>(
+          absl::StrCat("Failed to compile module shard ", i, ": ", errors[i]),
+          llvm::inconvertibleErrorCode());
+    }
+  }
+  for (auto& object : objects) {
+    if (llvm::Error error =
+            object_layer_.add(*main_jit_dylib_, std::move(object))) {
+      return error;
+    }
+  }
+  return llvm::Error::success();
+}
+
 void SimpleOrcJIT::DoneCompiling() {
   // The target machine takes a non-trivial amount of memory, so once we are
   // done compiling throw it away.
@@ -278,9 +382,11 @@ bool RegisterKnownJITSymbols() {
 
   REGISTER_CPU_RUNTIME_SYMBOL(AcquireInfeedBufferForDequeue);
   REGISTER_CPU_RUNTIME_SYMBOL(AcquireOutfeedBufferForPopulation);
+  REGISTER_CPU_RUNTIME_SYMBOL(AllGather);
   REGISTER_CPU_RUNTIME_SYMBOL(AllReduce);
   REGISTER_CPU_RUNTIME_SYMBOL(CollectivePermute);
   REGISTER_CPU_RUNTIME_SYMBOL(AllToAll);
+  REGISTER_CPU_RUNTIME_SYMBOL(ReduceScatter);
   REGISTER_CPU_RUNTIME_SYMBOL(PartitionId);
   REGISTER_CPU_RUNTIME_SYMBOL(ReplicaId);
   REGISTER_CPU_RUNTIME_SYMBOL(MKLConv2DF32);
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_SIMPLE_ORC_JIT_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_SIMPLE_ORC_JIT_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/TargetParser/Triple.h"
 #include "xla/service/cpu/compiler_functor.h"
+#include "xla/service/cpu/object_code_cache.h"
 #include "xla/types.h"
 
 namespace xla {
@@ -52,7 +54,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
   //
   // {pre,post}_optimization_hook is invoked on the module before/after all
   // LLVM IR-level optimizations.  post_codegen_hook is invoked after
-  // compiling to machine code.
+  // compiling to machine code.  If object_code_cache is set, compiled objects
+  // are served from and added to it.
   SimpleOrcJIT(
       std::unique_ptr<llvm::orc::ExecutorProcessControl> target_process_control,
       std::unique_ptr<llvm::orc::ExecutionSession> execution_session,
@@ -61,7 +64,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       bool disable_expensive_passes, llvm::FastMathFlags fast_math_flags,
       LLVMCompiler::ModuleHook pre_optimization_hook,
       LLVMCompiler::ModuleHook post_optimization_hook,
-      std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook);
+      std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+      std::shared_ptr<const ObjectCodeCache> object_code_cache = nullptr);
 
   static llvm::Expected<std::unique_ptr<SimpleOrcJIT>> Create(
       const llvm::TargetOptions& target_options,
@@ -69,7 +73,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       bool disable_expensive_passes, llvm::FastMathFlags fast_math_flags,
       LLVMCompiler::ModuleHook pre_optimization_hook,
       LLVMCompiler::ModuleHook post_optimization_hook,
-      std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook);
+      std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+      std::shared_ptr<const ObjectCodeCache> object_code_cache = nullptr);
 
   ~SimpleOrcJIT() override;
 
@@ -79,6 +84,14 @@ class SimpleOrcJIT : public llvm::JITEventListener {
 
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Splits 'module' into up to 'num_shards' modules, optimizes and compiles
+  // them concurrently, and adds the resulting objects to the JIT. Each shard
+  // is compiled in its own LLVMContext with its own TargetMachine; the
+  // optimization and codegen hooks are invoked once per shard, possibly
+  // concurrently.
+  llvm::Error AddModuleInShards(std::unique_ptr<llvm::Module> module,
+                                int num_shards);
+
   // Discards objects we no longer need once we are done compiling.
   void DoneCompiling();
 
@@ -100,6 +113,11 @@ class SimpleOrcJIT : public llvm::JITEventListener {
   }
 
  private:
+  // Returns a compiler for the compile layer or a module shard, configured
+  // with the options this JIT was created with.
+  std::unique_ptr<CompilerFunctor> CreateCompiler(
+      llvm::TargetMachine* target_machine) const;
+
   llvm::JITEvaluatedSymbol ResolveRuntimeSymbol(llvm::StringRef name);
 
   void notifyObjectLoaded(
@@ -108,6 +126,17 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       const llvm::RuntimeDyld::LoadedObjectInfo& object_info) override;
   void notifyFreeingObject(llvm::JITEventListener::ObjectKey key) override;
 
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const bool optimize_for_size_;
+  const bool disable_expensive_passes_;
+  const llvm::FastMathFlags fast_math_flags_;
+  const LLVMCompiler::ModuleHook pre_optimization_hook_;
+  const LLVMCompiler::ModuleHook post_optimization_hook_;
+  const std::function<void(const llvm::object::ObjectFile&)>
+      post_codegen_hook_;
+  const std::shared_ptr<const ObjectCodeCache> object_code_cache_;
+
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   llvm::Triple target_triple_;
   const llvm::DataLayout data_layout_;
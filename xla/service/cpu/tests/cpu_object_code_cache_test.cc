@@ -0,0 +1,124 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/service/cpu/tests/cpu_codegen_test.h"
+#include "xla/service/hlo_module_config.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/monitoring/cell_reader.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+using tsl::monitoring::testing::CellReader;
+
+constexpr char kLookupsMetric[] = "/xla/cpu/object_code_cache_lookups";
+
+constexpr char kAddHlo[] = R"(
+HloModule add
+
+ENTRY main {
+  p0 = f32[4] parameter(0)
+  p1 = f32[4] parameter(1)
+  ROOT add = f32[4] add(p0, p1)
+})";
+
+constexpr char kMultiplyHlo[] = R"(
+HloModule multiply
+
+ENTRY main {
+  p0 = f32[4] parameter(0)
+  p1 = f32[4] parameter(1)
+  ROOT multiply = f32[4] multiply(p0, p1)
+})";
+
+class CpuObjectCodeCacheTest : public CpuCodegenTest {
+ protected:
+  std::unique_ptr<HloModule> ParseWithCacheDir(absl::string_view hlo,
+                                               const std::string& cache_dir) {
+    HloModuleConfig config = GetModuleConfigForTest();
+    DebugOptions debug_options = config.debug_options();
+    debug_options.set_xla_cpu_object_code_cache_dir(cache_dir);
+    config.set_debug_options(debug_options);
+    return ParseAndReturnVerifiedModule(hlo, config).value();
+  }
+
+  int64_t NumCacheEntries(const std::string& cache_dir) {
+    std::vector<std::string> entries;
+    TF_CHECK_OK(tsl::Env::Default()->GetMatchingPaths(
+        tsl::io::JoinPath(cache_dir, "*.o"), &entries));
+    return entries.size();
+  }
+};
+
+TEST_F(CpuObjectCodeCacheTest, IdenticalModuleIsServedFromCache) {
+  std::string cache_dir =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "identical_module");
+  CellReader<int64_t> lookups(kLookupsMetric);
+  Literal lhs = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+  Literal rhs = LiteralUtil::CreateR1<float>({10, 20, 30, 40});
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal first, Execute(ParseWithCacheDir(kAddHlo, cache_dir),
+                             {&lhs, &rhs}));
+  EXPECT_EQ(lookups.Delta("miss"), 1);
+  EXPECT_EQ(lookups.Delta("hit"), 0);
+  EXPECT_EQ(NumCacheEntries(cache_dir), 1);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal second, Execute(ParseWithCacheDir(kAddHlo, cache_dir),
+                              {&lhs, &rhs}));
+  EXPECT_EQ(lookups.Delta("miss"), 0);
+  EXPECT_EQ(lookups.Delta("hit"), 1);
+  EXPECT_EQ(NumCacheEntries(cache_dir), 1);
+
+  EXPECT_EQ(first, LiteralUtil::CreateR1<float>({11, 22, 33, 44}));
+  EXPECT_EQ(second, first);
+}
+
+TEST_F(CpuObjectCodeCacheTest, DifferentModulesDoNotShareEntries) {
+  std::string cache_dir =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "different_modules");
+  CellReader<int64_t> lookups(kLookupsMetric);
+  Literal lhs = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+  Literal rhs = LiteralUtil::CreateR1<float>({10, 20, 30, 40});
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal sum, Execute(ParseWithCacheDir(kAddHlo, cache_dir),
+                           {&lhs, &rhs}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal product, Execute(ParseWithCacheDir(kMultiplyHlo, cache_dir),
+                               {&lhs, &rhs}));
+  EXPECT_EQ(lookups.Delta("miss"), 2);
+  EXPECT_EQ(lookups.Delta("hit"), 0);
+  EXPECT_EQ(NumCacheEntries(cache_dir), 2);
+
+  EXPECT_EQ(sum, LiteralUtil::CreateR1<float>({11, 22, 33, 44}));
+  EXPECT_EQ(product, LiteralUtil::CreateR1<float>({10, 40, 90, 160}));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,129 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "xla/array2d.h"
+#include "xla/debug_options_flags.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/service/cpu/cpu_compiler.h"
+#include "xla/service/cpu/tests/cpu_codegen_test.h"
+#include "xla/service/hlo_module_config.h"
+#include "xla/service/hlo_parser.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Returns a module with 'num_layers' dots, each followed by an elementwise
+// fusion, so that the emitted LLVM module has many functions to split.
+std::string LayeredHlo(int num_layers) {
+  std::string hlo = R"(
+HloModule layered
+
+ENTRY main {
+  p0 = f32[32,32] parameter(0)
+  p1 = f32[32,32] parameter(1)
+  x0 = f32[32,32] copy(p0)
+)";
+  for (int i = 1; i <= num_layers; ++i) {
+    absl::StrAppend(&hlo, "  d", i, " = f32[32,32] dot(x", i - 1,
+                    ", p1), lhs_contracting_dims={1}, "
+                    "rhs_contracting_dims={0}\n");
+    absl::StrAppend(&hlo, "  a", i, " = f32[32,32] add(d", i, ", x", i - 1,
+                    ")\n");
+    absl::StrAppend(&hlo, "  x", i, " = f32[32,32] tanh(a", i, ")\n");
+  }
+  absl::StrAppend(&hlo, "  ROOT r = f32[32,32] copy(x", num_layers, ")\n}\n");
+  return hlo;
+}
+
+HloModuleConfig ConfigWithSplitCount(HloModuleConfig config, int split_count) {
+  DebugOptions debug_options = config.debug_options();
+  debug_options.set_xla_cpu_parallel_codegen_split_count(split_count);
+  config.set_debug_options(debug_options);
+  return config;
+}
+
+class CpuParallelCodegenTest : public CpuCodegenTest {};
+
+TEST_F(CpuParallelCodegenTest, ShardedModuleComputesSameResult) {
+  const std::string hlo = LayeredHlo(/*num_layers=*/8);
+  Literal lhs = LiteralUtil::CreateR2FromArray2D<float>(
+      Array2D<float>(32, 32, 0.25f));
+  Literal rhs = LiteralUtil::CreateR2FromArray2D<float>(
+      Array2D<float>(32, 32, 0.01f));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<HloModule> unsharded,
+      ParseAndReturnVerifiedModule(
+          hlo, ConfigWithSplitCount(GetModuleConfigForTest(), 1)));
+  TF_ASSERT_OK_AND_ASSIGN(Literal expected,
+                          Execute(std::move(unsharded), {&lhs, &rhs}));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<HloModule> sharded,
+      ParseAndReturnVerifiedModule(
+          hlo, ConfigWithSplitCount(GetModuleConfigForTest(), 4)));
+  TF_ASSERT_OK_AND_ASSIGN(Literal actual,
+                          Execute(std::move(sharded), {&lhs, &rhs}));
+
+  EXPECT_EQ(actual, expected);
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below.
+//===----------------------------------------------------------------------===//
+
+void BM_CompileLayeredModule(::testing::benchmark::State& state) {
+  const int split_count = state.range(0);
+  const int num_layers = state.range(1);
+
+  HloModuleConfig config;
+  config.set_debug_options(GetDebugOptionsFromFlags());
+  std::unique_ptr<HloModule> module =
+      ParseAndReturnUnverifiedModule(
+          LayeredHlo(num_layers), ConfigWithSplitCount(config, split_count))
+          .value();
+
+  CpuCompiler compiler;
+  std::unique_ptr<HloModule> optimized =
+      compiler.RunHloPasses(std::move(module), /*stream_exec=*/nullptr,
+                            Compiler::CompileOptions{})
+          .value();
+  for (auto s : state) {
+    TF_CHECK_OK(compiler
+                    .RunBackend(optimized->Clone(), /*stream_exec=*/nullptr,
+                                Compiler::CompileOptions{})
+                    .status());
+  }
+}
+
+BENCHMARK(BM_CompileLayeredModule)
+    ->ArgsProduct({{1, 2, 4, 8}, {64, 256}})
+    ->MeasureProcessCPUTime()
+    ->UseRealTime()
+    ->Unit(::benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
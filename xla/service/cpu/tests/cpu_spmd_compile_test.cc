@@ -89,6 +89,44 @@ CHECK: call void @__xla_cpu_runtime_AllReduce
                                 /*match_optimized_ir=*/true);
 }
 
+TEST_F(CpuSpmdCompileTest, AllGatherAndReduceScatterAreNotDecomposed) {
+  const char *const hlo_string = R"(
+HloModule test
+
+sum {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY main {
+  p0 = f32[4,8]{1,0} parameter(0)
+  ag = f32[4,16]{1,0} all-gather(p0), replica_groups={{0,1}}, dimensions={1}
+  ROOT rs = f32[4,8]{1,0} reduce-scatter(ag), replica_groups={{0,1}}, dimensions={1}, to_apply=sum
+})";
+
+  HloModuleConfig config;
+  config.set_replica_count(2);
+  config.set_debug_options(GetDebugOptionsFromFlags());
+  auto module = ParseAndReturnVerifiedModule(hlo_string, config).value();
+
+  CpuAotCompilationOptions options{
+      /*triple=*/kTargetTripleForHost, /*cpu_name=*/kTargetCpuForHost,
+      /*features=*/"",
+      /*entry_point_name=*/"main",
+      /*relocation_model=*/CpuAotCompilationOptions::RelocationModel::Static};
+
+  std::string filecheck_pattern = R"(
+CHECK-NOT: call void @__xla_cpu_runtime_AllReduce
+CHECK: call void @__xla_cpu_runtime_AllGather
+CHECK-NOT: call void @__xla_cpu_runtime_AllReduce
+CHECK: call void @__xla_cpu_runtime_ReduceScatter
+)";
+
+  CompileAheadOfTimeAndVerifyIr(std::move(module), options, filecheck_pattern,
+                                /*match_optimized_ir=*/true);
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
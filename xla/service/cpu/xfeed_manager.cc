@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "xla/service/cpu/xfeed_manager.h"
 
+#include <thread>  // NOLINT
+
+#include "absl/time/clock.h"
 #include "xla/shape_util.h"
 #include "tsl/platform/logging.h"
 
@@ -34,17 +37,58 @@ void XfeedQueueManager::Reset() {
     buffer->Done(ShapeUtil::MakeNil());
   }
   enqueued_buffers_.clear();
+  num_enqueued_buffers_.store(0, std::memory_order_release);
+  not_full_cv_.SignalAll();
+}
+
+void XfeedQueueManager::set_capacity(int64_t capacity) {
+  CHECK_GE(capacity, 0);
+  absl::MutexLock l(&mu_);
+  capacity_ = capacity;
+  not_full_cv_.SignalAll();
+}
+
+void XfeedQueueManager::set_spin_duration(absl::Duration spin_duration) {
+  spin_duration_ns_.store(absl::ToInt64Nanoseconds(spin_duration),
+                          std::memory_order_relaxed);
+}
+
+bool XfeedQueueManager::HasRoomFor(int64_t num_buffers) const {
+  return capacity_ == 0 || enqueued_buffers_.empty() ||
+         static_cast<int64_t>(enqueued_buffers_.size()) + num_buffers <=
+             capacity_;
 }
 
 void XfeedQueueManager::EnqueueBuffersAtomically(
     absl::Span<XfeedBuffer* const> buffers) {
   absl::MutexLock l(&mu_);
+  while (!HasRoomFor(buffers.size())) {
+    VLOG(3) << "Waiting for room in the " << queue_name_ << " queue.";
+    not_full_cv_.Wait(&mu_);
+  }
+  EnqueueBuffersLocked(buffers);
+}
+
+bool XfeedQueueManager::TryEnqueueBuffersAtomically(
+    absl::Span<XfeedBuffer* const> buffers) {
+  absl::MutexLock l(&mu_);
+  if (!HasRoomFor(buffers.size())) {
+    return false;
+  }
+  EnqueueBuffersLocked(buffers);
+  return true;
+}
+
+void XfeedQueueManager::EnqueueBuffersLocked(
+    absl::Span<XfeedBuffer* const> buffers) {
   bool was_empty = enqueued_buffers_.empty();
   for (XfeedBuffer* b : buffers) {
     VLOG(3) << "Enqueueing " << queue_name_ << " buffer (of " << buffers.size()
             << " buffers) with length: " << b->length();
     enqueued_buffers_.push_back(b);
   }
+  num_enqueued_buffers_.store(enqueued_buffers_.size(),
+                              std::memory_order_release);
   if (was_empty && !buffers.empty()) {
     // This has the potential to suffer from the notified thread
     // immediately trying and failing to acquire mu_, but seems
@@ -55,6 +99,18 @@ void XfeedQueueManager::EnqueueBuffersAtomically(
 }
 
 XfeedBuffer* XfeedQueueManager::BlockingDequeueBuffer() {
+  const int64_t spin_duration_ns =
+      spin_duration_ns_.load(std::memory_order_relaxed);
+  if (spin_duration_ns > 0 &&
+      num_enqueued_buffers_.load(std::memory_order_acquire) == 0) {
+    // Poll without the lock so that producers are not slowed down.
+    absl::Time deadline = absl::Now() + absl::Nanoseconds(spin_duration_ns);
+    while (num_enqueued_buffers_.load(std::memory_order_acquire) == 0 &&
+           absl::Now() < deadline) {
+      std::this_thread::yield();
+    }
+  }
+
   absl::MutexLock l(&mu_);
   VLOG(3) << "Waiting for an available buffer.";
   while (enqueued_buffers_.empty()) {
@@ -64,6 +120,11 @@ XfeedBuffer* XfeedQueueManager::BlockingDequeueBuffer() {
   CHECK(current_buffer_ == nullptr);
   current_buffer_ = enqueued_buffers_.front();
   enqueued_buffers_.pop_front();
+  num_enqueued_buffers_.store(enqueued_buffers_.size(),
+                              std::memory_order_release);
+  if (capacity_ > 0) {
+    not_full_cv_.SignalAll();
+  }
   return current_buffer_;
 }
 
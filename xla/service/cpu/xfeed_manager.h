@@ -20,8 +20,14 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_XFEED_MANAGER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_XFEED_MANAGER_H_
 
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <string>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xla/shape.h"
 #include "xla/statusor.h"
@@ -59,12 +65,30 @@ class XfeedQueueManager {
   // condition is to call Reset when no computation is taking place.
   void Reset();
 
+  // Bounds the number of enqueued buffers to 'capacity', or removes the bound
+  // if 'capacity' is 0, which is the default. While bounded, producers get
+  // backpressure: EnqueueBuffersAtomically blocks until its batch fits. A
+  // batch larger than the capacity is admitted once the queue is empty, so
+  // that it cannot block forever.
+  void set_capacity(int64_t capacity);
+
+  // Makes BlockingDequeueBuffer poll for a buffer for up to 'spin_duration'
+  // before blocking on a condition variable. Spinning trades CPU time for
+  // lower wake-up latency when buffers arrive at a high rate. Defaults to
+  // zero, i.e. no spinning.
+  void set_spin_duration(absl::Duration spin_duration);
+
   // Adds a sequence of buffers to the queue atomically. buffer->Done will be
   // called when the buffer will no longer be accessed by the XfeedManager,
   // either as a result of a call to Reset or because the runtime has dequeued
-  // and used the buffer.
+  // and used the buffer. Blocks while a bounded queue has no room for the
+  // buffers.
   void EnqueueBuffersAtomically(absl::Span<XfeedBuffer* const> buffers);
 
+  // Like EnqueueBuffersAtomically, but returns false without enqueueing
+  // anything if a bounded queue has no room for the buffers.
+  bool TryEnqueueBuffersAtomically(absl::Span<XfeedBuffer* const> buffers);
+
   // Blocks until the queue is non-empty, then returns the buffer at the head of
   // the queue. Sets the current buffer to be the returned buffer. It is an
   // error to call BlockingDequeueBuffer if there is an unreleased current
@@ -85,6 +109,12 @@ class XfeedQueueManager {
   void ReleaseCurrentBuffer(int32_t length, void* data, StatusOr<Shape> shape);
 
  private:
+  // Returns whether 'num_buffers' more buffers fit in the queue.
+  bool HasRoomFor(int64_t num_buffers) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void EnqueueBuffersLocked(absl::Span<XfeedBuffer* const> buffers)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const std::string queue_name_;
 
   absl::Mutex mu_;
@@ -93,9 +123,21 @@ class XfeedQueueManager {
   // enqueued to an empty queue.
   absl::CondVar cv_;
 
+  // Condition variable that is signaled when buffers leave a bounded queue.
+  absl::CondVar not_full_cv_;
+
   // XfeedBuffer* queue contents are not owned, but buffer->Done must
   // be called when the buffer is no longer needed by the runtime.
-  std::deque<XfeedBuffer*> enqueued_buffers_;
+  std::deque<XfeedBuffer*> enqueued_buffers_ ABSL_GUARDED_BY(mu_);
+
+  // Mirrors enqueued_buffers_.size() so that a spinning consumer can poll it
+  // without taking mu_.
+  std::atomic<int64_t> num_enqueued_buffers_{0};
+
+  // Maximum number of enqueued buffers, or 0 if unbounded.
+  int64_t capacity_ ABSL_GUARDED_BY(mu_) = 0;
+
+  std::atomic<int64_t> spin_duration_ns_{0};
 
   // If non-NULL, the buffer that is currently being processed by the
   // runtime. Not owned.
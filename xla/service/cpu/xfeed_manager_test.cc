@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <memory>
 
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "xla/service/cpu/cpu_runtime.h"
 #include "xla/shape_util.h"
 #include "tsl/lib/core/status_test_util.h"
@@ -152,5 +154,77 @@ TEST_F(InfeedManagerTest, OutfeedWrongShape) {
   ProcessNextOutfeedBuffer(32, ShapeUtil::MakeShape(U8, {33}));
 }
 
+TEST_F(InfeedManagerTest, BoundedQueueBlocksUntilDequeue) {
+  cpu::runtime::XfeedQueueManager queue("bounded");
+  queue.set_capacity(1);
+  TestInfeedBuffer* a = new TestInfeedBuffer(64);
+  TestInfeedBuffer* b = new TestInfeedBuffer(32);
+  queue.EnqueueBuffersAtomically({a});
+
+  absl::Notification enqueued;
+  {
+    tsl::thread::ThreadPool pool(tsl::Env::Default(), "test", 1);
+    pool.Schedule([&]() {
+      queue.EnqueueBuffersAtomically({b});
+      enqueued.Notify();
+    });
+    EXPECT_FALSE(enqueued.WaitForNotificationWithTimeout(absl::Seconds(0.1)));
+
+    cpu::runtime::XfeedBuffer* buffer = queue.BlockingDequeueBuffer();
+    EXPECT_EQ(buffer, a);
+    queue.ReleaseCurrentBuffer(a->length(), a->data(), a->shape());
+    enqueued.WaitForNotification();
+  }
+
+  cpu::runtime::XfeedBuffer* buffer = queue.BlockingDequeueBuffer();
+  EXPECT_EQ(buffer, b);
+  queue.ReleaseCurrentBuffer(b->length(), b->data(), b->shape());
+}
+
+TEST_F(InfeedManagerTest, TryEnqueueFailsWhenFull) {
+  cpu::runtime::XfeedQueueManager queue("bounded");
+  queue.set_capacity(2);
+  // Reset releases 'a' and 'b' with a nil shape.
+  TestInfeedBuffer* a = new TestInfeedBuffer(64, /*expect_shape_match=*/false);
+  TestInfeedBuffer* b = new TestInfeedBuffer(32, /*expect_shape_match=*/false);
+  TestInfeedBuffer* c = new TestInfeedBuffer(16);
+  EXPECT_TRUE(queue.TryEnqueueBuffersAtomically({a}));
+  EXPECT_FALSE(queue.TryEnqueueBuffersAtomically({b, c}));
+  EXPECT_TRUE(queue.TryEnqueueBuffersAtomically({b}));
+  EXPECT_FALSE(queue.TryEnqueueBuffersAtomically({c}));
+
+  queue.Reset();
+  EXPECT_TRUE(queue.TryEnqueueBuffersAtomically({c}));
+  cpu::runtime::XfeedBuffer* buffer = queue.BlockingDequeueBuffer();
+  queue.ReleaseCurrentBuffer(buffer->length(), buffer->data(), c->shape());
+}
+
+TEST_F(InfeedManagerTest, BatchLargerThanCapacityIsAdmittedWhenEmpty) {
+  cpu::runtime::XfeedQueueManager queue("bounded");
+  queue.set_capacity(1);
+  TestInfeedBuffer* a = new TestInfeedBuffer(64);
+  TestInfeedBuffer* b = new TestInfeedBuffer(32);
+  queue.EnqueueBuffersAtomically({a, b});
+  for (TestInfeedBuffer* expected : {a, b}) {
+    cpu::runtime::XfeedBuffer* buffer = queue.BlockingDequeueBuffer();
+    EXPECT_EQ(buffer, expected);
+    queue.ReleaseCurrentBuffer(expected->length(), expected->data(),
+                               expected->shape());
+  }
+}
+
+TEST_F(InfeedManagerTest, SpinningDequeue) {
+  cpu::runtime::XfeedQueueManager queue("spinning");
+  queue.set_spin_duration(absl::Milliseconds(10));
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "test", 1);
+  for (int32_t length : {64, 32, 16}) {
+    TestInfeedBuffer* a = new TestInfeedBuffer(length);
+    pool.Schedule([&queue, a]() { queue.EnqueueBuffersAtomically({a}); });
+    cpu::runtime::XfeedBuffer* buffer = queue.BlockingDequeueBuffer();
+    EXPECT_EQ(buffer, a);
+    queue.ReleaseCurrentBuffer(a->length(), a->data(), a->shape());
+  }
+}
+
 }  // namespace
 }  // namespace xla
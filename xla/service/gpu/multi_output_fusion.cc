@@ -313,7 +313,7 @@ bool GpuMultiOutputFusion::FuseSiblings(HloInstruction* parent,
       TF_CHECK_OK(cost_analysis->RevisitInstruction(remaining));
       changed = true;
       siblings.erase(j);
-      RecomputeReachability();
+      reachability_->UpdateReachabilityAfterMutation(remaining);
     }
   }
   return changed;
@@ -394,7 +394,7 @@ StatusOr<bool> GpuMultiOutputFusion::DoMultiOutputFusion() {
           absl::StrCat("Fusing producer |", producer_name, "| into consumer |",
                        consumer_for_fusion->name(),
                        "| inside GPU multi-output fusion"));
-      RecomputeReachability();
+      reachability_->UpdateReachabilityAfterMutation(consumer_for_fusion);
       continue;
     }
     HloInstruction* input_fusion =
@@ -409,6 +409,7 @@ StatusOr<bool> GpuMultiOutputFusion::DoMultiOutputFusion() {
         absl::StrCat("About to fuse |", producer_name, "| into consumer |",
                      input_fusion->name(), "| inside GPU multi-output fusion"),
         /*producer=*/input_fusion);
+    reachability_->Replace(consumer_for_fusion, input_fusion);
     TF_CHECK_OK(
         computation_->ReplaceInstruction(consumer_for_fusion, input_fusion));
     if (producer->opcode() == HloOpcode::kFusion) {
@@ -424,7 +425,7 @@ StatusOr<bool> GpuMultiOutputFusion::DoMultiOutputFusion() {
         *input_fusion,
         absl::StrCat("Fusing producer |", producer_name, "| into consumer |",
                      input_fusion->name(), "| inside GPU multi-output fusion"));
-    RecomputeReachability();
+    reachability_->UpdateReachabilityAfterMutation(input_fusion);
   }
   return changed;
 }
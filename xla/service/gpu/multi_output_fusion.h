@@ -110,7 +110,8 @@ class GpuMultiOutputFusion : public HloModulePass {
 
   StatusOr<bool> DoMultiOutputFusion();
 
-  // Recompute reachability for the current computation.
+  // Recompute reachability for the current computation. Fusions within the
+  // computation update the map incrementally instead.
   void RecomputeReachability();
 
   void DumpFusionState(const HloInstruction& consumer, absl::string_view label,
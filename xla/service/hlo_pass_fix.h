@@ -17,8 +17,13 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_FIX_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <type_traits>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/ir/hlo_module_group.h"
 #include "xla/service/hlo_pass_interface.h"
@@ -29,6 +34,13 @@ limitations under the License.
 namespace xla {
 
 // Do an HLO pass to a fix point.
+//
+// If the pass is computation-local (see HloPassInterface::IsComputationLocal),
+// computations are compared by HloComputation::ContentFingerprint before and
+// after each iteration, so that changes the pass reports but which leave a
+// computation as it was do not keep the loop going; they still count as
+// changes of the run. Across runs, such a pass is not run again on
+// computations that did not change since it reached its fixed point on them.
 template <typename Pass, int kIterationLimit = 25>
 class HloPassFix : public Pass {
  public:
@@ -58,6 +70,12 @@ class HloPassFix : public Pass {
     return !run_state.changed.empty();
   }
 
+  // The fixed point loop lives in Run(), so running Pass on computations
+  // directly would skip it.
+  bool IsComputationPass() override { return false; }
+
+  int64_t FixedPointIterations() const override { return iterations_; }
+
   using HloPassInterface::RunOnModuleGroup;
   StatusOr<bool> RunOnModuleGroup(HloModuleGroup* module_group,
                                   const absl::flat_hash_set<absl::string_view>&
@@ -65,6 +83,7 @@ class HloPassFix : public Pass {
     bool changed = false;
     bool changed_this_iteration = true;
     int64_t iteration_count = 0;
+    iterations_ = 0;
     VLOG(3) << "Running HloPassFix.";
     while (changed_this_iteration) {
       TF_ASSIGN_OR_RETURN(
@@ -73,6 +92,7 @@ class HloPassFix : public Pass {
       changed |= changed_this_iteration;
       VLOG(3) << "changed_this_iteration: " << changed_this_iteration;
       ++iteration_count;
+      iterations_ = iteration_count;
       if (iteration_count == kIterationLimit) {
         VLOG(1) << "Unexpectedly high number of iterations in HLO passes, "
                    "exiting fixed point loop.";
@@ -88,19 +108,39 @@ class HloPassFix : public Pass {
       HloModule* module, RunState* run_state,
       const absl::flat_hash_set<absl::string_view>& execution_threads) {
     VLOG(3) << "Running HloPassFix on " << Pass::name();
+    iterations_ = 0;
+    const bool fingerprint = Pass::IsComputationLocal();
+    if (fingerprint) {
+      SkipComputationsAtFixedPoint(module, run_state, execution_threads);
+    }
     while (!run_state->changed_last_iteration.empty()) {
-      TF_RETURN_IF_ERROR(
-          RunOnChangedComputationsOnce(module, run_state, execution_threads));
+      Status status =
+          RunOnChangedComputationsOnce(module, run_state, execution_threads);
+      if (!status.ok()) {
+        fingerprints_.clear();
+        return status;
+      }
+      // What the pass reported is what the run changed; the fingerprints only
+      // decide which computations to run it on again.
+      run_state->changed.insert(run_state->changed_this_iteration.begin(),
+                                run_state->changed_this_iteration.end());
+      if (fingerprint) {
+        DropUnchangedComputations(run_state);
+      }
       VLOG(3) << Pass::name() << " iteration " << run_state->iteration
               << " changed_this_iteration: "
               << !run_state->changed_last_iteration.empty();
       run_state->IncrementIteration();
+      ++iterations_;
       if (run_state->iteration == kIterationLimit) {
         VLOG(1) << "Unexpectedly high number of iterations in HLO passes '"
                 << Pass::name() << "' for module '" << module->name()
                 << "'. Exiting fixed point loop.";
         // Clear changed and abort in case this is fixed point is nested.
         run_state->changed.clear();
+        // The module did not reach a fixed point, so the next run must not
+        // skip any computation.
+        fingerprints_.clear();
         break;
       }
     }
@@ -111,8 +151,7 @@ class HloPassFix : public Pass {
       HloModule* module, RunState* run_state,
       const absl::flat_hash_set<absl::string_view>& execution_threads) {
     // If Pass overrides RunOnChangedComputations, just forward to it.
-    if (!std::is_same<decltype(&HloPassInterface::RunOnChangedComputations),
-                      decltype(&Pass::RunOnChangedComputations)>::value) {
+    if (kRunsOnChangedComputations) {
       return Pass::RunOnChangedComputations(module, run_state,
                                             execution_threads);
     }
@@ -127,6 +166,78 @@ class HloPassFix : public Pass {
     }
     return OkStatus();
   }
+
+  // Records the fingerprint of 'computation' and returns whether it is the
+  // same as the one recorded before.
+  bool RefreshFingerprint(const HloComputation* computation) {
+    uint64_t fingerprint = computation->ContentFingerprint();
+    auto [it, inserted] =
+        fingerprints_.insert({computation->unique_id(), fingerprint});
+    if (inserted) {
+      return false;
+    }
+    bool unchanged = it->second == fingerprint;
+    it->second = fingerprint;
+    return unchanged;
+  }
+
+  // Leaves out of the computations the pass is about to run on those that did
+  // not change since it last reached a fixed point on them. A pass that runs
+  // on the whole module is skipped only if no computation changed.
+  void SkipComputationsAtFixedPoint(
+      HloModule* module, RunState* run_state,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) {
+    if (fingerprinted_module_id_ != module->unique_id()) {
+      fingerprints_.clear();
+      fingerprinted_module_id_ = module->unique_id();
+    }
+    if (kRunsOnChangedComputations) {
+      absl::erase_if(run_state->changed_last_iteration,
+                     [this](const HloComputation* computation) {
+                       return RefreshFingerprint(computation);
+                     });
+      return;
+    }
+    bool at_fixed_point = true;
+    for (const HloComputation* computation :
+         module->computations(execution_threads)) {
+      // Fingerprints all computations, as they are compared to the ones after
+      // the first iteration.
+      at_fixed_point &= RefreshFingerprint(computation);
+    }
+    if (at_fixed_point) {
+      VLOG(3) << Pass::name() << " is at a fixed point on module "
+              << module->name() << ", skipping it";
+      run_state->changed_last_iteration.clear();
+    }
+  }
+
+  // Leaves out of the computations the pass reported as changed in this
+  // iteration those whose fingerprint did not change, i.e. those it only made
+  // no-op rewrites to, so that such rewrites do not keep the fixed point loop
+  // going.
+  void DropUnchangedComputations(RunState* run_state) {
+    absl::erase_if(run_state->changed_this_iteration,
+                   [this](const HloComputation* computation) {
+                     return RefreshFingerprint(computation);
+                   });
+  }
+
+  // Whether Pass runs only on the computations that changed in the last
+  // iteration rather than on the whole module.
+  static constexpr bool kRunsOnChangedComputations =
+      !std::is_same<decltype(&HloPassInterface::RunOnChangedComputations),
+                    decltype(&Pass::RunOnChangedComputations)>::value;
+
+  // Number of iterations of the last fixed point loop.
+  int64_t iterations_ = 0;
+
+  // Fingerprints of the computations of the module the pass last ran on, by
+  // computation id. Once the fixed point loop ends, these are the
+  // fingerprints at which the pass reached its fixed point; the map is
+  // cleared when the loop fails or gives up.
+  absl::flat_hash_map<int64_t, uint64_t> fingerprints_;
+  int fingerprinted_module_id_ = -1;
 };
 
 }  // namespace xla
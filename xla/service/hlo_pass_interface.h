@@ -18,8 +18,11 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/ir/hlo_module_group.h"
+#include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/status_macros.h"
 #include "xla/statusor.h"
 #include "xla/types.h"
@@ -140,6 +143,25 @@ class HloPassInterface {
       const absl::flat_hash_set<absl::string_view>& execution_threads) = 0;
 
   virtual bool IsPassPipeline() { return false; }
+
+  // Whether this is an HloComputationPass, which may be run on several
+  // computations of a module at once.
+  virtual bool IsComputationPass() { return false; }
+
+  // How often the last run of the pass ran it to reach a fixed point, for
+  // passes that iterate (see HloPassFix); 0 for the others.
+  virtual int64_t FixedPointIterations() const { return 0; }
+
+  // Whether what the pass does to a computation depends only on the contents
+  // of that computation and of the fusion computations nested in it: not on
+  // the computations it calls otherwise, the module config, or earlier runs
+  // of the pass. HloPassFix then compares the computations by fingerprint
+  // (see HloComputation::ContentFingerprint) to end the fixed point loop on
+  // rewrites that leave them as they were, and to skip computations that did
+  // not change since an earlier run reached its fixed point on them.
+  // Fingerprinting walks every computation it checks, so it only pays off for
+  // passes that are expensive to run.
+  virtual bool IsComputationLocal() const { return false; }
 };
 
 // Base class for passes which are module-scoped.
@@ -167,6 +189,67 @@ class HloModulePass : public HloPassInterface {
   virtual void UpdateLayout(Shape* shape) {}
 };
 
+// Base class for module passes which transform each non-fusion computation
+// independently of the others. RunOnComputation may read and mutate only the
+// given computation and the fusion computations nested in it: it must not add
+// or remove computations of the module, nor look into other computations,
+// including the ones called by the given computation. It must also be safe to
+// call concurrently on different computations, so it must not mutate the pass
+// object without synchronization. In exchange, HloPassPipeline may run the
+// pass on several computations at once; see
+// HloPassPipeline::SetComputationThreadPool.
+class HloComputationPass : public HloModulePass {
+ public:
+  // Runs the pass on the given non-fusion computation. Returns whether it
+  // modified the computation.
+  virtual StatusOr<bool> RunOnComputation(HloComputation* computation) = 0;
+
+  // Runs RunOnComputation on each computation in turn. Subclasses should not
+  // override this, as HloPassPipeline may call RunOnComputation instead.
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(HloModule* module,
+                     const absl::flat_hash_set<absl::string_view>&
+                         execution_threads) override {
+    bool changed = false;
+    for (HloComputation* computation :
+         module->MakeNonfusionComputations(execution_threads)) {
+      TF_ASSIGN_OR_RETURN(bool computation_changed,
+                          RunOnComputation(computation));
+      changed |= computation_changed;
+    }
+    return changed;
+  }
+
+  // Runs RunOnComputation only on the non-fusion computations that changed in
+  // the last iteration, so that HloPassFix does not run it again on the
+  // computations that already reached a fixed point.
+  Status RunOnChangedComputations(HloModule* module, RunState* run_state,
+                                  const absl::flat_hash_set<absl::string_view>&
+                                      execution_threads) override {
+    for (HloComputation* computation :
+         module->MakeNonfusionComputations(execution_threads)) {
+      if (!run_state->changed_last_iteration.contains(computation)) {
+        continue;
+      }
+      TF_ASSIGN_OR_RETURN(bool changed, RunOnComputation(computation));
+      if (!changed) {
+        continue;
+      }
+      run_state->changed_this_iteration.insert(computation);
+      for (HloInstruction* instruction : computation->instructions()) {
+        if (instruction->opcode() == HloOpcode::kFusion) {
+          run_state->changed_this_iteration.insert(
+              instruction->called_computations().begin(),
+              instruction->called_computations().end());
+        }
+      }
+    }
+    return OkStatus();
+  }
+
+  bool IsComputationPass() override { return true; }
+};
+
 // Base class for passes which are module-group scoped. These passes cannot run
 // on an HLO module.
 class HloModuleGroupPass : public HloPassInterface {
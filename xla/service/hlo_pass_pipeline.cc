@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <functional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "xla/status_macros.h"
 #include "xla/types.h"
 #include "xla/util.h"
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/status.h"
@@ -121,6 +124,22 @@ void SetInstructionMetadata(HloModuleGroup& module_group) {
   }
 }
 
+int64_t InstructionCount(const HloModule& module) {
+  int64_t count = 0;
+  for (const HloComputation* computation : module.computations()) {
+    count += computation->instruction_count();
+  }
+  return count;
+}
+
+int64_t InstructionCount(const HloModuleGroup& module_group) {
+  int64_t count = 0;
+  for (const HloModule* module : module_group.modules()) {
+    count += InstructionCount(*module);
+  }
+  return count;
+}
+
 }  // namespace
 
 template <typename HloT>
@@ -177,16 +196,32 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     std::string pass_name = std::string(pass->name());
     VLOG(1) << "  HLO pass " << pass_name;
     VLOG(2) << "  Module hash " << absl::HashOf(*hlo);
+    int64_t instruction_count_before = 0;
     if (!pass->IsPassPipeline()) {
+      instruction_count_before = InstructionCount(*hlo);
       compilation_stats_->StartPass(pass_name);
     }
     RecordPassStartMetadata(*hlo, pass_name, pipeline_name);
+    if (pass->IsPassPipeline()) {
+      auto* nested = static_cast<HloPassPipeline*>(pass);
+      if (nested->computation_thread_pool_ == nullptr) {
+        nested->SetComputationThreadPool(computation_thread_pool_);
+      }
+      // Passes of nested pipelines without stats of their own are recorded
+      // here, as the nested pipeline itself is not.
+      if (nested->empty_compilation_stats_ != nullptr &&
+          nested->compilation_stats_ ==
+              nested->empty_compilation_stats_.get()) {
+        nested->compilation_stats_ = compilation_stats_;
+      }
+    }
     // Embed RunHelper into lambda to enable recording of error statuses
     auto run_helper_lambda =
         [this, pass_name](
             HloPassInterface* pass, HloT* hlo,
             const absl::flat_hash_set<absl::string_view>& execution_threads) {
-          auto status_or = RunHelper(pass, hlo, execution_threads);
+          auto status_or = RunHelper(pass, hlo, execution_threads,
+                                     computation_thread_pool_);
           if (!status_or.ok()) {
             compilation_stats_->RecordPassError(
                 pass_name, tsl::error_name(status_or.status().code()));
@@ -220,12 +255,47 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
       TF_RETURN_IF_ERROR(run_invariant_checkers_lambda(hlo, pass_name));
     }
     if (!pass->IsPassPipeline()) {
+      CompilationStats::PassRunDetails details;
+      details.instruction_count_before = instruction_count_before;
+      details.instruction_count_after = InstructionCount(*hlo);
+      details.module_changed = pass_changed;
+      details.fixed_point_iterations = pass->FixedPointIterations();
+      compilation_stats_->RecordPassRunDetails(pass_name, details);
       compilation_stats_->EndPass(pass_name);
     }
   }
   return changed;
 }
 
+StatusOr<bool> HloPassPipeline::RunOnComputationsInParallel(
+    HloComputationPass* pass, HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads,
+    tsl::thread::ThreadPool* thread_pool) {
+  std::vector<HloComputation*> computations =
+      module->MakeNonfusionComputations(execution_threads);
+  if (computations.size() < 2) {
+    return pass->Run(module, execution_threads);
+  }
+  VLOG(2) << "  Running " << pass->name() << " on " << computations.size()
+          << " computations in parallel";
+  std::vector<StatusOr<bool>> results(computations.size(), false);
+  tsl::BlockingCounter counter(computations.size());
+  for (int64_t i = 0; i < computations.size(); ++i) {
+    thread_pool->Schedule([&, i] {
+      results[i] = pass->RunOnComputation(computations[i]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  bool changed = false;
+  for (StatusOr<bool>& result : results) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed, std::move(result));
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
 std::vector<HloPassInterface*> HloPassPipeline::GetEnabledPasses(
     const DebugOptions& debug_options) {
   if (debug_options.xla_disable_all_hlo_passes()) {
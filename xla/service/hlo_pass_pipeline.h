@@ -27,6 +27,7 @@ limitations under the License.
 #include "xla/service/hlo_pass_interface.h"
 #include "xla/statusor.h"
 #include "xla/types.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -89,6 +90,22 @@ class HloPassPipeline : public HloPassInterface {
 
   bool IsPassPipeline() override { return true; }
 
+  // A pipeline is computation-local if all its passes are.
+  bool IsComputationLocal() const override {
+    return std::all_of(passes_.begin(), passes_.end(),
+                       [](const std::unique_ptr<HloPassInterface>& pass) {
+                         return pass->IsComputationLocal();
+                       });
+  }
+
+  // Lets the pipeline run each HloComputationPass on the computations of a
+  // module in parallel on 'thread_pool', which must outlive the runs of the
+  // pipeline. Nested pipelines without a thread pool of their own use it too.
+  // The pipeline must not be run on a thread of 'thread_pool'.
+  void SetComputationThreadPool(tsl::thread::ThreadPool* thread_pool) {
+    computation_thread_pool_ = thread_pool;
+  }
+
   // Return size of passes_.
   int PassesSize() { return passes_.size(); }
   // Return reference to pass specified by index.
@@ -134,26 +151,47 @@ class HloPassPipeline : public HloPassInterface {
   // empty thread list means all `execution_threads` are considered. These
   // helpers enable templating of the core of the pipeline logic by providing
   // HloModule and HloModuleGroup specific methods with the same name.
+  // If 'thread_pool' is given, HloComputationPasses run on the computations
+  // of a module in parallel.
   static StatusOr<bool> RunHelper(
       HloPassInterface* pass, HloModule* module,
-      const absl::flat_hash_set<absl::string_view>& execution_threads) {
-    TF_ASSIGN_OR_RETURN(bool changed, pass->Run(module, execution_threads));
+      const absl::flat_hash_set<absl::string_view>& execution_threads,
+      tsl::thread::ThreadPool* thread_pool = nullptr) {
+    bool changed;
+    if (thread_pool != nullptr && pass->IsComputationPass()) {
+      TF_ASSIGN_OR_RETURN(
+          changed, RunOnComputationsInParallel(
+                       static_cast<HloComputationPass*>(pass), module,
+                       execution_threads, thread_pool));
+    } else {
+      TF_ASSIGN_OR_RETURN(changed, pass->Run(module, execution_threads));
+    }
     module->Cleanup();
     return changed;
   }
   static StatusOr<bool> RunHelper(
       HloPassInterface* pass, HloModuleGroup* module_group,
-      const absl::flat_hash_set<absl::string_view>& execution_threads) {
+      const absl::flat_hash_set<absl::string_view>& execution_threads,
+      tsl::thread::ThreadPool* thread_pool = nullptr) {
     TF_ASSIGN_OR_RETURN(
         bool changed, pass->RunOnModuleGroup(module_group, execution_threads));
     module_group->Cleanup();
     return changed;
   }
 
+  // Runs 'pass' on each non-fusion computation of 'module' on 'thread_pool',
+  // and waits for all of them to finish. Returns the first error in
+  // computation order.
+  static StatusOr<bool> RunOnComputationsInParallel(
+      HloComputationPass* pass, HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads,
+      tsl::thread::ThreadPool* thread_pool);
+
   const std::string name_;
   std::vector<std::unique_ptr<HloPassInterface>> passes_;
   std::vector<std::unique_ptr<HloPassInterface>> invariant_checkers_;
   bool run_called_ = false;
+  tsl::thread::ThreadPool* computation_thread_pool_ = nullptr;
 
   CompilationStats* compilation_stats_;
   // Default stats instance for when one is not passed in the constructor.
@@ -15,13 +15,27 @@ limitations under the License.
 
 #include "xla/service/hlo_pass_pipeline.h"
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_reachability.h"
+#include "xla/service/compilation_stats.h"
 #include "xla/service/hlo_parser.h"
+#include "xla/service/hlo_pass_fix.h"
 #include "xla/tests/hlo_test_base.h"
 #include "xla/util.h"
 #include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -112,6 +126,128 @@ class BazToQuxModuleGroupPass : public HloModuleGroupPass {
   }
 };
 
+// A computation pass which adds a few negates of the root to each computation
+// and counts the computations it ran on.
+class AddNegatesComputationPass : public HloComputationPass {
+ public:
+  absl::string_view name() const override { return "add-negates"; }
+
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    HloInstruction* root = computation->root_instruction();
+    for (int i = 0; i < 8; ++i) {
+      computation->AddInstruction(
+          HloInstruction::CreateUnary(root->shape(), HloOpcode::kNegate, root));
+    }
+    ++computation_count_;
+    return true;
+  }
+
+  int computation_count() const { return computation_count_; }
+
+ private:
+  std::atomic<int> computation_count_{0};
+};
+
+// A module pass which reports a change the first `changes` times it runs. It
+// changes the backend config of the entry root each time, unless `no_op` is
+// set, in which case it only claims to have changed the module.
+class ChangeNTimesPass : public HloModulePass {
+ public:
+  explicit ChangeNTimesPass(int changes, bool no_op = false)
+      : changes_(changes), no_op_(no_op) {}
+  absl::string_view name() const override { return "change-n-times"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(HloModule* module,
+                     const absl::flat_hash_set<absl::string_view>&
+                         execution_threads) override {
+    if (changes_ <= 0) {
+      return false;
+    }
+    --changes_;
+    if (!no_op_) {
+      HloInstruction* root = module->entry_computation()->root_instruction();
+      root->set_raw_backend_config_string(absl::StrCat("changes=", changes_));
+    }
+    return true;
+  }
+
+ private:
+  int changes_;
+  bool no_op_;
+};
+
+// A computation pass which only counts the computations it ran on.
+class CountComputationsPass : public HloComputationPass {
+ public:
+  explicit CountComputationsPass(bool computation_local = true)
+      : computation_local_(computation_local) {}
+  absl::string_view name() const override { return "count-computations"; }
+
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    ++computation_count_;
+    return false;
+  }
+
+  bool IsComputationLocal() const override { return computation_local_; }
+
+  int computation_count() const { return computation_count_; }
+
+ private:
+  bool computation_local_;
+  std::atomic<int> computation_count_{0};
+};
+
+// A computation pass which replaces the root of each computation by a copy of
+// it. This leaves the computation as it was, but is reported as a change.
+class CloneRootComputationPass : public HloComputationPass {
+ public:
+  absl::string_view name() const override { return "clone-root"; }
+
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    HloInstruction* root = computation->root_instruction();
+    HloInstruction* clone = computation->AddInstruction(root->Clone());
+    TF_RETURN_IF_ERROR(computation->ReplaceInstruction(root, clone));
+    ++computation_count_;
+    return true;
+  }
+
+  bool IsComputationLocal() const override { return true; }
+
+  int computation_count() const { return computation_count_; }
+
+ private:
+  std::atomic<int> computation_count_{0};
+};
+
+// Builds a module whose entry computation calls `num_callees` computations,
+// each of which is a chain of `chain_length` adds.
+std::unique_ptr<HloModule> MakeModuleWithCallees(const std::string& name,
+                                                 int num_callees,
+                                                 int chain_length = 1) {
+  auto module = std::make_unique<HloModule>(name, HloModuleConfig());
+  Shape shape = ShapeUtil::MakeShape(F32, {});
+  HloComputation::Builder entry_builder("entry");
+  HloInstruction* param = entry_builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape, "p"));
+  std::vector<HloInstruction*> calls;
+  for (int i = 0; i < num_callees; ++i) {
+    HloComputation::Builder builder(absl::StrCat("callee", i));
+    HloInstruction* value = builder.AddInstruction(
+        HloInstruction::CreateParameter(0, shape, "p"));
+    for (int j = 0; j < chain_length; ++j) {
+      value = builder.AddInstruction(
+          HloInstruction::CreateBinary(shape, HloOpcode::kAdd, value, value));
+    }
+    HloComputation* callee = module->AddEmbeddedComputation(builder.Build());
+    calls.push_back(entry_builder.AddInstruction(
+        HloInstruction::CreateCall(shape, {param}, callee)));
+  }
+  entry_builder.AddInstruction(HloInstruction::CreateTuple(calls));
+  module->AddEntryComputation(entry_builder.Build());
+  return module;
+}
+
 // An invariant checker pass which returns an error if there exists an
 // instruction named 'bar'.
 class BarBlowerUpper : public HloModulePass {
@@ -363,6 +499,194 @@ ENTRY main {
       ::testing::HasSubstr("Module group pass cannot be run on a module"));
 }
 
+TEST_F(HloPassPipelineTest, ComputationPassRunsInParallel) {
+  constexpr int kNumCallees = 64;
+  std::unique_ptr<HloModule> module =
+      MakeModuleWithCallees(TestName(), kNumCallees);
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), TestName(),
+                                      /*num_threads=*/4);
+
+  HloPassPipeline pipeline(TestName());
+  pipeline.SetComputationThreadPool(&thread_pool);
+  auto& pass = pipeline.AddPass<AddNegatesComputationPass>();
+  EXPECT_TRUE(pipeline.Run(module.get()).value());
+
+  EXPECT_EQ(pass.computation_count(), kNumCallees + 1);
+  for (const HloComputation* computation : module->computations()) {
+    EXPECT_EQ(absl::c_count_if(computation->instructions(),
+                               [](const HloInstruction* instruction) {
+                                 return instruction->opcode() ==
+                                        HloOpcode::kNegate;
+                               }),
+              8)
+        << computation->name();
+  }
+  // Instructions added concurrently still got unique names and ids.
+  TF_EXPECT_OK(module->CheckUniqueNamesAndIdsForComputationsAndInstructions());
+}
+
+TEST_F(HloPassPipelineTest, NestedPipelineUsesComputationThreadPool) {
+  std::unique_ptr<HloModule> module =
+      MakeModuleWithCallees(TestName(), /*num_callees=*/8);
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), TestName(),
+                                      /*num_threads=*/2);
+
+  HloPassPipeline pipeline(TestName());
+  pipeline.SetComputationThreadPool(&thread_pool);
+  auto& nested = pipeline.AddPass<HloPassPipeline>("nested");
+  auto& pass = nested.AddPass<AddNegatesComputationPass>();
+  EXPECT_TRUE(pipeline.Run(module.get()).value());
+  EXPECT_EQ(pass.computation_count(), 9);
+  TF_EXPECT_OK(module->CheckUniqueNamesAndIdsForComputationsAndInstructions());
+}
+
+TEST_F(HloPassPipelineTest, PassProfilingStats) {
+  const std::string module_str = R"(
+HloModule PassProfilingStats
+
+ENTRY main {
+  a = f32[] parameter(0)
+  ROOT foo = f32[] negate(a)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+  PassProfilingStats stats;
+  HloPassPipeline pipeline(TestName(), &stats);
+  pipeline.AddPass<FooToBarModulePass>();
+  pipeline.AddPass<HloPassFix<ChangeNTimesPass>>(/*changes=*/2);
+  // The nested pipeline has no stats of its own, so its passes are recorded
+  // by the outer one.
+  auto& nested = pipeline.AddPass<HloPassPipeline>("nested");
+  nested.AddPass<AddNegatesComputationPass>();
+  EXPECT_TRUE(pipeline.Run(module.get()).value());
+
+  const HloPassProfiles& profiles = stats.profiles();
+  ASSERT_THAT(profiles.passes(), SizeIs(3));
+  EXPECT_EQ(stats.GetPassesSize(), 3);
+
+  const HloPassProfile& foo2bar = profiles.passes(0);
+  EXPECT_EQ(foo2bar.pass_name(), "foo2bar");
+  EXPECT_TRUE(foo2bar.module_changed());
+  EXPECT_EQ(foo2bar.instruction_count_before(), 2);
+  EXPECT_EQ(foo2bar.instruction_count_after(), 2);
+  EXPECT_EQ(foo2bar.fixed_point_iterations(), 0);
+  EXPECT_GE(foo2bar.wall_time_usec(), 0);
+  EXPECT_GE(foo2bar.peak_rss_delta_bytes(), 0);
+
+  const HloPassProfile& change_n_times = profiles.passes(1);
+  EXPECT_EQ(change_n_times.pass_name(), "change-n-times");
+  EXPECT_TRUE(change_n_times.module_changed());
+  // Two runs that change the module and one that finds the fixed point.
+  EXPECT_EQ(change_n_times.fixed_point_iterations(), 3);
+
+  const HloPassProfile& add_negates = profiles.passes(2);
+  EXPECT_EQ(add_negates.pass_name(), "add-negates");
+  EXPECT_EQ(add_negates.instruction_count_before(), 2);
+  EXPECT_EQ(add_negates.instruction_count_after(), 10);
+  EXPECT_GE(add_negates.start_timestamp_usec(),
+            change_n_times.start_timestamp_usec());
+
+  std::vector<std::string> csv_lines =
+      absl::StrSplit(stats.ToCsv(), '\n', absl::SkipEmpty());
+  ASSERT_THAT(csv_lines, SizeIs(4));
+  EXPECT_THAT(csv_lines[0], ::testing::StartsWith("pass_name,"));
+  EXPECT_THAT(csv_lines[2], ::testing::StartsWith("change-n-times,"));
+}
+
+TEST_F(HloPassPipelineTest, PassProfilingStatsRecordInvariantCheckerErrors) {
+  const std::string module_str = R"(
+HloModule PassProfilingStatsRecordInvariantCheckerErrors
+
+ENTRY main {
+  a = f32[] parameter(0)
+  ROOT foo = f32[] negate(a)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+  PassProfilingStats stats;
+  HloPassPipeline pipeline(TestName(), &stats);
+  pipeline.AddInvariantChecker<BarBlowerUpper>();
+  pipeline.AddPass<FooToBarModulePass>();
+  EXPECT_FALSE(pipeline.Run(module.get()).ok());
+
+  // The checker fails while foo2bar is still running, so the error ends its
+  // profile.
+  const HloPassProfiles& profiles = stats.profiles();
+  ASSERT_THAT(profiles.passes(), SizeIs(1));
+  EXPECT_EQ(profiles.passes(0).pass_name(), "foo2bar");
+  EXPECT_FALSE(profiles.passes(0).error().empty());
+}
+
+TEST_F(HloPassPipelineTest, FixedPointEndsOnNoOpRewrites) {
+  std::unique_ptr<HloModule> module = MakeModuleWithCallees(TestName(), 2);
+  HloPassFix<CloneRootComputationPass> pass;
+  // The computations are the same after the first iteration, so the loop
+  // ends, but the rewrites the pass reported are still changes of the run.
+  EXPECT_TRUE(pass.Run(module.get()).value());
+  EXPECT_EQ(pass.FixedPointIterations(), 1);
+  EXPECT_EQ(pass.computation_count(), 3);
+}
+
+TEST_F(HloPassPipelineTest, FixedPointIteratesPassesThatAreNotLocal) {
+  std::unique_ptr<HloModule> module = MakeModuleWithCallees(TestName(), 2);
+  // The pass does not opt into fingerprinting, so every reported change
+  // counts until the pass stops reporting changes.
+  HloPassFix<ChangeNTimesPass> pass(/*changes=*/3, /*no_op=*/true);
+  EXPECT_TRUE(pass.Run(module.get()).value());
+  EXPECT_EQ(pass.FixedPointIterations(), 4);
+}
+
+TEST_F(HloPassPipelineTest, FixedPointSkipsUnchangedComputations) {
+  std::unique_ptr<HloModule> module = MakeModuleWithCallees(TestName(), 3);
+  HloPassFix<CountComputationsPass> pass;
+  EXPECT_FALSE(pass.Run(module.get()).value());
+  EXPECT_EQ(pass.computation_count(), 4);
+
+  // Nothing changed since the pass reached its fixed point.
+  EXPECT_FALSE(pass.Run(module.get()).value());
+  EXPECT_EQ(pass.computation_count(), 4);
+  EXPECT_EQ(pass.FixedPointIterations(), 0);
+
+  // Only the changed callee is run on again.
+  HloComputation* callee = module->GetComputationWithName("callee1");
+  ASSERT_NE(callee, nullptr);
+  HloInstruction* root = callee->root_instruction();
+  callee->set_root_instruction(callee->AddInstruction(
+      HloInstruction::CreateUnary(root->shape(), HloOpcode::kNegate, root)));
+  EXPECT_FALSE(pass.Run(module.get()).value());
+  EXPECT_EQ(pass.computation_count(), 5);
+}
+
+TEST_F(HloPassPipelineTest, FixedPointDoesNotSkipPassesThatAreNotLocal) {
+  std::unique_ptr<HloModule> module = MakeModuleWithCallees(TestName(), 3);
+  HloPassFix<CountComputationsPass> pass(/*computation_local=*/false);
+  EXPECT_FALSE(pass.Run(module.get()).value());
+  EXPECT_EQ(pass.computation_count(), 4);
+
+  EXPECT_FALSE(pass.Run(module.get()).value());
+  EXPECT_EQ(pass.computation_count(), 8);
+  EXPECT_EQ(pass.FixedPointIterations(), 1);
+}
+
+TEST_F(HloPassPipelineTest, FixedPointPipelineSkipsUnchangedModule) {
+  std::unique_ptr<HloModule> module = MakeModuleWithCallees(TestName(), 3);
+  HloPassFix<HloPassPipeline> pipeline("fixed-point");
+  auto& counter = pipeline.AddPass<CountComputationsPass>();
+  EXPECT_FALSE(pipeline.Run(module.get()).value());
+  EXPECT_EQ(counter.computation_count(), 4);
+
+  EXPECT_FALSE(pipeline.Run(module.get()).value());
+  EXPECT_EQ(counter.computation_count(), 4);
+
+  // Any change makes the pipeline run on the whole module again.
+  HloComputation* entry = module->entry_computation();
+  entry->root_instruction()->set_raw_backend_config_string("changed");
+  EXPECT_FALSE(pipeline.Run(module.get()).value());
+  EXPECT_EQ(counter.computation_count(), 8);
+}
+
 // Test that metadata is set when a module group goes through a pass pipeline.
 TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
   HloModuleGroup module_group(TestName());
@@ -401,5 +725,50 @@ TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below.
+//===----------------------------------------------------------------------===//
+
+// A computation pass which builds the reachability map of each computation,
+// as analysis-heavy passes do, and changes nothing.
+class ReachabilityComputationPass : public HloComputationPass {
+ public:
+  explicit ReachabilityComputationPass(bool computation_local)
+      : computation_local_(computation_local) {}
+  absl::string_view name() const override { return "reachability"; }
+
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    std::unique_ptr<HloReachabilityMap> reachability =
+        HloReachabilityMap::Build(computation);
+    CHECK(reachability != nullptr);
+    return false;
+  }
+
+  bool IsComputationLocal() const override { return computation_local_; }
+
+ private:
+  bool computation_local_;
+};
+
+// Reruns a fixed point pass on a module it already reached its fixed point on,
+// as happens when a pipeline is run to a fixed point. If `state.range(0)` is
+// nonzero, the pass is computation-local, so the reruns only fingerprint the
+// computations instead of running the pass on them.
+void BM_FixedPointRerunOnUnchangedModule(
+    ::testing::benchmark::State& state) {
+  const bool computation_local = state.range(0) != 0;
+  std::unique_ptr<HloModule> module = MakeModuleWithCallees(
+      "BM_FixedPointRerunOnUnchangedModule", /*num_callees=*/16,
+      /*chain_length=*/state.range(1));
+  HloPassFix<ReachabilityComputationPass> pass(computation_local);
+  CHECK_OK(pass.Run(module.get()).status());
+  for (auto s : state) {
+    CHECK_OK(pass.Run(module.get()).status());
+  }
+}
+
+BENCHMARK(BM_FixedPointRerunOnUnchangedModule)
+    ->ArgsProduct({{0, 1}, {64, 1024}});
+
 }  // namespace
 }  // namespace xla
@@ -15,13 +15,17 @@ limitations under the License.
 
 #include "xla/hlo/ir/hlo_reachability.h"
 
+#include <memory>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/service/computation_placer.h"
 #include "xla/test.h"
 #include "xla/test_helpers.h"
 #include "xla/tests/hlo_test_base.h"
+#include "tsl/platform/test_benchmark.h"
 
 namespace xla {
 
@@ -240,6 +244,224 @@ TEST_F(HloReachabilityTest, ReplaceInstructions) {
   EXPECT_TRUE(reachability->IsReachable(p0, fusion));
 }
 
+// Builds a computation of `num_chains` chains of adds with `length` adds each.
+// Every `cross_link_period` steps, a chain also consumes the previous add of
+// the next chain.
+std::unique_ptr<HloComputation> MakeInterleavedChains(
+    int64_t num_chains, int64_t length, int64_t cross_link_period) {
+  Shape shape = ShapeUtil::MakeShape(F32, {});
+  auto builder = HloComputation::Builder("interleaved_chains");
+  HloInstruction* param =
+      builder.AddInstruction(HloInstruction::CreateParameter(0, shape, "p"));
+  std::vector<HloInstruction*> heads(num_chains, param);
+  for (int64_t step = 0; step < length; ++step) {
+    std::vector<HloInstruction*> next(num_chains);
+    for (int64_t chain = 0; chain < num_chains; ++chain) {
+      HloInstruction* other = (step + 1) % cross_link_period == 0
+                                  ? heads[(chain + 1) % num_chains]
+                                  : heads[chain];
+      next[chain] = builder.AddInstruction(HloInstruction::CreateBinary(
+          shape, HloOpcode::kAdd, heads[chain], other));
+    }
+    heads = std::move(next);
+  }
+  builder.AddInstruction(HloInstruction::CreateTuple(heads));
+  return builder.Build();
+}
+
+TEST_F(HloReachabilityTest, IntervalsMatchDense) {
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation = module->AddEntryComputation(
+      MakeInterleavedChains(/*num_chains=*/4, /*length=*/20,
+                            /*cross_link_period=*/5));
+  auto dense = HloReachabilityMap::Build(
+      computation, HloReachabilityMap::Representation::kDense);
+  auto intervals = HloReachabilityMap::Build(
+      computation, HloReachabilityMap::Representation::kIntervals);
+  EXPECT_EQ(intervals->representation(),
+            HloReachabilityMap::Representation::kIntervals);
+
+  auto expect_same_reachability = [&]() {
+    for (const HloInstruction* a : computation->instructions()) {
+      for (const HloInstruction* b : computation->instructions()) {
+        EXPECT_EQ(intervals->IsReachable(a, b), dense->IsReachable(a, b))
+            << a->name() << " -> " << b->name();
+      }
+    }
+  };
+  expect_same_reachability();
+
+  // A control edge makes a new instruction reachable from a late one.
+  HloInstruction* root = computation->root_instruction();
+  HloInstruction* param = computation->parameter_instruction(0);
+  HloInstruction* late = root->mutable_operand(0);
+  HloInstruction* early = computation->AddInstruction(
+      HloInstruction::CreateBinary(param->shape(), HloOpcode::kAdd, param,
+                                   param));
+  TF_ASSERT_OK(late->AddControlDependencyTo(early));
+  dense = HloReachabilityMap::Build(
+      computation, HloReachabilityMap::Representation::kDense);
+  intervals = HloReachabilityMap::Build(
+      computation, HloReachabilityMap::Representation::kIntervals);
+  EXPECT_TRUE(intervals->IsReachable(late, early));
+  expect_same_reachability();
+}
+
+TEST_F(HloReachabilityTest, LargeComputationsDefaultToIntervals) {
+  EXPECT_EQ(HloReachabilityMap::DefaultRepresentation(16),
+            HloReachabilityMap::Representation::kDense);
+  EXPECT_EQ(HloReachabilityMap::DefaultRepresentation(
+                HloReachabilityMap::kIntervalsThreshold),
+            HloReachabilityMap::Representation::kIntervals);
+}
+
+TEST_F(HloReachabilityTest, UpdateAfterMutationMatchesRebuild) {
+  for (auto representation : {HloReachabilityMap::Representation::kDense,
+                              HloReachabilityMap::Representation::kIntervals}) {
+    auto module = CreateNewVerifiedModule();
+    HloComputation* computation = module->AddEntryComputation(
+        MakeInterleavedChains(/*num_chains=*/4, /*length=*/20,
+                              /*cross_link_period=*/5));
+    auto reachability = HloReachabilityMap::Build(computation, representation);
+    auto expect_same_as_rebuild = [&]() {
+      auto rebuilt = HloReachabilityMap::Build(computation, representation);
+      for (const HloInstruction* a : computation->instructions()) {
+        for (const HloInstruction* b : computation->instructions()) {
+          EXPECT_EQ(reachability->IsReachable(a, b), rebuilt->IsReachable(a, b))
+              << a->name() << " -> " << b->name();
+        }
+      }
+    };
+
+    // The root tuple consumes the last add of each chain, so walking operands
+    // of its operands goes back along a chain.
+    auto chain_element = [&](int64_t chain, int64_t steps_back) {
+      HloInstruction* hlo = computation->root_instruction()->mutable_operand(
+          chain);
+      for (int64_t i = 0; i < steps_back; ++i) {
+        hlo = hlo->mutable_operand(0);
+      }
+      return hlo;
+    };
+
+    // A new instruction, not in the map yet, links an element of chain 1 to a
+    // later element of chain 0 that was not reachable from it.
+    HloInstruction* early = chain_element(/*chain=*/1, /*steps_back=*/3);
+    HloInstruction* late = chain_element(/*chain=*/0, /*steps_back=*/2);
+    EXPECT_FALSE(reachability->IsReachable(early, late));
+    HloInstruction* negate = computation->AddInstruction(
+        HloInstruction::CreateUnary(early->shape(), HloOpcode::kNegate, early));
+    TF_ASSERT_OK(late->ReplaceOperandWith(1, negate));
+    reachability->UpdateReachabilityAfterMutation(late);
+    EXPECT_TRUE(reachability->IsPresent(negate));
+    EXPECT_TRUE(reachability->IsReachable(early, late));
+    expect_same_as_rebuild();
+
+    // Dropping the link again shrinks what is reachable.
+    TF_ASSERT_OK(late->ReplaceOperandWith(1, late->mutable_operand(0)));
+    TF_ASSERT_OK(computation->RemoveInstruction(negate));
+    reachability->UpdateReachabilityAfterMutation(late);
+    expect_same_as_rebuild();
+
+    // Multi-output fusion adds a fusion and get-tuple-elements for the users
+    // of the fused producer.
+    HloInstruction* consumer = chain_element(/*chain=*/2, /*steps_back=*/5);
+    HloInstruction* producer = consumer->mutable_operand(0);
+    ASSERT_GT(producer->user_count(), 1);
+    HloInstruction* fusion =
+        computation->AddInstruction(HloInstruction::CreateFusion(
+            consumer->shape(), HloInstruction::FusionKind::kLoop, consumer));
+    reachability->Replace(consumer, fusion);
+    TF_ASSERT_OK(computation->ReplaceInstruction(consumer, fusion));
+    fusion->FuseInstructionIntoMultiOutput(producer);
+    TF_ASSERT_OK(computation->RemoveInstruction(producer));
+    reachability->UpdateReachabilityAfterMutation(fusion);
+    expect_same_as_rebuild();
+  }
+}
+
+// Builds the reachability map of a computation with `state.range(0)` chains
+// of 1024 adds each, using the representation `state.range(1)`.
+void BM_BuildReachability(::testing::benchmark::State& state) {
+  const int64_t num_chains = state.range(0);
+  const auto representation =
+      static_cast<HloReachabilityMap::Representation>(state.range(1));
+  HloModuleConfig config;
+  HloModule module("BM_BuildReachability", config);
+  HloComputation* computation =
+      module.AddEntryComputation(MakeInterleavedChains(
+          num_chains, /*length=*/1024, /*cross_link_period=*/64));
+
+  size_t bytes = 0;
+  for (auto s : state) {
+    auto reachability = HloReachabilityMap::Build(computation, representation);
+    bytes = reachability->ReachabilitySetBytes();
+  }
+  state.counters["instructions"] = computation->instruction_count();
+  state.counters["reachability_bytes"] = bytes;
+}
+
+BENCHMARK(BM_BuildReachability)
+    ->ArgsProduct(
+        {{4, 16, 64},
+         {static_cast<int>(HloReachabilityMap::Representation::kDense),
+          static_cast<int>(HloReachabilityMap::Representation::kIntervals)}})
+    ->Unit(::benchmark::kMillisecond);
+
+// Multi-output fuses every add with two users into its consumer along the
+// chains of a computation like BM_BuildReachability's, and keeps the
+// reachability map up to date after each fusion. `state.range(1)` selects
+// between updating the map incrementally (1) and rebuilding it from scratch
+// (0), which is what fusion passes did before incremental updates existed.
+void BM_ReachabilityAcrossFusions(::testing::benchmark::State& state) {
+  const int64_t num_chains = state.range(0);
+  const bool incremental = state.range(1);
+  int64_t fusions = 0;
+  for (auto s : state) {
+    state.PauseTiming();
+    HloModuleConfig config;
+    HloModule module("BM_ReachabilityAcrossFusions", config);
+    HloComputation* computation =
+        module.AddEntryComputation(MakeInterleavedChains(
+            num_chains, /*length=*/1024, /*cross_link_period=*/64));
+    auto reachability = HloReachabilityMap::Build(computation);
+    // Each cross-linked add is the first operand of exactly one consumer.
+    std::vector<HloInstruction*> consumers;
+    for (HloInstruction* hlo : computation->MakeInstructionPostOrder()) {
+      if (hlo->opcode() == HloOpcode::kAdd &&
+          hlo->operand(0)->opcode() == HloOpcode::kAdd &&
+          hlo->operand(0)->user_count() > 1) {
+        consumers.push_back(hlo);
+      }
+    }
+    fusions = consumers.size();
+    state.ResumeTiming();
+
+    for (HloInstruction* consumer : consumers) {
+      HloInstruction* producer = consumer->mutable_operand(0);
+      HloInstruction* fusion =
+          computation->AddInstruction(HloInstruction::CreateFusion(
+              consumer->shape(), HloInstruction::FusionKind::kLoop, consumer));
+      if (incremental) {
+        reachability->Replace(consumer, fusion);
+      }
+      CHECK_OK(computation->ReplaceInstruction(consumer, fusion));
+      fusion->FuseInstructionIntoMultiOutput(producer);
+      CHECK_OK(computation->RemoveInstruction(producer));
+      if (incremental) {
+        reachability->UpdateReachabilityAfterMutation(fusion);
+      } else {
+        reachability = HloReachabilityMap::Build(computation);
+      }
+    }
+  }
+  state.counters["fusions"] = fusions;
+}
+
+BENCHMARK(BM_ReachabilityAcrossFusions)
+    ->ArgsProduct({{4, 16, 64}, {0, 1}})
+    ->Unit(::benchmark::kMillisecond);
+
 }  // namespace
 
 }  // namespace xla
@@ -516,6 +516,10 @@ StatusOr<bool> InstructionFusion::Run(
     CHECK(!computation->IsFusionComputation());
     std::unique_ptr<HloReachabilityMap> reachability =
         HloReachabilityMap::Build(computation);
+    // Fusion instructions created since the reachability map was last brought
+    // up to date. Only multi-output fusion reads the map after fusions have
+    // happened, so it is updated lazily right before such a decision.
+    absl::flat_hash_set<HloInstruction*> fusions_missing_from_reachability;
 
     HloInstructionSet do_not_duplicate;
     // If we allow duplications, we need to compute which instructions we do not
@@ -595,6 +599,10 @@ StatusOr<bool> InstructionFusion::Run(
           FusionDecision can_fuse_mof =
               ShouldFuseIntoMultiOutput(instruction, i);
           if (can_fuse_mof) {
+            for (HloInstruction* fusion : fusions_missing_from_reachability) {
+              reachability->UpdateReachabilityAfterMutation(fusion);
+            }
+            fusions_missing_from_reachability.clear();
             can_fuse_mof = can_fuse_mof.And(
                 FusionDecision{!MultiOutputFusionCreatesCycle(
                                    operand, instruction, *reachability),
@@ -649,11 +657,13 @@ StatusOr<bool> InstructionFusion::Run(
         std::string producer_name = operand->name();
         fusion_queue->OnFusingInstruction(fusion_instruction, operand,
                                           instruction);
+        fusions_missing_from_reachability.insert(fusion_instruction);
         changed = true;
         ++fuse_count;
 
         if (operand->user_count() == 0) {
           do_not_duplicate.erase(operand);
+          fusions_missing_from_reachability.erase(operand);
           // Operand is now dead. Remove from queue.
           fusion_queue->RemoveInstruction(operand);
           // Remove from computation.
@@ -789,17 +799,22 @@ bool InstructionFusion::MultiOutputFusionCreatesCycle(
       continue;
     }
 
-    // If the reachability map already contains the producer and the operand of
-    // the consumer, and the producer can reach the operand, then we know for
-    // sure MultiOutputFusion would create a cycle. If not, we need to do a DFS
-    // traversal of the computation to verify that this multioutput fusion would
-    // not create a cycle.
-    if (reachability.IsPresent(producer) && reachability.IsPresent(operand) &&
-        reachability.IsReachable(producer, operand)) {
-      return true;
+    // Run() brings the reachability map up to date before each multi-output
+    // fusion decision, so if it contains both the producer and the operand of
+    // the consumer, it tells for sure whether MultiOutputFusion would create a
+    // cycle. If not, we need to do a DFS traversal of the computation to verify
+    // that this multioutput fusion would not create a cycle.
+    if (reachability.IsPresent(producer) && reachability.IsPresent(operand)) {
+      if (reachability.IsReachable(producer, operand)) {
+        return true;
+      }
+      continue;
     }
     operands.insert(operand->unique_id());
   }
+  if (operands.empty()) {
+    return false;
+  }
 
   // Do a DFS on the producer to see if any of the other consumer operands are
   // reachable in the current state of the graph.
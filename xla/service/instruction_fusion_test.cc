@@ -15,9 +15,18 @@ limitations under the License.
 
 #include "xla/service/instruction_fusion.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "xla/service/hlo_matchers.h"
 #include "xla/service/hlo_parser.h"
 #include "xla/tests/hlo_test_base.h"
+#include "tsl/platform/test_benchmark.h"
 
 namespace xla {
 
@@ -690,6 +699,107 @@ TEST_F(InstructionFusionTest, DontFuseAcrossRoot) {
       op::Add(op::Multiply(op::Parameter(), op::Parameter()), op::Parameter()));
 }
 
+// Returns the HLO text of a module with `num_chains` chains of `length` adds
+// each. Every `cross_link_period` steps, a chain also consumes the previous add
+// of the next chain, which gives those adds two users.
+std::string CrossLinkedChainsHlo(int64_t num_chains, int64_t length,
+                                 int64_t cross_link_period) {
+  std::string hlo = R"(
+HloModule cross_linked_chains
+
+ENTRY entry_computation {
+  p = f32[16]{0} parameter(0)
+)";
+  std::vector<std::string> heads(num_chains, "p");
+  for (int64_t step = 0; step < length; ++step) {
+    std::vector<std::string> next(num_chains);
+    for (int64_t chain = 0; chain < num_chains; ++chain) {
+      const std::string& other = (step + 1) % cross_link_period == 0
+                                     ? heads[(chain + 1) % num_chains]
+                                     : heads[chain];
+      next[chain] = absl::StrCat("add.", chain, ".", step);
+      absl::StrAppend(&hlo, "  ", next[chain], " = f32[16]{0} add(",
+                      heads[chain], ", ", other, ")\n");
+    }
+    heads = std::move(next);
+  }
+  absl::StrAppend(&hlo, "  ROOT tuple = (",
+                  absl::StrJoin(std::vector<std::string>(num_chains,
+                                                         "f32[16]{0}"),
+                                ", "),
+                  ") tuple(", absl::StrJoin(heads, ", "), ")\n}\n");
+  return hlo;
+}
+
+// Fuses adds without duplicating them: adds with several users are
+// multi-output fused, which needs a cycle check against the reachability
+// that Run() maintains across fusions.
+class MultiOutputAddFusion : public InstructionFusion {
+ public:
+  MultiOutputAddFusion()
+      : InstructionFusion(InstructionFusion::IsExpensive,
+                          /*may_duplicate=*/false) {}
+
+ protected:
+  FusionDecision ShouldFuse(HloInstruction* consumer,
+                            int64_t operand_index) override {
+    if (consumer->opcode() == HloOpcode::kTuple) {
+      return "not fusing into a tuple";
+    }
+    return InstructionFusion::ShouldFuse(consumer, operand_index);
+  }
+
+  FusionDecision ShouldFuseIntoMultiOutput(HloInstruction* consumer,
+                                           int64_t operand_index) override {
+    if (consumer->operand(operand_index)->opcode() != HloOpcode::kAdd) {
+      return "producer is not an add";
+    }
+    if (consumer->opcode() != HloOpcode::kAdd &&
+        consumer->opcode() != HloOpcode::kFusion) {
+      return "consumer is neither an add nor a fusion";
+    }
+    return {};
+  }
+};
+
+TEST_F(InstructionFusionTest, MultiOutputFusionOfLargeGeneratedModule) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module,
+      ParseAndReturnVerifiedModule(CrossLinkedChainsHlo(
+          /*num_chains=*/16, /*length=*/256, /*cross_link_period=*/8)));
+  HloComputation* computation = module->entry_computation();
+  EXPECT_TRUE(RunHloPass(MultiOutputAddFusion(), module.get()).value());
+  TF_ASSERT_OK(verifier().Run(module.get()).status());
+  EXPECT_TRUE(absl::c_any_of(computation->instructions(),
+                             [](const HloInstruction* instruction) {
+                               return instruction->IsMultiOutputFusion();
+                             }))
+      << module->ToString();
+}
+
+// Runs multi-output fusion over `state.range(0)` chains of 1024 adds. The cost
+// of keeping reachability up to date, compared to rebuilding it, is measured
+// by BM_ReachabilityAcrossFusions in hlo_reachability_test.cc.
+void BM_MultiOutputFusionOfLargeModule(::testing::benchmark::State& state) {
+  const std::string hlo = CrossLinkedChainsHlo(
+      state.range(0), /*length=*/1024, /*cross_link_period=*/8);
+  int64_t instructions = 0;
+  for (auto s : state) {
+    state.PauseTiming();
+    auto module = ParseAndReturnUnverifiedModule(hlo).value();
+    instructions = module->entry_computation()->instruction_count();
+    state.ResumeTiming();
+    CHECK_OK(MultiOutputAddFusion().Run(module.get()).status());
+  }
+  state.counters["instructions"] = instructions;
+}
+
+BENCHMARK(BM_MultiOutputFusionOfLargeModule)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->Unit(::benchmark::kMillisecond);
+
 class FusionDecisionTest : public HloTestBase {};
 
 TEST_F(FusionDecisionTest, NotFusionPossibleDisjunction) {
@@ -48,6 +48,9 @@ StatusOr<bool> ReduceScatterDecomposer::Run(
       if (!rs || !rs->shape().IsArray()) {
         continue;
       }
+      if (should_decompose_ && !should_decompose_(*rs)) {
+        continue;
+      }
 
       std::optional<int64_t> channel_id;
       if (rs->channel_id()) {
@@ -17,7 +17,9 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_REDUCE_SCATTER_DECOMPOSER_H_
 
 #include <functional>
+#include <utility>
 
+#include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/service/hlo_pass_interface.h"
 #include "xla/statusor.h"
@@ -25,12 +27,16 @@ limitations under the License.
 namespace xla {
 
 // A pass that decomposes a reduce-scatter into an all-reduce followed by a
-// dynamic-slice.
+// dynamic-slice. Only reduce-scatters for which `should_decompose` returns true
+// are decomposed; by default all array-shaped reduce-scatters are.
 class ReduceScatterDecomposer : public HloModulePass {
  public:
   explicit ReduceScatterDecomposer(
-      std::function<void(Shape&)> update_layout = nullptr)
-      : update_layout_(update_layout) {}
+      std::function<void(Shape&)> update_layout = nullptr,
+      std::function<bool(const HloReduceScatterInstruction&)>
+          should_decompose = nullptr)
+      : update_layout_(update_layout),
+        should_decompose_(std::move(should_decompose)) {}
   absl::string_view name() const override {
     return "reduce-scatter-decomposer";
   }
@@ -40,6 +46,7 @@ class ReduceScatterDecomposer : public HloModulePass {
       HloModule* module,
       const absl::flat_hash_set<absl::string_view>& execution_threads) override;
   std::function<void(Shape&)> update_layout_;
+  std::function<bool(const HloReduceScatterInstruction&)> should_decompose_;
 };
 
 }  // namespace xla
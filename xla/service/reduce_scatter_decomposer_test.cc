@@ -222,5 +222,31 @@ ENTRY main {
   RunPass(hlo_string, PassAction::kNoChange);
 }
 
+TEST_F(ReduceScatterDecomposerTest, NoChangeWhenShouldDecomposeIsFalse) {
+  absl::string_view hlo_string = R"(
+HloModule m
+
+sum {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add.2 = f32[] add(a, b)
+}
+
+ENTRY main {
+  p0 = f32[4, 8] parameter(0)
+  ROOT rs = f32[4, 4] reduce-scatter(p0), replica_groups={{0,1}}, dimensions={1}, to_apply=sum
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(
+                                           hlo_string, /*replica_count=*/2));
+  ReduceScatterDecomposer decomposer(
+      /*update_layout=*/nullptr,
+      /*should_decompose=*/[](const HloReduceScatterInstruction&) {
+        return false;
+      });
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, decomposer.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
 }  // namespace
 }  // namespace xla
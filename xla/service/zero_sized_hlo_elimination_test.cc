@@ -23,6 +23,8 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/literal.h"
+#include "xla/service/hlo_pass_fix.h"
+#include "xla/service/hlo_pass_pipeline.h"
 #include "xla/service/shape_inference.h"
 #include "xla/shape_util.h"
 #include "xla/status_macros.h"
@@ -94,5 +96,31 @@ TEST_F(ZeroSizedHloEliminationTest, ZeroSizedInstructionWithoutLayoutFolded) {
   EXPECT_TRUE(changed);
 }
 
+TEST_F(ZeroSizedHloEliminationTest, FixedPointPipelineSkipsUnchangedModule) {
+  const char* const hlo_string = R"(
+HloModule FixedPointPipelineSkipsUnchangedModule
+
+ENTRY main {
+  p = f32[3,0]{1,0} parameter(0)
+  tanh = f32[3,0]{1,0} tanh(p)
+  ROOT negate = f32[3,0]{1,0} negate(tanh)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  HloPassFix<HloPassPipeline> pipeline("zero-sized-cleanup");
+  pipeline.AddPass<ZeroSizedHloElimination>();
+  EXPECT_TRUE(pipeline.IsComputationLocal());
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(pipeline.FixedPointIterations(), 2);
+
+  // The module is at the pipeline's fixed point, so it is not run again.
+  TF_ASSERT_OK_AND_ASSIGN(changed, pipeline.Run(module.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_EQ(pipeline.FixedPointIterations(), 0);
+}
+
 }  // namespace
 }  // namespace xla
@@ -27,18 +27,29 @@ limitations under the License.
 #include "absl/functional/any_invocable.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
-#include "absl/synchronization/notification.h"
 #include "xla/stream_executor/host/host_platform_id.h"
 #include "xla/stream_executor/host/host_stream.h"
 #include "xla/stream_executor/host/host_timer.h"
 #include "xla/stream_executor/plugin_registry.h"
 #include "xla/stream_executor/stream_executor_internal.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/mem.h"
 #include "tsl/platform/profile_utils/cpu_utils.h"
+#include "tsl/platform/threadpool.h"
 
 namespace stream_executor {
 namespace host {
 
+namespace {
+
+tsl::ThreadOptions GetThreadOptions(size_t stack_size_in_bytes) {
+  tsl::ThreadOptions options;
+  options.stack_size = stack_size_in_bytes;
+  return options;
+}
+
+}  // namespace
+
 HostStream* AsHostStream(Stream* stream) {
   DCHECK(stream != nullptr);
   return dynamic_cast<HostStream*>(stream->implementation());
@@ -60,6 +71,20 @@ tsl::Status HostExecutor::Init(int device_ordinal,
           it->second);
     }
   }
+  it = device_options.non_portable_tags.find("host_stream_num_threads");
+  if (it != device_options.non_portable_tags.end()) {
+    int num_threads;
+    if (!absl::SimpleAtoi(it->second, &num_threads)) {
+      return tsl::errors::InvalidArgument(
+          "Unable to parse host_stream_num_threads as an integer: ",
+          it->second);
+    }
+    if (num_threads > 0) {
+      stream_thread_pool_ = std::make_shared<tsl::thread::ThreadPool>(
+          tsl::Env::Default(), GetThreadOptions(thread_stack_size_in_bytes_),
+          "host_executor", num_threads);
+    }
+  }
   return ::tsl::OkStatus();
 }
 
@@ -195,24 +220,25 @@ bool HostExecutor::AllocateStream(Stream* stream) { return true; }
 void HostExecutor::DeallocateStream(Stream* stream) {}
 
 bool HostExecutor::CreateStreamDependency(Stream* dependent, Stream* other) {
-  auto event = std::make_shared<absl::Notification>();
+  auto event = std::make_shared<HostStreamNotification>();
   AsHostStream(other)->EnqueueTask([event]() { event->Notify(); });
-  AsHostStream(dependent)->EnqueueTask(
-      [event]() { event->WaitForNotification(); });
+  AsHostStream(dependent)->EnqueueWait(std::move(event));
   return true;
 }
 
 class HostEvent : public internal::EventInterface {
  public:
-  HostEvent() : notification_(std::make_shared<absl::Notification>()) {}
+  HostEvent() : notification_(std::make_shared<HostStreamNotification>()) {}
 
-  std::shared_ptr<absl::Notification>& notification() { return notification_; }
+  std::shared_ptr<HostStreamNotification>& notification() {
+    return notification_;
+  }
 
  private:
   // We use a std::shared_ptr here because the client may delete the HostEvent
   // object while there are still RecordEvent and WaitForEvent callbacks pending
   // on a stream.
-  std::shared_ptr<absl::Notification> notification_;
+  std::shared_ptr<HostStreamNotification> notification_;
 };
 
 std::unique_ptr<internal::EventInterface>
@@ -234,7 +260,7 @@ tsl::Status HostExecutor::DeallocateEvent(Event* /*event*/) {
 }
 
 tsl::Status HostExecutor::RecordEvent(Stream* stream, Event* event) {
-  std::shared_ptr<absl::Notification> notification =
+  std::shared_ptr<HostStreamNotification> notification =
       AsHostEvent(event)->notification();
   AsHostStream(stream)->EnqueueTask([notification]() {
     CHECK(!notification->HasBeenNotified());
@@ -244,15 +270,12 @@ tsl::Status HostExecutor::RecordEvent(Stream* stream, Event* event) {
 }
 
 tsl::Status HostExecutor::WaitForEvent(Stream* stream, Event* event) {
-  std::shared_ptr<absl::Notification> notification =
-      AsHostEvent(event)->notification();
-  AsHostStream(stream)->EnqueueTask(
-      [notification]() { notification->WaitForNotification(); });
+  AsHostStream(stream)->EnqueueWait(AsHostEvent(event)->notification());
   return ::tsl::OkStatus();
 }
 
 Event::Status HostExecutor::PollForEventStatus(Event* event) {
-  absl::Notification& notification = *AsHostEvent(event)->notification();
+  HostStreamNotification& notification = *AsHostEvent(event)->notification();
   return notification.HasBeenNotified() ? Event::Status::kComplete
                                         : Event::Status::kPending;
 }
@@ -356,6 +379,9 @@ rng::RngSupport* HostExecutor::CreateRng() {
 
 std::unique_ptr<internal::StreamInterface>
 HostExecutor::GetStreamImplementation() {
+  if (stream_thread_pool_) {
+    return std::make_unique<HostStream>(stream_thread_pool_);
+  }
   return std::unique_ptr<internal::StreamInterface>(
       new HostStream(thread_stack_size_in_bytes_));
 }
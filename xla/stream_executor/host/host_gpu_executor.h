@@ -20,6 +20,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_STREAM_EXECUTOR_HOST_HOST_GPU_EXECUTOR_H_
 
 #include <cstdint>
+#include <memory>
 
 #include "absl/functional/any_invocable.h"
 #include "xla/stream_executor/blas.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "xla/stream_executor/stream_executor.h"
 #include "xla/stream_executor/stream_executor_internal.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/threadpool.h"
 
 namespace stream_executor {
 namespace host {
@@ -49,7 +51,10 @@ class HostExecutor : public internal::StreamExecutorInterface {
   ~HostExecutor() override;
 
   // The stack size used for host streams can be set via
-  // device_options.non_portable_tags["host_stack_size"].
+  // device_options.non_portable_tags["host_thread_stack_size_in_bytes"].
+  // If device_options.non_portable_tags["host_stream_num_threads"] is a
+  // positive number, the executor's streams share a pool of that many threads
+  // instead of each running on a thread of its own.
   tsl::Status Init(int device_ordinal, DeviceOptions device_options) override;
 
   tsl::Status GetKernel(const MultiKernelLoaderSpec& spec,
@@ -181,6 +186,8 @@ class HostExecutor : public internal::StreamExecutorInterface {
   const PluginConfig plugin_config_;
   // Size of thread stacks for streams in bytes. '0' means "the default size".
   size_t thread_stack_size_in_bytes_ = 0;
+  // Threads shared by all streams, or null if each stream has its own thread.
+  std::shared_ptr<tsl::thread::ThreadPool> stream_thread_pool_;
 };
 
 }  // namespace host
@@ -17,8 +17,11 @@ limitations under the License.
 // the HostExecutor implementation.
 #include "xla/stream_executor/host/host_stream.h"
 
-#include <queue>
+#include <iterator>
+#include <memory>
 #include <utility>
+#include <variant>
+#include <vector>
 
 #include "absl/functional/any_invocable.h"
 #include "absl/synchronization/notification.h"
@@ -39,36 +42,117 @@ tsl::ThreadOptions GetThreadOptions(size_t stack_size_in_bytes) {
 
 }  // namespace
 
+void HostStreamNotification::Notify() {
+  std::vector<absl::AnyInvocable<void() &&>> callbacks;
+  {
+    absl::MutexLock lock(&mu_);
+    notified_ = true;
+    std::swap(callbacks, callbacks_);
+  }
+  for (auto& callback : callbacks) {
+    std::move(callback)();
+  }
+}
+
+bool HostStreamNotification::HasBeenNotified() const {
+  absl::MutexLock lock(&mu_);
+  return notified_;
+}
+
+void HostStreamNotification::WaitForNotification() const {
+  absl::MutexLock lock(&mu_);
+  mu_.Await(absl::Condition(&notified_));
+}
+
+void HostStreamNotification::AndThen(absl::AnyInvocable<void() &&> callback) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (!notified_) {
+      callbacks_.push_back(std::move(callback));
+      return;
+    }
+  }
+  std::move(callback)();
+}
+
 HostStream::HostStream(size_t stack_size_in_bytes)
     : thread_(tsl::Env::Default()->StartThread(
           GetThreadOptions(stack_size_in_bytes), "host_executor",
           [this]() { WorkLoop(); })) {}
 
+HostStream::HostStream(std::shared_ptr<tsl::thread::ThreadPool> thread_pool)
+    : thread_pool_(std::move(thread_pool)) {
+  CHECK(thread_pool_ != nullptr);
+}
+
 HostStream::~HostStream() {
+  if (thread_pool_) {
+    // Tasks hold no reference to the stream, so wait for the last Drain.
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &HostStream::Idle));
+    return;
+  }
   {
     absl::MutexLock lock(&mu_);
-    work_queue_.push(nullptr);
+    stop_ = true;
   }
   // thread_'s destructor blocks until the thread finishes running.
   thread_.reset();
 }
 
 bool HostStream::EnqueueTask(absl::AnyInvocable<void() &&> task) {
-  return EnqueueTaskWithStatus([task = std::move(task)]() mutable {
-    std::move(task)();
-    return ::tsl::OkStatus();
-  });
+  CHECK(task != nullptr);
+  return Enqueue(std::move(task));
 }
 
 bool HostStream::EnqueueTaskWithStatus(
     absl::AnyInvocable<tsl::Status() &&> task) {
   CHECK(task != nullptr);
+  return Enqueue(std::move(task));
+}
+
+bool HostStream::EnqueueWait(
+    std::shared_ptr<HostStreamNotification> notification) {
+  CHECK(notification != nullptr);
+  return Enqueue(std::move(notification));
+}
+
+bool HostStream::Enqueue(Task task) {
   absl::MutexLock lock(&mu_);
-  work_queue_.push(std::move(task));
+  work_queue_.push_back(std::move(task));
+  // Only one Drain is in flight at a time, which keeps tasks in FIFO order and
+  // lets a single pool wakeup run every task enqueued before it starts.
+  if (thread_pool_ && !draining_) {
+    draining_ = true;
+    thread_pool_->Schedule([this]() { Drain(); });
+  }
   return true;
 }
 
-bool HostStream::WorkAvailable() { return !work_queue_.empty(); }
+bool HostStream::WorkAvailable() { return stop_ || !work_queue_.empty(); }
+
+bool HostStream::Idle() { return !draining_; }
+
+size_t HostStream::RunTasks(std::vector<Task>& tasks, bool park) {
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    Task& task = tasks[i];
+    if (auto* fn = std::get_if<absl::AnyInvocable<void() &&>>(&task)) {
+      std::move(*fn)();
+    } else if (auto* status_fn =
+                   std::get_if<absl::AnyInvocable<tsl::Status() &&>>(&task)) {
+      status_.Update(std::move(*status_fn)());
+    } else {
+      auto& notification =
+          std::get<std::shared_ptr<HostStreamNotification>>(task);
+      if (!park) {
+        notification->WaitForNotification();
+      } else if (!notification->HasBeenNotified()) {
+        return i;
+      }
+    }
+  }
+  return tasks.size();
+}
 
 void HostStream::WorkLoop() {
   // Set denormal and rounding behavior to match the default TF ThreadPool
@@ -77,30 +161,63 @@ void HostStream::WorkLoop() {
   tsl::port::ScopedFlushDenormal flush;
   tsl::port::ScopedSetRound round(FE_TONEAREST);
   while (true) {
-    std::queue<absl::AnyInvocable<tsl::Status() &&>> queue;
+    bool stop;
     {
       absl::MutexLock lock(&mu_);
       mu_.Await(absl::Condition(this, &HostStream::WorkAvailable));
-      std::swap(queue, work_queue_);
+      std::swap(batch_, work_queue_);
+      stop = stop_;
     }
-    while (!queue.empty()) {
-      absl::AnyInvocable<tsl::Status()&&>& fn = queue.front();
-      if (!fn) {
-        return;
-      }
-      status_.Update(std::move(fn)());
-      queue.pop();
+    RunTasks(batch_, /*park=*/false);
+    batch_.clear();
+    if (stop) {
+      return;
     }
   }
 }
 
+void HostStream::Drain() {
+  tsl::port::ScopedFlushDenormal flush;
+  tsl::port::ScopedSetRound round(FE_TONEAREST);
+  {
+    absl::MutexLock lock(&mu_);
+    std::swap(batch_, work_queue_);
+  }
+  size_t num_run = RunTasks(batch_, /*park=*/true);
+  if (num_run < batch_.size()) {
+    // Park the stream: the wait and the tasks after it go back to the front of
+    // the queue, and draining_ stays set so that no Drain is scheduled until
+    // the notification reschedules one.
+    std::shared_ptr<HostStreamNotification> notification =
+        std::get<std::shared_ptr<HostStreamNotification>>(batch_[num_run]);
+    {
+      absl::MutexLock lock(&mu_);
+      work_queue_.insert(work_queue_.begin(),
+                         std::make_move_iterator(batch_.begin() + num_run),
+                         std::make_move_iterator(batch_.end()));
+    }
+    batch_.clear();
+    notification->AndThen(
+        [this]() { thread_pool_->Schedule([this]() { Drain(); }); });
+    return;
+  }
+  batch_.clear();
+  absl::MutexLock lock(&mu_);
+  if (work_queue_.empty()) {
+    draining_ = false;
+  } else {
+    // Yield the pool thread between batches so that a busy stream does not
+    // starve the other streams sharing the pool.
+    thread_pool_->Schedule([this]() { Drain(); });
+  }
+}
+
 tsl::Status HostStream::BlockUntilDone() {
   absl::Notification done;
   tsl::Status status;
   EnqueueTask([&done, &status, this]() {
-    // This task is always executed synchronously before 'status_' is updated
-    // with the result of the task (always OK() in this case), so we don't need
-    // to worry about locking access to 'status_'.
+    // Tasks of a stream never run concurrently, and this task doesn't report
+    // a status, so we don't need to worry about locking access to 'status_'.
     status = status_;
     status_ = ::tsl::OkStatus();
     done.Notify();
@@ -20,21 +20,49 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
-#include <queue>
+#include <variant>
+#include <vector>
 
 #include "absl/functional/any_invocable.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/stream_executor/stream_executor_internal.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
 
 namespace stream_executor {
 namespace host {
 
+// A one-shot notification that a HostStream can wait for without holding a
+// thread while it is pending; see HostStream::EnqueueWait.
+class HostStreamNotification {
+ public:
+  // Marks the notification as notified and runs the pending callbacks.
+  void Notify();
+  bool HasBeenNotified() const;
+  // Blocks the calling thread until the notification is notified.
+  void WaitForNotification() const;
+  // Runs 'callback' once the notification is notified, right away if it
+  // already is.
+  void AndThen(absl::AnyInvocable<void() &&> callback);
+
+ private:
+  mutable absl::Mutex mu_;
+  bool notified_ ABSL_GUARDED_BY(mu_) = false;
+  std::vector<absl::AnyInvocable<void() &&>> callbacks_ ABSL_GUARDED_BY(mu_);
+};
+
+// A stream runs its tasks in FIFO order, one at a time. Tasks either run on a
+// thread dedicated to the stream, or on a thread pool that is shared by many
+// streams; in the latter case a stream only occupies a pool thread while it
+// has work, so idle streams cost no threads.
 class HostStream : public internal::StreamInterface {
  public:
-  // stack_size_in_bytes may be '0', meaning "use the default thread stack
-  // size".
+  // Runs tasks on a dedicated thread. stack_size_in_bytes may be '0', meaning
+  // "use the default thread stack size".
   explicit HostStream(size_t stack_size_in_bytes);
+  // Runs tasks on 'thread_pool'. The pool must not be destroyed before the
+  // stream, which the shared ownership guarantees.
+  explicit HostStream(std::shared_ptr<tsl::thread::ThreadPool> thread_pool);
   ~HostStream() override;
 
   // Enqueue a task that reports a status when finished. Tasks that fail do not
@@ -44,6 +72,11 @@ class HostStream : public internal::StreamInterface {
   bool EnqueueTaskWithStatus(absl::AnyInvocable<tsl::Status() &&> task);
   // Enqueue a task that doesn't report any status.
   bool EnqueueTask(absl::AnyInvocable<void() &&> task);
+  // Enqueue a wait: the tasks enqueued after it run once 'notification' is
+  // notified. A stream on a shared thread pool gives its pool thread back
+  // while it waits, so that streams waiting for each other cannot deadlock
+  // the pool.
+  bool EnqueueWait(std::shared_ptr<HostStreamNotification> notification);
 
   void* GpuStreamHack() override { return nullptr; }
   void** GpuStreamMemberHack() override { return nullptr; }
@@ -53,13 +86,41 @@ class HostStream : public internal::StreamInterface {
   tsl::Status BlockUntilDone();
 
  private:
+  // Tasks are stored as enqueued rather than wrapping status-less tasks in
+  // another closure, which would usually need a heap allocation.
+  using Task = std::variant<absl::AnyInvocable<void() &&>,
+                            absl::AnyInvocable<tsl::Status() &&>,
+                            std::shared_ptr<HostStreamNotification>>;
+
+  bool Enqueue(Task task);
   bool WorkAvailable() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool Idle() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   void WorkLoop();
+  // Runs the tasks that are queued when it is called on a thread pool thread,
+  // then schedules itself again if more tasks have arrived in the meantime.
+  // A wait for a pending notification parks the stream instead: the tasks
+  // from the wait on go back to the queue, and the notification schedules
+  // the next Drain.
+  void Drain();
+  // Runs the tasks in 'tasks' in order and returns how many ran. Waits block
+  // the calling thread unless 'park' is set, in which case the tasks stop at
+  // the first wait for a pending notification.
+  size_t RunTasks(std::vector<Task>& tasks, bool park);
 
   absl::Mutex mu_;
-  std::queue<absl::AnyInvocable<tsl::Status() &&>> work_queue_
-      ABSL_GUARDED_BY(mu_);
+  std::vector<Task> work_queue_ ABSL_GUARDED_BY(mu_);
+  // Set when a dedicated thread should exit after running the queued tasks.
+  bool stop_ ABSL_GUARDED_BY(mu_) = false;
+  // Set while a Drain is scheduled or running on thread_pool_, or while the
+  // stream is parked on a wait. The queue is only non-empty while this is
+  // set.
+  bool draining_ ABSL_GUARDED_BY(mu_) = false;
+  // Exactly one of thread_ and thread_pool_ is set.
   std::unique_ptr<tsl::Thread> thread_;
+  std::shared_ptr<tsl::thread::ThreadPool> thread_pool_;
+  // Tasks are moved here from work_queue_ in batches; only accessed by the
+  // thread that runs tasks, and reused to avoid reallocating the queue.
+  std::vector<Task> batch_;
   tsl::Status status_;
 };
 
@@ -13,14 +13,23 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "absl/synchronization/mutex.h"
+#include "xla/stream_executor/host/host_stream.h"
+#include "xla/stream_executor/event.h"
 #include "xla/stream_executor/multi_platform_manager.h"
 #include "xla/stream_executor/platform.h"
 #include "xla/stream_executor/stream.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
 
 namespace se = stream_executor;
 
@@ -78,3 +87,141 @@ TEST(HostStream, ReportsFirstHostCallbackError) {
   // "error 2" is just lost.
   ASSERT_EQ(stream.BlockHostUntilDone().error_message(), "error 1");
 }
+
+TEST(HostStream, SharedThreadPoolEnforcesFIFOOrderPerStream) {
+  auto pool = std::make_shared<tsl::thread::ThreadPool>(tsl::Env::Default(),
+                                                        "host_stream_test", 4);
+  constexpr int kNumStreams = 8;
+  std::vector<std::unique_ptr<se::host::HostStream>> streams;
+  std::vector<int> expected(kNumStreams, 0);
+  std::vector<bool> ok(kNumStreams, true);
+  for (int s = 0; s < kNumStreams; ++s) {
+    streams.push_back(std::make_unique<se::host::HostStream>(pool));
+  }
+  // Tasks of one stream never run concurrently, so each stream's counter is
+  // only touched by one thread at a time.
+  for (int i = 0; i < 1000; ++i) {
+    for (int s = 0; s < kNumStreams; ++s) {
+      streams[s]->EnqueueTask([i, s, &expected, &ok]() {
+        if (expected[s] != i) {
+          ok[s] = false;
+        }
+        ++expected[s];
+      });
+    }
+  }
+  for (int s = 0; s < kNumStreams; ++s) {
+    TF_ASSERT_OK(streams[s]->BlockUntilDone());
+    EXPECT_TRUE(ok[s]) << "stream " << s;
+    EXPECT_EQ(expected[s], 1000) << "stream " << s;
+  }
+}
+
+TEST(HostStream, SharedThreadPoolReportsFirstError) {
+  auto pool = std::make_shared<tsl::thread::ThreadPool>(tsl::Env::Default(),
+                                                        "host_stream_test", 2);
+  se::host::HostStream stream(pool);
+  stream.EnqueueTaskWithStatus(
+      []() { return tsl::errors::Internal("error 1"); });
+  stream.EnqueueTaskWithStatus(
+      []() { return tsl::errors::Internal("error 2"); });
+  ASSERT_EQ(stream.BlockUntilDone().error_message(), "error 1");
+  TF_ASSERT_OK(stream.BlockUntilDone());
+}
+
+TEST(HostStream, SharedThreadPoolStreamDestructionWaitsForTasks) {
+  auto pool = std::make_shared<tsl::thread::ThreadPool>(tsl::Env::Default(),
+                                                        "host_stream_test", 2);
+  int count = 0;
+  {
+    se::host::HostStream stream(pool);
+    for (int i = 0; i < 100; ++i) {
+      stream.EnqueueTask([&count]() { ++count; });
+    }
+  }
+  EXPECT_EQ(count, 100);
+}
+
+TEST(HostStream, SharedThreadPoolStreamsWaitForEachOther) {
+  se::Platform* platform =
+      se::MultiPlatformManager::PlatformWithName("Host").value();
+  se::StreamExecutorConfig config(/*ordinal=*/0);
+  config.device_options.non_portable_tags["host_stream_num_threads"] = "1";
+  std::unique_ptr<se::StreamExecutor> executor =
+      platform->GetUncachedExecutor(config).value();
+  se::Stream a(executor.get());
+  se::Stream b(executor.get());
+  se::Stream c(executor.get());
+  a.Init();
+  b.Init();
+  c.Init();
+  se::Event event(executor.get());
+  ASSERT_TRUE(event.Init());
+
+  // With a single pool thread, a wait that blocked the thread would keep 'c'
+  // from ever recording the event that 'b' waits for.
+  absl::Mutex mu;
+  std::vector<char> order;
+  auto append = [&mu, &order](char stream) {
+    return [&mu, &order, stream]() {
+      absl::MutexLock lock(&mu);
+      order.push_back(stream);
+    };
+  };
+  b.ThenWaitFor(&event);
+  b.ThenDoHostCallback(append('b'));
+  // Uses CreateStreamDependency.
+  a.ThenWaitFor(&b);
+  a.ThenDoHostCallback(append('a'));
+  c.ThenDoHostCallback(append('c'));
+  c.ThenRecordEvent(&event);
+
+  TF_ASSERT_OK(a.BlockHostUntilDone());
+  TF_ASSERT_OK(b.BlockHostUntilDone());
+  TF_ASSERT_OK(c.BlockHostUntilDone());
+  absl::MutexLock lock(&mu);
+  EXPECT_EQ(order, std::vector<char>({'c', 'b', 'a'}));
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below.
+//===----------------------------------------------------------------------===//
+
+// Enqueues many small tasks on each of range(0) streams. Streams run on
+// dedicated threads if range(1) is 0, otherwise on a pool of range(1) threads.
+void BM_HostStreamSmallTasks(::testing::benchmark::State& state) {
+  const int num_streams = state.range(0);
+  const int num_threads = state.range(1);
+  constexpr int kTasksPerStream = 1000;
+
+  std::shared_ptr<tsl::thread::ThreadPool> pool;
+  if (num_threads > 0) {
+    pool = std::make_shared<tsl::thread::ThreadPool>(
+        tsl::Env::Default(), "host_stream_bm", num_threads);
+  }
+  std::vector<std::unique_ptr<se::host::HostStream>> streams;
+  for (int s = 0; s < num_streams; ++s) {
+    streams.push_back(pool ? std::make_unique<se::host::HostStream>(pool)
+                           : std::make_unique<se::host::HostStream>(
+                                 /*stack_size_in_bytes=*/size_t{0}));
+  }
+  std::vector<char> src(256);
+  std::vector<std::vector<char>> dst(num_streams, std::vector<char>(256));
+  for (auto _ : state) {
+    for (int i = 0; i < kTasksPerStream; ++i) {
+      for (int s = 0; s < num_streams; ++s) {
+        streams[s]->EnqueueTask([&src, dst = &dst[s]]() {
+          std::copy(src.begin(), src.end(), dst->begin());
+        });
+      }
+    }
+    for (auto& stream : streams) {
+      TF_CHECK_OK(stream->BlockUntilDone());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_streams * kTasksPerStream);
+}
+
+BENCHMARK(BM_HostStreamSmallTasks)
+    ->ArgsProduct({{1, 4, 16}, {0, 2, 4}})
+    ->UseRealTime();